@@ -0,0 +1,585 @@
+// Microbenchmarks for the header-only math types: vectors, quaternions, matrices, ColorRGB and FastMath,
+// per element and in the batch/SIMD forms. Needs nothing but the headers in source/, so it builds anywhere:
+//
+//   g++ -std=c++20 -O2 -DNDEBUG -march=native -Isource benchmarks/MathBenchmark.cpp -o MathBenchmark
+//   cl /std:c++20 /O2 /DNDEBUG /arch:AVX2 /EHsc /Isource benchmarks\MathBenchmark.cpp
+//
+// Add -DDAE_MATH_SCALAR to measure the portable code. Usage:
+//
+//   MathBenchmark [--filter <text>] [--json <file>] [--compare <baseline.json>] [--threshold <percent>] [--sample-ms <ms>]
+//
+// FastMath rows are each followed by their std:: reference and the gain over it, --filter std runs just the references.
+// --json writes the results, keep one as the baseline. --compare runs against such a file and exits with 1 when an
+// operation got slower by more than the threshold (10% by default). Compare builds with the same flags on the same machine
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Math.h"
+#include "FastMath.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace dae
+{
+	namespace
+	{
+		// Elements per call, small enough that everything stays in L1
+		constexpr size_t numElements{ 1024 };
+		constexpr int numSamples{ 7 };
+
+		// Keeps the compiler from merging or dropping the repeated calls, their stores have to happen every time
+		inline void ClobberMemory()
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			_ReadWriteBarrier();
+#else
+			asm volatile("" ::: "memory");
+#endif
+		}
+
+		struct Options
+		{
+			std::string filter{};
+			std::string jsonPath{};
+			std::string baselinePath{};
+			double thresholdPercent{ 10.0 };
+			double sampleMilliseconds{ 10.0 };
+		};
+
+		struct Result
+		{
+			std::string name{};
+			// Fastest sample, the least disturbed by the rest of the system
+			double nsPerOp{};
+			double medianNsPerOp{};
+		};
+
+		// Vertex-like layout for the strided transforms
+		struct StridedVertex
+		{
+			Vector3 position;
+			Vector3 normal;
+			Vector2 uv;
+		};
+
+		class Benchmark final
+		{
+		public:
+			explicit Benchmark(const Options& options) : m_Options{ options } {}
+
+			Benchmark(const Benchmark& other) = delete;
+			Benchmark& operator=(const Benchmark& other) = delete;
+			Benchmark(Benchmark&& other) = delete;
+			Benchmark& operator=(Benchmark&& other) = delete;
+
+			// kernel does numOps operations per call
+			void Run(const std::string& name, size_t numOps, const std::function<void()>& kernel)
+			{
+				if (!m_Options.filter.empty() && name.find(m_Options.filter) == std::string::npos)
+					return;
+
+				// Enough calls per sample to reach the sample time
+				size_t numCalls{ 1 };
+				for (;;)
+				{
+					const double seconds{ Time(kernel, numCalls) };
+					if (seconds * 1000.0 >= m_Options.sampleMilliseconds)
+						break;
+					numCalls *= seconds > 0.0 ? std::clamp(static_cast<size_t>(m_Options.sampleMilliseconds / (seconds * 1000.0) * 1.2) + 1, size_t{ 2 }, size_t{ 100 }) : 100;
+				}
+
+				double samples[numSamples]{};
+				for (double& sample : samples)
+					sample = Time(kernel, numCalls) * 1e9 / static_cast<double>(numCalls * numOps);
+				std::sort(std::begin(samples), std::end(samples));
+
+				m_Results.push_back({ name, samples[0], samples[numSamples / 2] });
+				std::cout << "[BENCH] " << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(3)
+					<< std::setw(10) << samples[0] << " ns/op (median " << samples[numSamples / 2] << ")\n";
+			}
+
+			// How many times faster name ran than referenceName, when both ran
+			void ReportGain(const std::string& name, const std::string& referenceName) const
+			{
+				const auto find{ [this](const std::string& resultName)
+					{
+						return std::find_if(m_Results.begin(), m_Results.end(), [&resultName](const Result& result) { return result.name == resultName; });
+					} };
+				const auto result{ find(name) };
+				const auto reference{ find(referenceName) };
+				if (result == m_Results.end() || reference == m_Results.end() || result->nsPerOp <= 0.0)
+					return;
+
+				std::cout << "[BENCH]   " << name << ": " << std::setprecision(2) << reference->nsPerOp / result->nsPerOp << "x the speed of " << referenceName << "\n";
+			}
+
+			const std::vector<Result>& GetResults() const { return m_Results; }
+
+		private:
+			static double Time(const std::function<void()>& kernel, size_t numCalls)
+			{
+				const auto start{ std::chrono::steady_clock::now() };
+				for (size_t i{}; i < numCalls; ++i)
+				{
+					kernel();
+					ClobberMemory();
+				}
+				return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			const Options& m_Options;
+			std::vector<Result> m_Results{};
+		};
+
+		// Inputs drawn once with a fixed seed, so every run and every build sees the same values
+		struct Inputs
+		{
+			std::vector<float> scalars, angles, positives, exponents;
+			std::vector<Vector2> vector2s, otherVector2s;
+			std::vector<Vector3> vector3s, otherVector3s;
+			std::vector<Vector4> vector4s, otherVector4s;
+			std::vector<Quaternion> quaternions, otherQuaternions;
+			std::vector<ColorRGB> colors, otherColors;
+			std::vector<Matrix> matrices, affineMatrices, rigidMatrices;
+			std::vector<StridedVertex> vertices;
+			std::vector<float> x, y, z;
+
+			Inputs()
+			{
+				std::mt19937 generator{ 1234 };
+				std::uniform_real_distribution<float> unit{ -1.f, 1.f };
+				std::uniform_real_distribution<float> positive{ 0.01f, 4.f };
+				std::uniform_real_distribution<float> angle{ -PI, PI };
+
+				const auto randomVector3{ [&]() { return Vector3{ unit(generator), unit(generator), unit(generator) }; } };
+				const auto randomRotation{ [&]() { return Quaternion{ unit(generator), unit(generator), unit(generator), unit(generator) }.Normalized(); } };
+				for (size_t i{}; i < numElements; ++i)
+				{
+					scalars.push_back(unit(generator));
+					angles.push_back(angle(generator) * 4.f);
+					positives.push_back(positive(generator));
+					exponents.push_back(unit(generator) * 8.f);
+					vector2s.push_back({ unit(generator), unit(generator) });
+					otherVector2s.push_back({ unit(generator), unit(generator) });
+					vector3s.push_back(randomVector3());
+					otherVector3s.push_back(randomVector3());
+					vector4s.push_back({ randomVector3(), 1.f });
+					otherVector4s.push_back({ randomVector3(), unit(generator) });
+					quaternions.push_back(randomRotation());
+					otherQuaternions.push_back(randomRotation());
+					// Some channels above one, so MaxToOne takes both paths
+					colors.push_back({ positive(generator) * 0.4f, positive(generator) * 0.4f, positive(generator) * 0.4f });
+					otherColors.push_back({ positive(generator) * 0.4f, positive(generator) * 0.4f, positive(generator) * 0.4f });
+					vertices.push_back({ randomVector3(), randomVector3(), { unit(generator), unit(generator) } });
+					x.push_back(unit(generator));
+					y.push_back(unit(generator));
+					z.push_back(unit(generator));
+				}
+
+				// A handful of matrices is plenty, the operations don't depend on the values
+				for (size_t i{}; i < 64; ++i)
+				{
+					Matrix rigid{ Matrix::CreateRotation(randomRotation()) * Matrix::CreateTranslation(randomVector3() * 10.f) };
+					rigidMatrices.push_back(rigid);
+					affineMatrices.push_back(Matrix::CreateScale(positive(generator), positive(generator), positive(generator)) * rigid);
+					matrices.push_back(affineMatrices.back() * Matrix::CreatePerspectiveFovLH(1.f, 16.f / 9.f, 0.1f, 100.f));
+				}
+			}
+		};
+
+		// The Matrix::CreateRotation* functions with std::sin and std::cos instead of FastMath::SinCos
+		Matrix CreateRotationXStd(float pitch)
+		{
+			const float sin{ std::sin(pitch) }, cos{ std::cos(pitch) };
+			return { { 1, 0, 0, 0 }, { 0, cos, -sin, 0 }, { 0, sin, cos, 0 }, { 0, 0, 0, 1 } };
+		}
+
+		Matrix CreateRotationYStd(float yaw)
+		{
+			const float sin{ std::sin(yaw) }, cos{ std::cos(yaw) };
+			return { { cos, 0, -sin, 0 }, { 0, 1, 0, 0 }, { sin, 0, cos, 0 }, { 0, 0, 0, 1 } };
+		}
+
+		Matrix CreateRotationZStd(float roll)
+		{
+			const float sin{ std::sin(roll) }, cos{ std::cos(roll) };
+			return { { cos, sin, 0, 0 }, { -sin, cos, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+		}
+
+		// Orthogonalizes tangent against normal and normalizes it, like the per-vertex step of TangentSpace::GenerateTangents.
+		// useFastMath picks FastMath::RSqrt, as there, or 1 / std::sqrt
+		template<bool useFastMath>
+		Vector3 OrthonormalizeTangent(const Vector3& tangent, const Vector3& normal)
+		{
+			const float sqrNormalLength{ normal.SqrMagnitude() };
+			const Vector3 rejected{ sqrNormalLength > 0.f ? tangent - normal * (Vector3::Dot(normal, tangent) / sqrNormalLength) : tangent };
+			const float sqrLength{ rejected.SqrMagnitude() };
+			if (sqrLength < FLT_MIN || sqrLength > FLT_MAX)
+				return Vector3::Zero;
+			if constexpr (useFastMath)
+				return rejected * FastMath::RSqrt(sqrLength);
+			else
+				return rejected * (1.f / std::sqrt(sqrLength));
+		}
+
+		void RunVectorBenchmarks(Benchmark& benchmark, const Inputs& in)
+		{
+			static std::vector<float> floats(numElements);
+			static std::vector<Vector2> vector2s(numElements);
+			static std::vector<Vector3> vector3s(numElements);
+			static std::vector<Vector4> vector4s(numElements);
+
+			benchmark.Run("Vector2::operator+", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector2s[i] = in.vector2s[i] + in.otherVector2s[i]; });
+			benchmark.Run("Vector2::Dot", numElements, [&]() { for (size_t i{}; i < numElements; ++i) floats[i] = Vector2::Dot(in.vector2s[i], in.otherVector2s[i]); });
+			benchmark.Run("Vector2::Cross", numElements, [&]() { for (size_t i{}; i < numElements; ++i) floats[i] = Vector2::Cross(in.vector2s[i], in.otherVector2s[i]); });
+			benchmark.Run("Vector2::Magnitude", numElements, [&]() { for (size_t i{}; i < numElements; ++i) floats[i] = in.vector2s[i].Magnitude(); });
+			benchmark.Run("Vector2::Normalized", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector2s[i] = in.vector2s[i].Normalized(); });
+
+			benchmark.Run("Vector3::operator+", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = in.vector3s[i] + in.otherVector3s[i]; });
+			benchmark.Run("Vector3::operator*(float)", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = in.vector3s[i] * in.scalars[i]; });
+			benchmark.Run("Vector3::Dot", numElements, [&]() { for (size_t i{}; i < numElements; ++i) floats[i] = Vector3::Dot(in.vector3s[i], in.otherVector3s[i]); });
+			benchmark.Run("Vector3::Cross", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = Vector3::Cross(in.vector3s[i], in.otherVector3s[i]); });
+			benchmark.Run("Vector3::Magnitude", numElements, [&]() { for (size_t i{}; i < numElements; ++i) floats[i] = in.vector3s[i].Magnitude(); });
+			benchmark.Run("Vector3::Normalized", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = in.vector3s[i].Normalized(); });
+			benchmark.Run("Vector3::Project", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = Vector3::Project(in.vector3s[i], in.otherVector3s[i]); });
+			benchmark.Run("Vector3::Reject", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = Vector3::Reject(in.vector3s[i], in.otherVector3s[i]); });
+			benchmark.Run("Vector3::Reflect", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = Vector3::Reflect(in.vector3s[i], in.otherVector3s[i]); });
+
+			benchmark.Run("Vector4::operator+", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector4s[i] = in.vector4s[i] + in.otherVector4s[i]; });
+			benchmark.Run("Vector4::Dot", numElements, [&]() { for (size_t i{}; i < numElements; ++i) floats[i] = Vector4::Dot(in.vector4s[i], in.otherVector4s[i]); });
+			benchmark.Run("Vector4::Normalized", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector4s[i] = in.vector4s[i].Normalized(); });
+		}
+
+		void RunQuaternionBenchmarks(Benchmark& benchmark, const Inputs& in)
+		{
+			static std::vector<Quaternion> quaternions(numElements);
+			static std::vector<Vector3> vector3s(numElements);
+
+			benchmark.Run("Quaternion::operator*", numElements, [&]() { for (size_t i{}; i < numElements; ++i) quaternions[i] = in.quaternions[i] * in.otherQuaternions[i]; });
+			benchmark.Run("Quaternion::Normalized", numElements, [&]() { for (size_t i{}; i < numElements; ++i) quaternions[i] = in.quaternions[i].Normalized(); });
+			benchmark.Run("Quaternion::Rotate", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = in.quaternions[i].Rotate(in.vector3s[i]); });
+			benchmark.Run("Quaternion::CreateFromAxisAngle", numElements, [&]() { for (size_t i{}; i < numElements; ++i) quaternions[i] = Quaternion::CreateFromAxisAngle(in.vector3s[i], in.angles[i]); });
+			benchmark.Run("Quaternion::CreateRotationY", numElements, [&]() { for (size_t i{}; i < numElements; ++i) quaternions[i] = Quaternion::CreateRotationY(in.angles[i]); });
+		}
+
+		void RunColorBenchmarks(Benchmark& benchmark, const Inputs& in)
+		{
+			static std::vector<ColorRGB> colors(numElements);
+
+			benchmark.Run("ColorRGB::operator+", numElements, [&]() { for (size_t i{}; i < numElements; ++i) colors[i] = in.colors[i] + in.otherColors[i]; });
+			benchmark.Run("ColorRGB::operator*(ColorRGB)", numElements, [&]() { for (size_t i{}; i < numElements; ++i) colors[i] = in.colors[i] * in.otherColors[i]; });
+			benchmark.Run("ColorRGB::operator*(float)", numElements, [&]() { for (size_t i{}; i < numElements; ++i) colors[i] = in.colors[i] * in.positives[i]; });
+			benchmark.Run("ColorRGB::operator/(float)", numElements, [&]() { for (size_t i{}; i < numElements; ++i) colors[i] = in.colors[i] / in.positives[i]; });
+			benchmark.Run("ColorRGB::Lerp", numElements, [&]() { for (size_t i{}; i < numElements; ++i) colors[i] = ColorRGB::Lerp(in.colors[i], in.otherColors[i], in.scalars[i]); });
+			benchmark.Run("ColorRGB::MaxToOne", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; ++i)
+					{
+						colors[i] = in.colors[i];
+						colors[i].MaxToOne();
+					}
+				});
+		}
+
+		void RunMatrixBenchmarks(Benchmark& benchmark, const Inputs& in)
+		{
+			static std::vector<Matrix> matrices(in.matrices.size());
+			static std::vector<Vector3> vector3s(numElements);
+			static std::vector<Vector4> vector4s(numElements);
+			static std::vector<StridedVertex> vertices(numElements);
+			static std::vector<float> x(numElements), y(numElements), z(numElements);
+			const size_t numMatrices{ in.matrices.size() };
+			const Matrix& matrix{ in.matrices[0] };
+
+			benchmark.Run("Matrix::operator*", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = in.matrices[i] * in.rigidMatrices[i]; });
+			benchmark.Run("Matrix::Transpose", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = Matrix::Transpose(in.matrices[i]); });
+			benchmark.Run("Matrix::Inverse", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = Matrix::Inverse(in.matrices[i]); });
+			benchmark.Run("Matrix::InverseAffine", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = Matrix::InverseAffine(in.affineMatrices[i]); });
+			benchmark.Run("Matrix::InverseRigid", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = Matrix::InverseRigid(in.rigidMatrices[i]); });
+
+			// FastMath::SinCos inside, against the same matrices from std::sin and std::cos
+			benchmark.Run("Matrix::CreateRotationX", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = Matrix::CreateRotationX(in.angles[i]); });
+			benchmark.Run("Matrix::CreateRotationX, std", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = CreateRotationXStd(in.angles[i]); });
+			benchmark.ReportGain("Matrix::CreateRotationX", "Matrix::CreateRotationX, std");
+			benchmark.Run("Matrix::CreateRotationY", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = Matrix::CreateRotationY(in.angles[i]); });
+			benchmark.Run("Matrix::CreateRotationY, std", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = CreateRotationYStd(in.angles[i]); });
+			benchmark.ReportGain("Matrix::CreateRotationY", "Matrix::CreateRotationY, std");
+			benchmark.Run("Matrix::CreateRotationZ", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = Matrix::CreateRotationZ(in.angles[i]); });
+			benchmark.Run("Matrix::CreateRotationZ, std", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = CreateRotationZStd(in.angles[i]); });
+			benchmark.ReportGain("Matrix::CreateRotationZ", "Matrix::CreateRotationZ, std");
+			benchmark.Run("Matrix::CreateRotation(pitch, yaw, roll)", numMatrices, [&]()
+				{
+					for (size_t i{}; i < numMatrices; ++i)
+						matrices[i] = Matrix::CreateRotation(in.angles[i], in.angles[i + numMatrices], in.angles[i + 2 * numMatrices]);
+				});
+			benchmark.Run("Matrix::CreateRotation(pitch, yaw, roll), std", numMatrices, [&]()
+				{
+					for (size_t i{}; i < numMatrices; ++i)
+						matrices[i] = CreateRotationXStd(in.angles[i]) * CreateRotationYStd(in.angles[i + numMatrices]) * CreateRotationZStd(in.angles[i + 2 * numMatrices]);
+				});
+			benchmark.ReportGain("Matrix::CreateRotation(pitch, yaw, roll)", "Matrix::CreateRotation(pitch, yaw, roll), std");
+			benchmark.Run("Matrix::CreateRotation(Quaternion)", numMatrices, [&]() { for (size_t i{}; i < numMatrices; ++i) matrices[i] = Matrix::CreateRotation(in.quaternions[i]); });
+
+			// One at a time
+			benchmark.Run("Matrix::TransformPoint(Vector3)", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = matrix.TransformPoint(in.vector3s[i]); });
+			benchmark.Run("Matrix::TransformPoint(Vector4)", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector4s[i] = matrix.TransformPoint(in.vector4s[i]); });
+			benchmark.Run("Matrix::TransformVector", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = matrix.TransformVector(in.vector3s[i]); });
+
+			// Batch forms
+			benchmark.Run("Matrix::TransformPoints(span)", numElements, [&]() { matrix.TransformPoints(in.vector3s, vector3s); });
+			benchmark.Run("Matrix::TransformVectors(span)", numElements, [&]() { matrix.TransformVectors(in.vector3s, vector3s); });
+			benchmark.Run("Matrix::TransformPoints(span, Vector4)", numElements, [&]() { matrix.TransformPoints(in.vector3s, vector4s); });
+			benchmark.Run("Matrix::TransformPoints(span, Vector4, divideByW)", numElements, [&]() { matrix.TransformPoints(in.vector3s, vector4s, true); });
+			benchmark.Run("Matrix::TransformPoints(strided)", numElements, [&]()
+				{
+					matrix.TransformPoints(&in.vertices[0].position, sizeof(StridedVertex), &vertices[0].position, sizeof(StridedVertex), numElements);
+				});
+			benchmark.Run("Matrix::TransformPoints(x, y, z)", numElements, [&]() { matrix.TransformPoints(in.x, in.y, in.z, x, y, z); });
+			benchmark.Run("Matrix::TransformVectors(x, y, z)", numElements, [&]() { matrix.TransformVectors(in.x, in.y, in.z, x, y, z); });
+		}
+
+		void RunFastMathBenchmarks(Benchmark& benchmark, const Inputs& in)
+		{
+			static std::vector<float> resultsX(numElements), resultsY(numElements), resultsZ(numElements);
+			static std::vector<Vector3> vector3s(numElements);
+
+			benchmark.Run("FastMath::RSqrt", numElements, [&]() { for (size_t i{}; i < numElements; ++i) resultsX[i] = FastMath::RSqrt(in.positives[i]); });
+			benchmark.Run("1 / std::sqrt", numElements, [&]() { for (size_t i{}; i < numElements; ++i) resultsX[i] = 1.f / std::sqrt(in.positives[i]); });
+			benchmark.ReportGain("FastMath::RSqrt", "1 / std::sqrt");
+			benchmark.Run("FastMath::Normalized", numElements, [&]() { for (size_t i{}; i < numElements; ++i) vector3s[i] = FastMath::Normalized(in.vector3s[i]); });
+			benchmark.Run("Normalized, 1 / std::sqrt", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; ++i)
+						vector3s[i] = in.vector3s[i] * (1.f / std::sqrt(in.vector3s[i].SqrMagnitude()));
+				});
+			benchmark.ReportGain("FastMath::Normalized", "Normalized, 1 / std::sqrt");
+			benchmark.Run("FastMath::SinCos", numElements, [&]() { for (size_t i{}; i < numElements; ++i) FastMath::SinCos(in.angles[i], resultsX[i], resultsY[i]); });
+			benchmark.Run("std::sin + std::cos", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; ++i)
+					{
+						resultsX[i] = std::sin(in.angles[i]);
+						resultsY[i] = std::cos(in.angles[i]);
+					}
+				});
+			benchmark.ReportGain("FastMath::SinCos", "std::sin + std::cos");
+			benchmark.Run("FastMath::Exp2", numElements, [&]() { for (size_t i{}; i < numElements; ++i) resultsX[i] = FastMath::Exp2(in.exponents[i]); });
+			benchmark.Run("std::exp2", numElements, [&]() { for (size_t i{}; i < numElements; ++i) resultsX[i] = std::exp2(in.exponents[i]); });
+			benchmark.ReportGain("FastMath::Exp2", "std::exp2");
+			benchmark.Run("FastMath::Log2", numElements, [&]() { for (size_t i{}; i < numElements; ++i) resultsX[i] = FastMath::Log2(in.positives[i]); });
+			benchmark.Run("std::log2", numElements, [&]() { for (size_t i{}; i < numElements; ++i) resultsX[i] = std::log2(in.positives[i]); });
+			benchmark.ReportGain("FastMath::Log2", "std::log2");
+			benchmark.Run("FastMath::Pow", numElements, [&]() { for (size_t i{}; i < numElements; ++i) resultsX[i] = FastMath::Pow(in.positives[i], in.exponents[i]); });
+			benchmark.Run("std::pow", numElements, [&]() { for (size_t i{}; i < numElements; ++i) resultsX[i] = std::pow(in.positives[i], in.exponents[i]); });
+			benchmark.ReportGain("FastMath::Pow", "std::pow");
+
+			// The tangent path: every vertex tangent goes through this in TangentSpace::GenerateTangents
+			benchmark.Run("Tangent orthonormalize, FastMath", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; ++i)
+						vector3s[i] = OrthonormalizeTangent<true>(in.otherVector3s[i], in.vector3s[i]);
+				});
+			benchmark.Run("Tangent orthonormalize, std", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; ++i)
+						vector3s[i] = OrthonormalizeTangent<false>(in.otherVector3s[i], in.vector3s[i]);
+				});
+			benchmark.ReportGain("Tangent orthonormalize, FastMath", "Tangent orthonormalize, std");
+
+#ifdef DAE_MATH_SIMD
+			constexpr size_t width{ SimdFloat::width };
+			benchmark.Run("FastMath::RSqrt(SimdFloat)", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; i += width)
+						FastMath::RSqrt(SimdFloat::Load(&in.positives[i])).Store(&resultsX[i]);
+				});
+			benchmark.Run("FastMath::Normalize(SimdFloat)", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; i += width)
+					{
+						SimdFloat lanesX{ SimdFloat::Load(&in.x[i]) }, lanesY{ SimdFloat::Load(&in.y[i]) }, lanesZ{ SimdFloat::Load(&in.z[i]) };
+						FastMath::Normalize(lanesX, lanesY, lanesZ);
+						lanesX.Store(&resultsX[i]);
+						lanesY.Store(&resultsY[i]);
+						lanesZ.Store(&resultsZ[i]);
+					}
+				});
+			benchmark.Run("FastMath::SinCos(SimdFloat)", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; i += width)
+					{
+						SimdFloat sin, cos;
+						FastMath::SinCos(SimdFloat::Load(&in.angles[i]), sin, cos);
+						sin.Store(&resultsX[i]);
+						cos.Store(&resultsY[i]);
+					}
+				});
+			benchmark.Run("FastMath::Exp2(SimdFloat)", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; i += width)
+						FastMath::Exp2(SimdFloat::Load(&in.exponents[i])).Store(&resultsX[i]);
+				});
+			benchmark.Run("FastMath::Log2(SimdFloat)", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; i += width)
+						FastMath::Log2(SimdFloat::Load(&in.positives[i])).Store(&resultsX[i]);
+				});
+			benchmark.Run("FastMath::Pow(SimdFloat)", numElements, [&]()
+				{
+					for (size_t i{}; i < numElements; i += width)
+						FastMath::Pow(SimdFloat::Load(&in.positives[i]), SimdFloat::Load(&in.exponents[i])).Store(&resultsX[i]);
+				});
+
+			benchmark.ReportGain("FastMath::RSqrt(SimdFloat)", "1 / std::sqrt");
+			benchmark.ReportGain("FastMath::Normalize(SimdFloat)", "Normalized, 1 / std::sqrt");
+			benchmark.ReportGain("FastMath::SinCos(SimdFloat)", "std::sin + std::cos");
+			benchmark.ReportGain("FastMath::Exp2(SimdFloat)", "std::exp2");
+			benchmark.ReportGain("FastMath::Log2(SimdFloat)", "std::log2");
+			benchmark.ReportGain("FastMath::Pow(SimdFloat)", "std::pow");
+#endif
+		}
+
+		bool WriteJson(const std::string& path, const std::vector<Result>& results)
+		{
+			std::ofstream file{ path };
+			if (!file)
+				return false;
+
+			file << "{\n\t\"backend\": \"" << mathBackendName << "\",\n\t\"results\": [\n";
+			file << std::setprecision(6);
+			for (size_t i{}; i < results.size(); ++i)
+			{
+				file << "\t\t{ \"name\": \"" << results[i].name << "\", \"nsPerOp\": " << results[i].nsPerOp
+					<< ", \"medianNsPerOp\": " << results[i].medianNsPerOp << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+			}
+			file << "\t]\n}\n";
+			return static_cast<bool>(file);
+		}
+
+		// Reads back what WriteJson writes, names never contain quotes. Empty when the file can't be read
+		std::map<std::string, double> ReadBaseline(const std::string& path)
+		{
+			std::ifstream file{ path };
+			std::stringstream stream;
+			stream << file.rdbuf();
+			const std::string text{ stream.str() };
+
+			std::map<std::string, double> nsPerOp{};
+			const std::string nameKey{ "\"name\"" }, valueKey{ "\"nsPerOp\"" };
+			for (size_t position{ text.find(nameKey) }; position != std::string::npos; position = text.find(nameKey, position))
+			{
+				const size_t nameStart{ text.find('"', text.find(':', position + nameKey.size())) + 1 };
+				const size_t nameEnd{ text.find('"', nameStart) };
+				const size_t valuePosition{ text.find(valueKey, nameEnd) };
+				if (nameStart == 0 || nameEnd == std::string::npos || valuePosition == std::string::npos)
+					break;
+
+				const size_t valueStart{ text.find(':', valuePosition + valueKey.size()) + 1 };
+				nsPerOp[text.substr(nameStart, nameEnd - nameStart)] = std::strtod(text.c_str() + valueStart, nullptr);
+				position = valueStart;
+			}
+			return nsPerOp;
+		}
+
+		// Returns the number of regressions
+		int Compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double thresholdPercent)
+		{
+			int numRegressions{};
+			std::cout << "\n[BENCH] Against the baseline, threshold +" << std::defaultfloat << thresholdPercent << "%\n";
+			for (const Result& result : results)
+			{
+				const auto it{ baseline.find(result.name) };
+				std::cout << "[BENCH] " << std::left << std::setw(48) << result.name << std::right;
+				if (it == baseline.end() || it->second <= 0.0)
+				{
+					std::cout << "    not in baseline\n";
+					continue;
+				}
+
+				const double changePercent{ (result.nsPerOp / it->second - 1.0) * 100.0 };
+				const bool isRegression{ changePercent > thresholdPercent };
+				numRegressions += isRegression ? 1 : 0;
+				std::cout << std::fixed << std::setprecision(3) << std::setw(10) << it->second << " -> " << std::setw(8) << result.nsPerOp << " ns/op "
+					<< std::showpos << std::setprecision(1) << std::setw(7) << changePercent << "%" << std::noshowpos << (isRegression ? "  REGRESSION\n" : "\n");
+			}
+			return numRegressions;
+		}
+
+		bool ParseOptions(int argc, char* argv[], Options& options)
+		{
+			for (int i{ 1 }; i < argc; ++i)
+			{
+				const bool hasValue{ i + 1 < argc };
+				if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+					options.filter = argv[++i];
+				else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+					options.jsonPath = argv[++i];
+				else if (std::strcmp(argv[i], "--compare") == 0 && hasValue)
+					options.baselinePath = argv[++i];
+				else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue)
+					options.thresholdPercent = std::atof(argv[++i]);
+				else if (std::strcmp(argv[i], "--sample-ms") == 0 && hasValue)
+					options.sampleMilliseconds = std::max(std::atof(argv[++i]), 0.1);
+				else
+					return false;
+			}
+			return true;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using namespace dae;
+
+	Options options{};
+	if (!ParseOptions(argc, argv, options))
+	{
+		std::cerr << "Usage: " << argv[0] << " [--filter <text>] [--json <file>] [--compare <baseline.json>] [--threshold <percent>] [--sample-ms <ms>]\n";
+		return 2;
+	}
+
+	std::map<std::string, double> baseline{};
+	if (!options.baselinePath.empty())
+	{
+		baseline = ReadBaseline(options.baselinePath);
+		if (baseline.empty())
+		{
+			std::cerr << "[BENCH] No results in baseline " << options.baselinePath << "\n";
+			return 2;
+		}
+	}
+
+	std::cout << "[BENCH] Math backend " << mathBackendName << ", " << numSamples << " samples of " << options.sampleMilliseconds << " ms each\n";
+	const Inputs inputs{};
+	Benchmark benchmark{ options };
+	RunVectorBenchmarks(benchmark, inputs);
+	RunQuaternionBenchmarks(benchmark, inputs);
+	RunColorBenchmarks(benchmark, inputs);
+	RunMatrixBenchmarks(benchmark, inputs);
+	RunFastMathBenchmarks(benchmark, inputs);
+
+	if (!options.jsonPath.empty() && !WriteJson(options.jsonPath, benchmark.GetResults()))
+	{
+		std::cerr << "[BENCH] Couldn't write " << options.jsonPath << "\n";
+		return 2;
+	}
+
+	if (!baseline.empty() && Compare(benchmark.GetResults(), baseline, options.thresholdPercent) > 0)
+		return 1;
+	return 0;
+}
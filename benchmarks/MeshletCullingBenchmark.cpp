@@ -0,0 +1,152 @@
+// Meshlet culling of a mesh imported like MeshGeometry::Load does, seen from a ring of cameras around it. Builds without
+// SDL and DirectX from the CPU side of source/:
+//
+//   g++ -std=c++20 -O2 -DNDEBUG -DDAE_HEADLESS -Isource benchmarks/MeshletCullingBenchmark.cpp source/FrustumCulling.cpp source/MappedFile.cpp
+//       source/MeshletCulling.cpp source/MeshProcessing.cpp source/TangentSpace.cpp source/Utils.cpp source/VertexFormat.cpp -pthread -o MeshletCullingBenchmark
+//   cl /std:c++20 /O2 /DNDEBUG /DDAE_HEADLESS /EHsc /Isource benchmarks\MeshletCullingBenchmark.cpp source\FrustumCulling.cpp source\MappedFile.cpp
+//       source\MeshletCulling.cpp source\MeshProcessing.cpp source\TangentSpace.cpp source\Utils.cpp source\VertexFormat.cpp
+//
+// Usage:
+//
+//   MeshletCullingBenchmark [<file.obj>]
+//
+// Culls source/Resources/vehicle.obj when no file is given. Reports how much the cones and the frustum reject, and what a cull costs,
+// for single and double-sided materials
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "pch.h"
+#include "MeshletCulling.h"
+#include "MeshProcessing.h"
+#include "Utils.h"
+#include "VertexFormat.h"
+
+namespace dae
+{
+	namespace
+	{
+		// Same cache size and passes as the import
+		constexpr uint32_t vertexCacheSize{ 32 };
+
+		struct MeshletCullBenchmark
+		{
+			uint32_t numViews{};
+			// Share of the triangles rejected per view, cameras around the mesh that see all of it
+			float minRejectedPercentage{};
+			float averageRejectedPercentage{};
+			float maxRejectedPercentage{};
+			// Same from cameras at one bounding radius from the centre, where the frustum rejects too
+			float averageCloseRejectedPercentage{};
+			float microsecondsPerCull{};
+		};
+
+		// Camera looking at target, view * projection with a 45 degree field of view
+		Matrix CreateBenchmarkViewProjection(const Vector3& eye, const Vector3& target, float nearPlane, float farPlane)
+		{
+			const Vector3 forward{ (target - eye).Normalized() };
+			const Vector3 helper{ std::abs(forward.y) > 0.9f ? Vector3::UnitX : Vector3::UnitY };
+			const Vector3 right{ Vector3::Cross(helper, forward).Normalized() };
+			const Vector3 up{ Vector3::Cross(forward, right) };
+			const Matrix view{ Matrix::InverseRigid({ right, up, forward, eye }) };
+			return view * Matrix::CreatePerspectiveFovLH(tanf(22.5f * TO_RADIANS), 1.f, nearPlane, farPlane);
+		}
+
+		// Culls from a ring of cameras around the bounds plus one above and one below, at two distances
+		MeshletCullBenchmark BenchmarkMeshletCulling(const MeshletCuller& culler, const Vector3& boundsMin, const Vector3& boundsMax, bool cullBackFaces)
+		{
+			MeshletCullBenchmark benchmark{};
+			const Vector3 center{ (boundsMin + boundsMax) * 0.5f };
+			const float radius{ (boundsMax - boundsMin).Magnitude() * 0.5f };
+			if (culler.GetNumMeshlets() == 0 || radius <= 0.f)
+				return benchmark;
+
+			// Same directions AnalyzeOverdraw looks from
+			constexpr int numRingViews{ 8 };
+			std::vector<Vector3> viewDirections{};
+			for (int i{}; i < numRingViews; ++i)
+			{
+				const float angle{ PI_2 * i / numRingViews };
+				viewDirections.push_back(Vector3{ cosf(angle), -0.3f, sinf(angle) }.Normalized());
+			}
+			viewDirections.push_back(-Vector3::UnitY);
+			viewDirections.push_back(Vector3::UnitY);
+
+			constexpr int numRepeats{ 1000 };
+			std::vector<IndexRange> ranges{};
+			benchmark.minRejectedPercentage = 100.f;
+			double cullSeconds{};
+			size_t numCulls{};
+			for (const Vector3& forward : viewDirections)
+			{
+				// Far enough for the 45 degree frustum to hold the whole bounding sphere
+				const Vector3 farEye{ center - forward * (radius * 2.7f) };
+				const Matrix farViewProjection{ CreateBenchmarkViewProjection(farEye, center, radius * 0.01f, radius * 10.f) };
+
+				const auto startTime{ std::chrono::steady_clock::now() };
+				MeshletCullStats stats{};
+				for (int r{}; r < numRepeats; ++r)
+				{
+					stats = culler.Cull(farViewProjection, farEye, ranges, cullBackFaces);
+				}
+				cullSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+				numCulls += numRepeats;
+
+				const float rejected{ stats.GetRejectedPercentage() };
+				benchmark.minRejectedPercentage = std::min(benchmark.minRejectedPercentage, rejected);
+				benchmark.maxRejectedPercentage = std::max(benchmark.maxRejectedPercentage, rejected);
+				benchmark.averageRejectedPercentage += rejected;
+
+				const Vector3 closeEye{ center - forward * radius };
+				const Matrix closeViewProjection{ CreateBenchmarkViewProjection(closeEye, center, radius * 0.01f, radius * 10.f) };
+				benchmark.averageCloseRejectedPercentage += culler.Cull(closeViewProjection, closeEye, ranges, cullBackFaces).GetRejectedPercentage();
+				++benchmark.numViews;
+			}
+
+			benchmark.averageRejectedPercentage /= benchmark.numViews;
+			benchmark.averageCloseRejectedPercentage /= benchmark.numViews;
+			benchmark.microsecondsPerCull = static_cast<float>(cullSeconds * 1e6 / numCulls);
+			return benchmark;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using namespace dae;
+
+	if (argc > 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " [<file.obj>]\n";
+		return 2;
+	}
+	const std::string path{ argc == 2 ? argv[1] : "source/Resources/vehicle.obj" };
+
+	Utils::ObjParseOptions parseOptions{};
+	parseOptions.numThreads = 0;
+	parseOptions.weldVertices = true;
+	std::vector<Vertex> vertices{};
+	std::vector<uint32_t> indices{};
+	if (!Utils::ParseOBJ(path, vertices, indices, parseOptions))
+	{
+		std::cerr << "[BENCH] Couldn't read " << path << "\n";
+		return 2;
+	}
+
+	MeshProcessing::OptimizeVertexCache(indices, vertices.size(), vertexCacheSize);
+	MeshProcessing::OptimizeOverdraw(vertices, indices, vertexCacheSize);
+	const std::vector<MeshProcessing::Meshlet> meshlets{ MeshProcessing::BuildMeshlets(vertices, indices) };
+	const MeshletCuller culler{ meshlets.data(), static_cast<uint32_t>(meshlets.size()) };
+	const VertexPacking::QuantizationBounds bounds{ VertexPacking::ComputeBounds(vertices.data(), vertices.size()) };
+	std::cout << "[BENCH] " << path << ": " << indices.size() / 3 << " triangles in " << meshlets.size() << " meshlets\n";
+
+	for (const bool cullBackFaces : { true, false })
+	{
+		const MeshletCullBenchmark benchmark{ BenchmarkMeshletCulling(culler, bounds.min, bounds.min + bounds.extent, cullBackFaces) };
+		std::cout << "[BENCH] " << (cullBackFaces ? "Single-sided" : "Double-sided") << ": " << benchmark.microsecondsPerCull << " us per cull, "
+			<< benchmark.minRejectedPercentage << "/" << benchmark.averageRejectedPercentage << "/" << benchmark.maxRejectedPercentage
+			<< "% of triangles rejected (min/avg/max over " << benchmark.numViews << " views), " << benchmark.averageCloseRejectedPercentage << "% up close\n";
+	}
+	return 0;
+}
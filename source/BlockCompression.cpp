@@ -0,0 +1,1173 @@
+#include "pch.h"
+#include "BlockCompression.h"
+#include "FastMath.h"
+#include "Utils.h"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace dae
+{
+	namespace BlockCompression
+	{
+		namespace
+		{
+			// Fewer blocks than this per thread and spawning it costs more than it saves
+			constexpr size_t minBlocksPerThread{ 1024 };
+			constexpr int numChannels{ 4 };
+			constexpr int numTexels{ 16 };
+			constexpr int numPartitions{ 64 };
+
+			// A 4x4 block, one plane per channel so a SIMD load takes neighbouring texels, values in [0, 255]
+			struct Block
+			{
+				float values[numChannels][numTexels];
+			};
+
+			// Where every texel lies on its ramp of interpolated colors, 0 at the first endpoint
+			using Positions = std::array<float, numTexels>;
+
+			// Splits [0, count) into numThreads contiguous ranges
+			inline size_t GetRangeBegin(size_t count, size_t numThreads, size_t thread)
+			{
+				return count * thread / numThreads;
+			}
+
+			int GetNumRefinements(Quality quality)
+			{
+				return quality == Quality::Fast ? 0 : (quality == Quality::Normal ? 1 : 3);
+			}
+
+			int ToByte(float value)
+			{
+				return static_cast<int>(std::min(std::max(value, 0.f), 255.f) + 0.5f);
+			}
+
+			#pragma region Lanes
+			// A block is a whole number of SimdFloats on every backend, so its loops need no scalar tail
+#ifdef DAE_MATH_SIMD
+			using Lanes = SimdFloat;
+			constexpr size_t laneWidth{ SimdFloat::width };
+#else
+			using Lanes = float;
+			constexpr size_t laneWidth{ 1 };
+#endif
+			static_assert(numTexels % laneWidth == 0 && numPartitions % laneWidth == 0);
+
+			template<typename T>
+			T Splat(float value)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return value;
+				else
+					return T::Set(value);
+			}
+
+			template<typename T>
+			T Load(const float* pData)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return *pData;
+				else
+					return T::Load(pData);
+			}
+
+			template<typename T>
+			void Store(float* pData, T value)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					*pData = value;
+				else
+					value.Store(pData);
+			}
+
+			template<typename T>
+			T Min(T a, T b)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return std::min(a, b);
+				else
+					return T::Min(a, b);
+			}
+
+			template<typename T>
+			T Max(T a, T b)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return std::max(a, b);
+				else
+					return T::Max(a, b);
+			}
+
+			template<typename T>
+			T Round(T value)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return std::nearbyint(value);
+				else
+					return T::Round(value);
+			}
+
+			template<typename T>
+			T SelectLess(T a, T b, T ifLess, T otherwise)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return a < b ? ifLess : otherwise;
+				else
+					return T::Select(T::Less(a, b), ifLess, otherwise);
+			}
+
+			// Across the lanes, once per block rather than per texel
+			template<typename T, typename Combine>
+			float Reduce(T value, const Combine& combine)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return value;
+				else
+				{
+					float lanes[T::width];
+					value.Store(lanes);
+					float result{ lanes[0] };
+					for (size_t i{ 1 }; i < T::width; ++i)
+						result = combine(result, lanes[i]);
+					return result;
+				}
+			}
+
+			template<typename T>
+			float ReduceAdd(T value)
+			{
+				return Reduce(value, [](float a, float b) { return a + b; });
+			}
+
+			// The mask value of texels, 1 for all of them without a mask
+			template<typename T>
+			T LoadMask(const float* pMask, size_t texel)
+			{
+				return pMask ? Load<T>(pMask + texel) : Splat<T>(1.f);
+			}
+			#pragma endregion
+
+			#pragma region Endpoint Fitting
+			// Through the mean of the texels, along their principal axis. A zero direction for a flat block
+			struct Line
+			{
+				float origin[numChannels]{};
+				float direction[numChannels]{};
+			};
+
+			// The first count planes of pValues, over the texels where pMask is 1 (all of them without one). The axis is found by power
+			// iteration on the covariance, started from its column with the largest variance so anticorrelated channels don't cancel out
+			template<typename T>
+			Line FitLine(const float(*pValues)[numTexels], int count, const float* pMask)
+			{
+				Line line{};
+				T numMasked{ Splat<T>(0.f) };
+				T sums[numChannels]{ Splat<T>(0.f), Splat<T>(0.f), Splat<T>(0.f), Splat<T>(0.f) };
+				for (size_t texel{}; texel < numTexels; texel += laneWidth)
+				{
+					const T mask{ LoadMask<T>(pMask, texel) };
+					numMasked = numMasked + mask;
+					for (int channel{}; channel < count; ++channel)
+						sums[channel] = sums[channel] + mask * Load<T>(&pValues[channel][texel]);
+				}
+				const float inverseCount{ 1.f / ReduceAdd(numMasked) };
+				for (int channel{}; channel < count; ++channel)
+					line.origin[channel] = ReduceAdd(sums[channel]) * inverseCount;
+
+				T products[numChannels][numChannels]{};
+				for (int row{}; row < count; ++row)
+				{
+					for (int column{ row }; column < count; ++column)
+						products[row][column] = Splat<T>(0.f);
+				}
+				for (size_t texel{}; texel < numTexels; texel += laneWidth)
+				{
+					const T mask{ LoadMask<T>(pMask, texel) };
+					T centered[numChannels]{};
+					for (int channel{}; channel < count; ++channel)
+						centered[channel] = Load<T>(&pValues[channel][texel]) - Splat<T>(line.origin[channel]);
+					for (int row{}; row < count; ++row)
+					{
+						for (int column{ row }; column < count; ++column)
+							products[row][column] = products[row][column] + mask * centered[row] * centered[column];
+					}
+				}
+
+				float covariance[numChannels][numChannels]{};
+				int largest{};
+				for (int row{}; row < count; ++row)
+				{
+					for (int column{ row }; column < count; ++column)
+						covariance[row][column] = covariance[column][row] = ReduceAdd(products[row][column]);
+					if (covariance[row][row] > covariance[largest][largest])
+						largest = row;
+				}
+				if (covariance[largest][largest] < 1e-4f)
+					return line;
+
+				float axis[numChannels]{};
+				for (int channel{}; channel < count; ++channel)
+					axis[channel] = covariance[channel][largest];
+				for (int iteration{}; iteration < 4; ++iteration)
+				{
+					float next[numChannels]{};
+					float sqrLength{};
+					for (int row{}; row < count; ++row)
+					{
+						for (int column{}; column < count; ++column)
+							next[row] += covariance[row][column] * axis[column];
+						sqrLength += next[row] * next[row];
+					}
+					if (sqrLength < 1e-20f)
+						return line;
+					const float inverseLength{ 1.f / std::sqrt(sqrLength) };
+					for (int channel{}; channel < count; ++channel)
+						axis[channel] = next[channel] * inverseLength;
+				}
+				std::copy(axis, axis + count, line.direction);
+				return line;
+			}
+
+			// Endpoints at the masked texels furthest along the line either way, first at the far end
+			template<typename T>
+			void GetExtremes(const float(*pValues)[numTexels], int count, const float* pMask, const Line& line, float* pFirst, float* pLast)
+			{
+				constexpr float unmasked{ std::numeric_limits<float>::max() };
+				T lowest{ Splat<T>(unmasked) };
+				T highest{ Splat<T>(-unmasked) };
+				for (size_t texel{}; texel < numTexels; texel += laneWidth)
+				{
+					T projection{ Splat<T>(0.f) };
+					for (int channel{}; channel < count; ++channel)
+						projection = projection + (Load<T>(&pValues[channel][texel]) - Splat<T>(line.origin[channel])) * Splat<T>(line.direction[channel]);
+					const T mask{ LoadMask<T>(pMask, texel) };
+					lowest = Min(lowest, SelectLess(mask, Splat<T>(0.5f), Splat<T>(unmasked), projection));
+					highest = Max(highest, SelectLess(mask, Splat<T>(0.5f), Splat<T>(-unmasked), projection));
+				}
+				const float tMin{ Reduce(lowest, [](float a, float b) { return std::min(a, b); }) };
+				const float tMax{ Reduce(highest, [](float a, float b) { return std::max(a, b); }) };
+				for (int channel{}; channel < count; ++channel)
+				{
+					pFirst[channel] = line.origin[channel] + tMax * line.direction[channel];
+					pLast[channel] = line.origin[channel] + tMin * line.direction[channel];
+				}
+			}
+
+			// Every masked texel to the nearest of numLevels evenly spaced points from pFirst to pLast, unmasked ones keep their position.
+			// Returns the squared error over the masked texels. BC7's weights are only close to even, close enough to pick endpoints by
+			template<typename T>
+			float AssignPositions(const float(*pValues)[numTexels], int count, const float* pMask, const float* pFirst, const float* pLast,
+				int numLevels, Positions& positions)
+			{
+				float delta[numChannels]{};
+				float sqrLength{};
+				for (int channel{}; channel < count; ++channel)
+				{
+					delta[channel] = pLast[channel] - pFirst[channel];
+					sqrLength += delta[channel] * delta[channel];
+				}
+				const float maxPosition{ static_cast<float>(numLevels - 1) };
+				const T scale{ Splat<T>(sqrLength > 0.f ? maxPosition / sqrLength : 0.f) };
+				const T step{ Splat<T>(1.f / maxPosition) };
+
+				T error{ Splat<T>(0.f) };
+				for (size_t texel{}; texel < numTexels; texel += laneWidth)
+				{
+					T projection{ Splat<T>(0.f) };
+					for (int channel{}; channel < count; ++channel)
+						projection = projection + (Load<T>(&pValues[channel][texel]) - Splat<T>(pFirst[channel])) * Splat<T>(delta[channel]);
+					const T position{ Round(Min(Max(projection * scale, Splat<T>(0.f)), Splat<T>(maxPosition))) };
+
+					T texelError{ Splat<T>(0.f) };
+					for (int channel{}; channel < count; ++channel)
+					{
+						const T difference{ Load<T>(&pValues[channel][texel]) - (Splat<T>(pFirst[channel]) + Splat<T>(delta[channel]) * position * step) };
+						texelError = texelError + difference * difference;
+					}
+					const T mask{ LoadMask<T>(pMask, texel) };
+					error = error + mask * texelError;
+					Store(&positions[texel], SelectLess(mask, Splat<T>(0.5f), Load<T>(&positions[texel]), position));
+				}
+				return ReduceAdd(error);
+			}
+
+			// Least squares endpoints for the masked texels at their positions, false when they all share one position
+			template<typename T>
+			bool RefineEndpoints(const float(*pValues)[numTexels], int count, const float* pMask, const Positions& positions, int numLevels,
+				float* pFirst, float* pLast)
+			{
+				const T step{ Splat<T>(1.f / static_cast<float>(numLevels - 1)) };
+				T firstFirst{ Splat<T>(0.f) }, lastLast{ Splat<T>(0.f) }, firstLast{ Splat<T>(0.f) };
+				T firstValue[numChannels]{ Splat<T>(0.f), Splat<T>(0.f), Splat<T>(0.f), Splat<T>(0.f) };
+				T lastValue[numChannels]{ Splat<T>(0.f), Splat<T>(0.f), Splat<T>(0.f), Splat<T>(0.f) };
+				for (size_t texel{}; texel < numTexels; texel += laneWidth)
+				{
+					const T mask{ LoadMask<T>(pMask, texel) };
+					const T lastWeight{ Load<T>(&positions[texel]) * step };
+					const T firstWeight{ Splat<T>(1.f) - lastWeight };
+					firstFirst = firstFirst + mask * firstWeight * firstWeight;
+					lastLast = lastLast + mask * lastWeight * lastWeight;
+					firstLast = firstLast + mask * firstWeight * lastWeight;
+					for (int channel{}; channel < count; ++channel)
+					{
+						const T value{ mask * Load<T>(&pValues[channel][texel]) };
+						firstValue[channel] = firstValue[channel] + firstWeight * value;
+						lastValue[channel] = lastValue[channel] + lastWeight * value;
+					}
+				}
+
+				const float aa{ ReduceAdd(firstFirst) };
+				const float bb{ ReduceAdd(lastLast) };
+				const float ab{ ReduceAdd(firstLast) };
+				const float determinant{ aa * bb - ab * ab };
+				if (std::abs(determinant) < 1e-6f)
+					return false;
+
+				const float inverseDeterminant{ 1.f / determinant };
+				for (int channel{}; channel < count; ++channel)
+				{
+					const float ax{ ReduceAdd(firstValue[channel]) };
+					const float bx{ ReduceAdd(lastValue[channel]) };
+					pFirst[channel] = std::min(std::max((ax * bb - bx * ab) * inverseDeterminant, 0.f), 255.f);
+					pLast[channel] = std::min(std::max((bx * aa - ax * ab) * inverseDeterminant, 0.f), 255.f);
+				}
+				return true;
+			}
+
+			// Quantizes pFirst/pLast to what the format stores and assigns positions, then refines numRefinements times from those positions,
+			// keeping the endpoints with the least error. quantize(pFirst, pLast, code) fills code and replaces the endpoints with its decoded
+			// values. Returns that error
+			template<typename Code, typename Quantize>
+			float FitEndpoints(const float(*pValues)[numTexels], int count, const float* pMask, int numLevels, int numRefinements,
+				float* pFirst, float* pLast, const Quantize& quantize, Code& code, Positions& positions)
+			{
+				float bestError{ std::numeric_limits<float>::max() };
+				for (int refinement{}; refinement <= numRefinements; ++refinement)
+				{
+					float first[numChannels]{};
+					float last[numChannels]{};
+					std::copy(pFirst, pFirst + count, first);
+					std::copy(pLast, pLast + count, last);
+					Code candidate{};
+					quantize(first, last, candidate);
+
+					Positions candidatePositions{ positions };
+					const float error{ AssignPositions<Lanes>(pValues, count, pMask, first, last, numLevels, candidatePositions) };
+					if (error < bestError)
+					{
+						bestError = error;
+						code = candidate;
+						positions = candidatePositions;
+					}
+					if (error == 0.f || !RefineEndpoints<Lanes>(pValues, count, pMask, candidatePositions, numLevels, pFirst, pLast))
+						break;
+				}
+				return bestError;
+			}
+			#pragma endregion
+
+			#pragma region Quantization
+			// Narrow fields are widened to 8 bits by repeating their top bits, like the hardware does
+			constexpr int Expand(int code, int numBits)
+			{
+				return (code << (8 - numBits)) | (code >> (2 * numBits - 8));
+			}
+
+			// The numBits code whose expansion is nearest to every byte value. With a p-bit, the code is the top bits of a numBits + 1 field
+			// ending in pBit
+			std::array<uint8_t, 256> CreateNearestCodes(int numBits, int pBit)
+			{
+				std::array<uint8_t, 256> codes{};
+				for (int value{}; value < 256; ++value)
+				{
+					int bestDistance{ 256 };
+					for (int code{}; code < (1 << numBits); ++code)
+					{
+						const int expanded{ pBit < 0 ? Expand(code, numBits) : Expand((code << 1) | pBit, numBits + 1) };
+						const int distance{ std::abs(expanded - value) };
+						if (distance < bestDistance)
+						{
+							bestDistance = distance;
+							codes[value] = static_cast<uint8_t>(code);
+						}
+					}
+				}
+				return codes;
+			}
+
+			const std::array<uint8_t, 256> nearest5{ CreateNearestCodes(5, -1) };
+			const std::array<uint8_t, 256> nearest6{ CreateNearestCodes(6, -1) };
+			const std::array<uint8_t, 256> nearest6WithPBit[2]{ CreateNearestCodes(6, 0), CreateNearestCodes(6, 1) };
+
+			void Decode565(uint16_t color, float* pRgb)
+			{
+				pRgb[0] = static_cast<float>(Expand(color >> 11, 5));
+				pRgb[1] = static_cast<float>(Expand((color >> 5) & 0x3F, 6));
+				pRgb[2] = static_cast<float>(Expand(color & 0x1F, 5));
+			}
+
+			uint16_t Encode565(const float* pRgb)
+			{
+				return static_cast<uint16_t>((nearest5[ToByte(pRgb[0])] << 11) | (nearest6[ToByte(pRgb[1])] << 5) | nearest5[ToByte(pRgb[2])]);
+			}
+
+			// BC7 mode 6: 7 bits per channel and a p-bit of its own per endpoint
+			struct Mode6Code
+			{
+				int endpoints[2][numChannels];
+				int pBits[2];
+			};
+
+			void QuantizeMode6(float* pFirst, float* pLast, Mode6Code& code)
+			{
+				float* pEndpoints[2]{ pFirst, pLast };
+				for (int endpoint{}; endpoint < 2; ++endpoint)
+				{
+					int bestError{ std::numeric_limits<int>::max() };
+					for (int pBit{}; pBit < 2; ++pBit)
+					{
+						int error{};
+						int codes[numChannels]{};
+						for (int channel{}; channel < numChannels; ++channel)
+						{
+							const int value{ ToByte(pEndpoints[endpoint][channel]) };
+							codes[channel] = std::min(std::max((value - pBit + 1) >> 1, 0), 127);
+							const int difference{ ((codes[channel] << 1) | pBit) - value };
+							error += difference * difference;
+						}
+						if (error < bestError)
+						{
+							bestError = error;
+							std::copy(codes, codes + numChannels, code.endpoints[endpoint]);
+							code.pBits[endpoint] = pBit;
+						}
+					}
+					for (int channel{}; channel < numChannels; ++channel)
+						pEndpoints[endpoint][channel] = static_cast<float>((code.endpoints[endpoint][channel] << 1) | code.pBits[endpoint]);
+				}
+			}
+
+			// BC7 mode 1, one subset: 6 bits per rgb channel and a p-bit shared by both endpoints
+			struct Mode1Code
+			{
+				int endpoints[2][3];
+				int pBit;
+			};
+
+			int DecodeMode1Channel(int code, int pBit)
+			{
+				return Expand((code << 1) | pBit, 7);
+			}
+
+			void QuantizeMode1(float* pFirst, float* pLast, Mode1Code& code)
+			{
+				float* pEndpoints[2]{ pFirst, pLast };
+				int bestError{ std::numeric_limits<int>::max() };
+				for (int pBit{}; pBit < 2; ++pBit)
+				{
+					int error{};
+					Mode1Code candidate{ {}, pBit };
+					for (int endpoint{}; endpoint < 2; ++endpoint)
+					{
+						for (int channel{}; channel < 3; ++channel)
+						{
+							const int value{ ToByte(pEndpoints[endpoint][channel]) };
+							candidate.endpoints[endpoint][channel] = nearest6WithPBit[pBit][value];
+							const int difference{ DecodeMode1Channel(candidate.endpoints[endpoint][channel], pBit) - value };
+							error += difference * difference;
+						}
+					}
+					if (error < bestError)
+					{
+						bestError = error;
+						code = candidate;
+					}
+				}
+				for (int endpoint{}; endpoint < 2; ++endpoint)
+				{
+					for (int channel{}; channel < 3; ++channel)
+						pEndpoints[endpoint][channel] = static_cast<float>(DecodeMode1Channel(code.endpoints[endpoint][channel], code.pBit));
+				}
+			}
+			#pragma endregion
+
+			#pragma region BC7 Tables
+			// Bit i set where texel i is in subset 1, the two subset partitions of the BC7 specification
+			constexpr uint16_t partitionBits[numPartitions]
+			{
+				0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+				0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+				0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+				0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+				0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+				0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+				0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+				0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+			};
+
+			// The texel of subset 1 whose index drops its top bit, subset 0's is always texel 0
+			constexpr uint8_t secondAnchors[numPartitions]
+			{
+				15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+				15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+				15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+				6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+			};
+
+			constexpr int weights3[8]{ 0, 9, 18, 27, 37, 46, 55, 64 };
+			constexpr int weights4[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+			struct PartitionMasks
+			{
+				// Texel major, so the lanes of a load are partitions: 1 where the texel is in subset 1
+				float subsetOneByTexel[numTexels][numPartitions];
+				// Partition major, 1 where the texel is in the subset, for fitting one subset at a time
+				float subsets[numPartitions][2][numTexels];
+			};
+
+			PartitionMasks CreatePartitionMasks()
+			{
+				PartitionMasks masks{};
+				for (int partition{}; partition < numPartitions; ++partition)
+				{
+					for (int texel{}; texel < numTexels; ++texel)
+					{
+						const bool isSubsetOne{ ((partitionBits[partition] >> texel) & 1) != 0 };
+						masks.subsetOneByTexel[texel][partition] = isSubsetOne ? 1.f : 0.f;
+						masks.subsets[partition][0][texel] = isSubsetOne ? 0.f : 1.f;
+						masks.subsets[partition][1][texel] = isSubsetOne ? 1.f : 0.f;
+					}
+				}
+				return masks;
+			}
+
+			const PartitionMasks partitionMasks{ CreatePartitionMasks() };
+
+			// BC7 fields are packed from the lowest bit of the block up
+			class BitWriter
+			{
+			public:
+				explicit BitWriter(uint8_t* pBlock)
+					: m_pBlock{ pBlock }
+				{
+					std::memset(m_pBlock, 0, 16);
+				}
+
+				void Write(uint32_t value, int numBits)
+				{
+					for (int bit{}; bit < numBits; ++bit, ++m_Position)
+					{
+						if ((value >> bit) & 1)
+							m_pBlock[m_Position / 8] |= static_cast<uint8_t>(1 << (m_Position % 8));
+					}
+				}
+
+			private:
+				uint8_t* m_pBlock;
+				int m_Position{};
+			};
+
+			class BitReader
+			{
+			public:
+				explicit BitReader(const uint8_t* pBlock)
+					: m_pBlock{ pBlock }
+				{
+				}
+
+				int Read(int numBits)
+				{
+					int value{};
+					for (int bit{}; bit < numBits; ++bit, ++m_Position)
+						value |= ((m_pBlock[m_Position / 8] >> (m_Position % 8)) & 1) << bit;
+					return value;
+				}
+
+			private:
+				const uint8_t* m_pBlock;
+				int m_Position{};
+			};
+			#pragma endregion
+
+			#pragma region Encoding
+			void EncodeBC1(const Block& block, Quality quality, uint8_t* pBlock)
+			{
+				float first[numChannels]{};
+				float last[numChannels]{};
+				GetExtremes<Lanes>(block.values, 3, nullptr, FitLine<Lanes>(block.values, 3, nullptr), first, last);
+
+				std::array<uint16_t, 2> colors{};
+				Positions positions{};
+				FitEndpoints(block.values, 3, nullptr, 4, GetNumRefinements(quality), first, last,
+					[](float* pFirst, float* pLast, std::array<uint16_t, 2>& code)
+					{
+						code[0] = Encode565(pFirst);
+						code[1] = Encode565(pLast);
+						Decode565(code[0], pFirst);
+						Decode565(code[1], pLast);
+					}, colors, positions);
+
+				// Four colors only when the first is the larger, equal ones have a single color anyway
+				if (colors[0] < colors[1])
+				{
+					std::swap(colors[0], colors[1]);
+					for (float& position : positions)
+						position = 3.f - position;
+				}
+				else if (colors[0] == colors[1])
+					positions.fill(0.f);
+
+				// Ramp order to index: the endpoints are 0 and 1, the interpolated colors 2 and 3
+				constexpr uint32_t indices[4]{ 0, 2, 3, 1 };
+				uint32_t indexBits{};
+				for (int texel{}; texel < numTexels; ++texel)
+					indexBits |= indices[static_cast<int>(positions[texel])] << (2 * texel);
+				std::memcpy(pBlock, colors.data(), sizeof(colors));
+				std::memcpy(pBlock + 4, &indexBits, sizeof(indexBits));
+			}
+
+			void EncodeBC4(const float(*pValues)[numTexels], Quality quality, uint8_t* pBlock)
+			{
+				float first{ (*pValues)[0] };
+				float last{ (*pValues)[0] };
+				for (float value : *pValues)
+				{
+					first = std::max(first, value);
+					last = std::min(last, value);
+				}
+
+				const auto quantize{ [](float* pFirst, float* pLast, std::array<int, 2>& code)
+					{
+						code = { ToByte(*pFirst), ToByte(*pLast) };
+						*pFirst = static_cast<float>(code[0]);
+						*pLast = static_cast<float>(code[1]);
+					} };
+				std::array<int, 2> code{};
+				Positions positions{};
+				float error{ FitEndpoints(pValues, 1, nullptr, 8, GetNumRefinements(quality), &first, &last, quantize, code, positions) };
+
+				// Rounding the refined endpoints is not always the best pair, try the neighbours
+				if (quality == Quality::High && error > 0.f)
+				{
+					const std::array<int, 2> center{ code };
+					for (int firstOffset{ -2 }; firstOffset <= 2; ++firstOffset)
+					{
+						for (int lastOffset{ -2 }; lastOffset <= 2; ++lastOffset)
+						{
+							const float candidateFirst{ static_cast<float>(std::min(std::max(center[0] + firstOffset, 0), 255)) };
+							const float candidateLast{ static_cast<float>(std::min(std::max(center[1] + lastOffset, 0), 255)) };
+							Positions candidatePositions{};
+							const float candidateError{ AssignPositions<Lanes>(pValues, 1, nullptr, &candidateFirst, &candidateLast, 8, candidatePositions) };
+							if (candidateError < error)
+							{
+								error = candidateError;
+								code = { static_cast<int>(candidateFirst), static_cast<int>(candidateLast) };
+								positions = candidatePositions;
+							}
+						}
+					}
+				}
+
+				// Eight values only when the first is the larger, same as BC1
+				if (code[0] < code[1])
+				{
+					std::swap(code[0], code[1]);
+					for (float& position : positions)
+						position = 7.f - position;
+				}
+				else if (code[0] == code[1])
+					positions.fill(0.f);
+
+				constexpr uint64_t indices[8]{ 0, 2, 3, 4, 5, 6, 7, 1 };
+				uint64_t bits{ static_cast<uint64_t>(code[0]) | static_cast<uint64_t>(code[1]) << 8 };
+				for (int texel{}; texel < numTexels; ++texel)
+					bits |= indices[static_cast<int>(positions[texel])] << (16 + 3 * texel);
+				std::memcpy(pBlock, &bits, 8);
+			}
+
+			// How much the texels of every partition stray from a line per subset: the variance off the principal axis, times the texel count.
+			// Eight partitions a time on AVX, the covariance of each subset built from the products of every texel's channels
+			template<typename T>
+			void EstimatePartitionErrors(const Block& block, float(&errors)[numPartitions])
+			{
+				// r, g, b, rr, gg, bb, rg, rb, gb
+				constexpr int numMoments{ 9 };
+				float moments[numTexels][numMoments]{};
+				float totals[numMoments]{};
+				for (int texel{}; texel < numTexels; ++texel)
+				{
+					// In [0, 1], the powers of the power iteration stay in range
+					const float r{ block.values[0][texel] / 255.f };
+					const float g{ block.values[1][texel] / 255.f };
+					const float b{ block.values[2][texel] / 255.f };
+					const float texelMoments[numMoments]{ r, g, b, r * r, g * g, b * b, r * g, r * b, g * b };
+					for (int moment{}; moment < numMoments; ++moment)
+					{
+						moments[texel][moment] = texelMoments[moment];
+						totals[moment] += texelMoments[moment];
+					}
+				}
+
+				const auto getSubsetError{ [](T count, const T(&sums)[numMoments])
+					{
+						const T inverseCount{ Splat<T>(1.f) / count };
+						const T mean[3]{ sums[0] * inverseCount, sums[1] * inverseCount, sums[2] * inverseCount };
+						const T rr{ sums[3] * inverseCount - mean[0] * mean[0] };
+						const T gg{ sums[4] * inverseCount - mean[1] * mean[1] };
+						const T bb{ sums[5] * inverseCount - mean[2] * mean[2] };
+						const T rg{ sums[6] * inverseCount - mean[0] * mean[1] };
+						const T rb{ sums[7] * inverseCount - mean[0] * mean[2] };
+						const T gb{ sums[8] * inverseCount - mean[1] * mean[2] };
+
+						T axis[3]{ Splat<T>(1.f), Splat<T>(1.f), Splat<T>(1.f) };
+						for (int iteration{}; iteration < 3; ++iteration)
+						{
+							const T next[3]{ rr * axis[0] + rg * axis[1] + rb * axis[2], rg * axis[0] + gg * axis[1] + gb * axis[2], rb * axis[0] + gb * axis[1] + bb * axis[2] };
+							const T inverseLength{ FastMath::RSqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + Splat<T>(1e-20f)) };
+							for (int channel{}; channel < 3; ++channel)
+								axis[channel] = next[channel] * inverseLength;
+						}
+						// The Rayleigh quotient of a unit axis, the variance along it
+						const T along{ axis[0] * (rr * axis[0] + rg * axis[1] + rb * axis[2]) + axis[1] * (rg * axis[0] + gg * axis[1] + gb * axis[2])
+							+ axis[2] * (rb * axis[0] + gb * axis[1] + bb * axis[2]) };
+						return count * (rr + gg + bb - along);
+					} };
+
+				for (size_t partition{}; partition < numPartitions; partition += laneWidth)
+				{
+					T countOne{ Splat<T>(0.f) };
+					T sumsOne[numMoments]{};
+					for (T& sum : sumsOne)
+						sum = Splat<T>(0.f);
+					for (int texel{}; texel < numTexels; ++texel)
+					{
+						const T mask{ Load<T>(&partitionMasks.subsetOneByTexel[texel][partition]) };
+						countOne = countOne + mask;
+						for (int moment{}; moment < numMoments; ++moment)
+							sumsOne[moment] = sumsOne[moment] + mask * Splat<T>(moments[texel][moment]);
+					}
+					T sumsZero[numMoments]{};
+					for (int moment{}; moment < numMoments; ++moment)
+						sumsZero[moment] = Splat<T>(totals[moment]) - sumsOne[moment];
+					const T countZero{ Splat<T>(static_cast<float>(numTexels)) - countOne };
+					Store(&errors[partition], getSubsetError(countZero, sumsZero) + getSubsetError(countOne, sumsOne));
+				}
+			}
+
+			float EncodeMode1(const Block& block, int partition, int numRefinements, Mode1Code(&codes)[2], Positions& positions)
+			{
+				float error{};
+				for (int subset{}; subset < 2; ++subset)
+				{
+					const float* pMask{ partitionMasks.subsets[partition][subset] };
+					float first[numChannels]{};
+					float last[numChannels]{};
+					GetExtremes<Lanes>(block.values, 3, pMask, FitLine<Lanes>(block.values, 3, pMask), first, last);
+					error += FitEndpoints(block.values, 3, pMask, 8, numRefinements, first, last, QuantizeMode1, codes[subset], positions);
+				}
+				return error;
+			}
+
+			void WriteMode6(Mode6Code code, Positions positions, uint8_t* pBlock)
+			{
+				// The first texel's index has no top bit, it must be in the first half of the ramp
+				if (positions[0] >= 8.f)
+				{
+					std::swap(code.endpoints[0], code.endpoints[1]);
+					std::swap(code.pBits[0], code.pBits[1]);
+					for (float& position : positions)
+						position = 15.f - position;
+				}
+
+				BitWriter writer{ pBlock };
+				writer.Write(1 << 6, 7);
+				for (int channel{}; channel < numChannels; ++channel)
+				{
+					writer.Write(code.endpoints[0][channel], 7);
+					writer.Write(code.endpoints[1][channel], 7);
+				}
+				writer.Write(code.pBits[0], 1);
+				writer.Write(code.pBits[1], 1);
+				for (int texel{}; texel < numTexels; ++texel)
+					writer.Write(static_cast<uint32_t>(positions[texel]), texel == 0 ? 3 : 4);
+			}
+
+			void WriteMode1(int partition, Mode1Code(&codes)[2], Positions positions, uint8_t* pBlock)
+			{
+				const int anchors[2]{ 0, secondAnchors[partition] };
+				for (int subset{}; subset < 2; ++subset)
+				{
+					if (positions[anchors[subset]] < 4.f)
+						continue;
+					std::swap(codes[subset].endpoints[0], codes[subset].endpoints[1]);
+					for (int texel{}; texel < numTexels; ++texel)
+					{
+						if (((partitionBits[partition] >> texel) & 1) == subset)
+							positions[texel] = 7.f - positions[texel];
+					}
+				}
+
+				BitWriter writer{ pBlock };
+				writer.Write(1 << 1, 2);
+				writer.Write(partition, 6);
+				for (int channel{}; channel < 3; ++channel)
+				{
+					for (const Mode1Code& code : codes)
+					{
+						writer.Write(code.endpoints[0][channel], 6);
+						writer.Write(code.endpoints[1][channel], 6);
+					}
+				}
+				writer.Write(codes[0].pBit, 1);
+				writer.Write(codes[1].pBit, 1);
+				for (int texel{}; texel < numTexels; ++texel)
+					writer.Write(static_cast<uint32_t>(positions[texel]), texel == anchors[0] || texel == anchors[1] ? 2 : 3);
+			}
+
+			void EncodeBC7(const Block& block, Quality quality, uint8_t* pBlock)
+			{
+				const int numRefinements{ GetNumRefinements(quality) };
+
+				float first[numChannels]{};
+				float last[numChannels]{};
+				GetExtremes<Lanes>(block.values, numChannels, nullptr, FitLine<Lanes>(block.values, numChannels, nullptr), first, last);
+				Mode6Code mode6{};
+				Positions mode6Positions{};
+				const float mode6Error{ FitEndpoints(block.values, numChannels, nullptr, 16, numRefinements, first, last, QuantizeMode6, mode6, mode6Positions) };
+
+				// Mode 1 has no alpha. Normal leaves the blocks mode 6 fits to within a level per rgb value on average, half of them on the
+				// shipped maps, High tries every opaque block
+				const bool isOpaque{ std::all_of(std::begin(block.values[3]), std::end(block.values[3]), [](float alpha) { return alpha == 255.f; }) };
+				const float closeEnoughError{ quality == Quality::Normal ? numTexels * 3.f : 0.f };
+				const int numCandidates{ quality == Quality::Fast || !isOpaque || mode6Error <= closeEnoughError ? 0 : (quality == Quality::Normal ? 1 : 4) };
+				float bestError{ mode6Error };
+				int bestPartition{ -1 };
+				Mode1Code bestCodes[2]{};
+				Positions bestPositions{};
+				if (numCandidates > 0)
+				{
+					float estimates[numPartitions]{};
+					EstimatePartitionErrors<Lanes>(block, estimates);
+					int candidates[numPartitions]{};
+					for (int partition{}; partition < numPartitions; ++partition)
+						candidates[partition] = partition;
+					std::partial_sort(candidates, candidates + numCandidates, candidates + numPartitions,
+						[&estimates](int a, int b) { return estimates[a] < estimates[b]; });
+
+					for (int candidate{}; candidate < numCandidates; ++candidate)
+					{
+						Mode1Code codes[2]{};
+						Positions positions{};
+						const float error{ EncodeMode1(block, candidates[candidate], numRefinements, codes, positions) };
+						if (error < bestError)
+						{
+							bestError = error;
+							bestPartition = candidates[candidate];
+							std::copy(codes, codes + 2, bestCodes);
+							bestPositions = positions;
+						}
+					}
+				}
+
+				if (bestPartition < 0)
+					WriteMode6(mode6, mode6Positions, pBlock);
+				else
+					WriteMode1(bestPartition, bestCodes, bestPositions, pBlock);
+			}
+
+			void EncodeBlock(const Block& block, const EncodeOptions& options, uint8_t* pBlock)
+			{
+				switch (options.format)
+				{
+				case Format::BC1:
+					EncodeBC1(block, options.quality, pBlock);
+					break;
+				case Format::BC4:
+					EncodeBC4(&block.values[0], options.quality, pBlock);
+					break;
+				case Format::BC5:
+					EncodeBC4(&block.values[0], options.quality, pBlock);
+					EncodeBC4(&block.values[1], options.quality, pBlock + 8);
+					break;
+				case Format::BC7:
+					EncodeBC7(block, options.quality, pBlock);
+					break;
+				}
+			}
+
+			// Texels past the right and bottom edges repeat the last column and row
+			void LoadBlock(const uint8_t* pPixels, uint32_t width, uint32_t height, size_t pitch, uint32_t blockX, uint32_t blockY, Block& block)
+			{
+				for (uint32_t y{}; y < 4; ++y)
+				{
+					const uint8_t* pRow{ pPixels + std::min(blockY * 4 + y, height - 1) * pitch };
+					for (uint32_t x{}; x < 4; ++x)
+					{
+						const uint8_t* pTexel{ pRow + size_t{ std::min(blockX * 4 + x, width - 1) } * numChannels };
+						for (int channel{}; channel < numChannels; ++channel)
+							block.values[channel][y * 4 + x] = static_cast<float>(pTexel[channel]);
+					}
+				}
+			}
+			#pragma endregion
+
+			#pragma region Decoding
+			// Back to RGBA8 to measure the error, for the modes the encoder writes
+			void DecodeBC4(const uint8_t* pBlock, uint8_t(&texels)[numTexels][numChannels], int channel)
+			{
+				uint64_t bits{};
+				std::memcpy(&bits, pBlock, 8);
+				const int first{ pBlock[0] };
+				const int last{ pBlock[1] };
+				int values[8]{ first, last };
+				for (int i{ 2 }; i < 8; ++i)
+				{
+					if (first > last)
+						values[i] = ((8 - i) * first + (i - 1) * last + 3) / 7;
+					else
+						values[i] = i < 6 ? ((6 - i) * first + (i - 1) * last + 2) / 5 : (i == 6 ? 0 : 255);
+				}
+				for (int texel{}; texel < numTexels; ++texel)
+					texels[texel][channel] = static_cast<uint8_t>(values[(bits >> (16 + 3 * texel)) & 7]);
+			}
+
+			void DecodeBlock(Format format, const uint8_t* pBlock, uint8_t(&texels)[numTexels][numChannels])
+			{
+				switch (format)
+				{
+				case Format::BC1:
+				{
+					uint16_t colors[2]{};
+					uint32_t indexBits{};
+					std::memcpy(colors, pBlock, sizeof(colors));
+					std::memcpy(&indexBits, pBlock + 4, sizeof(indexBits));
+					float endpoints[2][3]{};
+					Decode565(colors[0], endpoints[0]);
+					Decode565(colors[1], endpoints[1]);
+					int palette[4][3]{};
+					for (int channel{}; channel < 3; ++channel)
+					{
+						const int a{ static_cast<int>(endpoints[0][channel]) };
+						const int b{ static_cast<int>(endpoints[1][channel]) };
+						palette[0][channel] = a;
+						palette[1][channel] = b;
+						palette[2][channel] = colors[0] > colors[1] ? (2 * a + b + 1) / 3 : (a + b + 1) / 2;
+						palette[3][channel] = colors[0] > colors[1] ? (a + 2 * b + 1) / 3 : 0;
+					}
+					for (int texel{}; texel < numTexels; ++texel)
+					{
+						const int index{ static_cast<int>((indexBits >> (2 * texel)) & 3) };
+						for (int channel{}; channel < 3; ++channel)
+							texels[texel][channel] = static_cast<uint8_t>(palette[index][channel]);
+						texels[texel][3] = 255;
+					}
+					break;
+				}
+				case Format::BC4:
+					DecodeBC4(pBlock, texels, 0);
+					break;
+				case Format::BC5:
+					DecodeBC4(pBlock, texels, 0);
+					DecodeBC4(pBlock + 8, texels, 1);
+					break;
+				case Format::BC7:
+				{
+					BitReader reader{ pBlock };
+					int mode{};
+					while (mode < 8 && reader.Read(1) == 0)
+						++mode;
+					assert((mode == 1 || mode == 6) && "ERROR: BC7 mode the encoder does not write!");
+					if (mode == 6)
+					{
+						int endpoints[2][numChannels]{};
+						for (int channel{}; channel < numChannels; ++channel)
+						{
+							endpoints[0][channel] = reader.Read(7) << 1;
+							endpoints[1][channel] = reader.Read(7) << 1;
+						}
+						const int pBits[2]{ reader.Read(1), reader.Read(1) };
+						for (int channel{}; channel < numChannels; ++channel)
+						{
+							endpoints[0][channel] |= pBits[0];
+							endpoints[1][channel] |= pBits[1];
+						}
+						for (int texel{}; texel < numTexels; ++texel)
+						{
+							const int weight{ weights4[reader.Read(texel == 0 ? 3 : 4)] };
+							for (int channel{}; channel < numChannels; ++channel)
+								texels[texel][channel] = static_cast<uint8_t>(((64 - weight) * endpoints[0][channel] + weight * endpoints[1][channel] + 32) >> 6);
+						}
+					}
+					else
+					{
+						const int partition{ reader.Read(6) };
+						int codes[2][2][3]{};
+						for (int channel{}; channel < 3; ++channel)
+						{
+							for (int subset{}; subset < 2; ++subset)
+							{
+								codes[subset][0][channel] = reader.Read(6);
+								codes[subset][1][channel] = reader.Read(6);
+							}
+						}
+						const int pBits[2]{ reader.Read(1), reader.Read(1) };
+						for (int texel{}; texel < numTexels; ++texel)
+						{
+							const int subset{ (partitionBits[partition] >> texel) & 1 };
+							const int weight{ weights3[reader.Read(texel == 0 || texel == secondAnchors[partition] ? 2 : 3)] };
+							for (int channel{}; channel < 3; ++channel)
+							{
+								const int first{ DecodeMode1Channel(codes[subset][0][channel], pBits[subset]) };
+								const int last{ DecodeMode1Channel(codes[subset][1][channel], pBits[subset]) };
+								texels[texel][channel] = static_cast<uint8_t>(((64 - weight) * first + weight * last + 32) >> 6);
+							}
+							texels[texel][3] = 255;
+						}
+					}
+					break;
+				}
+				}
+			}
+
+			int GetNumStoredChannels(Format format)
+			{
+				switch (format)
+				{
+				case Format::BC1:
+					return 3;
+				case Format::BC4:
+					return 1;
+				case Format::BC5:
+					return 2;
+				case Format::BC7:
+					return 4;
+				}
+				return 0;
+			}
+			#pragma endregion
+
+			struct LevelResult
+			{
+				EncodeStats stats;
+				double squaredError;
+				uint64_t numSamples;
+			};
+
+			LevelResult EncodeLevel(const uint8_t* pPixels, uint32_t width, uint32_t height, size_t pitch, const EncodeOptions& options, uint8_t* pBlocks)
+			{
+				assert(pPixels && pBlocks && width > 0 && height > 0 && pitch >= size_t{ width } * numChannels && "ERROR: no pixels to encode!");
+				const auto startTime{ std::chrono::steady_clock::now() };
+
+				const uint32_t numBlocksX{ (width + 3) / 4 };
+				const uint32_t numBlocksY{ (height + 3) / 4 };
+				const size_t blockSize{ GetBlockSize(options.format) };
+				const size_t rowPitch{ GetRowPitch(options.format, width) };
+
+				LevelResult result{};
+				result.stats.numBlocks = numBlocksX * numBlocksY;
+				const size_t hardwareThreads{ options.numThreads != 0 ? options.numThreads : std::max(1u, std::thread::hardware_concurrency()) };
+				result.stats.numThreads = static_cast<uint32_t>(std::min(hardwareThreads, std::max(size_t{ 1 }, result.stats.numBlocks / minBlocksPerThread)));
+				const size_t numThreads{ result.stats.numThreads };
+
+				Utils::RunParallel(numThreads, [&](size_t thread)
+					{
+						const size_t end{ GetRangeBegin(numBlocksY, numThreads, thread + 1) };
+						for (size_t blockY{ GetRangeBegin(numBlocksY, numThreads, thread) }; blockY < end; ++blockY)
+						{
+							for (uint32_t blockX{}; blockX < numBlocksX; ++blockX)
+							{
+								Block block{};
+								LoadBlock(pPixels, width, height, pitch, blockX, static_cast<uint32_t>(blockY), block);
+								EncodeBlock(block, options, pBlocks + blockY * rowPitch + blockX * blockSize);
+							}
+						}
+					});
+				result.stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+				// Decoded against the source, over the texels inside the level
+				const int numStoredChannels{ GetNumStoredChannels(options.format) };
+				std::vector<double> threadErrors(numThreads);
+				Utils::RunParallel(numThreads, [&](size_t thread)
+					{
+						const size_t end{ GetRangeBegin(numBlocksY, numThreads, thread + 1) };
+						for (size_t blockY{ GetRangeBegin(numBlocksY, numThreads, thread) }; blockY < end; ++blockY)
+						{
+							for (uint32_t blockX{}; blockX < numBlocksX; ++blockX)
+							{
+								uint8_t texels[numTexels][numChannels]{};
+								DecodeBlock(options.format, pBlocks + blockY * rowPitch + blockX * blockSize, texels);
+								for (uint32_t y{}; y < 4 && blockY * 4 + y < height; ++y)
+								{
+									for (uint32_t x{}; x < 4 && blockX * 4 + x < width; ++x)
+									{
+										const uint8_t* pTexel{ pPixels + (blockY * 4 + y) * pitch + (size_t{ blockX } * 4 + x) * numChannels };
+										for (int channel{}; channel < numStoredChannels; ++channel)
+										{
+											const double difference{ static_cast<double>(texels[y * 4 + x][channel]) - pTexel[channel] };
+											threadErrors[thread] += difference * difference;
+										}
+									}
+								}
+							}
+						}
+					});
+				for (double error : threadErrors)
+					result.squaredError += error;
+				result.numSamples = uint64_t{ width } * height * numStoredChannels;
+				return result;
+			}
+
+			void FinishStats(EncodeStats& stats, double squaredError, uint64_t numSamples, size_t numSourceBytes)
+			{
+				stats.megabytesPerSecond = stats.milliseconds > 0.f ? static_cast<float>(numSourceBytes / (1000.0 * stats.milliseconds)) : 0.f;
+				stats.psnr = squaredError > 0.0 ? static_cast<float>(10.0 * std::log10(255.0 * 255.0 * static_cast<double>(numSamples) / squaredError))
+					: std::numeric_limits<float>::infinity();
+			}
+		}
+
+		EncodeStats Encode(const uint8_t* pPixels, uint32_t width, uint32_t height, size_t pitch, const EncodeOptions& options, uint8_t* pBlocks)
+		{
+			LevelResult result{ EncodeLevel(pPixels, width, height, pitch, options, pBlocks) };
+			FinishStats(result.stats, result.squaredError, result.numSamples, size_t{ width } * height * numChannels);
+			return result.stats;
+		}
+
+		EncodeStats EncodeChain(const MipGeneration::MipChain& chain, const EncodeOptions& options, CompressedChain& compressed)
+		{
+			compressed.format = options.format;
+			compressed.levels.clear();
+			size_t numBytes{};
+			for (const MipGeneration::MipLevel& level : chain.levels)
+			{
+				compressed.levels.push_back({ level.width, level.height, numBytes });
+				numBytes += GetLevelSize(options.format, level.width, level.height);
+			}
+			compressed.blocks.resize(numBytes);
+
+			EncodeStats stats{};
+			double squaredError{};
+			uint64_t numSamples{};
+			size_t numSourceBytes{};
+			for (size_t i{}; i < chain.levels.size(); ++i)
+			{
+				const MipGeneration::MipLevel& level{ chain.levels[i] };
+				const LevelResult result{ EncodeLevel(&chain.pixels[level.offset], level.width, level.height, size_t{ level.width } * numChannels,
+					options, &compressed.blocks[compressed.levels[i].offset]) };
+				stats.numBlocks += result.stats.numBlocks;
+				stats.numThreads = std::max(stats.numThreads, result.stats.numThreads);
+				stats.milliseconds += result.stats.milliseconds;
+				squaredError += result.squaredError;
+				numSamples += result.numSamples;
+				numSourceBytes += size_t{ level.width } * level.height * numChannels;
+			}
+			FinishStats(stats, squaredError, numSamples, numSourceBytes);
+			return stats;
+		}
+	}
+}
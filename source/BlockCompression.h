@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "MipGeneration.h"
+
+namespace dae
+{
+	// BC1/BC4/BC5/BC7 encoding of RGBA8 images, for compressing textures when they are imported
+	namespace BlockCompression
+	{
+		enum class Format
+		{
+			// rgb in 565 endpoints and 2 bit indices, 8 bytes a block, alpha dropped
+			BC1,
+			// Red only, 8 bit endpoints and 3 bit indices, 8 bytes a block
+			BC4,
+			// Red and green as two BC4 blocks, 16 bytes a block
+			BC5,
+			// rgba, 16 bytes a block. Mode 6 (one line through rgba) for every block, mode 1 (two lines through rgb over one of
+			// 64 partitions) where that fits an opaque block better
+			BC7
+		};
+
+		enum class Quality
+		{
+			// Endpoints at the extremes along the principal axis, BC7 mode 6 only
+			Fast,
+			// One least squares refinement of the endpoints, BC7 tries the best partition estimate in mode 1 where mode 6 is off
+			// by more than a level per value
+			Normal,
+			// Three refinements, a search around the BC4 endpoints, BC7 tries the best four partitions
+			High
+		};
+
+		struct EncodeOptions
+		{
+			Format format{ Format::BC7 };
+			Quality quality{ Quality::Normal };
+			// 0 picks the hardware concurrency
+			uint32_t numThreads{};
+		};
+
+		struct EncodeStats
+		{
+			uint32_t numBlocks{};
+			uint32_t numThreads{};
+			// Encoding only, measuring the PSNR afterwards is not included
+			float milliseconds{};
+			// Source RGBA8 bytes per second
+			float megabytesPerSecond{};
+			// Over the channels the format stores, decoded blocks against the source. Infinite when they match exactly
+			float psnr{};
+		};
+
+		// The levels of a MipChain, offsets into blocks, each level's rows of blocks tightly packed
+		struct CompressedChain
+		{
+			Format format{};
+			std::vector<MipGeneration::MipLevel> levels;
+			std::vector<uint8_t> blocks;
+		};
+
+		constexpr size_t GetBlockSize(Format format)
+		{
+			return format == Format::BC1 || format == Format::BC4 ? 8 : 16;
+		}
+
+		// Levels narrower than 4 texels still take a whole block
+		constexpr size_t GetRowPitch(Format format, uint32_t width)
+		{
+			return size_t{ (width + 3) / 4 } * GetBlockSize(format);
+		}
+
+		constexpr size_t GetLevelSize(Format format, uint32_t width, uint32_t height)
+		{
+			return GetRowPitch(format, width) * ((height + 3) / 4);
+		}
+
+		// pPixels is width x height RGBA8 with rows pitch bytes apart, pBlocks GetLevelSize bytes. Texels past the right and bottom
+		// edges of partial blocks repeat the last column and row. Rows of blocks are split over numThreads threads, the endpoint
+		// fitting runs SimdFloat::width texels of a block at a time
+		EncodeStats Encode(const uint8_t* pPixels, uint32_t width, uint32_t height, size_t pitch, const EncodeOptions& options, uint8_t* pBlocks);
+
+		// Every level of chain, stats summed over all of them
+		EncodeStats EncodeChain(const MipGeneration::MipChain& chain, const EncodeOptions& options, CompressedChain& compressed);
+	}
+}
@@ -63,7 +63,9 @@ namespace dae
 			//ONB => invViewMatrix
 			//Inverse(ONB) => ViewMatrix
 
-			right = Vector3::Cross(Vector3::UnitY, forward);
+			// Normalized, so the basis stays orthonormal when pitched and after many rotations
+			forward.Normalize();
+			right = Vector3::Cross(Vector3::UnitY, forward).Normalized();
 			up = Vector3::Cross(forward, right);
 			// https://gamedev.net/forums/topic/388559-getting-a-up-vector-from-only-having-a-forward-vector/.
 
@@ -75,7 +77,7 @@ namespace dae
 				origin
 			};
 
-			viewMatrix = Matrix::Inverse(invViewMatrix);
+			viewMatrix = Matrix::InverseRigid(invViewMatrix);
 
 			//ViewMatrix => Matrix::CreateLookAtLH(...) [not implemented yet]
 			//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixlookatlh
@@ -9,7 +9,8 @@ namespace dae
 		Vector3 position;
 		Vector2 uv;
 		Vector3 normal;
-		Vector3 tangent;
+		// w: bitangent sign, bitangent = cross(normal, tangent.xyz) * w
+		Vector4 tangent;
 	};
 
 	//struct Vertex
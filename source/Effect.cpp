@@ -2,16 +2,29 @@
 #include "Effect.h"
 #include "Texture.h"
 #include "HelperFuncts.h"
+#include "Utils.h"
 
 namespace dae
 {
-	Effect::Effect(ID3D11Device* pDevice, const std::wstring& assetFile)
-		: m_pEffect{ LoadEffect(pDevice, assetFile) }
+	Effect::Effect(ID3D11Device* pDevice, const std::wstring& assetFile, VertexFormat vertexFormat)
+		: Effect{ pDevice, Compile(assetFile, vertexFormat) }
 	{
-		m_pTechnique = m_pEffect->GetTechniqueByName("PointFilteringTechnique");
-		if (!m_pTechnique->IsValid())
+	}
+
+	Effect::Effect(ID3D11Device* pDevice, const EffectData& data)
+		: m_pEffect{ LoadEffect(pDevice, data) }
+		, m_VertexFormat{ data.vertexFormat }
+		, m_SizeInBytes{ data.bytecode.size() }
+	{
+		// In FilteringMethod order
+		const char* const techniqueNames[]{ "PointFilteringTechnique", "LinearFilteringTechnique", "AnisotropicFilteringTechnique" };
+		for (int i{}; i < static_cast<int>(FilteringMethod::END); ++i)
 		{
-			std::wcout << L"Technique not valid\n";
+			m_pTechniques[i] = m_pEffect->GetTechniqueByName(techniqueNames[i]);
+			if (!m_pTechniques[i]->IsValid())
+			{
+				std::cout << techniqueNames[i] << " not valid\n";
+			}
 		}
 
 		// ---- WORLD ----
@@ -28,6 +41,15 @@ namespace dae
 		{
 			std::wcout << L"m_pDiffuseMapVariable not valid!\n";
 		}
+
+		// ---- RASTERIZER ----
+		// Without a gRasterizerState the D3D default culls back faces
+		ID3DX11EffectRasterizerVariable* pRasterizerVariable{ m_pEffect->GetVariableByName("gRasterizerState")->AsRasterizer() };
+		D3D11_RASTERIZER_DESC rasterizerDesc{};
+		if (pRasterizerVariable->IsValid() && SUCCEEDED(pRasterizerVariable->GetBackingStore(0, &rasterizerDesc)))
+		{
+			m_IsBackFaceCulled = rasterizerDesc.CullMode != D3D11_CULL_NONE;
+		}
 	}
 
 	Effect::~Effect()
@@ -40,9 +62,24 @@ namespace dae
 		return m_pEffect;
 	}
 
-	ID3DX11EffectTechnique* Effect::GetTechnique() const
+	ID3DX11EffectTechnique* Effect::GetTechnique(FilteringMethod filteringMethod) const
+	{
+		return m_pTechniques[static_cast<int>(filteringMethod)];
+	}
+
+	VertexFormat Effect::GetVertexFormat() const
+	{
+		return m_VertexFormat;
+	}
+
+	bool Effect::IsBackFaceCulled() const
+	{
+		return m_IsBackFaceCulled;
+	}
+
+	size_t Effect::GetSizeInBytes() const
 	{
-		return m_pTechnique;
+		return m_SizeInBytes;
 	}
 
 	void Effect::SetWorldViewProjectionMatrix(const Matrix& matrix)
@@ -75,37 +112,17 @@ namespace dae
 		}
 	}
 
-	void Effect::CycleFilteringMethods()
+	void Effect::SetMaterial(const Material& material)
 	{
-	
-		m_FilteringMethod = static_cast<FilteringMethod>((static_cast<int>(m_FilteringMethod) + 1) % (static_cast<int>(FilteringMethod::END)));
-
-		std::cout << "[FILTERINGMETHOD] ";
-		switch (m_FilteringMethod)
-		{
-		case dae::Effect::FilteringMethod::Point:
-			m_pTechnique = m_pEffect->GetTechniqueByName("PointFilteringTechnique");
-			if (!m_pTechnique->IsValid()) std::wcout << L"PointTechnique not valid\n";
-			std::cout << "Point\n";
-			break;
-		case dae::Effect::FilteringMethod::Linear:
-			m_pTechnique = m_pEffect->GetTechniqueByName("LinearFilteringTechnique");
-			if (!m_pTechnique->IsValid()) std::wcout << L"LinearTechnique not valid\n";
-			std::cout << "Linear\n";
-			break;
-		case dae::Effect::FilteringMethod::Anisotropic:
-			m_pTechnique = m_pEffect->GetTechniqueByName("AnisotropicFilteringTechnique");
-			if (!m_pTechnique->IsValid()) std::wcout << L"AnisotropicTechnique not valid\n";
-			std::cout << "Anisotropic\n";
-			break;
-		}
+		if (material.pDiffuseMap)
+			SetDiffuseMap(material.pDiffuseMap.get());
 	}
 
-	ID3DX11Effect* Effect::LoadEffect(ID3D11Device* pDevice, const std::wstring& assetFile)
+	EffectData Effect::Compile(const std::wstring& assetFile, VertexFormat vertexFormat)
 	{
-		HRESULT result;
+		EffectData data{ assetFile, vertexFormat };
+		ID3D10Blob* pBytecodeBlob{ nullptr };
 		ID3D10Blob* pErrorBlob{ nullptr };
-		ID3DX11Effect* pEffect;
 
 		DWORD shaderFlags{ 0 };
 
@@ -114,43 +131,74 @@ namespace dae
 		shaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
 
-		result = D3DX11CompileEffectFromFile
-		(
-			assetFile.c_str(),
-			nullptr,
-			nullptr,
-			shaderFlags,
-			0,
-			pDevice,
-			&pEffect,
-			&pErrorBlob
-		);
+		const D3D_SHADER_MACRO defines[]
+		{
+			{ GetShaderDefine(vertexFormat), "1" },
+			{ nullptr, nullptr }
+		};
 
-		if (FAILED(result))
+		// What D3DX11CompileEffectFromFile does before it needs the device
+		const HRESULT result
+		{
+			D3DCompileFromFile
+			(
+				assetFile.c_str(),
+				defines,
+				D3D_COMPILE_STANDARD_FILE_INCLUDE,
+				nullptr,
+				"fx_5_0",
+				shaderFlags,
+				0,
+				&pBytecodeBlob,
+				&pErrorBlob
+			)
+		};
+
+		if (pErrorBlob != nullptr)
 		{
-			if (pErrorBlob != nullptr)
+			const char* pErrors{ static_cast<char*>(pErrorBlob->GetBufferPointer()) };
+
+			std::wstringstream ss;
+			for (unsigned int i{}; i < pErrorBlob->GetBufferSize(); ++i)
 			{
-				const char* pErrors{ static_cast<char*>(pErrorBlob->GetBufferPointer()) };
+				ss << pErrors[i];
+			}
 
-				std::wstringstream ss;
-				for (unsigned int i{}; i < pErrorBlob->GetBufferSize(); ++i)
-				{
-					ss << pErrors[i];
-				}
+			OutputDebugStringW(ss.str().c_str());
+			pErrorBlob->Release();
+			pErrorBlob = nullptr;
 
-				OutputDebugStringW(ss.str().c_str());
-				pErrorBlob->Release();
-				pErrorBlob = nullptr;
+			std::wcout << ss.str() << "\n";
+		}
 
-				std::wcout << ss.str() << "\n";
-			}
-			else
-			{
-				std::wstringstream ss;
-				ss << "EffectLoader: Failed to CreateEffectFromFile!\nPath: " << assetFile;
-				std::wcout << ss.str() << "\n";
-				return nullptr;
-			}
+		if (FAILED(result))
+		{
+			std::wstringstream ss;
+			ss << "EffectLoader: Failed to CompileEffectFromFile!\nPath: " << assetFile;
+			std::wcout << ss.str() << "\n";
+			return data;
+		}
+
+		const char* pBytecode{ static_cast<const char*>(pBytecodeBlob->GetBufferPointer()) };
+		data.bytecode.assign(pBytecode, pBytecode + pBytecodeBlob->GetBufferSize());
+		data.contentHash = Utils::HashBytes(data.bytecode.data(), data.bytecode.size());
+		pBytecodeBlob->Release();
+		return data;
+	}
+
+	ID3DX11Effect* Effect::LoadEffect(ID3D11Device* pDevice, const EffectData& data)
+	{
+		ID3DX11Effect* pEffect{ nullptr };
+		if (data.bytecode.empty())
+			return nullptr;
+
+		const HRESULT result{ D3DX11CreateEffectFromMemory(data.bytecode.data(), data.bytecode.size(), 0, pDevice, &pEffect) };
+		if (FAILED(result))
+		{
+			std::wstringstream ss;
+			ss << "EffectLoader: Failed to CreateEffectFromMemory!\nPath: " << data.assetFile;
+			std::wcout << ss.str() << "\n";
+			return nullptr;
 		}
 
 		return pEffect;
@@ -1,13 +1,38 @@
 #pragma once
+#include <memory>
+#include "VertexFormat.h"
 
 namespace dae
 {
 	class Texture;
 
+	// What Effect::Compile leaves for the device: the fx_5_0 bytecode, empty when compiling failed
+	struct EffectData
+	{
+		std::wstring assetFile;
+		VertexFormat vertexFormat{ VertexFormat::Full };
+		std::vector<char> bytecode;
+		// Of the bytecode, equal for effects that compiled to the same thing whatever their path
+		uint64_t contentHash{};
+	};
+
+	// The maps a mesh is drawn with. They are bound right before its draw, so meshes with different maps can share an effect
+	struct Material
+	{
+		std::shared_ptr<Texture> pDiffuseMap{};
+		// Only used by ShadedEffect
+		std::shared_ptr<Texture> pNormalMap{};
+		std::shared_ptr<Texture> pSpecularMap{};
+		std::shared_ptr<Texture> pGlossinessMap{};
+	};
+
 	class Effect
 	{
 	public:
-		Effect(ID3D11Device* pDevice, const std::wstring& assetFile);
+		// The vertex shader input is compiled for vertexFormat, meshes using the effect upload that format
+		Effect(ID3D11Device* pDevice, const std::wstring& assetFile, VertexFormat vertexFormat = VertexFormat::Full);
+		// Only creates the effect on the device, the compiling was done by Compile
+		Effect(ID3D11Device* pDevice, const EffectData& data);
 		virtual ~Effect();
 
 		Effect(const Effect& other) = delete;
@@ -15,13 +40,21 @@ namespace dae
 		Effect(Effect&& other) = delete;
 		Effect& operator=(Effect&& other) = delete;
 
+		// Compiles the .fx for vertexFormat without a device, any thread can run it
+		static EffectData Compile(const std::wstring& assetFile, VertexFormat vertexFormat = VertexFormat::Full);
+
 		enum class FilteringMethod
 		{
 			Point, Linear, Anisotropic, END
 		};
 
 		ID3DX11Effect* GetEffect() const;
-		ID3DX11EffectTechnique* GetTechnique() const;
+		ID3DX11EffectTechnique* GetTechnique(FilteringMethod filteringMethod = FilteringMethod::Point) const;
+		VertexFormat GetVertexFormat() const;
+		// False when the rasterizer state draws both sides, nothing may be rejected for facing away then
+		bool IsBackFaceCulled() const;
+		// Of the bytecode the effect was created from
+		size_t GetSizeInBytes() const;
 
 		void SetWorldViewProjectionMatrix(const Matrix& matrix);
 
@@ -29,18 +62,21 @@ namespace dae
 		virtual void SetInverseViewMatrix(const Matrix& matrix);
 
 		void SetDiffuseMap(Texture* pDiffuseTexture);
+		// Binds the maps the effect uses, missing ones are left as they were
+		virtual void SetMaterial(const Material& material);
 
-		void CycleFilteringMethods();
 	protected:
 		ID3DX11Effect* m_pEffect{};
-		ID3DX11EffectTechnique* m_pTechnique{};
+		ID3DX11EffectTechnique* m_pTechniques[static_cast<int>(FilteringMethod::END)]{};
 
 		ID3DX11EffectMatrixVariable* m_pMatWorldViewProjVariable{};
 
 		ID3DX11EffectShaderResourceVariable* m_pDiffuseMapVariable{};
 
-		FilteringMethod m_FilteringMethod;
+		const VertexFormat m_VertexFormat;
+		const size_t m_SizeInBytes;
+		bool m_IsBackFaceCulled{ true };
 
-		static ID3DX11Effect* LoadEffect(ID3D11Device* pDevice, const std::wstring& assetFile);
+		static ID3DX11Effect* LoadEffect(ID3D11Device* pDevice, const EffectData& data);
 	};
 }
@@ -0,0 +1,205 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include "MathBackend.h"
+#include "Vector3.h"
+
+// Approximations for hot loops, scalar and SimdFloat forms of each. Errors are the largest measured against the
+// std:: functions in double over the stated range. Estimate instructions differ between CPUs and backends, so results
+// can differ in the last bits between machines, always within the bound
+namespace dae
+{
+	namespace FastMath
+	{
+		namespace Constants
+		{
+			// 1.5 * 2^23: adding it rounds to an integer (ties to even) and leaves that integer in the low mantissa bits
+			constexpr float roundingBias{ 12582912.f };
+
+			// pi / 2 in three parts, the first two with few enough bits that q * part is exact for |q| < 2^13
+			constexpr float piOverTwoHigh{ 1.5703125f };
+			constexpr float piOverTwoMiddle{ 4.837512969970703125e-4f };
+			constexpr float piOverTwoLow{ 7.54978995489188216e-8f };
+			constexpr float twoOverPi{ 0.636619772367581343f };
+
+			// Minimax on [-pi/4, pi/4] (Cephes)
+			constexpr float sin3{ -1.6666654611e-1f };
+			constexpr float sin5{ 8.3321608736e-3f };
+			constexpr float sin7{ -1.9515295891e-4f };
+			constexpr float cos4{ 4.166664568298827e-2f };
+			constexpr float cos6{ -1.388731625493765e-3f };
+			constexpr float cos8{ 2.443315711809948e-5f };
+
+			// 2^f on [-0.5, 0.5], interpolated at the Chebyshev nodes
+			constexpr float exp1{ 6.931472067e-1f };
+			constexpr float exp2{ 2.402265092e-1f };
+			constexpr float exp3{ 5.550327227e-2f };
+			constexpr float exp4{ 9.618056679e-3f };
+			constexpr float exp5{ 1.340042818e-3f };
+			constexpr float exp6{ 1.546144470e-4f };
+
+			// log2(m) = 2 / ln(2) * atanh(t), t = (m - 1) / (m + 1), |t| <= 0.172 for m in [sqrt(2) / 2, sqrt(2)]
+			constexpr float log1{ 2.885390082e+0f };
+			constexpr float log3{ 9.617966939e-1f };
+			constexpr float log5{ 5.770780164e-1f };
+			constexpr float log7{ 4.121985831e-1f };
+			constexpr float sqrtTwo{ 1.41421356237f };
+			constexpr uint32_t sqrtHalfBits{ 0x3F3504F3 };
+		}
+
+		// 1 / sqrt(x) for positive finite x, relative error 2.8e-7 (estimate and one Newton step)
+		inline float RSqrt(float x)
+		{
+#if defined(DAE_MATH_SSE)
+			const float estimate{ _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x))) };
+			return estimate * (1.5f - 0.5f * x * estimate * estimate);
+#else
+			return 1.f / std::sqrt(x);
+#endif
+		}
+
+		// Like Vector3::Normalized, NaN for the zero vector too. Length off by 2.8e-7 at most
+		inline Vector3 Normalized(const Vector3& v)
+		{
+			return v * RSqrt(v.SqrMagnitude());
+		}
+
+		// Both at once, absolute error 9.3e-8 for |x| <= 8192, 9.6e-7 up to 65536, meaningless past 6e6
+		constexpr void SinCos(float x, float& sin, float& cos)
+		{
+			using namespace Constants;
+			const float shifted{ x * twoOverPi + roundingBias };
+			const float q{ shifted - roundingBias };
+			// Its low two bits are q mod 4
+			const uint32_t quadrant{ std::bit_cast<uint32_t>(shifted) };
+			const float r{ ((x - q * piOverTwoHigh) - q * piOverTwoMiddle) - q * piOverTwoLow };
+			const float r2{ r * r };
+			const float s{ r + r * r2 * (sin3 + r2 * (sin5 + r2 * sin7)) };
+			const float c{ 1.f - 0.5f * r2 + r2 * r2 * (cos4 + r2 * (cos6 + r2 * cos8)) };
+
+			// Swapped in odd quadrants, sine negative in 2 and 3, cosine in 1 and 2. Indexed, not branched
+			const float values[2]{ s, c };
+			const uint32_t isOdd{ quadrant & 1 };
+			sin = values[isOdd] * (1.f - static_cast<float>(quadrant & 2));
+			cos = values[isOdd ^ 1] * (1.f - static_cast<float>((quadrant + 1) & 2));
+		}
+
+		// x clamped to [-126, 127], relative error 1.1e-7
+		constexpr float Exp2(float x)
+		{
+			using namespace Constants;
+			x = std::min(std::max(x, -126.f), 127.f);
+			const float shifted{ x + roundingBias };
+			const float f{ x - (shifted - roundingBias) };
+			const float p{ 1.f + f * (exp1 + f * (exp2 + f * (exp3 + f * (exp4 + f * (exp5 + f * exp6))))) };
+			// The integer part plus the bias, moved into the exponent field. Everything above it is shifted out
+			return p * std::bit_cast<float>((std::bit_cast<uint32_t>(shifted) + 127) << 23);
+		}
+
+		// Positive normal x, absolute error 1.3e-7 on top of rounding the result
+		constexpr float Log2(float x)
+		{
+			using namespace Constants;
+			// Offset by the bits of sqrt(2) / 2, the mantissa lands in [sqrt(2) / 2, sqrt(2)) and the exponent follows without a compare
+			const uint32_t offsetBits{ std::bit_cast<uint32_t>(x) - sqrtHalfBits };
+			const float exponent{ static_cast<float>(static_cast<int32_t>(offsetBits) >> 23) };
+			const float mantissa{ std::bit_cast<float>((offsetBits & 0x007FFFFF) + sqrtHalfBits) };
+			const float t{ (mantissa - 1.f) / (mantissa + 1.f) };
+			const float t2{ t * t };
+			return exponent + t * (log1 + t2 * (log3 + t2 * (log5 + t2 * log7)));
+		}
+
+		// x^y for x >= 0, 0 for x == 0. Relative error 1.5e-7 + 2.4e-7 * |y * log2(x)|
+		constexpr float Pow(float x, float y)
+		{
+			return x > 0.f ? Exp2(y * Log2(x)) : 0.f;
+		}
+
+#ifdef DAE_MATH_SIMD
+		inline SimdFloat RSqrt(SimdFloat x)
+		{
+			const SimdFloat estimate{ SimdFloat::RSqrtEstimate(x) };
+			return estimate * (SimdFloat::Set(1.5f) - SimdFloat::Set(0.5f) * x * estimate * estimate);
+		}
+
+		// Separate x/y/z lanes, like Normalized
+		inline void Normalize(SimdFloat& x, SimdFloat& y, SimdFloat& z)
+		{
+			const SimdFloat inverseLength{ RSqrt(x * x + y * y + z * z) };
+			x = x * inverseLength;
+			y = y * inverseLength;
+			z = z * inverseLength;
+		}
+
+		inline void SinCos(SimdFloat x, SimdFloat& sin, SimdFloat& cos)
+		{
+			using namespace Constants;
+			const SimdFloat zero{ SimdFloat::Set(0.f) };
+			const SimdFloat q{ SimdFloat::Round(x * SimdFloat::Set(twoOverPi)) };
+			const SimdFloat r{ ((x - q * SimdFloat::Set(piOverTwoHigh)) - q * SimdFloat::Set(piOverTwoMiddle)) - q * SimdFloat::Set(piOverTwoLow) };
+			const SimdFloat r2{ r * r };
+			const SimdFloat s{ r + r * r2 * (SimdFloat::Set(sin3) + r2 * (SimdFloat::Set(sin5) + r2 * SimdFloat::Set(sin7))) };
+			const SimdFloat c{ SimdFloat::Set(1.f) - SimdFloat::Set(0.5f) * r2
+				+ r2 * r2 * (SimdFloat::Set(cos4) + r2 * (SimdFloat::Set(cos6) + r2 * SimdFloat::Set(cos8))) };
+
+			// Quadrant in [0, 4) without integer lanes: q / 4 minus its rounding is a multiple of 1/4 in [-1/2, 1/2]
+			const SimdFloat quarter{ q * SimdFloat::Set(0.25f) };
+			SimdFloat quadrant{ (quarter - SimdFloat::Round(quarter)) * SimdFloat::Set(4.f) };
+			quadrant = SimdFloat::Select(SimdFloat::Less(quadrant, zero), quadrant + SimdFloat::Set(4.f), quadrant);
+			// Odd: half the quadrant is off its rounding by 1/2. Sine negative for 2 and 3, cosine for 1 and 2
+			const SimdFloat half{ quadrant * SimdFloat::Set(0.5f) };
+			const SimdFloat halfOffset{ half - SimdFloat::Round(half) };
+			const SimdFloat isOdd{ SimdFloat::Less(SimdFloat::Set(0.125f), halfOffset * halfOffset) };
+			const SimdFloat isSinNegative{ SimdFloat::Less(SimdFloat::Set(1.5f), quadrant) };
+			const SimdFloat cosineOffset{ quadrant - SimdFloat::Set(1.5f) };
+			const SimdFloat isCosNegative{ SimdFloat::Less(cosineOffset * cosineOffset, SimdFloat::Set(1.f)) };
+
+			const SimdFloat sinValue{ SimdFloat::Select(isOdd, c, s) };
+			const SimdFloat cosValue{ SimdFloat::Select(isOdd, s, c) };
+			sin = SimdFloat::Select(isSinNegative, zero - sinValue, sinValue);
+			cos = SimdFloat::Select(isCosNegative, zero - cosValue, cosValue);
+		}
+
+		inline SimdFloat Exp2(SimdFloat x)
+		{
+			using namespace Constants;
+			x = SimdFloat::Min(SimdFloat::Max(x, SimdFloat::Set(-126.f)), SimdFloat::Set(127.f));
+			const SimdFloat n{ SimdFloat::Round(x) };
+			const SimdFloat f{ x - n };
+			const SimdFloat p{ SimdFloat::Set(1.f) + f * (SimdFloat::Set(exp1) + f * (SimdFloat::Set(exp2) + f * (SimdFloat::Set(exp3)
+				+ f * (SimdFloat::Set(exp4) + f * (SimdFloat::Set(exp5) + f * SimdFloat::Set(exp6)))))) };
+			return p * SimdFloat::Pow2(n);
+		}
+
+		inline SimdFloat Log2(SimdFloat x)
+		{
+			using namespace Constants;
+			SimdFloat exponent;
+			SimdFloat mantissa{ SimdFloat::SplitExponent(x, exponent) };
+			const SimdFloat isAboveSqrtTwo{ SimdFloat::Less(SimdFloat::Set(sqrtTwo), mantissa) };
+			mantissa = SimdFloat::Select(isAboveSqrtTwo, mantissa * SimdFloat::Set(0.5f), mantissa);
+			exponent = SimdFloat::Select(isAboveSqrtTwo, exponent + SimdFloat::Set(1.f), exponent);
+			const SimdFloat t{ (mantissa - SimdFloat::Set(1.f)) / (mantissa + SimdFloat::Set(1.f)) };
+			const SimdFloat t2{ t * t };
+			return exponent + t * (SimdFloat::Set(log1) + t2 * (SimdFloat::Set(log3) + t2 * (SimdFloat::Set(log5) + t2 * SimdFloat::Set(log7))));
+		}
+
+		inline SimdFloat Pow(SimdFloat x, SimdFloat y)
+		{
+			const SimdFloat zero{ SimdFloat::Set(0.f) };
+			return SimdFloat::Select(SimdFloat::Less(zero, x), Exp2(y * Log2(x)), zero);
+		}
+#endif
+
+#if defined(DAE_MATH_SSE)
+		// For kernels written in SSE intrinsics directly, same as the SimdFloat RSqrt on SSE2
+		inline __m128 RSqrt(__m128 x)
+		{
+			const __m128 estimate{ _mm_rsqrt_ps(x) };
+			return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), estimate), estimate)));
+		}
+#endif
+	}
+}
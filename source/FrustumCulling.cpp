@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "FrustumCulling.h"
+
+#include "MathBackend.h"
+
+// Follows the math backend, so DAE_MATH_SCALAR turns this off as well
+#if defined(DAE_MATH_SSE)
+#define DAE_FRUSTUM_CULLING_SSE2
+#endif
+
+namespace dae
+{
+	void ExtractFrustumPlanes(const Matrix& matrix, Vector4 planes[numFrustumPlanes])
+	{
+		const auto column{ [&matrix](int index)
+			{
+				return Vector4{ matrix[0][index], matrix[1][index], matrix[2][index], matrix[3][index] };
+			} };
+		const Vector4 x{ column(0) };
+		const Vector4 y{ column(1) };
+		const Vector4 z{ column(2) };
+		const Vector4 w{ column(3) };
+
+		planes[0] = w + x;
+		planes[1] = w - x;
+		planes[2] = w + y;
+		planes[3] = w - y;
+		planes[4] = z;
+		planes[5] = w - z;
+		for (int i{}; i < numFrustumPlanes; ++i)
+		{
+			const float length{ planes[i].GetXYZ().Magnitude() };
+			if (length > 0.f)
+				planes[i] = planes[i] * (1.f / length);
+		}
+	}
+
+	BoundingVolume TransformBoundingVolume(const BoundingVolume& volume, const Matrix& matrix)
+	{
+		const Vector3 axisX{ matrix.GetAxisX() };
+		const Vector3 axisY{ matrix.GetAxisY() };
+		const Vector3 axisZ{ matrix.GetAxisZ() };
+
+		BoundingVolume result{};
+		result.center = matrix.TransformPoint(volume.center);
+		result.radius = volume.radius * std::max({ axisX.Magnitude(), axisY.Magnitude(), axisZ.Magnitude() });
+		// Arvo: every world axis picks up the absolute contribution of each box axis
+		const Vector3& extents{ volume.extents };
+		result.extents = {
+			std::abs(axisX.x) * extents.x + std::abs(axisY.x) * extents.y + std::abs(axisZ.x) * extents.z,
+			std::abs(axisX.y) * extents.x + std::abs(axisY.y) * extents.y + std::abs(axisZ.y) * extents.z,
+			std::abs(axisX.z) * extents.x + std::abs(axisY.z) * extents.y + std::abs(axisZ.z) * extents.z };
+		return result;
+	}
+
+	FrustumCullStats CullBoundingVolumes(const Matrix& viewProjection, const std::vector<BoundingVolume>& volumes, std::vector<uint8_t>& isVisible)
+	{
+		Vector4 planes[numFrustumPlanes];
+		ExtractFrustumPlanes(viewProjection, planes);
+
+		FrustumCullStats stats{};
+		stats.numVolumes = static_cast<uint32_t>(volumes.size());
+		isVisible.resize(volumes.size());
+
+		const auto count{ [&](size_t volume, bool isSphereInside, bool isBoxInside)
+			{
+				isVisible[volume] = isSphereInside && isBoxInside;
+				if (!isSphereInside)
+					++stats.sphereCulledVolumes;
+				else if (!isBoxInside)
+					++stats.boxCulledVolumes;
+				else
+					++stats.visibleVolumes;
+			} };
+
+#ifdef DAE_FRUSTUM_CULLING_SSE2
+		const __m128 signMask{ _mm_set1_ps(-0.f) };
+		for (size_t i{}; i < volumes.size(); i += 4)
+		{
+			// Transpose up to four volumes into lanes, missing lanes stay zero and are never read back
+			const size_t numLanes{ std::min(volumes.size() - i, size_t{ 4 }) };
+			alignas(16) float lanes[7][4]{};
+			for (size_t lane{}; lane < numLanes; ++lane)
+			{
+				const BoundingVolume& volume{ volumes[i + lane] };
+				lanes[0][lane] = volume.center.x;
+				lanes[1][lane] = volume.center.y;
+				lanes[2][lane] = volume.center.z;
+				lanes[3][lane] = volume.radius;
+				lanes[4][lane] = volume.extents.x;
+				lanes[5][lane] = volume.extents.y;
+				lanes[6][lane] = volume.extents.z;
+			}
+			const __m128 centerX{ _mm_load_ps(lanes[0]) }, centerY{ _mm_load_ps(lanes[1]) }, centerZ{ _mm_load_ps(lanes[2]) };
+			const __m128 negativeRadius{ _mm_xor_ps(_mm_load_ps(lanes[3]), signMask) };
+			const __m128 extentX{ _mm_load_ps(lanes[4]) }, extentY{ _mm_load_ps(lanes[5]) }, extentZ{ _mm_load_ps(lanes[6]) };
+
+			__m128 sphereInside{ _mm_castsi128_ps(_mm_set1_epi32(-1)) };
+			__m128 boxInside{ sphereInside };
+			for (const Vector4& plane : planes)
+			{
+				const __m128 planeX{ _mm_set1_ps(plane.x) }, planeY{ _mm_set1_ps(plane.y) }, planeZ{ _mm_set1_ps(plane.z) };
+				const __m128 distance{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, planeX), _mm_mul_ps(centerY, planeY)),
+					_mm_add_ps(_mm_mul_ps(centerZ, planeZ), _mm_set1_ps(plane.w))) };
+				sphereInside = _mm_and_ps(sphereInside, _mm_cmpge_ps(distance, negativeRadius));
+
+				// Box radius along the plane normal
+				const __m128 projectedExtent{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, _mm_andnot_ps(signMask, planeX)), _mm_mul_ps(extentY, _mm_andnot_ps(signMask, planeY))),
+					_mm_mul_ps(extentZ, _mm_andnot_ps(signMask, planeZ))) };
+				boxInside = _mm_and_ps(boxInside, _mm_cmpge_ps(distance, _mm_xor_ps(projectedExtent, signMask)));
+			}
+
+			const int sphereMask{ _mm_movemask_ps(sphereInside) };
+			const int boxMask{ _mm_movemask_ps(boxInside) };
+			for (size_t lane{}; lane < numLanes; ++lane)
+			{
+				count(i + lane, (sphereMask >> lane) & 1, (boxMask >> lane) & 1);
+			}
+		}
+#else
+		for (size_t i{}; i < volumes.size(); ++i)
+		{
+			const BoundingVolume& volume{ volumes[i] };
+			bool isSphereInside{ true };
+			bool isBoxInside{ true };
+			for (const Vector4& plane : planes)
+			{
+				const float distance{ Vector3::Dot(volume.center, plane.GetXYZ()) + plane.w };
+				isSphereInside &= distance >= -volume.radius;
+				isBoxInside &= distance >= -(volume.extents.x * std::abs(plane.x) + volume.extents.y * std::abs(plane.y) + volume.extents.z * std::abs(plane.z));
+			}
+			count(i, isSphereInside, isBoxInside);
+		}
+#endif
+
+		return stats;
+	}
+}
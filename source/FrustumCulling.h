@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Math.h"
+
+namespace dae
+{
+	constexpr int numFrustumPlanes{ 6 };
+
+	// Gribb/Hartmann for row vectors (clip = v * M), D3D depth range, pointing inwards
+	// Normalized, so plane distances come out in the units of the space M transforms from
+	void ExtractFrustumPlanes(const Matrix& matrix, Vector4 planes[numFrustumPlanes]);
+
+	// Sphere and box around the same center
+	struct BoundingVolume
+	{
+		Vector3 center;
+		float radius;
+		// Half the size of the box
+		Vector3 extents;
+	};
+
+	// The box becomes the axis aligned box around the transformed one, the radius grows with the largest scale
+	BoundingVolume TransformBoundingVolume(const BoundingVolume& volume, const Matrix& matrix);
+
+	struct FrustumCullStats
+	{
+		uint32_t numVolumes{};
+		// Rejected by the sphere test
+		uint32_t sphereCulledVolumes{};
+		// Sphere touched the frustum, the box did not
+		uint32_t boxCulledVolumes{};
+		uint32_t visibleVolumes{};
+	};
+
+	// Sphere first, box for what survives it, four volumes at a time with SSE2. isVisible gets 0 or 1 per volume
+	FrustumCullStats CullBoundingVolumes(const Matrix& viewProjection, const std::vector<BoundingVolume>& volumes, std::vector<uint8_t>& isVisible);
+}
@@ -0,0 +1,586 @@
+#include "pch.h"
+#include "Gltf.h"
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <string_view>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr uint32_t glbMagic{ 0x46546C67 }; // "glTF"
+		constexpr uint32_t glbVersion{ 2 };
+		constexpr uint32_t jsonChunkType{ 0x4E4F534A }; // "JSON"
+		constexpr uint32_t binChunkType{ 0x004E4942 }; // "BIN\0"
+		constexpr size_t glbHeaderSize{ 12 };
+		constexpr size_t chunkHeaderSize{ 8 };
+		// Vertex attribute strides the spec allows, multiples of 4
+		constexpr int64_t minByteStride{ 4 };
+		constexpr int64_t maxByteStride{ 252 };
+		// Triangle list, the default primitive mode
+		constexpr int64_t trianglesMode{ 4 };
+		// Nesting a glTF never comes close to, keeps a hostile file from overflowing the stack
+		constexpr int maxJsonDepth{ 64 };
+
+		inline uint32_t ReadUint32(const char* pData)
+		{
+			uint32_t value;
+			std::memcpy(&value, pData, sizeof(value));
+			return value;
+		}
+
+		// DOM of the JSON chunk, strings point into the mapping and keep their escapes (glTF keys and enums never have any)
+		struct JsonValue
+		{
+			enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+			Type type{ Type::Null };
+			double number{};
+			std::string_view string{};
+			// Array elements, or the member values of an object in the order of keys
+			std::vector<JsonValue> values{};
+			std::vector<std::string_view> keys{};
+
+			const JsonValue* Find(std::string_view key) const
+			{
+				if (type != Type::Object)
+					return nullptr;
+				for (size_t i{}; i < keys.size(); ++i)
+				{
+					if (keys[i] == key)
+						return &values[i];
+				}
+				return nullptr;
+			}
+
+			size_t GetNumElements() const
+			{
+				return type == Type::Array ? values.size() : 0;
+			}
+		};
+
+		// Recursive descent over the whole chunk, fails on anything that isn't JSON
+		class JsonParser final
+		{
+		public:
+			JsonParser(const char* pBegin, const char* pEnd)
+				: m_pCurrent{ pBegin }
+				, m_pEnd{ pEnd }
+			{
+			}
+
+			bool Parse(JsonValue& value)
+			{
+				if (!ParseValue(value, 0))
+					return false;
+				SkipWhitespace();
+				return m_pCurrent == m_pEnd;
+			}
+
+		private:
+			void SkipWhitespace()
+			{
+				while (m_pCurrent < m_pEnd && (*m_pCurrent == ' ' || *m_pCurrent == '\t' || *m_pCurrent == '\n' || *m_pCurrent == '\r'))
+					++m_pCurrent;
+			}
+
+			bool ParseLiteral(std::string_view literal)
+			{
+				if (static_cast<size_t>(m_pEnd - m_pCurrent) < literal.size() || std::string_view{ m_pCurrent, literal.size() } != literal)
+					return false;
+				m_pCurrent += literal.size();
+				return true;
+			}
+
+			bool ParseString(std::string_view& string)
+			{
+				if (m_pCurrent == m_pEnd || *m_pCurrent != '"')
+					return false;
+				const char* pBegin{ ++m_pCurrent };
+				while (m_pCurrent < m_pEnd && *m_pCurrent != '"')
+				{
+					// Skips the escaped character, so \" doesn't end the string
+					if (*m_pCurrent == '\\')
+						++m_pCurrent;
+					++m_pCurrent;
+				}
+				if (m_pCurrent >= m_pEnd)
+					return false;
+				string = { pBegin, static_cast<size_t>(m_pCurrent - pBegin) };
+				++m_pCurrent;
+				return true;
+			}
+
+			bool ParseValue(JsonValue& value, int depth)
+			{
+				if (depth > maxJsonDepth)
+					return false;
+				SkipWhitespace();
+				if (m_pCurrent == m_pEnd)
+					return false;
+
+				switch (*m_pCurrent)
+				{
+				case '{':
+				{
+					value.type = JsonValue::Type::Object;
+					++m_pCurrent;
+					SkipWhitespace();
+					if (m_pCurrent < m_pEnd && *m_pCurrent == '}')
+					{
+						++m_pCurrent;
+						return true;
+					}
+					while (true)
+					{
+						SkipWhitespace();
+						value.keys.emplace_back();
+						if (!ParseString(value.keys.back()))
+							return false;
+						SkipWhitespace();
+						if (m_pCurrent == m_pEnd || *m_pCurrent++ != ':')
+							return false;
+						value.values.emplace_back();
+						if (!ParseValue(value.values.back(), depth + 1))
+							return false;
+						SkipWhitespace();
+						if (m_pCurrent == m_pEnd)
+							return false;
+						const char separator{ *m_pCurrent++ };
+						if (separator == '}')
+							return true;
+						if (separator != ',')
+							return false;
+					}
+				}
+				case '[':
+				{
+					value.type = JsonValue::Type::Array;
+					++m_pCurrent;
+					SkipWhitespace();
+					if (m_pCurrent < m_pEnd && *m_pCurrent == ']')
+					{
+						++m_pCurrent;
+						return true;
+					}
+					while (true)
+					{
+						value.values.emplace_back();
+						if (!ParseValue(value.values.back(), depth + 1))
+							return false;
+						SkipWhitespace();
+						if (m_pCurrent == m_pEnd)
+							return false;
+						const char separator{ *m_pCurrent++ };
+						if (separator == ']')
+							return true;
+						if (separator != ',')
+							return false;
+					}
+				}
+				case '"':
+					value.type = JsonValue::Type::String;
+					return ParseString(value.string);
+				case 't':
+					value.type = JsonValue::Type::Bool;
+					value.number = 1.0;
+					return ParseLiteral("true");
+				case 'f':
+					value.type = JsonValue::Type::Bool;
+					return ParseLiteral("false");
+				case 'n':
+					return ParseLiteral("null");
+				default:
+				{
+					value.type = JsonValue::Type::Number;
+					const std::from_chars_result result{ std::from_chars(m_pCurrent, m_pEnd, value.number) };
+					if (result.ec != std::errc{})
+						return false;
+					m_pCurrent = result.ptr;
+					return true;
+				}
+				}
+			}
+
+			const char* m_pCurrent;
+			const char* m_pEnd;
+		};
+
+		// Non-negative integer member, fallback when the member is missing and -1 when it's anything else
+		int64_t GetInteger(const JsonValue& object, std::string_view key, int64_t fallback)
+		{
+			const JsonValue* pValue{ object.Find(key) };
+			if (!pValue)
+				return fallback;
+			if (pValue->type != JsonValue::Type::Number || pValue->number < 0.0 || pValue->number > 9007199254740992.0
+				|| pValue->number != static_cast<double>(static_cast<int64_t>(pValue->number)))
+				return -1;
+			return static_cast<int64_t>(pValue->number);
+		}
+
+		// Accessor index member, -1 when it's missing. Anything else that isn't a valid int becomes INT_MAX, an index no accessor
+		// has, so a primitive using it fails to load instead of narrowing onto some other accessor
+		int GetAccessorIndex(const JsonValue& object, std::string_view key)
+		{
+			if (!object.Find(key))
+				return -1;
+			const int64_t index{ GetInteger(object, key, -1) };
+			return index >= 0 && index < INT_MAX ? static_cast<int>(index) : INT_MAX;
+		}
+
+		uint32_t GetNumComponents(std::string_view type)
+		{
+			if (type == "SCALAR") return 1;
+			if (type == "VEC2") return 2;
+			if (type == "VEC3") return 3;
+			if (type == "VEC4") return 4;
+			if (type == "MAT2") return 4;
+			if (type == "MAT3") return 9;
+			if (type == "MAT4") return 16;
+			return 0;
+		}
+
+		size_t GetComponentSize(GltfAccessor::ComponentType type)
+		{
+			switch (type)
+			{
+			case GltfAccessor::ComponentType::Byte:
+			case GltfAccessor::ComponentType::UnsignedByte:
+				return 1;
+			case GltfAccessor::ComponentType::Short:
+			case GltfAccessor::ComponentType::UnsignedShort:
+				return 2;
+			case GltfAccessor::ComponentType::UnsignedInt:
+			case GltfAccessor::ComponentType::Float:
+				return 4;
+			}
+			return 0;
+		}
+
+		// Byte range of a bufferView inside the BIN chunk, pData stays null when it lives in any other buffer
+		struct BufferView
+		{
+			const char* pData{};
+			size_t length{};
+			size_t stride{};
+		};
+
+		void AddTangentStats(TangentSpace::TangentStats& total, const TangentSpace::TangentStats& stats)
+		{
+			total.numTriangles += stats.numTriangles;
+			total.degenerateTriangles += stats.degenerateTriangles;
+			total.numVertices += stats.numVertices;
+			total.mirroredVertices += stats.mirroredVertices;
+			total.fallbackVertices += stats.fallbackVertices;
+			total.numThreads = std::max(total.numThreads, stats.numThreads);
+			total.milliseconds += stats.milliseconds;
+		}
+	}
+
+	size_t GltfAccessor::GetElementSize() const
+	{
+		return GetComponentSize(componentType) * numComponents;
+	}
+
+	GlbFile::GlbFile(const std::string& path)
+		: m_File{ path }
+	{
+		m_IsValid = m_File.IsValid() && Parse();
+	}
+
+	const GltfAccessor& GlbFile::GetAccessor(int index) const
+	{
+		static const GltfAccessor emptyAccessor{};
+		if (index < 0 || static_cast<size_t>(index) >= m_Accessors.size())
+			return emptyAccessor;
+		return m_Accessors[index];
+	}
+
+	bool GlbFile::Parse()
+	{
+		const char* pFile{ m_File.GetData() };
+		const size_t fileSize{ m_File.GetSize() };
+		if (fileSize < glbHeaderSize + chunkHeaderSize || ReadUint32(pFile) != glbMagic || ReadUint32(pFile + 4) != glbVersion)
+			return false;
+		// The header's length bounds everything below, it has to hold at least the headers themselves
+		const size_t length{ std::min<size_t>(ReadUint32(pFile + 8), fileSize) };
+		if (length < glbHeaderSize + chunkHeaderSize)
+			return false;
+
+		// JSON chunk first, the BIN chunk (if any) right after it
+		const size_t jsonLength{ ReadUint32(pFile + glbHeaderSize) };
+		if (ReadUint32(pFile + glbHeaderSize + 4) != jsonChunkType || jsonLength > length - glbHeaderSize - chunkHeaderSize)
+			return false;
+		const char* pJson{ pFile + glbHeaderSize + chunkHeaderSize };
+
+		const char* pBin{};
+		size_t binLength{};
+		const size_t binChunkOffset{ glbHeaderSize + chunkHeaderSize + ((jsonLength + 3) & ~size_t{ 3 }) };
+		if (binChunkOffset + chunkHeaderSize <= length && ReadUint32(pFile + binChunkOffset + 4) == binChunkType)
+		{
+			binLength = ReadUint32(pFile + binChunkOffset);
+			if (binLength > length - binChunkOffset - chunkHeaderSize)
+				return false;
+			pBin = pFile + binChunkOffset + chunkHeaderSize;
+		}
+
+		JsonValue root{};
+		if (!JsonParser{ pJson, pJson + jsonLength }.Parse(root) || root.type != JsonValue::Type::Object)
+			return false;
+		const JsonValue emptyValue{};
+		const auto findArray{ [&root, &emptyValue](std::string_view key) -> const JsonValue&
+			{
+				const JsonValue* pValue{ root.Find(key) };
+				return pValue && pValue->type == JsonValue::Type::Array ? *pValue : emptyValue;
+			} };
+
+		// Only buffer 0 without a uri is the BIN chunk
+		bool hasBinBuffer{};
+		if (const JsonValue& buffers{ findArray("buffers") }; buffers.GetNumElements() > 0)
+		{
+			const JsonValue& buffer{ buffers.values[0] };
+			const int64_t byteLength{ GetInteger(buffer, "byteLength", -1) };
+			hasBinBuffer = pBin && !buffer.Find("uri") && byteLength >= 0 && static_cast<uint64_t>(byteLength) <= binLength;
+		}
+
+		std::vector<BufferView> bufferViews{};
+		for (const JsonValue& view : findArray("bufferViews").values)
+		{
+			BufferView& bufferView{ bufferViews.emplace_back() };
+			const int64_t buffer{ GetInteger(view, "buffer", -1) };
+			const int64_t byteOffset{ GetInteger(view, "byteOffset", 0) };
+			const int64_t byteLength{ GetInteger(view, "byteLength", -1) };
+			const int64_t byteStride{ GetInteger(view, "byteStride", 0) };
+			const bool hasByteStride{ view.Find("byteStride") != nullptr };
+			if (buffer != 0 || !hasBinBuffer || byteOffset < 0 || byteLength < 0
+				|| (hasByteStride && (byteStride < minByteStride || byteStride > maxByteStride || byteStride % 4 != 0))
+				|| static_cast<uint64_t>(byteOffset) + static_cast<uint64_t>(byteLength) > binLength)
+				continue;
+			bufferView = { pBin + byteOffset, static_cast<size_t>(byteLength), static_cast<size_t>(byteStride) };
+		}
+
+		// Accessors that can't be viewed in place keep a null pData, a primitive using one fails to load
+		for (const JsonValue& accessor : findArray("accessors").values)
+		{
+			GltfAccessor& result{ m_Accessors.emplace_back() };
+			const int64_t bufferView{ GetInteger(accessor, "bufferView", -1) };
+			const int64_t byteOffset{ GetInteger(accessor, "byteOffset", 0) };
+			const int64_t componentType{ GetInteger(accessor, "componentType", -1) };
+			const int64_t count{ GetInteger(accessor, "count", -1) };
+			const JsonValue* pType{ accessor.Find("type") };
+			const JsonValue* pNormalized{ accessor.Find("normalized") };
+			if (bufferView < 0 || static_cast<size_t>(bufferView) >= bufferViews.size() || !bufferViews[bufferView].pData || byteOffset < 0
+				|| count < 0 || !pType || accessor.Find("sparse"))
+				continue;
+
+			const BufferView& view{ bufferViews[bufferView] };
+			const GltfAccessor::ComponentType type{ static_cast<GltfAccessor::ComponentType>(componentType) };
+			const size_t componentSize{ GetComponentSize(type) };
+			const uint32_t numComponents{ GetNumComponents(pType->string) };
+			const size_t elementSize{ componentSize * numComponents };
+			const size_t stride{ view.stride > 0 ? view.stride : elementSize };
+			if (elementSize == 0 || stride < elementSize || stride % componentSize != 0)
+				continue;
+
+			// In bounds and aligned to the component, so elements can be read through a typed pointer. The last element has to fit
+			// in what the first leaves, divided rather than multiplied so a huge count or stride can't wrap around
+			if (static_cast<uint64_t>(byteOffset) > view.length)
+				continue;
+			const char* pData{ view.pData + byteOffset };
+			const size_t remaining{ view.length - static_cast<size_t>(byteOffset) };
+			if (reinterpret_cast<uintptr_t>(pData) % componentSize != 0
+				|| (count > 0 && (elementSize > remaining || static_cast<uint64_t>(count) - 1 > (remaining - elementSize) / stride)))
+				continue;
+
+			result.pData = pData;
+			result.count = static_cast<size_t>(count);
+			result.stride = stride;
+			result.componentType = type;
+			result.numComponents = numComponents;
+			result.isNormalized = pNormalized && pNormalized->type == JsonValue::Type::Bool && pNormalized->number != 0.0;
+		}
+
+		for (const JsonValue& mesh : findArray("meshes").values)
+		{
+			const JsonValue* pPrimitives{ mesh.Find("primitives") };
+			if (!pPrimitives)
+				continue;
+			for (const JsonValue& primitive : pPrimitives->values)
+			{
+				const JsonValue* pAttributes{ primitive.Find("attributes") };
+				if (!pAttributes || GetInteger(primitive, "mode", trianglesMode) != trianglesMode)
+					continue;
+				GltfPrimitive& result{ m_Primitives.emplace_back() };
+				result.position = GetAccessorIndex(*pAttributes, "POSITION");
+				result.normal = GetAccessorIndex(*pAttributes, "NORMAL");
+				result.tangent = GetAccessorIndex(*pAttributes, "TANGENT");
+				result.texCoord = GetAccessorIndex(*pAttributes, "TEXCOORD_0");
+				result.indices = GetAccessorIndex(primitive, "indices");
+			}
+		}
+
+		return true;
+	}
+
+	namespace Gltf
+	{
+		bool LoadGLB(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding, GlbLoadStats* pStats,
+			uint32_t numThreads)
+		{
+			using ComponentType = GltfAccessor::ComponentType;
+			const auto startTime{ std::chrono::steady_clock::now() };
+
+			const GlbFile file{ filename };
+			if (!file.IsValid())
+				return false;
+
+			vertices.clear();
+			indices.clear();
+			GlbLoadStats stats{};
+			stats.fileSize = file.GetFileSize();
+
+			std::vector<Vertex> primitiveVertices{};
+			std::vector<uint32_t> primitiveIndices{};
+			for (const GltfPrimitive& primitive : file.GetPrimitives())
+			{
+				// Attributes in a layout core glTF allows but this doesn't read fail the load rather than be dropped
+				const GltfAccessor& position{ file.GetAccessor(primitive.position) };
+				const GltfAccessor& normal{ file.GetAccessor(primitive.normal) };
+				const GltfAccessor& tangent{ file.GetAccessor(primitive.tangent) };
+				const GltfAccessor& texCoord{ file.GetAccessor(primitive.texCoord) };
+				const GltfAccessor& index{ file.GetAccessor(primitive.indices) };
+				if (!position.Holds(ComponentType::Float, 3))
+					return false;
+				const size_t numVertices{ position.count };
+				const auto isUsable{ [numVertices](int accessor, const GltfAccessor& attribute, bool isLayoutSupported)
+					{
+						return accessor < 0 || (isLayoutSupported && attribute.count == numVertices);
+					} };
+				const bool hasFloatTexCoord{ texCoord.Holds(ComponentType::Float, 2) };
+				const bool hasNormalizedTexCoord{ texCoord.isNormalized
+					&& (texCoord.Holds(ComponentType::UnsignedByte, 2) || texCoord.Holds(ComponentType::UnsignedShort, 2)) };
+				if (!isUsable(primitive.normal, normal, normal.Holds(ComponentType::Float, 3))
+					|| !isUsable(primitive.tangent, tangent, tangent.Holds(ComponentType::Float, 4))
+					|| !isUsable(primitive.texCoord, texCoord, hasFloatTexCoord || hasNormalizedTexCoord))
+					return false;
+				if (vertices.size() + numVertices > UINT32_MAX)
+					return false;
+
+				// Interleaved into Vertex, the layout the input assembler reads; the views themselves don't copy
+				const AccessorView<Vector3> positions{ position.As<Vector3>() };
+				const AccessorView<Vector3> normals{ normal.As<Vector3>() };
+				const AccessorView<Vector4> tangents{ tangent.As<Vector4>() };
+				primitiveVertices.assign(numVertices, Vertex{});
+				for (size_t i{}; i < numVertices; ++i)
+				{
+					primitiveVertices[i].position = positions[i];
+				}
+				for (size_t i{}; i < normals.size(); ++i)
+				{
+					primitiveVertices[i].normal = normals[i];
+				}
+				for (size_t i{}; i < tangents.size(); ++i)
+				{
+					primitiveVertices[i].tangent = tangents[i];
+				}
+				if (hasFloatTexCoord)
+				{
+					const AccessorView<Vector2> texCoords{ texCoord.As<Vector2>() };
+					for (size_t i{}; i < numVertices; ++i)
+					{
+						primitiveVertices[i].uv = texCoords[i];
+					}
+				}
+				else if (hasNormalizedTexCoord && texCoord.componentType == ComponentType::UnsignedShort)
+				{
+					const AccessorView<std::array<uint16_t, 2>> texCoords{ texCoord.As<std::array<uint16_t, 2>>() };
+					for (size_t i{}; i < texCoords.size(); ++i)
+					{
+						primitiveVertices[i].uv = { texCoords[i][0] / 65535.f, texCoords[i][1] / 65535.f };
+					}
+				}
+				else if (hasNormalizedTexCoord)
+				{
+					const AccessorView<std::array<uint8_t, 2>> texCoords{ texCoord.As<std::array<uint8_t, 2>>() };
+					for (size_t i{}; i < texCoords.size(); ++i)
+					{
+						primitiveVertices[i].uv = { texCoords[i][0] / 255.f, texCoords[i][1] / 255.f };
+					}
+				}
+
+				// 8, 16 or 32-bit indices, or none for a plain triangle list
+				const auto copyIndices{ [&primitiveIndices, numVertices](const auto& view)
+					{
+						primitiveIndices.resize(view.size());
+						for (size_t i{}; i < view.size(); ++i)
+						{
+							if (view[i] >= numVertices)
+								return false;
+							primitiveIndices[i] = view[i];
+						}
+						return true;
+					} };
+				bool areIndicesValid{ true };
+				if (primitive.indices < 0)
+				{
+					primitiveIndices.resize(numVertices);
+					for (size_t i{}; i < numVertices; ++i)
+					{
+						primitiveIndices[i] = static_cast<uint32_t>(i);
+					}
+				}
+				else if (index.Holds(ComponentType::UnsignedInt, 1))
+					areIndicesValid = copyIndices(index.As<uint32_t>());
+				else if (index.Holds(ComponentType::UnsignedShort, 1))
+					areIndicesValid = copyIndices(index.As<uint16_t>());
+				else if (index.Holds(ComponentType::UnsignedByte, 1))
+					areIndicesValid = copyIndices(index.As<uint8_t>());
+				else
+					areIndicesValid = false;
+				if (!areIndicesValid || primitiveIndices.size() % 3 != 0)
+					return false;
+
+				// Same frames ParseOBJ would build, generated before the flip like there
+				if (primitive.tangent < 0)
+				{
+					AddTangentStats(stats.tangents, TangentSpace::GenerateTangents(primitiveVertices, primitiveIndices, numThreads));
+					++stats.generatedTangentPrimitives;
+				}
+
+				const uint32_t firstVertex{ static_cast<uint32_t>(vertices.size()) };
+				for (Vertex& vertex : primitiveVertices)
+				{
+					if (flipAxisAndWinding)
+					{
+						vertex.position.z *= -1.f;
+						vertex.normal.z *= -1.f;
+						vertex.tangent.z *= -1.f;
+					}
+					vertices.push_back(vertex);
+				}
+				for (size_t i{}; i < primitiveIndices.size(); i += 3)
+				{
+					indices.push_back(firstVertex + primitiveIndices[i]);
+					indices.push_back(firstVertex + primitiveIndices[flipAxisAndWinding ? i + 2 : i + 1]);
+					indices.push_back(firstVertex + primitiveIndices[flipAxisAndWinding ? i + 1 : i + 2]);
+				}
+
+				++stats.numPrimitives;
+			}
+
+			if (indices.empty())
+				return false;
+
+			stats.numVertices = vertices.size();
+			stats.numTriangles = indices.size() / 3;
+			stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			if (pStats)
+				*pStats = stats;
+			return true;
+		}
+	}
+}
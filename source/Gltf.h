@@ -0,0 +1,144 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <span>
+#include <cassert>
+#include <cstdint>
+#include "DataTypes.h"
+#include "MappedFile.h"
+#include "TangentSpace.h"
+
+namespace dae
+{
+	// Typed view of a glTF accessor inside the mapped file, elements are read in place, nothing is copied
+	template<typename T>
+	class AccessorView final
+	{
+	public:
+		AccessorView() = default;
+		AccessorView(const char* pData, size_t count, size_t stride)
+			: m_pData{ pData }
+			, m_Count{ count }
+			, m_Stride{ stride }
+		{
+		}
+
+		size_t size() const { return m_Count; }
+		bool empty() const { return m_Count == 0; }
+		const T& operator[](size_t index) const
+		{
+			assert(index < m_Count);
+			return *reinterpret_cast<const T*>(m_pData + index * m_Stride);
+		}
+
+		// Tightly packed, no byteStride between the elements
+		bool IsContiguous() const { return m_Stride == sizeof(T); }
+		std::span<const T> AsSpan() const
+		{
+			assert(IsContiguous());
+			return { reinterpret_cast<const T*>(m_pData), m_Count };
+		}
+
+	private:
+		const char* m_pData{};
+		size_t m_Count{};
+		size_t m_Stride{};
+	};
+
+	struct GltfAccessor
+	{
+		enum class ComponentType : uint32_t
+		{
+			Byte = 5120,
+			UnsignedByte = 5121,
+			Short = 5122,
+			UnsignedShort = 5123,
+			UnsignedInt = 5125,
+			Float = 5126
+		};
+
+		const char* pData{};
+		size_t count{};
+		size_t stride{};
+		ComponentType componentType{};
+		// 1 for SCALAR up to 16 for MAT4
+		uint32_t numComponents{};
+		bool isNormalized{};
+
+		size_t GetElementSize() const;
+
+		bool Holds(ComponentType type, uint32_t components) const
+		{
+			return pData != nullptr && componentType == type && numComponents == components;
+		}
+
+		// Empty unless the elements are exactly T's size, check the layout with Holds first
+		template<typename T>
+		AccessorView<T> As() const
+		{
+			return pData != nullptr && GetElementSize() == sizeof(T) ? AccessorView<T>{ pData, count, stride } : AccessorView<T>{};
+		}
+	};
+
+	// Accessor indices of one triangle list primitive, -1 when the attribute is absent
+	struct GltfPrimitive
+	{
+		int position{ -1 };
+		int normal{ -1 };
+		int tangent{ -1 };
+		int texCoord{ -1 };
+		int indices{ -1 };
+	};
+
+	// Binary glTF 2.0 (.glb): the file is mapped and its BIN chunk is never copied, accessors point straight into it.
+	// Only the embedded buffer is supported, no external .bin, data: uris or sparse accessors
+	class GlbFile final
+	{
+	public:
+		explicit GlbFile(const std::string& path);
+
+		GlbFile(const GlbFile& other) = delete;
+		GlbFile& operator=(const GlbFile& other) = delete;
+		GlbFile(GlbFile&& other) = delete;
+		GlbFile& operator=(GlbFile&& other) = delete;
+
+		bool IsValid() const { return m_IsValid; }
+		size_t GetFileSize() const { return m_File.GetSize(); }
+
+		// Triangle list primitives of every mesh, in file order. Points and lines are skipped
+		const std::vector<GltfPrimitive>& GetPrimitives() const { return m_Primitives; }
+		// Empty accessor (pData == nullptr) for -1 or an index out of range
+		const GltfAccessor& GetAccessor(int index) const;
+
+	private:
+		bool Parse();
+
+		MappedFile m_File;
+		std::vector<GltfAccessor> m_Accessors{};
+		std::vector<GltfPrimitive> m_Primitives{};
+		bool m_IsValid{};
+	};
+
+	namespace Gltf
+	{
+		struct GlbLoadStats
+		{
+			size_t fileSize{};
+			size_t numPrimitives{};
+			size_t numVertices{};
+			size_t numTriangles{};
+			// Primitives that came without TANGENT and got them generated
+			size_t generatedTangentPrimitives{};
+			float milliseconds{};
+			// Part of milliseconds spent on generated tangent frames
+			TangentSpace::TangentStats tangents{};
+		};
+
+		// Same output as Utils::ParseOBJ: every primitive appended to one vertex/index buffer, normals, tangents and indices
+		// used as stored, tangent frames only generated for primitives without them. Positions are in mesh space, node
+		// transforms aren't applied. glTF's uv origin is already top left, so unlike OBJ v isn't flipped. numThreads is for the
+		// tangent frames, 0 picks the hardware concurrency
+		bool LoadGLB(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true,
+			GlbLoadStats* pStats = nullptr, uint32_t numThreads = 0);
+	}
+}
@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dae
+{
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::string& path)
+	{
+		HANDLE file{ CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+		if (file == INVALID_HANDLE_VALUE) return;
+		m_FileHandle = file;
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+
+		m_MappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_MappingHandle) return;
+
+		m_pData = static_cast<const char*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (m_pData) m_Size = static_cast<size_t>(size.QuadPart);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_pData) UnmapViewOfFile(m_pData);
+		if (m_MappingHandle) CloseHandle(m_MappingHandle);
+		if (m_FileHandle) CloseHandle(m_FileHandle);
+	}
+#else
+	MappedFile::MappedFile(const std::string& path)
+	{
+		m_FileDescriptor = open(path.c_str(), O_RDONLY);
+		if (m_FileDescriptor < 0) return;
+
+		struct stat fileStat {};
+		if (fstat(m_FileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) return;
+
+		void* pMapping{ mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0) };
+		if (pMapping == MAP_FAILED) return;
+
+		// We only ever scan front to back
+		madvise(pMapping, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+		m_pData = static_cast<const char*>(pMapping);
+		m_Size = static_cast<size_t>(fileStat.st_size);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_pData) munmap(const_cast<char*>(m_pData), m_Size);
+		if (m_FileDescriptor >= 0) close(m_FileDescriptor);
+	}
+#endif
+}
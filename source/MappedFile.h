@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+namespace dae
+{
+	// Read-only memory mapping of a whole file (MapViewOfFile on Windows, mmap elsewhere)
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+		MappedFile(MappedFile&& other) = delete;
+		MappedFile& operator=(MappedFile&& other) = delete;
+
+		bool IsValid() const { return m_pData != nullptr; }
+		const char* GetData() const { return m_pData; }
+		const char* GetEnd() const { return m_pData + m_Size; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		const char* m_pData{};
+		size_t m_Size{};
+
+#ifdef _WIN32
+		void* m_FileHandle{};
+		void* m_MappingHandle{};
+#else
+		int m_FileDescriptor{ -1 };
+#endif
+	};
+}
@@ -3,5 +3,6 @@
 #include "Vector2.h"
 #include "Vector3.h"
 #include "Vector4.h"
+#include "Quaternion.h"
 #include "Matrix.h"
 #include "MathHelpers.h"
\ No newline at end of file
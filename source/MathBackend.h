@@ -0,0 +1,205 @@
+#pragma once
+#include <cstddef>
+
+// Instruction set the math types are compiled for, picked from the target flags (/arch:AVX2, -mavx2, ...).
+// SIMD paths do the same operations in the same order as the scalar code, so results don't depend on the backend.
+// Define DAE_MATH_SCALAR to force the portable code, e.g. to compare against it
+#ifndef DAE_MATH_SCALAR
+#if defined(__AVX512F__)
+#define DAE_MATH_AVX512
+#define DAE_MATH_AVX
+#define DAE_MATH_SSE
+#elif defined(__AVX__)
+#define DAE_MATH_AVX
+#define DAE_MATH_SSE
+#elif defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DAE_MATH_SSE
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define DAE_MATH_NEON
+#endif
+#endif
+
+#if defined(DAE_MATH_SSE) || defined(DAE_MATH_NEON)
+#define DAE_MATH_SIMD
+#endif
+
+#if defined(DAE_MATH_AVX)
+#include <immintrin.h>
+#elif defined(DAE_MATH_SSE)
+#include <emmintrin.h>
+#elif defined(DAE_MATH_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace dae
+{
+	// For logs and benchmarks
+#if defined(DAE_MATH_AVX512)
+	constexpr const char* mathBackendName{ "AVX-512" };
+#elif defined(DAE_MATH_AVX) && defined(__AVX2__)
+	constexpr const char* mathBackendName{ "AVX2" };
+#elif defined(DAE_MATH_AVX)
+	constexpr const char* mathBackendName{ "AVX" };
+#elif defined(DAE_MATH_SSE)
+	constexpr const char* mathBackendName{ "SSE2" };
+#elif defined(DAE_MATH_NEON)
+	constexpr const char* mathBackendName{ "NEON" };
+#else
+	constexpr const char* mathBackendName{ "scalar" };
+#endif
+
+#ifdef DAE_MATH_SIMD
+	// Widest float register of the backend, with the operators the batch kernels are written in.
+	// The operators are plain IEEE operations, an expression gives the same result per lane as on float.
+	// Besides those, for the FastMath kernels:
+	// - Round: to the nearest integer, ties to even
+	// - RSqrtEstimate: 1 / sqrt(a) to at least 12 bits
+	// - Less/Select: masks are lanes with every bit set or clear
+	// - Pow2: 2^n for integral n in [-126, 127]
+	// - SplitExponent: mantissa in [1, 2) and unbiased exponent of a positive normal number
+	struct SimdFloat
+	{
+#if defined(DAE_MATH_AVX512)
+		static constexpr size_t width{ 16 };
+		__m512 value;
+
+		static SimdFloat Load(const float* pData) { return { _mm512_loadu_ps(pData) }; }
+		static SimdFloat Set(float value) { return { _mm512_set1_ps(value) }; }
+		void Store(float* pData) const { _mm512_storeu_ps(pData, value); }
+
+		friend SimdFloat operator+(SimdFloat a, SimdFloat b) { return { _mm512_add_ps(a.value, b.value) }; }
+		friend SimdFloat operator-(SimdFloat a, SimdFloat b) { return { _mm512_sub_ps(a.value, b.value) }; }
+		friend SimdFloat operator*(SimdFloat a, SimdFloat b) { return { _mm512_mul_ps(a.value, b.value) }; }
+		friend SimdFloat operator/(SimdFloat a, SimdFloat b) { return { _mm512_div_ps(a.value, b.value) }; }
+
+		static SimdFloat Min(SimdFloat a, SimdFloat b) { return { _mm512_min_ps(a.value, b.value) }; }
+		static SimdFloat Max(SimdFloat a, SimdFloat b) { return { _mm512_max_ps(a.value, b.value) }; }
+		static SimdFloat Round(SimdFloat a) { return { _mm512_roundscale_ps(a.value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+		static SimdFloat RSqrtEstimate(SimdFloat a) { return { _mm512_rsqrt14_ps(a.value) }; }
+		static SimdFloat Less(SimdFloat a, SimdFloat b)
+		{
+			return { _mm512_castsi512_ps(_mm512_maskz_mov_epi32(_mm512_cmp_ps_mask(a.value, b.value, _CMP_LT_OQ), _mm512_set1_epi32(-1))) };
+		}
+		static SimdFloat Select(SimdFloat mask, SimdFloat ifTrue, SimdFloat ifFalse)
+		{
+			const __m512i bits{ _mm512_castps_si512(mask.value) };
+			return { _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_castps_si512(ifTrue.value)),
+				_mm512_andnot_si512(bits, _mm512_castps_si512(ifFalse.value)))) };
+		}
+		static SimdFloat Pow2(SimdFloat n)
+		{
+			return { _mm512_castsi512_ps(_mm512_cvtps_epi32(_mm512_mul_ps(_mm512_add_ps(n.value, _mm512_set1_ps(127.f)), _mm512_set1_ps(8388608.f)))) };
+		}
+		static SimdFloat SplitExponent(SimdFloat a, SimdFloat& exponent)
+		{
+			const __m512i bits{ _mm512_castps_si512(a.value) };
+			const __m512 exponentBits{ _mm512_cvtepi32_ps(_mm512_and_si512(bits, _mm512_set1_epi32(0x7F800000))) };
+			exponent = { _mm512_sub_ps(_mm512_mul_ps(exponentBits, _mm512_set1_ps(1.f / 8388608.f)), _mm512_set1_ps(127.f)) };
+			return { _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F800000))) };
+		}
+#elif defined(DAE_MATH_AVX)
+		static constexpr size_t width{ 8 };
+		__m256 value;
+
+		static SimdFloat Load(const float* pData) { return { _mm256_loadu_ps(pData) }; }
+		static SimdFloat Set(float value) { return { _mm256_set1_ps(value) }; }
+		void Store(float* pData) const { _mm256_storeu_ps(pData, value); }
+
+		friend SimdFloat operator+(SimdFloat a, SimdFloat b) { return { _mm256_add_ps(a.value, b.value) }; }
+		friend SimdFloat operator-(SimdFloat a, SimdFloat b) { return { _mm256_sub_ps(a.value, b.value) }; }
+		friend SimdFloat operator*(SimdFloat a, SimdFloat b) { return { _mm256_mul_ps(a.value, b.value) }; }
+		friend SimdFloat operator/(SimdFloat a, SimdFloat b) { return { _mm256_div_ps(a.value, b.value) }; }
+
+		static SimdFloat Min(SimdFloat a, SimdFloat b) { return { _mm256_min_ps(a.value, b.value) }; }
+		static SimdFloat Max(SimdFloat a, SimdFloat b) { return { _mm256_max_ps(a.value, b.value) }; }
+		static SimdFloat Round(SimdFloat a) { return { _mm256_round_ps(a.value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+		static SimdFloat RSqrtEstimate(SimdFloat a) { return { _mm256_rsqrt_ps(a.value) }; }
+		static SimdFloat Less(SimdFloat a, SimdFloat b) { return { _mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ) }; }
+		static SimdFloat Select(SimdFloat mask, SimdFloat ifTrue, SimdFloat ifFalse) { return { _mm256_blendv_ps(ifFalse.value, ifTrue.value, mask.value) }; }
+		static SimdFloat Pow2(SimdFloat n)
+		{
+			return { _mm256_castsi256_ps(_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(n.value, _mm256_set1_ps(127.f)), _mm256_set1_ps(8388608.f)))) };
+		}
+		static SimdFloat SplitExponent(SimdFloat a, SimdFloat& exponent)
+		{
+			// Float and/or only, AVX has no 256 bit integer operations
+			const __m256 exponentBits{ _mm256_and_ps(a.value, _mm256_castsi256_ps(_mm256_set1_epi32(0x7F800000))) };
+			exponent = { _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_castps_si256(exponentBits)), _mm256_set1_ps(1.f / 8388608.f)),
+				_mm256_set1_ps(127.f)) };
+			return { _mm256_or_ps(_mm256_and_ps(a.value, _mm256_castsi256_ps(_mm256_set1_epi32(0x007FFFFF))), _mm256_set1_ps(1.f)) };
+		}
+#elif defined(DAE_MATH_SSE)
+		static constexpr size_t width{ 4 };
+		__m128 value;
+
+		static SimdFloat Load(const float* pData) { return { _mm_loadu_ps(pData) }; }
+		static SimdFloat Set(float value) { return { _mm_set1_ps(value) }; }
+		void Store(float* pData) const { _mm_storeu_ps(pData, value); }
+
+		friend SimdFloat operator+(SimdFloat a, SimdFloat b) { return { _mm_add_ps(a.value, b.value) }; }
+		friend SimdFloat operator-(SimdFloat a, SimdFloat b) { return { _mm_sub_ps(a.value, b.value) }; }
+		friend SimdFloat operator*(SimdFloat a, SimdFloat b) { return { _mm_mul_ps(a.value, b.value) }; }
+		friend SimdFloat operator/(SimdFloat a, SimdFloat b) { return { _mm_div_ps(a.value, b.value) }; }
+
+		static SimdFloat Min(SimdFloat a, SimdFloat b) { return { _mm_min_ps(a.value, b.value) }; }
+		static SimdFloat Max(SimdFloat a, SimdFloat b) { return { _mm_max_ps(a.value, b.value) }; }
+		// SSE2 has no rounding instruction, the conversion rounds to nearest even. Only for |a| < 2^31
+		static SimdFloat Round(SimdFloat a) { return { _mm_cvtepi32_ps(_mm_cvtps_epi32(a.value)) }; }
+		static SimdFloat RSqrtEstimate(SimdFloat a) { return { _mm_rsqrt_ps(a.value) }; }
+		static SimdFloat Less(SimdFloat a, SimdFloat b) { return { _mm_cmplt_ps(a.value, b.value) }; }
+		static SimdFloat Select(SimdFloat mask, SimdFloat ifTrue, SimdFloat ifFalse)
+		{
+			return { _mm_or_ps(_mm_and_ps(mask.value, ifTrue.value), _mm_andnot_ps(mask.value, ifFalse.value)) };
+		}
+		static SimdFloat Pow2(SimdFloat n)
+		{
+			return { _mm_castsi128_ps(_mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(n.value, _mm_set1_ps(127.f)), _mm_set1_ps(8388608.f)))) };
+		}
+		static SimdFloat SplitExponent(SimdFloat a, SimdFloat& exponent)
+		{
+			const __m128 exponentBits{ _mm_and_ps(a.value, _mm_castsi128_ps(_mm_set1_epi32(0x7F800000))) };
+			exponent = { _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_castps_si128(exponentBits)), _mm_set1_ps(1.f / 8388608.f)), _mm_set1_ps(127.f)) };
+			return { _mm_or_ps(_mm_and_ps(a.value, _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF))), _mm_set1_ps(1.f)) };
+		}
+#elif defined(DAE_MATH_NEON)
+		static constexpr size_t width{ 4 };
+		float32x4_t value;
+
+		static SimdFloat Load(const float* pData) { return { vld1q_f32(pData) }; }
+		static SimdFloat Set(float value) { return { vdupq_n_f32(value) }; }
+		void Store(float* pData) const { vst1q_f32(pData, value); }
+
+		friend SimdFloat operator+(SimdFloat a, SimdFloat b) { return { vaddq_f32(a.value, b.value) }; }
+		friend SimdFloat operator-(SimdFloat a, SimdFloat b) { return { vsubq_f32(a.value, b.value) }; }
+		friend SimdFloat operator*(SimdFloat a, SimdFloat b) { return { vmulq_f32(a.value, b.value) }; }
+		friend SimdFloat operator/(SimdFloat a, SimdFloat b) { return { vdivq_f32(a.value, b.value) }; }
+
+		static SimdFloat Min(SimdFloat a, SimdFloat b) { return { vminq_f32(a.value, b.value) }; }
+		static SimdFloat Max(SimdFloat a, SimdFloat b) { return { vmaxq_f32(a.value, b.value) }; }
+		static SimdFloat Round(SimdFloat a) { return { vrndnq_f32(a.value) }; }
+		// The NEON estimate has 8 bits, one step brings it level with the x64 ones
+		static SimdFloat RSqrtEstimate(SimdFloat a)
+		{
+			const float32x4_t estimate{ vrsqrteq_f32(a.value) };
+			return { vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a.value, estimate), estimate)) };
+		}
+		static SimdFloat Less(SimdFloat a, SimdFloat b) { return { vreinterpretq_f32_u32(vcltq_f32(a.value, b.value)) }; }
+		static SimdFloat Select(SimdFloat mask, SimdFloat ifTrue, SimdFloat ifFalse)
+		{
+			return { vbslq_f32(vreinterpretq_u32_f32(mask.value), ifTrue.value, ifFalse.value) };
+		}
+		static SimdFloat Pow2(SimdFloat n)
+		{
+			return { vreinterpretq_f32_s32(vcvtnq_s32_f32(vmulq_f32(vaddq_f32(n.value, vdupq_n_f32(127.f)), vdupq_n_f32(8388608.f)))) };
+		}
+		static SimdFloat SplitExponent(SimdFloat a, SimdFloat& exponent)
+		{
+			const uint32x4_t bits{ vreinterpretq_u32_f32(a.value) };
+			const float32x4_t exponentBits{ vcvtq_f32_u32(vandq_u32(bits, vdupq_n_u32(0x7F800000))) };
+			exponent = { vsubq_f32(vmulq_f32(exponentBits, vdupq_n_f32(1.f / 8388608.f)), vdupq_n_f32(127.f)) };
+			return { vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007FFFFF)), vdupq_n_u32(0x3F800000))) };
+		}
+#endif
+	};
+#endif
+}
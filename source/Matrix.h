@@ -1,65 +1,434 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <span>
+#include <type_traits>
+#include "MathBackend.h"
+#include "FastMath.h"
 #include "Vector3.h"
 #include "Vector4.h"
+#include "MathHelpers.h"
+#include "Quaternion.h"
 
 namespace dae {
 	struct Matrix
 	{
 		Matrix() = default;
-		Matrix(
+		constexpr Matrix(
 			const Vector3& xAxis,
 			const Vector3& yAxis,
 			const Vector3& zAxis,
-			const Vector3& t);
+			const Vector3& t) :
+			Matrix({ xAxis, 0 }, { yAxis, 0 }, { zAxis, 0 }, { t, 1 })
+		{
+		}
 
-		Matrix(
+		constexpr Matrix(
 			const Vector4& xAxis,
 			const Vector4& yAxis,
 			const Vector4& zAxis,
-			const Vector4& t);
-
-		Matrix(const Matrix& m);
-
-		Vector3 TransformVector(const Vector3& v) const;
-		Vector3 TransformVector(float x, float y, float z) const;
-		Vector3 TransformPoint(const Vector3& p) const;
-		Vector3 TransformPoint(float x, float y, float z) const;
-
-		Vector4 TransformPoint(const Vector4& p) const;
-		Vector4 TransformPoint(float x, float y, float z, float w) const;
-
-		const Matrix& Transpose();
-		const Matrix& Inverse();
-
-		Vector3 GetAxisX() const;
-		Vector3 GetAxisY() const;
-		Vector3 GetAxisZ() const;
-		Vector3 GetTranslation() const;
-
-		static Matrix CreateTranslation(float x, float y, float z);
-		static Matrix CreateTranslation(const Vector3& t);
-		static Matrix CreateRotationX(float pitch);
-		static Matrix CreateRotationY(float yaw);
-		static Matrix CreateRotationZ(float roll);
-		static Matrix CreateRotation(float pitch, float yaw, float roll);
-		static Matrix CreateRotation(const Vector3& r);
-		static Matrix CreateScale(float sx, float sy, float sz);
-		static Matrix CreateScale(const Vector3& s);
-		static Matrix Transpose(const Matrix& m);
-		static Matrix Inverse(const Matrix& m);
-
-		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up);
-		static Matrix CreatePerspectiveFovLH(float fovy, float aspect, float zn, float zf);
-
-		Vector4& operator[](int index);
-		Vector4 operator[](int index) const;
-		Matrix operator*(const Matrix& m) const;
-		const Matrix& operator*=(const Matrix& m);
+			const Vector4& t) :
+			data{ xAxis, yAxis, zAxis, t }
+		{
+		}
+
+		constexpr Matrix(const Matrix& m) = default;
+		constexpr Matrix& operator=(const Matrix& m) = default;
+
+		constexpr Vector3 TransformVector(const Vector3& v) const
+		{
+			return TransformVector(v.x, v.y, v.z);
+		}
+
+		constexpr Vector3 TransformVector(float x, float y, float z) const
+		{
+			return Vector3{
+				data[0].x * x + data[1].x * y + data[2].x * z,
+				data[0].y * x + data[1].y * y + data[2].y * z,
+				data[0].z * x + data[1].z * y + data[2].z * z
+			};
+		}
+
+		constexpr Vector3 TransformPoint(const Vector3& p) const
+		{
+			return TransformPoint(p.x, p.y, p.z);
+		}
+
+		constexpr Vector3 TransformPoint(float x, float y, float z) const
+		{
+			return Vector3{
+				data[0].x * x + data[1].x * y + data[2].x * z + data[3].x,
+				data[0].y * x + data[1].y * y + data[2].y * z + data[3].y,
+				data[0].z * x + data[1].z * y + data[2].z * z + data[3].z,
+			};
+		}
+
+		constexpr Vector4 TransformPoint(const Vector4& p) const
+		{
+			return TransformPoint(p.x, p.y, p.z, p.w);
+		}
+
+		constexpr Vector4 TransformPoint(float x, float y, float z, float w) const
+		{
+#ifdef DAE_MATH_SIMD
+			if (!std::is_constant_evaluated())
+				return TransformSimd(x, y, z);
+#endif
+			return Vector4{
+				data[0].x * x + data[1].x * y + data[2].x * z + data[3].x,
+				data[0].y * x + data[1].y * y + data[2].y * z + data[3].y,
+				data[0].z * x + data[1].z * y + data[2].z * z + data[3].z,
+				data[0].w * x + data[1].w * y + data[2].w * z + data[3].w
+			};
+		}
+
+		// Bulk forms, the same results as one TransformPoint/TransformVector per element. The result needs at least as many
+		// elements as the input and may be the input itself
+		void TransformPoints(std::span<const Vector3> points, std::span<Vector3> result) const;
+		void TransformVectors(std::span<const Vector3> vectors, std::span<Vector3> result) const;
+		// Homogeneous, w = 1 going in. divideByW divides xyz by w and keeps w, for perspective-correct interpolation
+		void TransformPoints(std::span<const Vector3> points, std::span<Vector4> result, bool divideByW = false) const;
+		// Interleaved with any stride in bytes, e.g. the positions of a vertex buffer: (&vertices[0].position, sizeof(Vertex), ...)
+		void TransformPoints(const Vector3* pPoints, size_t pointStride, Vector3* pResult, size_t resultStride, size_t count) const;
+		void TransformVectors(const Vector3* pVectors, size_t vectorStride, Vector3* pResult, size_t resultStride, size_t count) const;
+		// Separate x/y/z arrays, the layout the SIMD kernels work in. Interleaved input gains nothing from a
+		// conversion to it, the inlined per-element transform keeps up with the loads and stores
+		void TransformPoints(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+			std::span<float> resultX, std::span<float> resultY, std::span<float> resultZ) const;
+		void TransformVectors(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+			std::span<float> resultX, std::span<float> resultY, std::span<float> resultZ) const;
+
+		constexpr const Matrix& Transpose()
+		{
+			*this = Transpose(*this);
+			return *this;
+		}
+
+		constexpr const Matrix& Inverse()
+		{
+#if defined(DAE_MATH_SSE)
+			if (!std::is_constant_evaluated())
+			{
+				InverseSse();
+				return *this;
+			}
+#endif
+			//Optimized Inverse as explained in FGED1 - used widely in other libraries too.
+			const Vector3 a = data[0];
+			const Vector3 b = data[1];
+			const Vector3 c = data[2];
+			const Vector3 d = data[3];
+
+			const float x = data[0][3];
+			const float y = data[1][3];
+			const float z = data[2][3];
+			const float w = data[3][3];
+
+			Vector3 s = Vector3::Cross(a, b);
+			Vector3 t = Vector3::Cross(c, d);
+			Vector3 u = a * y - b * x;
+			Vector3 v = c * w - d * z;
+
+			const float det = Vector3::Dot(s, v) + Vector3::Dot(t, u);
+			assert((!AreEqual(det, 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+			const float invDet = 1.f / det;
+
+			s *= invDet; t *= invDet; u *= invDet; v *= invDet;
+
+			const Vector3 r0 = Vector3::Cross(b, v) + t * y;
+			const Vector3 r1 = Vector3::Cross(v, a) - t * x;
+			const Vector3 r2 = Vector3::Cross(d, u) + s * w;
+			const Vector3 r3 = Vector3::Cross(u, c) - s * z;
+
+			data[0] = Vector4{ r0.x, r1.x, r2.x, r3.x };
+			data[1] = Vector4{ r0.y, r1.y, r2.y, r3.y };
+			data[2] = Vector4{ r0.z, r1.z, r2.z, r3.z };
+			data[3] = { -Vector3::Dot(b, t),Vector3::Dot(a, t),-Vector3::Dot(d, s),Vector3::Dot(c, s) };
+
+			return *this;
+		}
+
+		// Inverse of a matrix whose last column is (0, 0, 0, 1), e.g. any scale, rotation and translation:
+		// the inverted 3x3 followed by the translation moved back through it
+		const Matrix& InverseAffine()
+		{
+			assert(IsAffine() && "ERROR: InverseAffine on a matrix that isn't affine!");
+			const Vector3 a = data[0];
+			const Vector3 b = data[1];
+			const Vector3 c = data[2];
+			const Vector3 t = data[3];
+
+			const Vector3 bc = Vector3::Cross(b, c);
+			const float det = Vector3::Dot(a, bc);
+			assert((!AreEqual(det, 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+			const float invDet = 1.f / det;
+
+			const Vector3 r0 = bc * invDet;
+			const Vector3 r1 = Vector3::Cross(c, a) * invDet;
+			const Vector3 r2 = Vector3::Cross(a, b) * invDet;
+
+			data[0] = Vector4{ r0.x, r1.x, r2.x, 0.f };
+			data[1] = Vector4{ r0.y, r1.y, r2.y, 0.f };
+			data[2] = Vector4{ r0.z, r1.z, r2.z, 0.f };
+			data[3] = Vector4{ -Vector3::Dot(t, r0), -Vector3::Dot(t, r1), -Vector3::Dot(t, r2), 1.f };
+
+			return *this;
+		}
+
+		// Inverse of rotation and translation only, the 3x3 is orthonormal so its inverse is its transpose
+		const Matrix& InverseRigid()
+		{
+			assert(IsRigid() && "ERROR: InverseRigid on a matrix that isn't a rotation and translation!");
+			const Vector3 a = data[0];
+			const Vector3 b = data[1];
+			const Vector3 c = data[2];
+			const Vector3 t = data[3];
+
+			data[0] = Vector4{ a.x, b.x, c.x, 0.f };
+			data[1] = Vector4{ a.y, b.y, c.y, 0.f };
+			data[2] = Vector4{ a.z, b.z, c.z, 0.f };
+			data[3] = Vector4{ -Vector3::Dot(t, a), -Vector3::Dot(t, b), -Vector3::Dot(t, c), 1.f };
+
+			return *this;
+		}
+
+		// Last column is (0, 0, 0, 1), nothing projective
+		bool IsAffine(float epsilon = 1e-5f) const
+		{
+			return AreEqual(data[0].w, 0.f, epsilon) && AreEqual(data[1].w, 0.f, epsilon) && AreEqual(data[2].w, 0.f, epsilon)
+				&& AreEqual(data[3].w, 1.f, epsilon);
+		}
+
+		// Affine with unit length, perpendicular axes: no scale or shear, mirroring is allowed
+		bool IsRigid(float epsilon = 1e-4f) const
+		{
+			const Vector3 a = data[0];
+			const Vector3 b = data[1];
+			const Vector3 c = data[2];
+			return IsAffine(epsilon)
+				&& AreEqual(a.SqrMagnitude(), 1.f, epsilon) && AreEqual(b.SqrMagnitude(), 1.f, epsilon) && AreEqual(c.SqrMagnitude(), 1.f, epsilon)
+				&& AreEqual(Vector3::Dot(a, b), 0.f, epsilon) && AreEqual(Vector3::Dot(b, c), 0.f, epsilon) && AreEqual(Vector3::Dot(c, a), 0.f, epsilon);
+		}
+
+		constexpr Vector3 GetAxisX() const
+		{
+			return data[0];
+		}
+
+		constexpr Vector3 GetAxisY() const
+		{
+			return data[1];
+		}
+
+		constexpr Vector3 GetAxisZ() const
+		{
+			return data[2];
+		}
+
+		constexpr Vector3 GetTranslation() const
+		{
+			return data[3];
+		}
+
+		static constexpr Matrix CreateTranslation(float x, float y, float z)
+		{
+			return CreateTranslation({ x, y, z });
+		}
+
+		static constexpr Matrix CreateTranslation(const Vector3& t)
+		{
+			return { Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, t };
+		}
+
+		static constexpr Matrix CreateRotationX(float pitch)
+		{
+			float sin{}, cos{};
+			FastMath::SinCos(pitch, sin, cos);
+			return {
+				{1, 0, 0, 0},
+				{0, cos, -sin, 0},
+				{0, sin, cos, 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotationY(float yaw)
+		{
+			float sin{}, cos{};
+			FastMath::SinCos(yaw, sin, cos);
+			return {
+				{cos, 0, -sin, 0},
+				{0, 1, 0, 0},
+				{sin, 0, cos, 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotationZ(float roll)
+		{
+			float sin{}, cos{};
+			FastMath::SinCos(roll, sin, cos);
+			return {
+				{cos, sin, 0, 0},
+				{-sin, cos, 0, 0},
+				{0, 0, 1, 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotation(float pitch, float yaw, float roll)
+		{
+			return CreateRotation({ pitch, yaw, roll });
+		}
+
+		static constexpr Matrix CreateRotation(const Vector3& r)
+		{
+			return CreateRotationX(r[0]) * CreateRotationY(r[1]) * CreateRotationZ(r[2]);
+		}
+
+		// q is expected to be unit length
+		static constexpr Matrix CreateRotation(const Quaternion& q)
+		{
+			const float xx{ q.x * q.x }, yy{ q.y * q.y }, zz{ q.z * q.z };
+			const float xy{ q.x * q.y }, xz{ q.x * q.z }, yz{ q.y * q.z };
+			const float wx{ q.w * q.x }, wy{ q.w * q.y }, wz{ q.w * q.z };
+			return {
+				{ 1.f - 2.f * (yy + zz), 2.f * (xy + wz), 2.f * (xz - wy) },
+				{ 2.f * (xy - wz), 1.f - 2.f * (xx + zz), 2.f * (yz + wx) },
+				{ 2.f * (xz + wy), 2.f * (yz - wx), 1.f - 2.f * (xx + yy) },
+				Vector3::Zero
+			};
+		}
+
+		static constexpr Matrix CreateScale(float sx, float sy, float sz)
+		{
+			return { {sx, 0, 0}, {0, sy, 0}, {0, 0, sz}, Vector3::Zero };
+		}
+
+		static constexpr Matrix CreateScale(const Vector3& s)
+		{
+			return CreateScale(s[0], s[1], s[2]);
+		}
+
+		static constexpr Matrix Transpose(const Matrix& m)
+		{
+#ifdef DAE_MATH_SIMD
+			if (!std::is_constant_evaluated())
+				return TransposeSimd(m);
+#endif
+			return {
+				{ m.data[0].x, m.data[1].x, m.data[2].x, m.data[3].x },
+				{ m.data[0].y, m.data[1].y, m.data[2].y, m.data[3].y },
+				{ m.data[0].z, m.data[1].z, m.data[2].z, m.data[3].z },
+				{ m.data[0].w, m.data[1].w, m.data[2].w, m.data[3].w }
+			};
+		}
+
+		static constexpr Matrix Inverse(const Matrix& m)
+		{
+			Matrix out{ m };
+			out.Inverse();
+
+			return out;
+		}
+
+		static Matrix InverseAffine(const Matrix& m)
+		{
+			Matrix out{ m };
+			out.InverseAffine();
+
+			return out;
+		}
+
+		static Matrix InverseRigid(const Matrix& m)
+		{
+			Matrix out{ m };
+			out.InverseRigid();
+
+			return out;
+		}
+
+		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up)
+		{
+			assert(false && "Not Implemented");
+			return {};
+		}
+
+		static constexpr Matrix CreatePerspectiveFovLH(float fov, float aspect, float zn, float zf)
+		{
+			return
+			{
+				{ 1.0f / (aspect * fov), 0.0f, 0.0f, 0.0f },
+				{ 0.0f, 1.0f / fov, 0.0f, 0.0f },
+				{ 0.0f, 0.0f, zf / (zf - zn), 1.0f},
+				{ 0.0f, 0.0f, -(zf * zn) / (zf - zn), 0.0f }
+			};
+		}
+
+		#pragma region Operator Overloads
+		constexpr Vector4& operator[](int index)
+		{
+			assert(index <= 3 && index >= 0);
+			return data[index];
+		}
+
+		constexpr Vector4 operator[](int index) const
+		{
+			assert(index <= 3 && index >= 0);
+			return data[index];
+		}
+
+		// Row r of the result is row r of this matrix transforming m, written out so the compiler keeps it in registers
+		constexpr Matrix operator*(const Matrix& m) const
+		{
+#ifdef DAE_MATH_SIMD
+			if (!std::is_constant_evaluated())
+				return MultiplySimd(*this, m);
+#endif
+			Matrix result{};
+			for (int r{ 0 }; r < 4; ++r)
+			{
+				const Vector4& row{ data[r] };
+				result.data[r] = {
+					row.x * m.data[0].x + row.y * m.data[1].x + row.z * m.data[2].x + row.w * m.data[3].x,
+					row.x * m.data[0].y + row.y * m.data[1].y + row.z * m.data[2].y + row.w * m.data[3].y,
+					row.x * m.data[0].z + row.y * m.data[1].z + row.z * m.data[2].z + row.w * m.data[3].z,
+					row.x * m.data[0].w + row.y * m.data[1].w + row.z * m.data[2].w + row.w * m.data[3].w
+				};
+			}
+
+			return result;
+		}
+
+		constexpr const Matrix& operator*=(const Matrix& m)
+		{
+			*this = *this * m;
+			return *this;
+		}
+		#pragma endregion
 
 	private:
+		// One expression for SIMD lanes (T = SimdFloat) and single elements (T = float), in the order TransformPoint evaluates
+		template<bool isPoint, bool hasW, bool divideByW, typename T>
+		static void TransformElement(const T(&m)[4][4], T x, T y, T z, T& resultX, T& resultY, T& resultZ, T& resultW);
+		template<bool isPoint, bool hasW, bool divideByW>
+		void TransformBatch(const float* pX, const float* pY, const float* pZ, float* pResultX, float* pResultY, float* pResultZ, float* pResultW,
+			size_t count) const;
+		template<bool isPoint, bool hasW, bool divideByW, typename Result>
+		void TransformInterleaved(const char* pInput, size_t inputStride, Result* pResult, size_t resultStride, size_t count) const;
 
-		//Row-Major Matrix
-		Vector4 data[4]
+#ifdef DAE_MATH_SIMD
+		static Matrix MultiplySimd(const Matrix& a, const Matrix& b);
+		static Matrix TransposeSimd(const Matrix& m);
+		Vector4 TransformSimd(float x, float y, float z) const;
+#endif
+#ifdef DAE_MATH_SSE
+		void InverseSse();
+#endif
+
+		//Row-Major Matrix, every row one aligned 128-bit register
+		alignas(16) Vector4 data[4]
 		{
 			{1,0,0,0}, //xAxis
 			{0,1,0,0}, //yAxis
@@ -72,4 +441,307 @@ namespace dae {
 		// v2x v2y v2z v2w
 		// v3x v3y v3z v3w
 	};
+
+#pragma region SIMD Backend
+	// Same multiplies and additions as the scalar code, in the same order, so the results are bit-identical
+#if defined(DAE_MATH_SSE)
+	inline Matrix Matrix::MultiplySimd(const Matrix& a, const Matrix& b)
+	{
+		Matrix result;
+#if defined(DAE_MATH_AVX)
+		// Two rows of the result per iteration, b's rows repeated in both halves
+		const __m256 b0{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&b.data[0])) };
+		const __m256 b1{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&b.data[1])) };
+		const __m256 b2{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&b.data[2])) };
+		const __m256 b3{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&b.data[3])) };
+		for (int r{ 0 }; r < 4; r += 2)
+		{
+			const __m256 rows{ _mm256_loadu_ps(&a.data[r].x) };
+			const __m256 sum{ _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(_mm256_permute_ps(rows, 0x00), b0), _mm256_mul_ps(_mm256_permute_ps(rows, 0x55), b1)),
+				_mm256_mul_ps(_mm256_permute_ps(rows, 0xAA), b2)), _mm256_mul_ps(_mm256_permute_ps(rows, 0xFF), b3)) };
+			_mm256_storeu_ps(&result.data[r].x, sum);
+		}
+#else
+		const __m128 b0{ _mm_load_ps(&b.data[0].x) };
+		const __m128 b1{ _mm_load_ps(&b.data[1].x) };
+		const __m128 b2{ _mm_load_ps(&b.data[2].x) };
+		const __m128 b3{ _mm_load_ps(&b.data[3].x) };
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			const __m128 row{ _mm_load_ps(&a.data[r].x) };
+			const __m128 sum{ _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0), _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1)),
+				_mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2)), _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3)) };
+			_mm_store_ps(&result.data[r].x, sum);
+		}
+#endif
+		return result;
+	}
+
+	inline Matrix Matrix::TransposeSimd(const Matrix& m)
+	{
+		__m128 row0{ _mm_load_ps(&m.data[0].x) };
+		__m128 row1{ _mm_load_ps(&m.data[1].x) };
+		__m128 row2{ _mm_load_ps(&m.data[2].x) };
+		__m128 row3{ _mm_load_ps(&m.data[3].x) };
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+		Matrix result;
+		_mm_store_ps(&result.data[0].x, row0);
+		_mm_store_ps(&result.data[1].x, row1);
+		_mm_store_ps(&result.data[2].x, row2);
+		_mm_store_ps(&result.data[3].x, row3);
+		return result;
+	}
+
+	inline Vector4 Matrix::TransformSimd(float x, float y, float z) const
+	{
+		const __m128 sum{ _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_load_ps(&data[0].x), _mm_set1_ps(x)), _mm_mul_ps(_mm_load_ps(&data[1].x), _mm_set1_ps(y))),
+			_mm_mul_ps(_mm_load_ps(&data[2].x), _mm_set1_ps(z))), _mm_load_ps(&data[3].x)) };
+		Vector4 result;
+		_mm_storeu_ps(&result.x, sum);
+		return result;
+	}
+
+	inline void Matrix::InverseSse()
+	{
+		// a.yzx * b.zxy - a.zxy * b.yzx, the w lane is left over and ends up in the discarded row
+		const auto cross{ [](__m128 a, __m128 b)
+			{
+				return _mm_sub_ps(
+					_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2))),
+					_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))));
+			} };
+		// (x + y) + z, the order Vector3::Dot sums in
+		const auto dot{ [](__m128 a, __m128 b)
+			{
+				const __m128 product{ _mm_mul_ps(a, b) };
+				const __m128 sum{ _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1))) };
+				return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2))));
+			} };
+
+		//Optimized Inverse as explained in FGED1 - used widely in other libraries too.
+		const __m128 a{ _mm_load_ps(&data[0].x) };
+		const __m128 b{ _mm_load_ps(&data[1].x) };
+		const __m128 c{ _mm_load_ps(&data[2].x) };
+		const __m128 d{ _mm_load_ps(&data[3].x) };
+
+		const __m128 x{ _mm_shuffle_ps(a, a, 0xFF) };
+		const __m128 y{ _mm_shuffle_ps(b, b, 0xFF) };
+		const __m128 z{ _mm_shuffle_ps(c, c, 0xFF) };
+		const __m128 w{ _mm_shuffle_ps(d, d, 0xFF) };
+
+		__m128 s{ cross(a, b) };
+		__m128 t{ cross(c, d) };
+		__m128 u{ _mm_sub_ps(_mm_mul_ps(a, y), _mm_mul_ps(b, x)) };
+		__m128 v{ _mm_sub_ps(_mm_mul_ps(c, w), _mm_mul_ps(d, z)) };
+
+		const float det{ dot(s, v) + dot(t, u) };
+		assert((!AreEqual(det, 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+		const __m128 invDet{ _mm_set1_ps(1.f / det) };
+
+		s = _mm_mul_ps(s, invDet); t = _mm_mul_ps(t, invDet); u = _mm_mul_ps(u, invDet); v = _mm_mul_ps(v, invDet);
+
+		__m128 r0{ _mm_add_ps(cross(b, v), _mm_mul_ps(t, y)) };
+		__m128 r1{ _mm_sub_ps(cross(v, a), _mm_mul_ps(t, x)) };
+		__m128 r2{ _mm_add_ps(cross(d, u), _mm_mul_ps(s, w)) };
+		__m128 r3{ _mm_sub_ps(cross(u, c), _mm_mul_ps(s, z)) };
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		_mm_store_ps(&data[0].x, r0);
+		_mm_store_ps(&data[1].x, r1);
+		_mm_store_ps(&data[2].x, r2);
+		data[3] = { -dot(b, t), dot(a, t), -dot(d, s), dot(c, s) };
+	}
+#elif defined(DAE_MATH_NEON)
+	inline Matrix Matrix::MultiplySimd(const Matrix& a, const Matrix& b)
+	{
+		const float32x4_t b0{ vld1q_f32(&b.data[0].x) };
+		const float32x4_t b1{ vld1q_f32(&b.data[1].x) };
+		const float32x4_t b2{ vld1q_f32(&b.data[2].x) };
+		const float32x4_t b3{ vld1q_f32(&b.data[3].x) };
+
+		Matrix result;
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			// Separate multiplies and adds, a fused multiply-add would round differently from the scalar code
+			const float32x4_t row{ vld1q_f32(&a.data[r].x) };
+			const float32x4_t sum{ vaddq_f32(vaddq_f32(vaddq_f32(
+				vmulq_laneq_f32(b0, row, 0), vmulq_laneq_f32(b1, row, 1)), vmulq_laneq_f32(b2, row, 2)), vmulq_laneq_f32(b3, row, 3)) };
+			vst1q_f32(&result.data[r].x, sum);
+		}
+		return result;
+	}
+
+	inline Matrix Matrix::TransposeSimd(const Matrix& m)
+	{
+		// De-interleaving load, every register ends up holding a column
+		const float32x4x4_t columns{ vld4q_f32(&m.data[0].x) };
+
+		Matrix result;
+		vst1q_f32(&result.data[0].x, columns.val[0]);
+		vst1q_f32(&result.data[1].x, columns.val[1]);
+		vst1q_f32(&result.data[2].x, columns.val[2]);
+		vst1q_f32(&result.data[3].x, columns.val[3]);
+		return result;
+	}
+
+	inline Vector4 Matrix::TransformSimd(float x, float y, float z) const
+	{
+		const float32x4_t sum{ vaddq_f32(vaddq_f32(vaddq_f32(
+			vmulq_n_f32(vld1q_f32(&data[0].x), x), vmulq_n_f32(vld1q_f32(&data[1].x), y)),
+			vmulq_n_f32(vld1q_f32(&data[2].x), z)), vld1q_f32(&data[3].x)) };
+		Vector4 result;
+		vst1q_f32(&result.x, sum);
+		return result;
+	}
+#endif
+#pragma endregion
+
+#pragma region Batch Transforms
+	template<bool isPoint, bool hasW, bool divideByW, typename T>
+	inline void Matrix::TransformElement(const T(&m)[4][4], T x, T y, T z, T& resultX, T& resultY, T& resultZ, T& resultW)
+	{
+		resultX = x * m[0][0] + y * m[1][0] + z * m[2][0];
+		resultY = x * m[0][1] + y * m[1][1] + z * m[2][1];
+		resultZ = x * m[0][2] + y * m[1][2] + z * m[2][2];
+		if constexpr (isPoint)
+		{
+			resultX = resultX + m[3][0];
+			resultY = resultY + m[3][1];
+			resultZ = resultZ + m[3][2];
+		}
+		if constexpr (hasW)
+		{
+			resultW = x * m[0][3] + y * m[1][3] + z * m[2][3] + m[3][3];
+			if constexpr (divideByW)
+			{
+				resultX = resultX / resultW;
+				resultY = resultY / resultW;
+				resultZ = resultZ / resultW;
+			}
+		}
+	}
+
+	template<bool isPoint, bool hasW, bool divideByW>
+	inline void Matrix::TransformBatch(const float* pX, const float* pY, const float* pZ, float* pResultX, float* pResultY, float* pResultZ, float* pResultW,
+		size_t count) const
+	{
+		size_t i{};
+#ifdef DAE_MATH_SIMD
+		SimdFloat lanes[4][4];
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			for (int c{ 0 }; c < 4; ++c)
+			{
+				lanes[r][c] = SimdFloat::Set(data[r][c]);
+			}
+		}
+		for (; i + SimdFloat::width <= count; i += SimdFloat::width)
+		{
+			SimdFloat resultX, resultY, resultZ, resultW;
+			TransformElement<isPoint, hasW, divideByW>(lanes, SimdFloat::Load(pX + i), SimdFloat::Load(pY + i), SimdFloat::Load(pZ + i),
+				resultX, resultY, resultZ, resultW);
+			resultX.Store(pResultX + i);
+			resultY.Store(pResultY + i);
+			resultZ.Store(pResultZ + i);
+			if constexpr (hasW)
+				resultW.Store(pResultW + i);
+		}
+#endif
+
+		// Tail, or everything without SIMD
+		float elements[4][4];
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			for (int c{ 0 }; c < 4; ++c)
+			{
+				elements[r][c] = data[r][c];
+			}
+		}
+		for (; i < count; ++i)
+		{
+			float resultX, resultY, resultZ, resultW;
+			TransformElement<isPoint, hasW, divideByW>(elements, pX[i], pY[i], pZ[i], resultX, resultY, resultZ, resultW);
+			pResultX[i] = resultX;
+			pResultY[i] = resultY;
+			pResultZ[i] = resultZ;
+			if constexpr (hasW)
+				pResultW[i] = resultW;
+		}
+	}
+
+	template<bool isPoint, bool hasW, bool divideByW, typename Result>
+	inline void Matrix::TransformInterleaved(const char* pInput, size_t inputStride, Result* pResult, size_t resultStride, size_t count) const
+	{
+		// Local copy, stores through pResult could alias *this and would reload the matrix every element
+		const Matrix matrix{ *this };
+		char* pOutput{ reinterpret_cast<char*>(pResult) };
+		for (size_t i{}; i < count; ++i)
+		{
+			// Read before written, so the result may overlap the input
+			const Vector3 element{ *reinterpret_cast<const Vector3*>(pInput + i * inputStride) };
+			Result& result{ *reinterpret_cast<Result*>(pOutput + i * resultStride) };
+			if constexpr (hasW)
+			{
+				const Vector4 point{ matrix.TransformPoint(element.x, element.y, element.z, 1.f) };
+				if constexpr (divideByW)
+					result = { point.x / point.w, point.y / point.w, point.z / point.w, point.w };
+				else
+					result = point;
+			}
+			else if constexpr (isPoint)
+				result = matrix.TransformPoint(element);
+			else
+				result = matrix.TransformVector(element);
+		}
+	}
+
+	inline void Matrix::TransformPoints(std::span<const Vector3> points, std::span<Vector3> result) const
+	{
+		assert(result.size() >= points.size());
+		TransformInterleaved<true, false, false>(reinterpret_cast<const char*>(points.data()), sizeof(Vector3), result.data(), sizeof(Vector3), points.size());
+	}
+
+	inline void Matrix::TransformVectors(std::span<const Vector3> vectors, std::span<Vector3> result) const
+	{
+		assert(result.size() >= vectors.size());
+		TransformInterleaved<false, false, false>(reinterpret_cast<const char*>(vectors.data()), sizeof(Vector3), result.data(), sizeof(Vector3), vectors.size());
+	}
+
+	inline void Matrix::TransformPoints(std::span<const Vector3> points, std::span<Vector4> result, bool divideByW) const
+	{
+		assert(result.size() >= points.size());
+		if (divideByW)
+			TransformInterleaved<true, true, true>(reinterpret_cast<const char*>(points.data()), sizeof(Vector3), result.data(), sizeof(Vector4), points.size());
+		else
+			TransformInterleaved<true, true, false>(reinterpret_cast<const char*>(points.data()), sizeof(Vector3), result.data(), sizeof(Vector4), points.size());
+	}
+
+	inline void Matrix::TransformPoints(const Vector3* pPoints, size_t pointStride, Vector3* pResult, size_t resultStride, size_t count) const
+	{
+		TransformInterleaved<true, false, false>(reinterpret_cast<const char*>(pPoints), pointStride, pResult, resultStride, count);
+	}
+
+	inline void Matrix::TransformVectors(const Vector3* pVectors, size_t vectorStride, Vector3* pResult, size_t resultStride, size_t count) const
+	{
+		TransformInterleaved<false, false, false>(reinterpret_cast<const char*>(pVectors), vectorStride, pResult, resultStride, count);
+	}
+
+	inline void Matrix::TransformPoints(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+		std::span<float> resultX, std::span<float> resultY, std::span<float> resultZ) const
+	{
+		assert(y.size() == x.size() && z.size() == x.size() && resultX.size() >= x.size() && resultY.size() >= x.size() && resultZ.size() >= x.size());
+		TransformBatch<true, false, false>(x.data(), y.data(), z.data(), resultX.data(), resultY.data(), resultZ.data(), nullptr, x.size());
+	}
+
+	inline void Matrix::TransformVectors(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+		std::span<float> resultX, std::span<float> resultY, std::span<float> resultZ) const
+	{
+		assert(y.size() == x.size() && z.size() == x.size() && resultX.size() >= x.size() && resultY.size() >= x.size() && resultZ.size() >= x.size());
+		TransformBatch<false, false, false>(x.data(), y.data(), z.data(), resultX.data(), resultY.data(), resultZ.data(), nullptr, x.size());
+	}
+#pragma endregion
 }
\ No newline at end of file
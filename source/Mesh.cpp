@@ -2,89 +2,26 @@
 #include "Mesh.h"
 #include "Texture.h"
 #include "HelperFuncts.h"
-#include "Utils.h"
+
+#include <cassert>
 
 namespace dae
 {
-	Mesh::Mesh(ID3D11Device* pDevice, const std::string& objFilePath, std::unique_ptr<Effect> pEffect)
-		:m_pEffect{ std::move(pEffect) }
+	Mesh::Mesh(ID3D11Device* pDevice, std::shared_ptr<MeshGeometry> pGeometry, std::shared_ptr<Effect> pEffect, const Material& material)
+		: m_pGeometry{ std::move(pGeometry) }
+		, m_pEffect{ std::move(pEffect) }
+		, m_Material{ material }
 	{
-		std::vector<Vertex> vertices;
-		std::vector<uint32_t> indices;
-		if (!Utils::ParseOBJ(objFilePath, vertices, indices))
-		{
-			std::cout << "Invalid filepath!\n";
-		}
-
-		// Create Vertex Layout
-		static constexpr uint32_t numElements{ 4 };
-		D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
-
-		vertexDesc[0].SemanticName = "POSITION";
-		vertexDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		vertexDesc[0].AlignedByteOffset = 0;
-		vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-		vertexDesc[1].SemanticName = "TEXCOORD";
-		vertexDesc[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-		vertexDesc[1].AlignedByteOffset = 12;
-		vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-		vertexDesc[2].SemanticName = "NORMAL";
-		vertexDesc[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		vertexDesc[2].AlignedByteOffset = 20;
-		vertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+		assert(m_pGeometry->GetVertexFormat() == m_pEffect->GetVertexFormat() && "ERROR: geometry and effect disagree on the vertex format!");
+		if (FAILED(CreateInputLayout(pDevice))) return;
 
-		vertexDesc[3].SemanticName = "TANGENT";
-		vertexDesc[3].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-		vertexDesc[3].AlignedByteOffset = 32;
-		vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-		// Create Input Layout
-		D3DX11_PASS_DESC passDesc{};
-		m_pEffect->GetTechnique()->GetPassByIndex(0)->GetDesc(&passDesc);
-
-		HRESULT result{ pDevice->CreateInputLayout
-			(
-				vertexDesc,
-				numElements,
-				passDesc.pIAInputSignature,
-				passDesc.IAInputSignatureSize,
-				&m_pInputLayout
-			) };
-		if (FAILED(result)) return;
-
-		// Create vertex buffer
-		D3D11_BUFFER_DESC bd{};
-		bd.Usage = D3D11_USAGE_IMMUTABLE;
-		bd.ByteWidth = sizeof(Vertex) * static_cast<uint32_t>(vertices.size());
-		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		bd.CPUAccessFlags = 0;
-		bd.MiscFlags = 0;
-
-		D3D11_SUBRESOURCE_DATA initData{};
-		initData.pSysMem = vertices.data();
-
-		result = pDevice->CreateBuffer(&bd, &initData, &m_pVertexBuffer);
-		if (FAILED(result)) return;
-
-		// Create index buffer
-		m_NumIndices = static_cast<uint32_t>(indices.size());
-		bd.Usage = D3D11_USAGE_IMMUTABLE;
-		bd.ByteWidth = sizeof(uint32_t) * m_NumIndices;
-		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		bd.CPUAccessFlags = 0;
-		bd.MiscFlags = 0;
-		initData.pSysMem = indices.data();
-
-		result = pDevice->CreateBuffer(&bd, &initData, &m_pIndexBuffer);
-		if (FAILED(result)) return;
+		const std::vector<MeshProcessing::LevelOfDetail>& levelsOfDetail{ m_pGeometry->GetLevelsOfDetail() };
+		if (!levelsOfDetail.empty())
+			m_DrawRanges = { { levelsOfDetail[0].firstIndex, levelsOfDetail[0].numIndices } };
 	}
 
 	Mesh::~Mesh()
 	{
-		SAFE_RELEASE(m_pIndexBuffer);
-		SAFE_RELEASE(m_pVertexBuffer);
 		SAFE_RELEASE(m_pInputLayout);
 	}
 
@@ -97,43 +34,140 @@ namespace dae
 		pDeviceContext->IASetInputLayout(m_pInputLayout);
 
 		// 3. Set vertex buffer
-		constexpr UINT stride{ sizeof(Vertex) };
+		ID3D11Buffer* pVertexBuffer{ m_pGeometry->GetVertexBuffer() };
+		const UINT stride{ GetVertexStride(m_pGeometry->GetVertexFormat()) };
 		constexpr UINT offset{};
-		pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
+		pDeviceContext->IASetVertexBuffers(0, 1, &pVertexBuffer, &stride, &offset);
 
 		// 4. Set index buffer
-		pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+		pDeviceContext->IASetIndexBuffer(m_pGeometry->GetIndexBuffer(), DXGI_FORMAT_R32_UINT, 0);
 
-		// 5. Draw
+		// 5. Set what belongs to this instance, other instances set their own on the shared effect
+		m_pEffect->SetWorldViewProjectionMatrix(m_WorldViewProjectionMatrix);
+		m_pEffect->SetWorldMatrix(GetWorldMatrix());
+		m_pEffect->SetInverseViewMatrix(m_InverseViewMatrix);
+		m_pEffect->SetMaterial(m_Material);
+
+		// 6. Draw
+		ID3DX11EffectTechnique* pTechnique{ m_pEffect->GetTechnique(m_FilteringMethod) };
 		D3DX11_TECHNIQUE_DESC techniqueDesc{};
-		m_pEffect->GetTechnique()->GetDesc(&techniqueDesc);
+		pTechnique->GetDesc(&techniqueDesc);
 		for (UINT p{}; p < techniqueDesc.Passes; ++p)
 		{
-			m_pEffect->GetTechnique()->GetPassByIndex(p)->Apply(0, pDeviceContext);
-			pDeviceContext->DrawIndexed(m_NumIndices, 0, 0);
+			pTechnique->GetPassByIndex(p)->Apply(0, pDeviceContext);
+			for (const IndexRange& range : m_DrawRanges)
+			{
+				pDeviceContext->DrawIndexed(range.numIndices, range.firstIndex, 0);
+			}
 		}
 	}
 	void Mesh::RotateX(float angle)
 	{
-		m_RotationMatrix = Matrix::CreateRotationX(angle) * m_RotationMatrix;
+		m_Transform.Rotate(Quaternion::CreateRotationX(angle));
 	}
 	void Mesh::RotateY(float angle)
 	{
-		m_RotationMatrix = Matrix::CreateRotationY(angle) * m_RotationMatrix;
+		m_Transform.Rotate(Quaternion::CreateRotationY(angle));
 	}
 	void Mesh::RotateZ(float angle)
 	{
-		m_RotationMatrix = Matrix::CreateRotationZ(angle) * m_RotationMatrix;
+		m_Transform.Rotate(Quaternion::CreateRotationZ(angle));
+	}
+	Transform& Mesh::GetTransform()
+	{
+		return m_Transform;
 	}
 	void Mesh::UpdateViewMatrices(const Matrix& viewProjectionMatrix, const Matrix& inverseViewMatrix)
 	{
-		Matrix world{ m_ScaleMatrix * m_RotationMatrix * m_TranslationMatrix };
-		m_pEffect->SetWorldViewProjectionMatrix(world * viewProjectionMatrix);
-		m_pEffect->SetInverseViewMatrix(inverseViewMatrix);
-		m_pEffect->SetWorldMatrix(world);
+		const Matrix& world{ GetWorldMatrix() };
+		m_WorldViewProjectionMatrix = m_pGeometry->GetDequantizationMatrix() * world * viewProjectionMatrix;
+		m_InverseViewMatrix = inverseViewMatrix;
+
+		const MeshletCuller* pMeshletCuller{ m_pGeometry->GetMeshletCuller() };
+		const std::vector<MeshProcessing::LevelOfDetail>& levelsOfDetail{ m_pGeometry->GetLevelsOfDetail() };
+		if (m_LevelOfDetail == 0 && pMeshletCuller)
+		{
+			// Cull in object space, where the meshlet bounds live. Double-sided materials show the faces the cones would reject
+			const Vector3 objectSpaceCamera{ Matrix::Transpose(m_Transform.GetInverseTransposeWorldMatrix()).TransformPoint(inverseViewMatrix.GetTranslation()) };
+			m_MeshletCullStats = pMeshletCuller->Cull(world * viewProjectionMatrix, objectSpaceCamera, m_DrawRanges, m_pEffect->IsBackFaceCulled());
+		}
+		else if (m_LevelOfDetail < levelsOfDetail.size())
+		{
+			// Meshlets only cover level 0, coarser levels are drawn whole
+			const MeshProcessing::LevelOfDetail& level{ levelsOfDetail[m_LevelOfDetail] };
+			m_DrawRanges = { { level.firstIndex, level.numIndices } };
+			m_MeshletCullStats = {};
+		}
+	}
+	void Mesh::SelectLevelOfDetail(const Vector3& cameraPosition, float fov, float viewportHeight, float maxPixelError)
+	{
+		const Matrix& world{ GetWorldMatrix() };
+		const float scale{ std::max({ world.GetAxisX().Magnitude(), world.GetAxisY().Magnitude(), world.GetAxisZ().Magnitude() }) };
+		// Closest point of the bounding sphere
+		const BoundingVolume bounds{ TransformBoundingVolume(m_pGeometry->GetBounds(), world) };
+		const float distance{ (bounds.center - cameraPosition).Magnitude() - bounds.radius };
+		m_LevelOfDetail = MeshProcessing::SelectLevelOfDetail(m_pGeometry->GetLevelsOfDetail(), distance, scale, fov, viewportHeight, maxPixelError);
+	}
+	uint32_t Mesh::GetLevelOfDetail() const
+	{
+		return m_LevelOfDetail;
+	}
+	BoundingVolume Mesh::GetWorldBoundingVolume() const
+	{
+		return TransformBoundingVolume(m_pGeometry->GetBounds(), GetWorldMatrix());
+	}
+	const MeshletCullStats& Mesh::GetMeshletCullStats() const
+	{
+		return m_MeshletCullStats;
 	}
 	void Mesh::CycleFilteringMethods()
 	{
-		m_pEffect->CycleFilteringMethods();
+		m_FilteringMethod = static_cast<Effect::FilteringMethod>((static_cast<int>(m_FilteringMethod) + 1) % (static_cast<int>(Effect::FilteringMethod::END)));
+
+		std::cout << "[FILTERINGMETHOD] ";
+		switch (m_FilteringMethod)
+		{
+		case Effect::FilteringMethod::Point:
+			std::cout << "Point\n";
+			break;
+		case Effect::FilteringMethod::Linear:
+			std::cout << "Linear\n";
+			break;
+		case Effect::FilteringMethod::Anisotropic:
+			std::cout << "Anisotropic\n";
+			break;
+		}
+	}
+	const std::shared_ptr<MeshGeometry>& Mesh::GetGeometry() const
+	{
+		return m_pGeometry;
+	}
+	const std::shared_ptr<Effect>& Mesh::GetEffect() const
+	{
+		return m_pEffect;
+	}
+
+	HRESULT Mesh::CreateInputLayout(ID3D11Device* pDevice)
+	{
+		// Create Vertex Layout
+		const std::vector<D3D11_INPUT_ELEMENT_DESC> vertexDesc{ GetInputElements(m_pGeometry->GetVertexFormat()) };
+
+		// Create Input Layout
+		D3DX11_PASS_DESC passDesc{};
+		m_pEffect->GetTechnique()->GetPassByIndex(0)->GetDesc(&passDesc);
+
+		return pDevice->CreateInputLayout
+			(
+				vertexDesc.data(),
+				static_cast<UINT>(vertexDesc.size()),
+				passDesc.pIAInputSignature,
+				passDesc.IAInputSignatureSize,
+				&m_pInputLayout
+			);
+	}
+
+	const Matrix& Mesh::GetWorldMatrix() const
+	{
+		return m_Transform.GetWorldMatrix();
 	}
 }
\ No newline at end of file
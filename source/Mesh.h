@@ -1,46 +1,76 @@
 #pragma once
-#include "ShadedEffect.h"
+#include "Effect.h"
+#include "MeshGeometry.h"
 #include "DataTypes.h"
+#include "MeshletCulling.h"
+#include "FrustumCulling.h"
+#include "Transform.h"
 
 namespace dae
 {
-	class Texture;
-
+	// One placement of a MeshGeometry. The geometry, the effect and the maps of the material are shared with every other
+	// instance that uses them, only the transform, level of detail, cull results and filtering method are its own
 	class Mesh final
 	{
 	public:
-		Mesh(ID3D11Device* pDevice, const std::string& objFilePath, std::unique_ptr<Effect> pEffect);
+		// The geometry has to be created for the vertex format of the effect
+		Mesh(ID3D11Device* pDevice, std::shared_ptr<MeshGeometry> pGeometry, std::shared_ptr<Effect> pEffect, const Material& material = {});
 		Mesh(const Mesh& other) = delete;
 		Mesh& operator=(const Mesh& other) = delete;
 		Mesh(Mesh&& other) = delete;
 		Mesh& operator=(Mesh&& other) = delete;
 		~Mesh();
 
+		// Sets the matrices and maps of this instance on the shared effect before drawing
 		void Render(ID3D11DeviceContext* pDeviceContext) const;
 
 		void RotateX(float angle);
 		void RotateY(float angle);
 		void RotateZ(float angle);
 
+		// For updating the world matrices of many meshes at once, see Transform::UpdateWorldMatrices
+		Transform& GetTransform();
+
+		// Picks the coarsest level whose simplification error stays under maxPixelError on screen, fov being tan(fovAngle / 2)
+		// Takes effect at the next UpdateViewMatrices
+		void SelectLevelOfDetail(const Vector3& cameraPosition, float fov, float viewportHeight, float maxPixelError = 1.f);
+		uint32_t GetLevelOfDetail() const;
+
+		// Follows the current scale, rotation and translation
+		BoundingVolume GetWorldBoundingVolume() const;
+
+		// Also culls the meshlets for the next Render when level 0 is selected
 		void UpdateViewMatrices(const Matrix& viewProjectionMatrix, const Matrix& inverseViewMatrix);
 
-		// Returns new filtering method
+		const MeshletCullStats& GetMeshletCullStats() const;
+
+		// Point, linear, anisotropic, for this instance only
 		void CycleFilteringMethods();
 
+		const std::shared_ptr<MeshGeometry>& GetGeometry() const;
+		const std::shared_ptr<Effect>& GetEffect() const;
+
 	private:
-		std::unique_ptr<Effect> m_pEffect{};
+		HRESULT CreateInputLayout(ID3D11Device* pDevice);
+		const Matrix& GetWorldMatrix() const;
 
-		ID3D11InputLayout* m_pInputLayout{};
+		std::shared_ptr<MeshGeometry> m_pGeometry{};
+		std::shared_ptr<Effect> m_pEffect{};
+		Material m_Material{};
+		Effect::FilteringMethod m_FilteringMethod{ Effect::FilteringMethod::Point };
 
-		ID3D11Buffer* m_pVertexBuffer{};
+		ID3D11InputLayout* m_pInputLayout{};
 
-		uint32_t m_NumIndices{};
-		ID3D11Buffer* m_pIndexBuffer{};
+		// What survived the last cull, the whole of level 0 until then
+		std::vector<IndexRange> m_DrawRanges{};
+		MeshletCullStats m_MeshletCullStats{};
+		uint32_t m_LevelOfDetail{};
 
 		// WorldOrientation
-		Matrix m_TranslationMatrix{ Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, Vector3::Zero };
-		Matrix m_RotationMatrix{ Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, Vector3::Zero };
-		Matrix m_ScaleMatrix{ Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, Vector3::Zero };
+		Transform m_Transform{};
+		// Kept from UpdateViewMatrices, the shared effect only gets them right before this instance draws
+		Matrix m_WorldViewProjectionMatrix{};
+		Matrix m_InverseViewMatrix{};
 	};
 }
 
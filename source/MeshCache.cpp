@@ -0,0 +1,323 @@
+#include "pch.h"
+#include "MeshCache.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+
+namespace dae
+{
+	namespace
+	{
+		inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		void WritePadding(std::ofstream& file, uint64_t alignment)
+		{
+			static constexpr char zeros[MeshCache::sectionAlignment]{};
+			const uint64_t position{ static_cast<uint64_t>(file.tellp()) };
+			file.write(zeros, static_cast<std::streamsize>(AlignUp(position, alignment) - position));
+		}
+
+		float GetSqrBoundsRadius(const Vertex* pVertices, size_t numVertices, const Vector3& center, float sqrRadius)
+		{
+			for (size_t i{}; i < numVertices; ++i)
+			{
+				sqrRadius = std::max(sqrRadius, (pVertices[i].position - center).SqrMagnitude());
+			}
+			return sqrRadius;
+		}
+
+		// Import time only, a cached load uploads what this wrote
+		void PackVertices(const Vertex* pVertices, size_t numVertices, const VertexPacking::QuantizationBounds& bounds, std::vector<PackedVertex>& packedVertices)
+		{
+			packedVertices.resize(numVertices);
+			VertexPacking::Pack(pVertices, numVertices, bounds, packedVertices.data());
+
+#ifdef _DEBUG
+			const VertexPacking::PackingError error{ VertexPacking::MeasureError(pVertices, packedVertices.data(), numVertices, bounds) };
+			assert(VertexPacking::IsWithinBounds(error, VertexPacking::GetErrorBounds(pVertices, numVertices, bounds)) && "Vertex packing error out of bounds!");
+#endif
+		}
+	}
+
+	namespace MeshCache
+	{
+		VertexFormat GetVertexFormat(uint32_t flags)
+		{
+			return (flags & PackedVertices) != 0 ? VertexFormat::Packed : VertexFormat::Full;
+		}
+
+		std::string GetCachePath(const std::string& sourcePath)
+		{
+			const size_t extension{ sourcePath.find_last_of('.') };
+			const size_t directory{ sourcePath.find_last_of("/\\") };
+			if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+				return sourcePath + ".dmesh";
+			return sourcePath.substr(0, extension) + ".dmesh";
+		}
+
+		bool Write(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t flags,
+			const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshProcessing::Meshlet>& meshlets,
+			const std::vector<MeshProcessing::LevelOfDetail>& levelsOfDetail)
+		{
+			std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+			if (!file)
+				return false;
+
+			const VertexFormat vertexFormat{ GetVertexFormat(flags) };
+			Header header{};
+			header.magic = magic;
+			header.version = version;
+			header.flags = flags;
+			header.vertexStride = GetVertexStride(vertexFormat);
+			header.sourceHash = sourceHash;
+			header.sourceSize = sourceSize;
+			header.numVertices = static_cast<uint32_t>(vertices.size());
+			header.numIndices = static_cast<uint32_t>(indices.size());
+			header.vertexOffset = AlignUp(sizeof(Header), sectionAlignment);
+			header.indexOffset = AlignUp(header.vertexOffset + uint64_t{ header.vertexStride } * vertices.size(), sectionAlignment);
+			header.numMeshlets = static_cast<uint32_t>(meshlets.size());
+			header.meshletStride = sizeof(MeshProcessing::Meshlet);
+			header.meshletOffset = AlignUp(header.indexOffset + sizeof(uint32_t) * indices.size(), sectionAlignment);
+			header.numLevelsOfDetail = static_cast<uint32_t>(levelsOfDetail.size());
+			header.levelOfDetailStride = sizeof(MeshProcessing::LevelOfDetail);
+			header.levelOfDetailOffset = AlignUp(header.meshletOffset + sizeof(MeshProcessing::Meshlet) * meshlets.size(), sectionAlignment);
+
+			if (!vertices.empty())
+			{
+				header.boundsMin = vertices[0].position;
+				header.boundsMax = vertices[0].position;
+				for (const Vertex& vertex : vertices)
+				{
+					header.boundsMin = { std::min(header.boundsMin.x, vertex.position.x), std::min(header.boundsMin.y, vertex.position.y), std::min(header.boundsMin.z, vertex.position.z) };
+					header.boundsMax = { std::max(header.boundsMax.x, vertex.position.x), std::max(header.boundsMax.y, vertex.position.y), std::max(header.boundsMax.z, vertex.position.z) };
+				}
+			}
+			header.boundsRadius = std::sqrt(GetSqrBoundsRadius(vertices.data(), vertices.size(), (header.boundsMin + header.boundsMax) * 0.5f, 0.f));
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			WritePadding(file, sectionAlignment);
+			if (vertexFormat == VertexFormat::Packed)
+			{
+				std::vector<PackedVertex> packedVertices;
+				PackVertices(vertices.data(), vertices.size(), VertexPacking::ComputeBounds(header.boundsMin, header.boundsMax), packedVertices);
+				file.write(reinterpret_cast<const char*>(packedVertices.data()), static_cast<std::streamsize>(sizeof(PackedVertex) * packedVertices.size()));
+			}
+			else
+			{
+				file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(sizeof(Vertex) * vertices.size()));
+			}
+			WritePadding(file, sectionAlignment);
+			file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(sizeof(uint32_t) * indices.size()));
+			WritePadding(file, sectionAlignment);
+			file.write(reinterpret_cast<const char*>(meshlets.data()), static_cast<std::streamsize>(sizeof(MeshProcessing::Meshlet) * meshlets.size()));
+			WritePadding(file, sectionAlignment);
+			file.write(reinterpret_cast<const char*>(levelsOfDetail.data()), static_cast<std::streamsize>(sizeof(MeshProcessing::LevelOfDetail) * levelsOfDetail.size()));
+
+			return static_cast<bool>(file);
+		}
+
+		const Header* Validate(const MappedFile& file, uint64_t sourceHash, uint64_t sourceSize, uint32_t flags)
+		{
+			if (!file.IsValid() || file.GetSize() < sizeof(Header))
+				return nullptr;
+
+			const Header* pHeader{ reinterpret_cast<const Header*>(file.GetData()) };
+			if (pHeader->magic != magic || pHeader->version != version || pHeader->vertexStride != GetVertexStride(GetVertexFormat(flags))
+				|| pHeader->meshletStride != sizeof(MeshProcessing::Meshlet) || pHeader->levelOfDetailStride != sizeof(MeshProcessing::LevelOfDetail))
+				return nullptr;
+
+			// Stale
+			if (pHeader->sourceHash != sourceHash || pHeader->sourceSize != sourceSize || pHeader->flags != flags)
+				return nullptr;
+
+			// Truncated or damaged. Sizes are checked against what is left after the offset, so a huge offset can't wrap around
+			const uint64_t fileSize{ file.GetSize() };
+			const auto isInFile{ [fileSize](uint64_t offset, uint64_t size) { return offset <= fileSize && size <= fileSize - offset; } };
+			const uint64_t vertexSize{ uint64_t{ pHeader->vertexStride } * pHeader->numVertices };
+			const uint64_t indexSize{ uint64_t{ sizeof(uint32_t) } * pHeader->numIndices };
+			const uint64_t meshletSize{ uint64_t{ sizeof(MeshProcessing::Meshlet) } * pHeader->numMeshlets };
+			const uint64_t levelOfDetailSize{ uint64_t{ sizeof(MeshProcessing::LevelOfDetail) } * pHeader->numLevelsOfDetail };
+			if (!isInFile(pHeader->vertexOffset, vertexSize) || !isInFile(pHeader->indexOffset, indexSize) || !isInFile(pHeader->meshletOffset, meshletSize)
+				|| !isInFile(pHeader->levelOfDetailOffset, levelOfDetailSize))
+				return nullptr;
+			if (pHeader->vertexOffset % sectionAlignment != 0 || pHeader->indexOffset % sectionAlignment != 0 || pHeader->meshletOffset % sectionAlignment != 0
+				|| pHeader->levelOfDetailOffset % sectionAlignment != 0 || pHeader->vertexOffset < sizeof(Header) || pHeader->indexOffset < pHeader->vertexOffset + vertexSize
+				|| pHeader->meshletOffset < pHeader->indexOffset + indexSize || pHeader->levelOfDetailOffset < pHeader->meshletOffset + meshletSize)
+				return nullptr;
+
+			// Level 0 at least, every level inside the index buffer
+			if (pHeader->numLevelsOfDetail == 0)
+				return nullptr;
+			const MeshProcessing::LevelOfDetail* pLevels{ GetLevelsOfDetail(*pHeader) };
+			for (uint32_t i{}; i < pHeader->numLevelsOfDetail; ++i)
+			{
+				if (uint64_t{ pLevels[i].firstIndex } + pLevels[i].numIndices > pHeader->numIndices)
+					return nullptr;
+			}
+
+			// Every meshlet inside the index buffer, with no more vertices than it has corners or the mesh has
+			const MeshProcessing::Meshlet* pMeshlets{ GetMeshlets(*pHeader) };
+			for (uint32_t i{}; i < pHeader->numMeshlets; ++i)
+			{
+				const MeshProcessing::Meshlet& meshlet{ pMeshlets[i] };
+				if (uint64_t{ meshlet.firstIndex } + meshlet.numIndices > pHeader->numIndices || meshlet.numIndices % 3 != 0
+					|| meshlet.numVertices > meshlet.numIndices || meshlet.numVertices > pHeader->numVertices)
+					return nullptr;
+			}
+
+			// Every index inside the vertex buffer, meshlet building and the upload take them as they are
+			const uint32_t* pIndices{ GetIndices(*pHeader) };
+			uint32_t maxIndex{};
+			for (uint32_t i{}; i < pHeader->numIndices; ++i)
+				maxIndex = std::max(maxIndex, pIndices[i]);
+			if (pHeader->numIndices > 0 && maxIndex >= pHeader->numVertices)
+				return nullptr;
+
+			return pHeader;
+		}
+
+		Writer::Writer(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t flags)
+			: m_VertexPath{ path + ".vertices" }
+			, m_IndexPath{ path + ".indices" }
+			, m_File{ path, std::ios::binary | std::ios::trunc }
+			, m_VertexFile{ m_VertexPath, std::ios::binary | std::ios::trunc }
+			, m_IndexFile{ m_IndexPath, std::ios::binary | std::ios::trunc }
+		{
+			m_Header.version = version;
+			m_Header.flags = flags;
+			m_Header.vertexStride = GetVertexStride(GetVertexFormat(flags));
+			m_Header.sourceHash = sourceHash;
+			m_Header.sourceSize = sourceSize;
+			m_Header.vertexOffset = AlignUp(sizeof(Header), sectionAlignment);
+			m_Header.meshletStride = sizeof(MeshProcessing::Meshlet);
+			m_Header.levelOfDetailStride = sizeof(MeshProcessing::LevelOfDetail);
+
+			// Placeholder, the magic stays zero until Finish
+			const Header emptyHeader{};
+			m_File.write(reinterpret_cast<const char*>(&emptyHeader), sizeof(Header));
+			WritePadding(m_File, sectionAlignment);
+		}
+
+		Writer::~Writer()
+		{
+			m_VertexFile.close();
+			m_IndexFile.close();
+			std::remove(m_VertexPath.c_str());
+			std::remove(m_IndexPath.c_str());
+		}
+
+		bool Writer::IsValid() const
+		{
+			return m_File.good() && m_VertexFile.good() && m_IndexFile.good();
+		}
+
+		bool Writer::Append(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+		{
+			if (!IsValid() || uint64_t{ m_Header.numVertices } + vertices.size() > UINT32_MAX || uint64_t{ m_Header.numIndices } + indices.size() > UINT32_MAX)
+				return false;
+
+			if (m_Header.numVertices == 0 && !vertices.empty())
+			{
+				m_Header.boundsMin = vertices[0].position;
+				m_Header.boundsMax = vertices[0].position;
+			}
+			for (const Vertex& vertex : vertices)
+			{
+				m_Header.boundsMin = { std::min(m_Header.boundsMin.x, vertex.position.x), std::min(m_Header.boundsMin.y, vertex.position.y), std::min(m_Header.boundsMin.z, vertex.position.z) };
+				m_Header.boundsMax = { std::max(m_Header.boundsMax.x, vertex.position.x), std::max(m_Header.boundsMax.y, vertex.position.y), std::max(m_Header.boundsMax.z, vertex.position.z) };
+			}
+
+			m_VertexFile.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(sizeof(Vertex) * vertices.size()));
+			m_IndexFile.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(sizeof(uint32_t) * indices.size()));
+			m_Header.numVertices += static_cast<uint32_t>(vertices.size());
+			m_Header.numIndices += static_cast<uint32_t>(indices.size());
+			return IsValid();
+		}
+
+		bool Writer::Finish()
+		{
+			m_VertexFile.close();
+			m_IndexFile.close();
+			if (!m_File || !m_VertexFile || !m_IndexFile)
+				return false;
+
+			// Vertex section, copied over in blocks now that the bounds are known
+			{
+				const VertexPacking::QuantizationBounds bounds{ VertexPacking::ComputeBounds(m_Header.boundsMin, m_Header.boundsMax) };
+				const Vector3 center{ (m_Header.boundsMin + m_Header.boundsMax) * 0.5f };
+				float sqrRadius{};
+
+				std::ifstream vertexFile{ m_VertexPath, std::ios::binary };
+				std::vector<Vertex> block(64 * 1024);
+				std::vector<PackedVertex> packedBlock;
+				while (vertexFile.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(sizeof(Vertex) * block.size())) || vertexFile.gcount() > 0)
+				{
+					const size_t numVertices{ static_cast<size_t>(vertexFile.gcount()) / sizeof(Vertex) };
+					sqrRadius = GetSqrBoundsRadius(block.data(), numVertices, center, sqrRadius);
+					if (GetVertexFormat(m_Header.flags) == VertexFormat::Packed)
+					{
+						PackVertices(block.data(), numVertices, bounds, packedBlock);
+						m_File.write(reinterpret_cast<const char*>(packedBlock.data()), static_cast<std::streamsize>(sizeof(PackedVertex) * numVertices));
+					}
+					else
+					{
+						m_File.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(sizeof(Vertex) * numVertices));
+					}
+				}
+				m_Header.boundsRadius = std::sqrt(sqrRadius);
+			}
+
+			// Index section, copied over in blocks
+			WritePadding(m_File, sectionAlignment);
+			m_Header.indexOffset = static_cast<uint64_t>(m_File.tellp());
+			{
+				std::ifstream indexFile{ m_IndexPath, std::ios::binary };
+				std::vector<char> block(1024 * 1024);
+				while (indexFile.read(block.data(), static_cast<std::streamsize>(block.size())) || indexFile.gcount() > 0)
+				{
+					m_File.write(block.data(), indexFile.gcount());
+				}
+			}
+
+			// No meshlets, level 0 is the whole index buffer
+			WritePadding(m_File, sectionAlignment);
+			m_Header.meshletOffset = static_cast<uint64_t>(m_File.tellp());
+			m_Header.levelOfDetailOffset = m_Header.meshletOffset;
+			m_Header.numLevelsOfDetail = 1;
+			const MeshProcessing::LevelOfDetail level{ 0, m_Header.numIndices, 0.f };
+			m_File.write(reinterpret_cast<const char*>(&level), sizeof(level));
+
+			m_Header.magic = magic;
+			m_File.seekp(0);
+			m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(Header));
+			m_File.close();
+			return static_cast<bool>(m_File);
+		}
+
+		const void* GetVertexData(const Header& header)
+		{
+			return reinterpret_cast<const char*>(&header) + header.vertexOffset;
+		}
+
+		const uint32_t* GetIndices(const Header& header)
+		{
+			return reinterpret_cast<const uint32_t*>(reinterpret_cast<const char*>(&header) + header.indexOffset);
+		}
+
+		const MeshProcessing::Meshlet* GetMeshlets(const Header& header)
+		{
+			return reinterpret_cast<const MeshProcessing::Meshlet*>(reinterpret_cast<const char*>(&header) + header.meshletOffset);
+		}
+
+		const MeshProcessing::LevelOfDetail* GetLevelsOfDetail(const Header& header)
+		{
+			return reinterpret_cast<const MeshProcessing::LevelOfDetail*>(reinterpret_cast<const char*>(&header) + header.levelOfDetailOffset);
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include "DataTypes.h"
+#include "MeshProcessing.h"
+#include "VertexFormat.h"
+
+namespace dae
+{
+	class MappedFile;
+
+	// .dmesh: binary copy of the ParseOBJ output in the vertex format it is drawn with, sections are laid out so they can be uploaded
+	// straight from the mapping
+	namespace MeshCache
+	{
+		constexpr uint32_t magic{ 0x48534D44 }; // "DMSH"
+		constexpr uint32_t version{ 5 };
+		constexpr uint32_t sectionAlignment{ 64 };
+
+		// Bits describing how the source was imported, a mismatch means the cache is stale
+		enum Flags : uint32_t
+		{
+			FlipAxisAndWinding = 1 << 0,
+			WeldVertices = 1 << 1,
+			OptimizeVertexCache = 1 << 2,
+			OptimizeOverdraw = 1 << 3,
+			OptimizeVertexFetch = 1 << 4,
+			BuildMeshlets = 1 << 5,
+			BuildLevelsOfDetail = 1 << 6,
+			// Written batch by batch by a Writer, none of the whole-mesh passes ran
+			Streamed = 1 << 7,
+			// The vertex section holds PackedVertex quantized against the bounds in the header, Vertex otherwise
+			PackedVertices = 1 << 8
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t flags;
+			uint32_t vertexStride;
+
+			uint64_t sourceHash;
+			uint64_t sourceSize;
+
+			uint32_t numVertices;
+			uint32_t numIndices;
+			uint64_t vertexOffset;
+			uint64_t indexOffset;
+
+			uint32_t numMeshlets;
+			uint32_t meshletStride;
+			uint64_t meshletOffset;
+
+			uint32_t numLevelsOfDetail;
+			uint32_t levelOfDetailStride;
+			uint64_t levelOfDetailOffset;
+
+			// Object space, also the quantization bounds of packed vertices
+			Vector3 boundsMin;
+			Vector3 boundsMax;
+			// Of the sphere around the box center
+			float boundsRadius;
+		};
+
+		VertexFormat GetVertexFormat(uint32_t flags);
+
+		// Resources/vehicle.obj => Resources/vehicle.dmesh
+		std::string GetCachePath(const std::string& sourcePath);
+
+		// Packs the vertices on the way when the flags ask for PackedVertices
+		bool Write(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t flags,
+			const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshProcessing::Meshlet>& meshlets,
+			const std::vector<MeshProcessing::LevelOfDetail>& levelsOfDetail);
+
+		// Streams a cache batch by batch: vertices and indices go into side files that Finish appends, packing the vertices once the
+		// bounds are known. The result has no meshlets and level 0 only. Until Finish succeeds the header is zeroed, so Validate rejects the file
+		class Writer final
+		{
+		public:
+			Writer(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t flags);
+			~Writer();
+
+			Writer(const Writer& other) = delete;
+			Writer& operator=(const Writer& other) = delete;
+			Writer(Writer&& other) = delete;
+			Writer& operator=(Writer&& other) = delete;
+
+			bool IsValid() const;
+			// Indices refer to the vertices of every batch so far, like Utils::StreamOBJ hands them out
+			bool Append(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+			bool Finish();
+
+		private:
+			std::string m_VertexPath;
+			std::string m_IndexPath;
+			std::ofstream m_File;
+			std::ofstream m_VertexFile;
+			std::ofstream m_IndexFile;
+			Header m_Header{};
+		};
+
+		// Returns the header at the start of the mapping if it is a complete, current cache of the source, nullptr otherwise
+		const Header* Validate(const MappedFile& file, uint64_t sourceHash, uint64_t sourceSize, uint32_t flags);
+
+		// Point into the mapping, only valid while the MappedFile is alive
+		// Vertex or PackedVertex, by GetVertexFormat(header.flags)
+		const void* GetVertexData(const Header& header);
+		const uint32_t* GetIndices(const Header& header);
+		const MeshProcessing::Meshlet* GetMeshlets(const Header& header);
+		const MeshProcessing::LevelOfDetail* GetLevelsOfDetail(const Header& header);
+	}
+}
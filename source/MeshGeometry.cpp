@@ -0,0 +1,342 @@
+#include "pch.h"
+#include "MeshGeometry.h"
+#include "HelperFuncts.h"
+#include "Utils.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "MeshProcessing.h"
+#include "Gltf.h"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+
+namespace dae
+{
+	namespace
+	{
+		// Post-transform cache that the index order gets tuned and measured for
+		constexpr uint32_t vertexCacheSize{ 32 };
+		// Trades a little vertex reuse for less overdraw
+		constexpr bool optimizeOverdraw{ true };
+		// Triangle count of each coarser level, as a share of the full mesh
+		constexpr std::array<float, 3> levelOfDetailRatios{ 0.5f, 0.25f, 0.1f };
+		// How far simplification may move the surface, as a share of the bounding box diagonal
+		constexpr float maxSimplificationError{ 0.01f };
+		// Sources this big are streamed into the cache batch by batch instead of being parsed whole,
+		// the passes that need the whole mesh (OptimizeForRendering) are skipped for them
+		constexpr uint64_t streamedImportSize{ uint64_t{ 1 } << 30 };
+
+		// Binary glTF goes through Gltf::LoadGLB, anything else is read as OBJ
+		bool IsGlbPath(const std::string& path)
+		{
+			if (path.size() < 4)
+				return false;
+			std::string extension{ path.substr(path.size() - 4) };
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return extension == ".glb";
+		}
+
+		// Import-time passes, the result ends up in the .dmesh so this only runs when the cache is rebuilt
+		// Reorders both buffers and appends the coarser levels to the index buffer, the meshlets cover level 0
+		void OptimizeForRendering(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+			std::vector<MeshProcessing::Meshlet>& meshlets, std::vector<MeshProcessing::LevelOfDetail>& levelsOfDetail)
+		{
+			using namespace MeshProcessing;
+
+			const VertexCacheStats cacheStatsBefore{ AnalyzeVertexCache(indices, vertices.size(), vertexCacheSize) };
+			const VertexFetchStats fetchStatsBefore{ AnalyzeVertexFetch(indices, vertices.size(), sizeof(Vertex)) };
+			const OverdrawStats overdrawStatsBefore{ AnalyzeOverdraw(vertices, indices) };
+
+			OptimizeVertexCache(indices, vertices.size(), vertexCacheSize);
+			if (optimizeOverdraw)
+				OptimizeOverdraw(vertices, indices, vertexCacheSize);
+			meshlets = BuildMeshlets(vertices, indices);
+
+			const auto simplifyStartTime{ std::chrono::steady_clock::now() };
+			const float diagonal{ VertexPacking::ComputeBounds(vertices.data(), vertices.size()).extent.Magnitude() };
+			levelsOfDetail = BuildLevelsOfDetail(vertices, indices, { levelOfDetailRatios.begin(), levelOfDetailRatios.end() },
+				maxSimplificationError * diagonal, vertexCacheSize);
+			const float simplifyMilliseconds{ std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - simplifyStartTime).count() };
+
+			// Fetch order only renames vertices, it keeps the triangle order the meshlets and levels were built on
+			// Coarser levels only use vertices of level 0, so its order decides
+			OptimizeVertexFetch(vertices, indices);
+
+			const std::vector<uint32_t> finestIndices{ indices.begin(), indices.begin() + levelsOfDetail[0].numIndices };
+			const VertexCacheStats cacheStatsAfter{ AnalyzeVertexCache(finestIndices, vertices.size(), vertexCacheSize) };
+			const VertexFetchStats fetchStatsAfter{ AnalyzeVertexFetch(finestIndices, vertices.size(), sizeof(Vertex)) };
+			const OverdrawStats overdrawStatsAfter{ AnalyzeOverdraw(vertices, finestIndices) };
+
+			std::cout << "[MESH] Vertex cache (" << vertexCacheSize << " entries): ACMR " << cacheStatsBefore.acmr << " -> " << cacheStatsAfter.acmr
+				<< ", ATVR " << cacheStatsBefore.atvr << " -> " << cacheStatsAfter.atvr << "\n";
+			std::cout << "[MESH] Vertex fetch overfetch " << fetchStatsBefore.overfetch << " -> " << fetchStatsAfter.overfetch
+				<< ", overdraw " << overdrawStatsBefore.overdraw << " -> " << overdrawStatsAfter.overdraw << "\n";
+			std::cout << "[MESH] " << levelsOfDetail.size() - 1 << " coarser level(s) of detail in " << simplifyMilliseconds << " ms\n";
+			for (size_t i{ 1 }; i < levelsOfDetail.size(); ++i)
+			{
+				std::cout << "[MESH]   LOD " << i << ": " << levelsOfDetail[i].numIndices / 3 << " triangles ("
+					<< 100.f * levelsOfDetail[i].numIndices / levelsOfDetail[0].numIndices << "%), error " << levelsOfDetail[i].error << "\n";
+			}
+		}
+	}
+
+	MeshGeometry::MeshGeometry(ID3D11Device* pDevice, MeshData&& data, VertexFormat vertexFormat)
+		: m_VertexFormat{ vertexFormat }
+	{
+		assert(data.vertexFormat == vertexFormat && "ERROR: the mesh data was loaded for another vertex format!");
+
+		if (const MeshCache::Header* pHeader{ data.pCacheHeader })
+		{
+			// Upload straight from the mapped sections
+			const MeshProcessing::LevelOfDetail* pLevels{ MeshCache::GetLevelsOfDetail(*pHeader) };
+			if (FAILED(CreateBuffers(pDevice, MeshCache::GetVertexData(*pHeader), pHeader->numVertices, pHeader->boundsMin, pHeader->boundsMax,
+				pHeader->boundsRadius, MeshCache::GetIndices(*pHeader), pHeader->numIndices)))
+				return;
+			m_LevelsOfDetail.assign(pLevels, pLevels + pHeader->numLevelsOfDetail);
+		}
+		else if (!data.levelsOfDetail.empty())
+		{
+			const void* pVertexData{ vertexFormat == VertexFormat::Packed ? static_cast<const void*>(data.packedVertices.data()) : data.vertices.data() };
+			const uint32_t numVertices{ static_cast<uint32_t>(vertexFormat == VertexFormat::Packed ? data.packedVertices.size() : data.vertices.size()) };
+			if (FAILED(CreateBuffers(pDevice, pVertexData, numVertices, data.boundsMin, data.boundsMax, data.boundsRadius,
+				data.indices.data(), static_cast<uint32_t>(data.indices.size()))))
+				return;
+			m_LevelsOfDetail = std::move(data.levelsOfDetail);
+		}
+		m_pMeshletCuller = std::move(data.pMeshletCuller);
+	}
+
+	MeshGeometry::~MeshGeometry()
+	{
+		SAFE_RELEASE(m_pIndexBuffer);
+		SAFE_RELEASE(m_pVertexBuffer);
+	}
+
+	MeshData MeshGeometry::Load(const std::string& filePath, VertexFormat vertexFormat, uint32_t numThreads)
+	{
+		const auto startTime{ std::chrono::steady_clock::now() };
+		MeshData data{};
+		data.vertexFormat = vertexFormat;
+
+		Utils::ObjParseOptions parseOptions{};
+		parseOptions.numThreads = numThreads;
+		parseOptions.weldVertices = true;
+
+		// The source is only hashed, never parsed, when the cache is current
+		uint64_t sourceHash{};
+		uint64_t sourceSize{};
+		{
+			const MappedFile sourceFile{ filePath };
+			if (!sourceFile.IsValid())
+			{
+				std::cout << "Invalid filepath!\n";
+				return data;
+			}
+			sourceHash = Utils::HashBytes(sourceFile.GetData(), sourceFile.GetSize());
+			sourceSize = sourceFile.GetSize();
+		}
+
+		// GLB is indexed already, welding only applies to OBJ
+		const bool isGlb{ IsGlbPath(filePath) };
+		const bool isStreamed{ !isGlb && sourceSize >= streamedImportSize };
+		const uint32_t cacheFlags{ (parseOptions.flipAxisAndWinding ? MeshCache::FlipAxisAndWinding : 0u)
+			| (parseOptions.weldVertices && !isGlb ? MeshCache::WeldVertices : 0u)
+			| (isStreamed ? MeshCache::Streamed : MeshCache::OptimizeVertexCache | (optimizeOverdraw ? MeshCache::OptimizeOverdraw : 0u)
+				| MeshCache::OptimizeVertexFetch | MeshCache::BuildMeshlets | MeshCache::BuildLevelsOfDetail)
+			| (vertexFormat == VertexFormat::Packed ? MeshCache::PackedVertices : 0u) };
+		data.contentHash = Utils::HashBytes(&cacheFlags, sizeof(cacheFlags), sourceHash);
+
+		const std::string cachePath{ MeshCache::GetCachePath(filePath) };
+		const auto loadFromCache{ [&]()
+			{
+				data.pCacheFile = std::make_unique<MappedFile>(cachePath);
+				data.pCacheHeader = MeshCache::Validate(*data.pCacheFile, sourceHash, sourceSize, cacheFlags);
+				if (!data.pCacheHeader)
+				{
+					data.pCacheFile.reset();
+					return false;
+				}
+
+				if (data.pCacheHeader->numMeshlets > 0)
+					data.pMeshletCuller = std::make_unique<MeshletCuller>(MeshCache::GetMeshlets(*data.pCacheHeader), data.pCacheHeader->numMeshlets);
+				std::cout << "[MESH] " << cachePath << ": loaded in "
+					<< std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms\n";
+				return true;
+			} };
+
+		if (loadFromCache())
+			return data;
+
+		if (isStreamed)
+		{
+			// Missing or stale cache of a source too big to hold, stream it into the cache and upload from there
+			Utils::ObjStreamOptions streamOptions{};
+			streamOptions.flipAxisAndWinding = parseOptions.flipAxisAndWinding;
+			streamOptions.weldVertices = parseOptions.weldVertices;
+			streamOptions.numThreads = numThreads;
+
+			MeshCache::Writer writer{ cachePath, sourceHash, sourceSize, cacheFlags };
+			Utils::ObjStreamStats streamStats{};
+			const bool isImported{ writer.IsValid() && Utils::StreamOBJ(filePath, streamOptions,
+				[&writer](const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) { return writer.Append(vertices, indices); },
+				&streamStats) && writer.Finish() };
+			if (!isImported)
+			{
+				std::cout << "Invalid OBJ file!\n";
+				return data;
+			}
+			std::cout << "[MESH] " << filePath << ": streamed in " << streamStats.milliseconds << " ms (" << streamStats.numPasses << " passes, "
+				<< streamStats.GetMegabytesPerSecond() << " MB/s), " << streamStats.numTriangles << " triangles, " << streamStats.numVertices << " vertices in "
+				<< streamStats.numBatches << " batches, " << streamStats.poolBytes / (1024 * 1024) << " MB of attribute records, peak working set "
+				<< Utils::GetPeakMemoryUsage() / (1024 * 1024) << " MB\n";
+
+			if (!loadFromCache())
+				std::cout << "[MESH] Could not read back " << cachePath << "\n";
+			return data;
+		}
+
+		// Missing or stale cache, import the source and rebuild it
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		if (isGlb)
+		{
+			Gltf::GlbLoadStats loadStats{};
+			if (!Gltf::LoadGLB(filePath, vertices, indices, parseOptions.flipAxisAndWinding, &loadStats, numThreads))
+			{
+				std::cout << "Invalid GLB file!\n";
+				return data;
+			}
+			std::cout << "[MESH] " << filePath << ": " << loadStats.milliseconds << " ms, " << loadStats.numPrimitives << " primitive(s), "
+				<< loadStats.numVertices << " vertices, " << loadStats.numTriangles << " triangles, tangent frames generated for "
+				<< loadStats.generatedTangentPrimitives << " primitive(s) in " << loadStats.tangents.milliseconds << " ms, peak working set "
+				<< Utils::GetPeakMemoryUsage() / (1024 * 1024) << " MB\n";
+		}
+		else
+		{
+			Utils::ObjParseStats parseStats{};
+			if (!Utils::ParseOBJ(filePath, vertices, indices, parseOptions, &parseStats))
+			{
+				std::cout << "Invalid OBJ file!\n";
+				return data;
+			}
+			std::cout << "[MESH] " << filePath << ": " << parseStats.parseMilliseconds << " ms on " << parseStats.numThreads << " thread(s) ("
+				<< parseStats.GetMegabytesPerSecond() << " MB/s), " << parseStats.numCorners << " corners welded into "
+				<< parseStats.numVertices << " vertices (" << parseStats.GetWeldRatio() << "x) in " << parseStats.weldMilliseconds << " ms, peak working set "
+				<< Utils::GetPeakMemoryUsage() / (1024 * 1024) << " MB\n";
+			std::cout << "[MESH] Tangent frames in " << parseStats.tangents.milliseconds << " ms on " << parseStats.tangents.numThreads << " thread(s), "
+				<< parseStats.tangents.mirroredVertices << " mirrored, " << parseStats.tangents.fallbackVertices << " fallback vertices, "
+				<< parseStats.tangents.degenerateTriangles << " degenerate triangles\n";
+		}
+
+		std::vector<MeshProcessing::Meshlet> meshlets;
+		std::vector<MeshProcessing::LevelOfDetail> levelsOfDetail;
+		OptimizeForRendering(vertices, indices, meshlets, levelsOfDetail);
+
+		std::cout << "[MESH] " << meshlets.size() << " meshlets\n";
+
+		// Upload from the cache just written, the vertices are packed in there already
+		if (MeshCache::Write(cachePath, sourceHash, sourceSize, cacheFlags, vertices, indices, meshlets, levelsOfDetail) && loadFromCache())
+			return data;
+		std::cout << "[MESH] Could not write " << cachePath << ", keeping the import in memory\n";
+
+		const VertexPacking::QuantizationBounds bounds{ VertexPacking::ComputeBounds(vertices.data(), vertices.size()) };
+		data.boundsMin = bounds.min;
+		data.boundsMax = bounds.min + bounds.extent;
+		const Vector3 center{ (data.boundsMin + data.boundsMax) * 0.5f };
+		float sqrRadius{};
+		for (const Vertex& vertex : vertices)
+		{
+			sqrRadius = std::max(sqrRadius, (vertex.position - center).SqrMagnitude());
+		}
+		data.boundsRadius = std::sqrt(sqrRadius);
+
+		if (vertexFormat == VertexFormat::Packed)
+		{
+			data.packedVertices.resize(vertices.size());
+			VertexPacking::Pack(vertices.data(), vertices.size(), VertexPacking::ComputeBounds(data.boundsMin, data.boundsMax), data.packedVertices.data());
+		}
+		else
+		{
+			data.vertices = std::move(vertices);
+		}
+		data.indices = std::move(indices);
+		data.levelsOfDetail = std::move(levelsOfDetail);
+		data.pMeshletCuller = std::make_unique<MeshletCuller>(meshlets.data(), static_cast<uint32_t>(meshlets.size()));
+		std::cout << "[MESH] " << filePath << ": loaded in "
+			<< std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms\n";
+		return data;
+	}
+
+	HRESULT MeshGeometry::CreateBuffers(ID3D11Device* pDevice, const void* pVertexData, uint32_t numVertices, const Vector3& boundsMin, const Vector3& boundsMax,
+		float boundsRadius, const uint32_t* pIndices, uint32_t numIndices)
+	{
+		// Sphere around the box center, tighter than the half diagonal
+		m_Bounds.center = (boundsMin + boundsMax) * 0.5f;
+		m_Bounds.extents = (boundsMax - boundsMin) * 0.5f;
+		m_Bounds.radius = boundsRadius;
+
+		if (m_VertexFormat == VertexFormat::Packed)
+			m_DequantizationMatrix = VertexPacking::GetDequantizationMatrix(VertexPacking::ComputeBounds(boundsMin, boundsMax));
+
+		// Create vertex buffer
+		D3D11_BUFFER_DESC bd{};
+		bd.Usage = D3D11_USAGE_IMMUTABLE;
+		bd.ByteWidth = GetVertexStride(m_VertexFormat) * numVertices;
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bd.CPUAccessFlags = 0;
+		bd.MiscFlags = 0;
+
+		D3D11_SUBRESOURCE_DATA initData{};
+		initData.pSysMem = pVertexData;
+
+		HRESULT result{ pDevice->CreateBuffer(&bd, &initData, &m_pVertexBuffer) };
+		if (FAILED(result)) return result;
+
+		// Create index buffer
+		bd.Usage = D3D11_USAGE_IMMUTABLE;
+		bd.ByteWidth = sizeof(uint32_t) * numIndices;
+		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		bd.CPUAccessFlags = 0;
+		bd.MiscFlags = 0;
+		initData.pSysMem = pIndices;
+
+		result = pDevice->CreateBuffer(&bd, &initData, &m_pIndexBuffer);
+		if (FAILED(result)) return result;
+
+		m_SizeInBytes = size_t{ GetVertexStride(m_VertexFormat) } * numVertices + sizeof(uint32_t) * size_t{ numIndices };
+		return result;
+	}
+	VertexFormat MeshGeometry::GetVertexFormat() const
+	{
+		return m_VertexFormat;
+	}
+	ID3D11Buffer* MeshGeometry::GetVertexBuffer() const
+	{
+		return m_pVertexBuffer;
+	}
+	ID3D11Buffer* MeshGeometry::GetIndexBuffer() const
+	{
+		return m_pIndexBuffer;
+	}
+	const MeshletCuller* MeshGeometry::GetMeshletCuller() const
+	{
+		return m_pMeshletCuller.get();
+	}
+	const std::vector<MeshProcessing::LevelOfDetail>& MeshGeometry::GetLevelsOfDetail() const
+	{
+		return m_LevelsOfDetail;
+	}
+	const BoundingVolume& MeshGeometry::GetBounds() const
+	{
+		return m_Bounds;
+	}
+	const Matrix& MeshGeometry::GetDequantizationMatrix() const
+	{
+		return m_DequantizationMatrix;
+	}
+	size_t MeshGeometry::GetSizeInBytes() const
+	{
+		return m_SizeInBytes;
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataTypes.h"
+#include "VertexFormat.h"
+#include "MeshletCulling.h"
+#include "FrustumCulling.h"
+#include "MeshCache.h"
+#include "MappedFile.h"
+
+namespace dae
+{
+	// What MeshGeometry::Load leaves for the upload: the mapped .dmesh, or the mesh that was just imported
+	struct MeshData
+	{
+		// Keeps pCacheHeader and the sections behind it mapped
+		std::unique_ptr<MappedFile> pCacheFile;
+		const MeshCache::Header* pCacheHeader{};
+		// Imported but the .dmesh could not be written, levelsOfDetail stays empty when importing failed.
+		// Only the vertices of vertexFormat are filled in
+		std::vector<Vertex> vertices;
+		std::vector<PackedVertex> packedVertices;
+		std::vector<uint32_t> indices;
+		std::vector<MeshProcessing::LevelOfDetail> levelsOfDetail;
+		Vector3 boundsMin;
+		Vector3 boundsMax;
+		float boundsRadius{};
+		VertexFormat vertexFormat{ VertexFormat::Full };
+		// From the meshlets of either, nullptr when there are none
+		std::unique_ptr<MeshletCuller> pMeshletCuller;
+		// Of the source and the import flags, equal for equal files whatever their path
+		uint64_t contentHash{};
+	};
+
+	// The buffers, meshlets and levels of detail of one mesh file, shared by every Mesh placed from it
+	class MeshGeometry final
+	{
+	public:
+		// Creates the buffers straight from the mapping when there is one, data that failed to load leaves the geometry empty.
+		// The data has to be loaded for vertexFormat
+		MeshGeometry(ID3D11Device* pDevice, MeshData&& data, VertexFormat vertexFormat);
+		~MeshGeometry();
+
+		MeshGeometry(const MeshGeometry& other) = delete;
+		MeshGeometry& operator=(const MeshGeometry& other) = delete;
+		MeshGeometry(MeshGeometry&& other) = delete;
+		MeshGeometry& operator=(MeshGeometry&& other) = delete;
+
+		// Maps the .dmesh next to filePath when it is current, otherwise imports the source, optimizes it and writes the .dmesh.
+		// The .dmesh holds the vertices in vertexFormat, so the buffers are created from it as is. Touches no device, any thread can run it.
+		// numThreads for parsing and tangent frames, 0 picks the hardware concurrency. Pass 1 from a task of a pool that is busy already
+		static MeshData Load(const std::string& filePath, VertexFormat vertexFormat, uint32_t numThreads = 0);
+
+		VertexFormat GetVertexFormat() const;
+		ID3D11Buffer* GetVertexBuffer() const;
+		ID3D11Buffer* GetIndexBuffer() const;
+		// nullptr when the mesh has no meshlets
+		const MeshletCuller* GetMeshletCuller() const;
+		// Level 0 first, all of them ranges of the index buffer. Empty when loading failed
+		const std::vector<MeshProcessing::LevelOfDetail>& GetLevelsOfDetail() const;
+		// Object space
+		const BoundingVolume& GetBounds() const;
+		// Packed positions arrive in [0, 1], only the position transform gets this
+		const Matrix& GetDequantizationMatrix() const;
+		// Of the vertex and index buffers
+		size_t GetSizeInBytes() const;
+
+	private:
+		// Works on any memory: imported vectors or the sections of a mapped .dmesh. The vertices are in m_VertexFormat already,
+		// packed ones quantized against the bounds
+		HRESULT CreateBuffers(ID3D11Device* pDevice, const void* pVertexData, uint32_t numVertices, const Vector3& boundsMin, const Vector3& boundsMax,
+			float boundsRadius, const uint32_t* pIndices, uint32_t numIndices);
+
+		const VertexFormat m_VertexFormat;
+
+		ID3D11Buffer* m_pVertexBuffer{};
+		ID3D11Buffer* m_pIndexBuffer{};
+		size_t m_SizeInBytes{};
+
+		std::unique_ptr<MeshletCuller> m_pMeshletCuller{};
+		std::vector<MeshProcessing::LevelOfDetail> m_LevelsOfDetail{};
+		// Computed when the buffers are created
+		BoundingVolume m_Bounds{};
+		Matrix m_DequantizationMatrix{ Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, Vector3::Zero };
+	};
+}
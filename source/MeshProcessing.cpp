@@ -0,0 +1,1218 @@
+#include "pch.h"
+#include "MeshProcessing.h"
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace dae
+{
+	namespace
+	{
+		// ---- FORSYTH SCORING ----
+		// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+
+		constexpr float cacheDecayPower{ 1.5f };
+		constexpr float lastTriangleScore{ 0.75f };
+		constexpr float valenceBoostScale{ 2.0f };
+		constexpr float valenceBoostPower{ 0.5f };
+
+		constexpr uint32_t invalidIndex{ UINT32_MAX };
+
+		float ScoreVertex(int cachePosition, uint32_t remainingTriangles, uint32_t cacheSize)
+		{
+			// Nothing left to draw with it
+			if (remainingTriangles == 0)
+				return -1.f;
+
+			float score{};
+			if (cachePosition >= 0)
+			{
+				// The three vertices of the last triangle get a fixed score so they aren't reused right away
+				if (cachePosition < 3)
+					score = lastTriangleScore;
+				else
+					score = powf(1.f - static_cast<float>(cachePosition - 3) / (cacheSize - 3), cacheDecayPower);
+			}
+
+			// Favour vertices with few triangles left, so they don't get stranded
+			score += valenceBoostScale * powf(static_cast<float>(remainingTriangles), -valenceBoostPower);
+			return score;
+		}
+
+		// Simulated FIFO shared by the analysis and the overdraw clustering, Reset() empties it in O(1)
+		class FifoCacheSimulator final
+		{
+		public:
+			FifoCacheSimulator(size_t numVertices, uint32_t cacheSize)
+				: m_CacheTimestamps(numVertices, 0)
+				, m_CacheSize{ cacheSize }
+				, m_Timestamp{ cacheSize + 1 }
+			{
+			}
+
+			// Returns whether the vertex had to be transformed
+			bool Access(uint32_t index)
+			{
+				if (m_Timestamp - m_CacheTimestamps[index] > m_CacheSize)
+				{
+					m_CacheTimestamps[index] = m_Timestamp++;
+					return true;
+				}
+				return false;
+			}
+
+			void Reset()
+			{
+				m_Timestamp += m_CacheSize + 1;
+			}
+
+		private:
+			std::vector<uint32_t> m_CacheTimestamps;
+			uint32_t m_CacheSize;
+			uint32_t m_Timestamp;
+		};
+
+		// +1 when triangles wind the same way as their vertex normals (cross(p1 - p0, p2 - p0)), -1 otherwise
+		float GetWindingSign(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+		{
+			float agreement{};
+			for (size_t i{}; i + 2 < indices.size(); i += 3)
+			{
+				const Vertex& v0{ vertices[indices[i]] };
+				const Vertex& v1{ vertices[indices[i + 1]] };
+				const Vertex& v2{ vertices[indices[i + 2]] };
+				const Vector3 faceNormal{ Vector3::Cross(v1.position - v0.position, v2.position - v0.position) };
+				agreement += Vector3::Dot(faceNormal, v0.normal + v1.normal + v2.normal) >= 0.f ? 1.f : -1.f;
+			}
+			return agreement >= 0.f ? 1.f : -1.f;
+		}
+
+		// First vertex with the exact same position, for every vertex
+		std::vector<uint32_t> RemapPositions(const std::vector<Vertex>& vertices)
+		{
+			std::vector<uint32_t> positionIds(vertices.size());
+			std::unordered_map<uint64_t, uint32_t> firstVertexAt{};
+			firstVertexAt.reserve(vertices.size());
+			for (uint32_t v{}; v < vertices.size(); ++v)
+			{
+				const Vector3& position{ vertices[v].position };
+				uint64_t key{ std::bit_cast<uint32_t>(position.x) };
+				key = key * 0x9E3779B97F4A7C15ull ^ std::bit_cast<uint32_t>(position.y);
+				key = key * 0x9E3779B97F4A7C15ull ^ std::bit_cast<uint32_t>(position.z);
+				const auto [it, isNew] { firstVertexAt.try_emplace(key, v) };
+				// A hash collision only costs sharing, never correctness
+				positionIds[v] = vertices[it->second].position.x == position.x && vertices[it->second].position.y == position.y
+					&& vertices[it->second].position.z == position.z ? it->second : v;
+			}
+			return positionIds;
+		}
+
+		// Ritter's sphere: start from the most separated pair of axis extremes, grow to fit the rest
+		void ComputeBoundingSphere(const std::vector<Vector3>& points, Vector3& center, float& radius)
+		{
+			size_t minIndex[3]{};
+			size_t maxIndex[3]{};
+			for (size_t i{ 1 }; i < points.size(); ++i)
+			{
+				for (int axis{}; axis < 3; ++axis)
+				{
+					if (points[i][axis] < points[minIndex[axis]][axis]) minIndex[axis] = i;
+					if (points[i][axis] > points[maxIndex[axis]][axis]) maxIndex[axis] = i;
+				}
+			}
+
+			int widestAxis{};
+			for (int axis{ 1 }; axis < 3; ++axis)
+			{
+				if ((points[maxIndex[axis]] - points[minIndex[axis]]).SqrMagnitude() > (points[maxIndex[widestAxis]] - points[minIndex[widestAxis]]).SqrMagnitude())
+					widestAxis = axis;
+			}
+
+			const Vector3& p0{ points[minIndex[widestAxis]] };
+			const Vector3& p1{ points[maxIndex[widestAxis]] };
+			center = (p0 + p1) * 0.5f;
+			radius = (p1 - p0).Magnitude() * 0.5f;
+
+			for (const Vector3& point : points)
+			{
+				const float distance{ (point - center).Magnitude() };
+				if (distance > radius)
+				{
+					const float newRadius{ (radius + distance) * 0.5f };
+					center += (point - center) * ((newRadius - radius) / distance);
+					radius = newRadius;
+				}
+			}
+		}
+
+		// Cone around the average face normal, its apex pulled back far enough that every face plane passes in front of it
+		// (same construction as meshoptimizer's cluster bounds), no cone when a face is more than ~84 degrees off the axis
+		void ComputeNormalCone(const std::vector<Vector3>& corners, const Vector3& center, MeshProcessing::Meshlet& meshlet)
+		{
+			meshlet.coneApex = center;
+			meshlet.coneAxis = Vector3::Zero;
+			meshlet.coneCutoff = 1.f;
+
+			std::vector<Vector3> faceNormals{};
+			faceNormals.reserve(corners.size() / 3);
+			Vector3 axis{};
+			for (size_t i{}; i + 2 < corners.size(); i += 3)
+			{
+				Vector3 normal{ Vector3::Cross(corners[i + 1] - corners[i], corners[i + 2] - corners[i]) };
+				if (normal.SqrMagnitude() <= 0.f)
+				{
+					faceNormals.push_back(Vector3::Zero);
+					continue;
+				}
+				normal.Normalize();
+				faceNormals.push_back(normal);
+				axis += normal;
+			}
+			if (axis.SqrMagnitude() <= 0.f)
+				return;
+			axis.Normalize();
+
+			float minDot{ 1.f };
+			for (const Vector3& normal : faceNormals)
+			{
+				if (normal.SqrMagnitude() > 0.f)
+					minDot = std::min(minDot, Vector3::Dot(normal, axis));
+			}
+			if (minDot <= 0.1f)
+				return;
+
+			float maxDistance{};
+			for (size_t t{}; t < faceNormals.size(); ++t)
+			{
+				if (faceNormals[t].SqrMagnitude() <= 0.f)
+					continue;
+				const float distance{ Vector3::Dot(center - corners[t * 3], faceNormals[t]) / Vector3::Dot(axis, faceNormals[t]) };
+				maxDistance = std::max(maxDistance, distance);
+			}
+
+			meshlet.coneApex = center - axis * maxDistance;
+			meshlet.coneAxis = axis;
+			meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+		}
+
+		// ---- QUADRIC SIMPLIFICATION ----
+		// Garland & Heckbert, with the seam and border rules of meshoptimizer: https://github.com/zeux/meshoptimizer
+
+		// Weighted sum of squared distances to planes: p^T A p + 2 b^T p + c
+		struct Quadric
+		{
+			double a00, a11, a22, a01, a02, a12;
+			double b0, b1, b2;
+			double c;
+			double weight;
+
+			// normal is unit length, the plane holds the points with dot(normal, p) + distance == 0
+			void AddPlane(const Vector3& normal, float distance, double planeWeight)
+			{
+				a00 += planeWeight * normal.x * normal.x;
+				a11 += planeWeight * normal.y * normal.y;
+				a22 += planeWeight * normal.z * normal.z;
+				a01 += planeWeight * normal.x * normal.y;
+				a02 += planeWeight * normal.x * normal.z;
+				a12 += planeWeight * normal.y * normal.z;
+				b0 += planeWeight * normal.x * distance;
+				b1 += planeWeight * normal.y * distance;
+				b2 += planeWeight * normal.z * distance;
+				c += planeWeight * distance * distance;
+				weight += planeWeight;
+			}
+
+			Quadric& operator+=(const Quadric& other)
+			{
+				a00 += other.a00; a11 += other.a11; a22 += other.a22;
+				a01 += other.a01; a02 += other.a02; a12 += other.a12;
+				b0 += other.b0; b1 += other.b1; b2 += other.b2;
+				c += other.c;
+				weight += other.weight;
+				return *this;
+			}
+
+			// Average squared distance from p to the planes
+			double Evaluate(const Vector3& p) const
+			{
+				if (weight <= 0.0)
+					return 0.0;
+
+				const double x{ p.x }, y{ p.y }, z{ p.z };
+				const double error{ a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+					+ 2.0 * (b0 * x + b1 * y + b2 * z) + c };
+				return std::max(error, 0.0) / weight;
+			}
+		};
+
+		// Open edges keep their shape this much harder than faces
+		constexpr double boundaryWeight{ 2.0 };
+		// A level has to drop at least 10% of the triangles of the level before it
+		constexpr float minLevelReduction{ 0.9f };
+
+		// What a position may collapse into
+		enum class VertexKind : uint8_t
+		{
+			// One vertex, closed fan: anywhere
+			Manifold,
+			// One vertex on an open edge: along the border, into another border vertex
+			Border,
+			// Two vertices split by uvs or normals: along the seam, both sides at once
+			Seam,
+			// Corners, seam/border crossings, non-manifold fans
+			Locked
+		};
+
+		// The triangle around a moving corner must not turn over when that corner moves to target
+		bool FlipsTriangle(const Vector3& moving, const Vector3& b, const Vector3& c, const Vector3& target)
+		{
+			const Vector3 before{ Vector3::Cross(b - moving, c - moving) };
+			const Vector3 after{ Vector3::Cross(b - target, c - target) };
+			return Vector3::Dot(before, after) <= 0.f;
+		}
+
+		// Seam and border structure of a triangle list, per vertex
+		struct MeshTopology
+		{
+			// Circular list through the referenced vertices sharing a position
+			std::vector<uint32_t> wedges;
+			// Edges without a twin in the opposite direction: the single one, the vertex itself when there are more
+			std::vector<uint32_t> openOut;
+			std::vector<uint32_t> openIn;
+			std::vector<VertexKind> kinds;
+			// Per corner, for the edge that starts there
+			std::vector<bool> isOpenEdge;
+		};
+
+		void ClassifyVertices(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& positionIds, MeshTopology& topology)
+		{
+			const size_t numVertices{ positionIds.size() };
+			std::vector<bool> isReferenced(numVertices);
+			for (const uint32_t index : indices)
+			{
+				isReferenced[index] = true;
+			}
+
+			topology.wedges.resize(numVertices);
+			for (uint32_t v{}; v < numVertices; ++v)
+			{
+				topology.wedges[v] = v;
+				const uint32_t position{ positionIds[v] };
+				if (position != v && isReferenced[v] && isReferenced[position])
+				{
+					topology.wedges[v] = topology.wedges[position];
+					topology.wedges[position] = v;
+				}
+			}
+
+			topology.openOut.assign(numVertices, invalidIndex);
+			topology.openIn.assign(numVertices, invalidIndex);
+			topology.isOpenEdge.assign(indices.size(), false);
+			std::unordered_set<uint64_t> edges{};
+			edges.reserve(indices.size());
+			for (size_t i{}; i + 2 < indices.size(); i += 3)
+			{
+				for (size_t k{}; k < 3; ++k)
+				{
+					edges.insert(uint64_t{ indices[i + k] } << 32 | indices[i + (k + 1) % 3]);
+				}
+			}
+			for (size_t i{}; i + 2 < indices.size(); i += 3)
+			{
+				for (size_t k{}; k < 3; ++k)
+				{
+					const uint32_t from{ indices[i + k] };
+					const uint32_t to{ indices[i + (k + 1) % 3] };
+					if (edges.contains(uint64_t{ to } << 32 | from))
+						continue;
+					topology.isOpenEdge[i + k] = true;
+					topology.openOut[from] = topology.openOut[from] == invalidIndex ? to : from;
+					topology.openIn[to] = topology.openIn[to] == invalidIndex ? from : to;
+				}
+			}
+
+			const auto hasOneOpenLoop{ [&topology](uint32_t v)
+				{
+					return topology.openIn[v] != invalidIndex && topology.openIn[v] != v && topology.openOut[v] != invalidIndex && topology.openOut[v] != v;
+				} };
+			topology.kinds.assign(numVertices, VertexKind::Locked);
+			for (uint32_t v{}; v < numVertices; ++v)
+			{
+				if (!isReferenced[v] || positionIds[v] != v)
+					continue;
+
+				VertexKind kind{ VertexKind::Locked };
+				const uint32_t other{ topology.wedges[v] };
+				if (other == v)
+				{
+					if (topology.openIn[v] == invalidIndex && topology.openOut[v] == invalidIndex)
+						kind = VertexKind::Manifold;
+					else if (hasOneOpenLoop(v))
+						kind = VertexKind::Border;
+				}
+				// Both sides of the seam have to run between the same two positions
+				else if (topology.wedges[other] == v && hasOneOpenLoop(v) && hasOneOpenLoop(other)
+					&& positionIds[topology.openOut[v]] == positionIds[topology.openIn[other]]
+					&& positionIds[topology.openIn[v]] == positionIds[topology.openOut[other]])
+					kind = VertexKind::Seam;
+
+				uint32_t wedge{ v };
+				do
+				{
+					topology.kinds[wedge] = kind;
+					wedge = topology.wedges[wedge];
+				} while (wedge != v);
+			}
+		}
+
+		// Rotated so the smallest index comes first, which keeps the winding
+		std::array<uint32_t, 3> CanonicalTriangle(uint32_t index0, uint32_t index1, uint32_t index2)
+		{
+			if (index1 < index0 && index1 < index2) return { index1, index2, index0 };
+			if (index2 < index0 && index2 < index1) return { index2, index0, index1 };
+			return { index0, index1, index2 };
+		}
+	}
+
+	namespace MeshProcessing
+	{
+		VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t numVertices, uint32_t cacheSize, CacheModel model)
+		{
+			VertexCacheStats stats{};
+			if (indices.empty() || cacheSize == 0)
+				return stats;
+
+			size_t numMisses{};
+			if (model == CacheModel::FIFO)
+			{
+				// A vertex is still cached when fewer than cacheSize misses happened since it was loaded
+				FifoCacheSimulator cache{ numVertices, cacheSize };
+				for (const uint32_t index : indices)
+				{
+					if (cache.Access(index)) ++numMisses;
+				}
+			}
+			else
+			{
+				// Most recently used first
+				std::vector<uint32_t> cache{};
+				cache.reserve(cacheSize + 1);
+				for (const uint32_t index : indices)
+				{
+					const auto it{ std::find(cache.begin(), cache.end(), index) };
+					if (it != cache.end())
+					{
+						std::rotate(cache.begin(), it, it + 1);
+						continue;
+					}
+
+					++numMisses;
+					cache.insert(cache.begin(), index);
+					if (cache.size() > cacheSize) cache.pop_back();
+				}
+			}
+
+			std::vector<bool> isReferenced(numVertices);
+			size_t numReferenced{};
+			for (const uint32_t index : indices)
+			{
+				if (!isReferenced[index])
+				{
+					isReferenced[index] = true;
+					++numReferenced;
+				}
+			}
+
+			stats.acmr = static_cast<float>(numMisses) / (indices.size() / 3);
+			stats.atvr = static_cast<float>(numMisses) / numReferenced;
+			return stats;
+		}
+
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t numVertices, uint32_t cacheSize)
+		{
+			const size_t numTriangles{ indices.size() / 3 };
+			if (numTriangles < 2 || cacheSize <= 3)
+				return;
+
+#ifdef _DEBUG
+			const std::vector<uint32_t> originalIndices{ indices };
+#endif
+
+			// Vertex -> triangles that still have to be emitted (CSR, each range shrinks as triangles go out)
+			std::vector<uint32_t> remainingTriangles(numVertices);
+			for (const uint32_t index : indices)
+			{
+				++remainingTriangles[index];
+			}
+			std::vector<uint32_t> triangleOffsets(numVertices + 1);
+			for (size_t v{}; v < numVertices; ++v)
+			{
+				triangleOffsets[v + 1] = triangleOffsets[v] + remainingTriangles[v];
+			}
+			std::vector<uint32_t> adjacentTriangles(indices.size());
+			{
+				std::vector<uint32_t> writeOffsets{ triangleOffsets.begin(), triangleOffsets.end() - 1 };
+				for (size_t i{}; i < indices.size(); ++i)
+				{
+					adjacentTriangles[writeOffsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			std::vector<int> cachePositions(numVertices, -1);
+			std::vector<float> vertexScores(numVertices);
+			for (size_t v{}; v < numVertices; ++v)
+			{
+				vertexScores[v] = ScoreVertex(-1, remainingTriangles[v], cacheSize);
+			}
+
+			std::vector<float> triangleScores(numTriangles);
+			std::vector<bool> isEmitted(numTriangles);
+			uint32_t bestTriangle{};
+			for (size_t t{}; t < numTriangles; ++t)
+			{
+				triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+				if (triangleScores[t] > triangleScores[bestTriangle]) bestTriangle = static_cast<uint32_t>(t);
+			}
+
+			// Most recent first, holds 3 extra slots for the vertices that fall out after an insert
+			std::vector<uint32_t> cache{};
+			std::vector<uint32_t> newCache{};
+			cache.reserve(cacheSize + 3);
+			newCache.reserve(cacheSize + 3);
+
+			std::vector<uint32_t> output{};
+			output.reserve(indices.size());
+			size_t scanCursor{};
+
+			while (output.size() < indices.size())
+			{
+				// Dead end: nothing in the cache has triangles left, continue with the next unused one
+				if (bestTriangle == invalidIndex)
+				{
+					while (isEmitted[scanCursor]) ++scanCursor;
+					bestTriangle = static_cast<uint32_t>(scanCursor);
+				}
+
+				isEmitted[bestTriangle] = true;
+				const uint32_t* pTriangle{ &indices[size_t(bestTriangle) * 3] };
+				output.insert(output.end(), pTriangle, pTriangle + 3);
+
+				newCache.clear();
+				for (int corner{}; corner < 3; ++corner)
+				{
+					const uint32_t v{ pTriangle[corner] };
+
+					// Remove the triangle from the vertex' remaining list
+					uint32_t* pBegin{ &adjacentTriangles[triangleOffsets[v]] };
+					uint32_t* pEnd{ pBegin + remainingTriangles[v] };
+					*std::find(pBegin, pEnd, bestTriangle) = *(pEnd - 1);
+					--remainingTriangles[v];
+
+					newCache.push_back(v);
+				}
+				for (const uint32_t v : cache)
+				{
+					if (v != pTriangle[0] && v != pTriangle[1] && v != pTriangle[2])
+						newCache.push_back(v);
+				}
+				std::swap(cache, newCache);
+
+				// Rescore everything that moved, including what fell out
+				for (size_t i{}; i < cache.size(); ++i)
+				{
+					const uint32_t v{ cache[i] };
+					cachePositions[v] = i < cacheSize ? static_cast<int>(i) : -1;
+
+					const float newScore{ ScoreVertex(cachePositions[v], remainingTriangles[v], cacheSize) };
+					const float scoreDelta{ newScore - vertexScores[v] };
+					vertexScores[v] = newScore;
+
+					const uint32_t* pBegin{ &adjacentTriangles[triangleOffsets[v]] };
+					for (const uint32_t* pCurrent{ pBegin }; pCurrent < pBegin + remainingTriangles[v]; ++pCurrent)
+					{
+						triangleScores[*pCurrent] += scoreDelta;
+					}
+				}
+				if (cache.size() > cacheSize) cache.resize(cacheSize);
+
+				// Next triangle is the best one that touches the cache
+				bestTriangle = invalidIndex;
+				float bestScore{ -1.f };
+				for (const uint32_t v : cache)
+				{
+					const uint32_t* pBegin{ &adjacentTriangles[triangleOffsets[v]] };
+					for (const uint32_t* pCurrent{ pBegin }; pCurrent < pBegin + remainingTriangles[v]; ++pCurrent)
+					{
+						if (triangleScores[*pCurrent] > bestScore)
+						{
+							bestScore = triangleScores[*pCurrent];
+							bestTriangle = *pCurrent;
+						}
+					}
+				}
+			}
+
+			indices = std::move(output);
+
+#ifdef _DEBUG
+			assert(HaveSameTriangles(originalIndices, indices) && "OptimizeVertexCache changed the triangle set!");
+#endif
+		}
+
+		bool HaveSameTriangles(const std::vector<uint32_t>& indicesA, const std::vector<uint32_t>& indicesB)
+		{
+			if (indicesA.size() != indicesB.size())
+				return false;
+
+			const auto toSortedTriangles = [](const std::vector<uint32_t>& indices)
+			{
+				std::vector<std::array<uint32_t, 3>> triangles{};
+				triangles.reserve(indices.size() / 3);
+				for (size_t i{}; i + 2 < indices.size(); i += 3)
+				{
+					triangles.push_back(CanonicalTriangle(indices[i], indices[i + 1], indices[i + 2]));
+				}
+				std::sort(triangles.begin(), triangles.end());
+				return triangles;
+			};
+
+			return toSortedTriangles(indicesA) == toSortedTriangles(indicesB);
+		}
+
+		VertexFetchStats AnalyzeVertexFetch(const std::vector<uint32_t>& indices, size_t numVertices, size_t vertexSize)
+		{
+			// 16 KB worth of lines, roughly a GPU L1 / a CPU L1D
+			constexpr size_t cacheLineSize{ 64 };
+			constexpr size_t numCacheLines{ 256 };
+
+			VertexFetchStats stats{};
+			if (indices.empty() || vertexSize == 0)
+				return stats;
+
+			std::vector<size_t> cacheTags(numCacheLines, SIZE_MAX);
+			std::vector<bool> isReferenced(numVertices);
+			size_t bytesFetched{};
+			size_t bytesReferenced{};
+			for (const uint32_t index : indices)
+			{
+				if (!isReferenced[index])
+				{
+					isReferenced[index] = true;
+					bytesReferenced += vertexSize;
+				}
+
+				const size_t firstLine{ index * vertexSize / cacheLineSize };
+				const size_t lastLine{ (index * vertexSize + vertexSize - 1) / cacheLineSize };
+				for (size_t line{ firstLine }; line <= lastLine; ++line)
+				{
+					size_t& tag{ cacheTags[line % numCacheLines] };
+					if (tag != line)
+					{
+						tag = line;
+						bytesFetched += cacheLineSize;
+					}
+				}
+			}
+
+			stats.overfetch = static_cast<float>(bytesFetched) / bytesReferenced;
+			return stats;
+		}
+
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			std::vector<uint32_t> remap(vertices.size(), invalidIndex);
+			std::vector<Vertex> orderedVertices{};
+			orderedVertices.reserve(vertices.size());
+
+			for (uint32_t& index : indices)
+			{
+				if (remap[index] == invalidIndex)
+				{
+					remap[index] = static_cast<uint32_t>(orderedVertices.size());
+					orderedVertices.push_back(vertices[index]);
+				}
+				index = remap[index];
+			}
+
+			vertices = std::move(orderedVertices);
+		}
+
+		OverdrawStats AnalyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t resolution)
+		{
+			OverdrawStats stats{};
+			if (vertices.empty() || indices.size() < 3 || resolution == 0)
+				return stats;
+
+			// Bounding sphere, good enough to fit every view
+			Vector3 center{};
+			for (const Vertex& vertex : vertices)
+			{
+				center += vertex.position;
+			}
+			center /= static_cast<float>(vertices.size());
+			float radius{};
+			for (const Vertex& vertex : vertices)
+			{
+				radius = std::max(radius, (vertex.position - center).Magnitude());
+			}
+			if (radius <= 0.f)
+				return stats;
+
+			const float windingSign{ GetWindingSign(vertices, indices) };
+			const float toPixels{ (resolution - 1) / (2.f * radius) };
+
+			std::vector<float> depthBuffer(size_t(resolution) * resolution);
+			std::vector<Vector3> projected(vertices.size());
+
+			// Ring of directions around the up axis, plus one above and one below
+			constexpr int numRingViews{ 8 };
+			std::vector<Vector3> viewDirections{};
+			for (int i{}; i < numRingViews; ++i)
+			{
+				const float angle{ PI_2 * i / numRingViews };
+				viewDirections.emplace_back(cosf(angle), -0.3f, sinf(angle));
+			}
+			viewDirections.push_back(-Vector3::UnitY);
+			viewDirections.push_back(Vector3::UnitY);
+
+			size_t pixelsShaded{};
+			size_t pixelsCovered{};
+			for (Vector3 forward : viewDirections)
+			{
+				forward.Normalize();
+				const Vector3 helper{ abs(forward.y) > 0.9f ? Vector3::UnitX : Vector3::UnitY };
+				const Vector3 right{ Vector3::Cross(helper, forward).Normalized() };
+				const Vector3 up{ Vector3::Cross(forward, right) };
+
+				// x, y in pixels, z is depth along the view direction
+				const Vector3 pixelRight{ right * toPixels };
+				const Vector3 pixelUp{ up * toPixels };
+				const Matrix projection{
+					{ pixelRight.x, pixelUp.x, forward.x },
+					{ pixelRight.y, pixelUp.y, forward.y },
+					{ pixelRight.z, pixelUp.z, forward.z },
+					{ (radius - Vector3::Dot(center, right)) * toPixels, (radius - Vector3::Dot(center, up)) * toPixels, -Vector3::Dot(center, forward) } };
+				projection.TransformPoints(&vertices[0].position, sizeof(Vertex), projected.data(), sizeof(Vector3), vertices.size());
+
+				std::fill(depthBuffer.begin(), depthBuffer.end(), FLT_MAX);
+				for (size_t i{}; i + 2 < indices.size(); i += 3)
+				{
+					const Vector3& p0{ projected[indices[i]] };
+					const Vector3& p1{ projected[indices[i + 1]] };
+					const Vector3& p2{ projected[indices[i + 2]] };
+
+					// Signed area doubles as the backface test
+					const float area{ (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x) };
+					if (area * windingSign >= 0.f)
+						continue;
+
+					const int minX{ std::max(0, static_cast<int>(std::min({ p0.x, p1.x, p2.x }))) };
+					const int minY{ std::max(0, static_cast<int>(std::min({ p0.y, p1.y, p2.y }))) };
+					const int maxX{ std::min(static_cast<int>(resolution) - 1, static_cast<int>(std::max({ p0.x, p1.x, p2.x }))) };
+					const int maxY{ std::min(static_cast<int>(resolution) - 1, static_cast<int>(std::max({ p0.y, p1.y, p2.y }))) };
+					const float invArea{ 1.f / area };
+
+					for (int y{ minY }; y <= maxY; ++y)
+					{
+						for (int x{ minX }; x <= maxX; ++x)
+						{
+							const float px{ x + 0.5f };
+							const float py{ y + 0.5f };
+							const float w0{ ((p2.x - p1.x) * (py - p1.y) - (p2.y - p1.y) * (px - p1.x)) * invArea };
+							const float w1{ ((p0.x - p2.x) * (py - p2.y) - (p0.y - p2.y) * (px - p2.x)) * invArea };
+							const float w2{ 1.f - w0 - w1 };
+							if (w0 < 0.f || w1 < 0.f || w2 < 0.f)
+								continue;
+
+							const float depth{ w0 * p0.z + w1 * p1.z + w2 * p2.z };
+							float& storedDepth{ depthBuffer[size_t(y) * resolution + x] };
+							if (depth < storedDepth)
+							{
+								storedDepth = depth;
+								++pixelsShaded;
+							}
+						}
+					}
+				}
+
+				for (const float depth : depthBuffer)
+				{
+					if (depth != FLT_MAX) ++pixelsCovered;
+				}
+			}
+
+			stats.overdraw = pixelsCovered > 0 ? static_cast<float>(pixelsShaded) / pixelsCovered : 0.f;
+			return stats;
+		}
+
+		void OptimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t cacheSize, float threshold)
+		{
+			const size_t numTriangles{ indices.size() / 3 };
+			if (numTriangles < 2)
+				return;
+
+			// Overall ACMR of the current order, the clusters may not get much worse than this
+			const float acmr{ AnalyzeVertexCache(indices, vertices.size(), cacheSize).acmr };
+
+			// Cluster boundaries: a cluster ends as soon as its own ACMR, with a cold cache, is within threshold of the total
+			std::vector<size_t> clusterStarts{ 0 };
+			{
+				FifoCacheSimulator cache{ vertices.size(), cacheSize };
+				size_t clusterMisses{};
+				size_t clusterTriangles{};
+				for (size_t t{}; t < numTriangles; ++t)
+				{
+					for (size_t corner{}; corner < 3; ++corner)
+					{
+						if (cache.Access(indices[t * 3 + corner])) ++clusterMisses;
+					}
+					++clusterTriangles;
+
+					if (t + 1 < numTriangles && clusterMisses <= threshold * acmr * clusterTriangles)
+					{
+						clusterStarts.push_back(t + 1);
+						cache.Reset();
+						clusterMisses = 0;
+						clusterTriangles = 0;
+					}
+				}
+			}
+			clusterStarts.push_back(numTriangles);
+
+			const float windingSign{ GetWindingSign(vertices, indices) };
+
+			Vector3 meshCentroid{};
+			for (const uint32_t index : indices)
+			{
+				meshCentroid += vertices[index].position;
+			}
+			meshCentroid /= static_cast<float>(indices.size());
+
+			// Clusters that face away from the centre the most are the outer shell, draw them first
+			const size_t numClusters{ clusterStarts.size() - 1 };
+			std::vector<float> clusterSortKeys(numClusters);
+			for (size_t c{}; c < numClusters; ++c)
+			{
+				Vector3 centroid{};
+				Vector3 normal{};
+				float area{};
+				for (size_t t{ clusterStarts[c] }; t < clusterStarts[c + 1]; ++t)
+				{
+					const Vector3& p0{ vertices[indices[t * 3]].position };
+					const Vector3& p1{ vertices[indices[t * 3 + 1]].position };
+					const Vector3& p2{ vertices[indices[t * 3 + 2]].position };
+
+					const Vector3 faceNormal{ Vector3::Cross(p1 - p0, p2 - p0) * windingSign };
+					const float faceArea{ faceNormal.Magnitude() };
+					centroid += (p0 + p1 + p2) * (faceArea / 3.f);
+					normal += faceNormal;
+					area += faceArea;
+				}
+
+				if (area > 0.f && normal.SqrMagnitude() > 0.f)
+				{
+					centroid /= area;
+					clusterSortKeys[c] = Vector3::Dot(centroid - meshCentroid, normal.Normalized());
+				}
+			}
+
+			std::vector<uint32_t> clusterOrder(numClusters);
+			for (uint32_t c{}; c < numClusters; ++c)
+			{
+				clusterOrder[c] = c;
+			}
+			std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](uint32_t a, uint32_t b) { return clusterSortKeys[a] > clusterSortKeys[b]; });
+
+			std::vector<uint32_t> output{};
+			output.reserve(indices.size());
+			for (const uint32_t c : clusterOrder)
+			{
+				output.insert(output.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+			}
+
+#ifdef _DEBUG
+			assert(HaveSameTriangles(indices, output) && "OptimizeOverdraw changed the triangle set!");
+#endif
+			indices = std::move(output);
+		}
+
+		std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t maxVertices, uint32_t maxTriangles, float coneWeight)
+		{
+			assert(maxVertices >= 3 && maxTriangles >= 1);
+
+			const size_t numTriangles{ indices.size() / 3 };
+			const float windingSign{ GetWindingSign(vertices, indices) };
+
+#ifdef _DEBUG
+			const std::vector<uint32_t> originalIndices{ indices };
+#endif
+
+			// Outward, unit length, zero for degenerate triangles
+			std::vector<Vector3> faceNormals(numTriangles);
+			for (size_t t{}; t < numTriangles; ++t)
+			{
+				const Vector3& p0{ vertices[indices[t * 3]].position };
+				const Vector3 normal{ Vector3::Cross(vertices[indices[t * 3 + 1]].position - p0, vertices[indices[t * 3 + 2]].position - p0) * windingSign };
+				if (normal.SqrMagnitude() > 0.f)
+					faceNormals[t] = normal.Normalized();
+			}
+
+			// Welding splits vertices along uv seams and hard edges, connect triangles through shared positions instead
+			const std::vector<uint32_t> positionIds{ RemapPositions(vertices) };
+
+			// Position -> triangles (CSR)
+			std::vector<uint32_t> triangleOffsets(vertices.size() + 1);
+			for (const uint32_t index : indices)
+			{
+				++triangleOffsets[positionIds[index] + 1];
+			}
+			for (size_t v{}; v < vertices.size(); ++v)
+			{
+				triangleOffsets[v + 1] += triangleOffsets[v];
+			}
+			std::vector<uint32_t> adjacentTriangles(indices.size());
+			{
+				std::vector<uint32_t> writeOffsets{ triangleOffsets.begin(), triangleOffsets.end() - 1 };
+				for (size_t i{}; i < indices.size(); ++i)
+				{
+					adjacentTriangles[writeOffsets[positionIds[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			// Holds the meshlet that last used each vertex
+			std::vector<uint32_t> vertexMeshlet(vertices.size(), invalidIndex);
+			std::vector<bool> isEmitted(numTriangles);
+			std::vector<uint32_t> meshletVertices{};
+			std::vector<Vector3> points{};
+			std::vector<Vector3> corners{};
+			std::vector<uint32_t> output{};
+			output.reserve(indices.size());
+			std::vector<Meshlet> meshlets{};
+			size_t scanCursor{};
+
+			const auto countNewVertices{ [&](uint32_t triangle, uint32_t meshletIndex)
+				{
+					const uint32_t* pTriangle{ &indices[size_t(triangle) * 3] };
+					uint32_t newVertices{};
+					for (int corner{}; corner < 3; ++corner)
+					{
+						const bool isRepeat{ (corner > 0 && pTriangle[corner] == pTriangle[0]) || (corner > 1 && pTriangle[corner] == pTriangle[1]) };
+						if (!isRepeat && vertexMeshlet[pTriangle[corner]] != meshletIndex)
+							++newVertices;
+					}
+					return newVertices;
+				} };
+
+			while (output.size() < indices.size())
+			{
+				// Seed with the next triangle in the current order, so the order of the earlier passes mostly survives
+				while (isEmitted[scanCursor]) ++scanCursor;
+
+				const uint32_t meshletIndex{ static_cast<uint32_t>(meshlets.size()) };
+				Meshlet meshlet{};
+				meshlet.firstIndex = static_cast<uint32_t>(output.size());
+				meshletVertices.clear();
+				Vector3 normalSum{};
+
+				uint32_t nextTriangle{ static_cast<uint32_t>(scanCursor) };
+				while (nextTriangle != invalidIndex)
+				{
+					isEmitted[nextTriangle] = true;
+					const uint32_t* pTriangle{ &indices[size_t(nextTriangle) * 3] };
+					output.insert(output.end(), pTriangle, pTriangle + 3);
+					meshlet.numIndices += 3;
+					normalSum += faceNormals[nextTriangle];
+
+					for (int corner{}; corner < 3; ++corner)
+					{
+						if (vertexMeshlet[pTriangle[corner]] != meshletIndex)
+						{
+							vertexMeshlet[pTriangle[corner]] = meshletIndex;
+							meshletVertices.push_back(pTriangle[corner]);
+							points.push_back(vertices[pTriangle[corner]].position);
+						}
+					}
+					// Outward facing winding for the cone
+					corners.push_back(vertices[pTriangle[0]].position);
+					corners.push_back(vertices[pTriangle[windingSign > 0.f ? 1 : 2]].position);
+					corners.push_back(vertices[pTriangle[windingSign > 0.f ? 2 : 1]].position);
+
+					if (meshlet.numIndices / 3 >= maxTriangles)
+						break;
+
+					// Grow into the neighbour that adds the fewest vertices and bends the cone the least
+					const Vector3 axis{ normalSum.SqrMagnitude() > 0.f ? normalSum.Normalized() : Vector3::Zero };
+					nextTriangle = invalidIndex;
+					float bestScore{ FLT_MAX };
+					for (const uint32_t v : meshletVertices)
+					{
+						const uint32_t position{ positionIds[v] };
+						for (uint32_t a{ triangleOffsets[position] }; a < triangleOffsets[position + 1]; ++a)
+						{
+							const uint32_t candidate{ adjacentTriangles[a] };
+							if (isEmitted[candidate])
+								continue;
+
+							const uint32_t newVertices{ countNewVertices(candidate, meshletIndex) };
+							if (meshletVertices.size() + newVertices > maxVertices)
+								continue;
+
+							const float score{ newVertices + coneWeight * (1.f - Vector3::Dot(faceNormals[candidate], axis)) };
+							if (score < bestScore)
+							{
+								bestScore = score;
+								nextTriangle = candidate;
+							}
+						}
+					}
+				}
+
+				meshlet.numVertices = static_cast<uint32_t>(meshletVertices.size());
+				ComputeBoundingSphere(points, meshlet.center, meshlet.radius);
+				ComputeNormalCone(corners, meshlet.center, meshlet);
+				points.clear();
+				corners.clear();
+				meshlets.push_back(meshlet);
+			}
+
+#ifdef _DEBUG
+			assert(HaveSameTriangles(originalIndices, output) && "BuildMeshlets changed the triangle set!");
+#endif
+			indices = std::move(output);
+			return meshlets;
+		}
+
+		float Simplify(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError)
+		{
+			const size_t numVertices{ vertices.size() };
+			const std::vector<uint32_t> positionIds{ RemapPositions(vertices) };
+
+			MeshTopology topology{};
+			ClassifyVertices(indices, positionIds, topology);
+
+			// Per position: the planes of its triangles, weighted by area, plus planes standing on its open edges
+			std::vector<Quadric> quadrics(numVertices);
+			for (size_t i{}; i + 2 < indices.size(); i += 3)
+			{
+				const Vector3& p0{ vertices[indices[i]].position };
+				const Vector3 normal{ Vector3::Cross(vertices[indices[i + 1]].position - p0, vertices[indices[i + 2]].position - p0) };
+				const float doubleArea{ normal.Magnitude() };
+				if (doubleArea <= 0.f)
+					continue;
+				const Vector3 unitNormal{ normal / doubleArea };
+
+				Quadric faceQuadric{};
+				faceQuadric.AddPlane(unitNormal, -Vector3::Dot(unitNormal, p0), doubleArea * 0.5);
+				for (size_t k{}; k < 3; ++k)
+				{
+					const uint32_t from{ indices[i + k] };
+					const uint32_t to{ indices[i + (k + 1) % 3] };
+					quadrics[positionIds[from]] += faceQuadric;
+					if (!topology.isOpenEdge[i + k])
+						continue;
+
+					const Vector3 edge{ vertices[to].position - vertices[from].position };
+					const float edgeLength{ edge.Magnitude() };
+					if (edgeLength <= 0.f)
+						continue;
+					const Vector3 edgeNormal{ Vector3::Cross(edge, unitNormal) / edgeLength };
+					Quadric edgeQuadric{};
+					edgeQuadric.AddPlane(edgeNormal, -Vector3::Dot(edgeNormal, vertices[from].position), boundaryWeight * edgeLength * edgeLength);
+					quadrics[positionIds[from]] += edgeQuadric;
+					quadrics[positionIds[to]] += edgeQuadric;
+				}
+			}
+
+			struct Collapse
+			{
+				uint32_t from;
+				uint32_t to;
+				double cost;
+			};
+			std::vector<Collapse> collapses{};
+			std::vector<uint32_t> collapseRemap(numVertices);
+			std::vector<bool> isPositionLocked(numVertices);
+			std::vector<uint32_t> triangleOffsets(numVertices + 1);
+			std::vector<uint32_t> adjacentTriangles{};
+
+			const double maxCost{ double{ maxError } * maxError };
+			double resultCost{};
+			while (indices.size() > targetIndexCount)
+			{
+				// Position -> triangles (CSR) of what is left
+				std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+				for (const uint32_t index : indices)
+				{
+					++triangleOffsets[positionIds[index] + 1];
+				}
+				for (size_t v{}; v < numVertices; ++v)
+				{
+					triangleOffsets[v + 1] += triangleOffsets[v];
+				}
+				adjacentTriangles.resize(indices.size());
+				{
+					std::vector<uint32_t> writeOffsets{ triangleOffsets.begin(), triangleOffsets.end() - 1 };
+					for (size_t i{}; i < indices.size(); ++i)
+					{
+						adjacentTriangles[writeOffsets[positionIds[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+					}
+				}
+
+				// Every allowed direction of every edge, priced by the error the moving position picks up
+				collapses.clear();
+				for (size_t i{}; i + 2 < indices.size(); i += 3)
+				{
+					for (size_t k{}; k < 6; ++k)
+					{
+						const uint32_t from{ indices[i + k % 3] };
+						const uint32_t to{ indices[i + (k < 3 ? (k + 1) % 3 : (k + 2) % 3)] };
+						if (positionIds[from] == positionIds[to])
+							continue;
+
+						const VertexKind kind{ topology.kinds[from] };
+						if (kind == VertexKind::Locked)
+							continue;
+						if (kind != VertexKind::Manifold && (topology.kinds[to] != kind || (topology.openOut[from] != to && topology.openIn[from] != to)))
+							continue;
+
+						collapses.push_back({ from, to, quadrics[positionIds[from]].Evaluate(vertices[to].position) });
+					}
+				}
+				if (collapses.empty())
+					break;
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+				// Each collapse takes out about two triangles, stop a pass early so later ones see the updated costs
+				const size_t triangleGoal{ (indices.size() - targetIndexCount + 2) / 3 };
+				const size_t collapseGoal{ std::min(std::max(triangleGoal / 2, size_t{ 1 }), collapses.size()) };
+				const double passCostLimit{ collapses[collapseGoal - 1].cost * 1.5 };
+
+				for (uint32_t v{}; v < numVertices; ++v)
+				{
+					collapseRemap[v] = v;
+				}
+				std::fill(isPositionLocked.begin(), isPositionLocked.end(), false);
+
+				size_t removedTriangles{};
+				for (const Collapse& collapse : collapses)
+				{
+					if (collapse.cost > maxCost || collapse.cost > passCostLimit || removedTriangles >= triangleGoal)
+						break;
+
+					const uint32_t fromPosition{ positionIds[collapse.from] };
+					const uint32_t toPosition{ positionIds[collapse.to] };
+					if (isPositionLocked[fromPosition] || isPositionLocked[toPosition])
+						continue;
+
+					// Triangles around the moving position that survive the collapse
+					bool flips{};
+					const Vector3& target{ vertices[collapse.to].position };
+					for (uint32_t a{ triangleOffsets[fromPosition] }; a < triangleOffsets[fromPosition + 1] && !flips; ++a)
+					{
+						const size_t triangle{ adjacentTriangles[a] * size_t{ 3 } };
+						uint32_t corners[3]{};
+						size_t movingCorner{};
+						for (size_t k{}; k < 3; ++k)
+						{
+							corners[k] = collapseRemap[indices[triangle + k]];
+							if (positionIds[corners[k]] == fromPosition)
+								movingCorner = k;
+						}
+						const uint32_t b{ corners[(movingCorner + 1) % 3] };
+						const uint32_t c{ corners[(movingCorner + 2) % 3] };
+						if (positionIds[b] == toPosition || positionIds[c] == toPosition || positionIds[b] == positionIds[c])
+							continue;
+						flips = FlipsTriangle(vertices[corners[movingCorner]].position, vertices[b].position, vertices[c].position, target);
+					}
+					if (flips)
+						continue;
+
+					collapseRemap[collapse.from] = collapse.to;
+					if (topology.kinds[collapse.from] == VertexKind::Seam)
+					{
+						// The other side of the seam follows along its own open edge
+						const uint32_t otherFrom{ topology.wedges[collapse.from] };
+						const uint32_t otherTo{ topology.openOut[collapse.from] == collapse.to ? topology.openIn[otherFrom] : topology.openOut[otherFrom] };
+						assert(positionIds[otherTo] == toPosition && "Seam sides out of step!");
+						collapseRemap[otherFrom] = otherTo;
+					}
+
+					isPositionLocked[fromPosition] = true;
+					isPositionLocked[toPosition] = true;
+					quadrics[toPosition] += quadrics[fromPosition];
+					removedTriangles += topology.kinds[collapse.from] == VertexKind::Border ? 1 : 2;
+					resultCost = std::max(resultCost, collapse.cost);
+				}
+				if (removedTriangles == 0)
+					break;
+
+				// Drop the triangles that lost an edge
+				size_t numKept{};
+				for (size_t i{}; i + 2 < indices.size(); i += 3)
+				{
+					const uint32_t index0{ collapseRemap[indices[i]] };
+					const uint32_t index1{ collapseRemap[indices[i + 1]] };
+					const uint32_t index2{ collapseRemap[indices[i + 2]] };
+					if (positionIds[index0] == positionIds[index1] || positionIds[index1] == positionIds[index2] || positionIds[index0] == positionIds[index2])
+						continue;
+					indices[numKept++] = index0;
+					indices[numKept++] = index1;
+					indices[numKept++] = index2;
+				}
+				indices.resize(numKept);
+
+				// Collapses open and close seams and borders
+				ClassifyVertices(indices, positionIds, topology);
+			}
+
+			return static_cast<float>(std::sqrt(resultCost));
+		}
+
+		std::vector<LevelOfDetail> BuildLevelsOfDetail(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const std::vector<float>& ratios,
+			float maxError, uint32_t cacheSize)
+		{
+			const uint32_t numSourceIndices{ static_cast<uint32_t>(indices.size()) };
+			std::vector<LevelOfDetail> levels{ { 0, numSourceIndices, 0.f } };
+
+			std::vector<uint32_t> levelIndices{};
+			for (const float ratio : ratios)
+			{
+				assert(ratio > 0.f && ratio < 1.f);
+
+				// Always from the source, so every error is measured against the full mesh
+				levelIndices.assign(indices.begin(), indices.begin() + numSourceIndices);
+				const size_t targetIndexCount{ static_cast<size_t>(numSourceIndices * ratio) / 3 * 3 };
+				const float error{ Simplify(vertices, levelIndices, targetIndexCount, maxError) };
+
+				// Seams, borders or the error limit stopped it short of anything worth a level
+				if (levelIndices.empty() || levelIndices.size() > levels.back().numIndices * minLevelReduction)
+					break;
+
+				OptimizeVertexCache(levelIndices, vertices.size(), cacheSize);
+				levels.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(levelIndices.size()), error });
+				indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+			}
+			return levels;
+		}
+
+		uint32_t SelectLevelOfDetail(const std::vector<LevelOfDetail>& levelsOfDetail, float distance, float scale, float fov, float viewportHeight,
+			float maxPixelError)
+		{
+			if (distance <= 0.f)
+				return 0;
+
+			// Object space units to pixels at that distance
+			const float pixelsPerUnit{ scale * viewportHeight / (2.f * fov * distance) };
+			for (uint32_t i{ static_cast<uint32_t>(levelsOfDetail.size()) }; i-- > 1;)
+			{
+				if (levelsOfDetail[i].error * pixelsPerUnit <= maxPixelError)
+					return i;
+			}
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "DataTypes.h"
+
+namespace dae
+{
+	// Offline passes over triangle-list index buffers, Mesh runs them once at import time
+	namespace MeshProcessing
+	{
+		enum class CacheModel
+		{
+			FIFO, LRU
+		};
+
+		struct VertexFetchStats
+		{
+			// Bytes pulled through the simulated cache per byte of referenced vertex data, 1 is perfect
+			float overfetch{};
+		};
+
+		struct OverdrawStats
+		{
+			// Shaded pixels per covered pixel, averaged over a ring of orthographic views, 1 is perfect
+			float overdraw{};
+		};
+
+		// Run of at most maxVertices vertices / maxTriangles triangles that is contiguous in the index buffer,
+		// so visible meshlets can be drawn as index ranges
+		struct Meshlet
+		{
+			uint32_t firstIndex;
+			uint32_t numIndices;
+			uint32_t numVertices;
+
+			// Bounding sphere
+			Vector3 center;
+			float radius;
+
+			// Every triangle faces away from a camera with dot(normalize(coneApex - camera), coneAxis) > coneCutoff,
+			// a cone that can't cull has a zero axis
+			Vector3 coneApex;
+			Vector3 coneAxis;
+			float coneCutoff;
+		};
+
+		// One level of a chain that shares the vertex buffer, every level is its own range of the index buffer
+		struct LevelOfDetail
+		{
+			uint32_t firstIndex;
+			uint32_t numIndices;
+			// Quadric error of the worst collapse, about how far the surface moved, in object space
+			float error;
+		};
+
+		struct VertexCacheStats
+		{
+			// Average cache miss ratio: transformed vertices per triangle, 0.5 is the best possible, 3 the worst
+			float acmr{};
+			// Average transform to vertex ratio: transformed vertices per referenced vertex, 1 is perfect
+			float atvr{};
+		};
+
+		// Simulates a post-transform cache of the given size over the index buffer
+		VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t numVertices, uint32_t cacheSize, CacheModel model = CacheModel::FIFO);
+
+		// Reorders triangles for post-transform cache reuse (Forsyth's linear-speed algorithm), the triangle set and winding are untouched
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t numVertices, uint32_t cacheSize = 32);
+
+		// Simulates a small direct-mapped cache of 64 byte lines in front of the vertex buffer
+		VertexFetchStats AnalyzeVertexFetch(const std::vector<uint32_t>& indices, size_t numVertices, size_t vertexSize);
+
+		// Stores vertices in the order the index buffer first uses them and drops unreferenced ones, run it after the index order is final
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		// Rasterizes the mesh with depth test and backface culling from a set of directions
+		OverdrawStats AnalyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t resolution = 256);
+
+		// Splits a cache-optimized index buffer into clusters that don't cost much vertex reuse (threshold x ACMR)
+		// and draws outward facing clusters first, so they occlude the rest
+		void OptimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t cacheSize = 32, float threshold = 1.05f);
+
+		// Grows meshlets over shared positions, seeded in the current triangle order, and rewrites the index buffer meshlet by meshlet
+		// coneWeight trades vertex reuse for tighter normal cones, run OptimizeVertexFetch afterwards
+		std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+			uint32_t maxVertices = 64, uint32_t maxTriangles = 124, float coneWeight = 0.5f);
+
+		// Collapses edges in order of quadric error until the index count is reached or the next collapse would cost more than maxError,
+		// returns the error of the result. Only ever moves vertices onto other vertices, so the vertex buffer stays as is.
+		// Positions shared by two vertices (uv or normal seams) only collapse along the seam, open borders only along the border
+		float Simplify(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError = FLT_MAX);
+
+		// Appends a simplified, cache optimized copy of the index buffer per ratio (of the triangle count), level 0 is the buffer as it was
+		// The chain ends early once seams, borders or maxError keep a ratio from getting much coarser than the level before it
+		std::vector<LevelOfDetail> BuildLevelsOfDetail(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const std::vector<float>& ratios,
+			float maxError = FLT_MAX, uint32_t cacheSize = 32);
+
+		// The coarsest level whose error covers at most maxPixelError pixels. distance runs from the camera to the closest point of the
+		// bounding sphere, level 0 from inside it. scale takes object space errors to world space, fov is tan(fovAngle / 2)
+		uint32_t SelectLevelOfDetail(const std::vector<LevelOfDetail>& levelsOfDetail, float distance, float scale, float fov, float viewportHeight,
+			float maxPixelError = 1.f);
+
+		// True when both buffers hold the same triangles with the same winding, in any order
+		bool HaveSameTriangles(const std::vector<uint32_t>& indicesA, const std::vector<uint32_t>& indicesB);
+	}
+}
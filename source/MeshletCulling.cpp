@@ -0,0 +1,132 @@
+#include "pch.h"
+#include "MeshletCulling.h"
+#include "FrustumCulling.h"
+
+#include "MathBackend.h"
+
+// Follows the math backend, so DAE_MATH_SCALAR turns this off as well
+#if defined(DAE_MATH_SSE)
+#define DAE_MESHLET_CULLING_SSE2
+#endif
+
+namespace dae
+{
+	MeshletCuller::MeshletCuller(const MeshProcessing::Meshlet* pMeshlets, uint32_t numMeshlets)
+	{
+		const size_t paddedSize{ (size_t(numMeshlets) + 3) & ~size_t{ 3 } };
+		for (std::vector<float>* pArray : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_ApexX, &m_ApexY, &m_ApexZ, &m_AxisX, &m_AxisY, &m_AxisZ })
+		{
+			pArray->assign(paddedSize, 0.f);
+		}
+		m_Radius.assign(paddedSize, -INFINITY);
+		m_Cutoff.assign(paddedSize, 1.f);
+		m_Ranges.resize(numMeshlets);
+
+		for (uint32_t i{}; i < numMeshlets; ++i)
+		{
+			const MeshProcessing::Meshlet& meshlet{ pMeshlets[i] };
+			m_CenterX[i] = meshlet.center.x;
+			m_CenterY[i] = meshlet.center.y;
+			m_CenterZ[i] = meshlet.center.z;
+			m_Radius[i] = meshlet.radius;
+			m_ApexX[i] = meshlet.coneApex.x;
+			m_ApexY[i] = meshlet.coneApex.y;
+			m_ApexZ[i] = meshlet.coneApex.z;
+			m_AxisX[i] = meshlet.coneAxis.x;
+			m_AxisY[i] = meshlet.coneAxis.y;
+			m_AxisZ[i] = meshlet.coneAxis.z;
+			m_Cutoff[i] = meshlet.coneCutoff;
+			m_Ranges[i] = { meshlet.firstIndex, meshlet.numIndices };
+		}
+	}
+
+	MeshletCullStats MeshletCuller::Cull(const Matrix& worldViewProjection, const Vector3& cameraPosition, std::vector<IndexRange>& ranges, bool cullBackFaces) const
+	{
+		Vector4 planes[numFrustumPlanes];
+		ExtractFrustumPlanes(worldViewProjection, planes);
+
+		MeshletCullStats stats{};
+		stats.numMeshlets = GetNumMeshlets();
+		ranges.clear();
+
+		// Counts the meshlet and, when it survives both tests, appends its range
+		const auto accept{ [&](uint32_t meshlet, bool isInFrustum, bool isBackFacing)
+			{
+				const IndexRange& range{ m_Ranges[meshlet] };
+				const uint32_t numTriangles{ range.numIndices / 3 };
+				stats.numTriangles += numTriangles;
+				if (!isInFrustum)
+				{
+					stats.frustumCulledTriangles += numTriangles;
+					return;
+				}
+				if (isBackFacing)
+				{
+					stats.backfaceCulledTriangles += numTriangles;
+					return;
+				}
+
+				++stats.visibleMeshlets;
+				stats.visibleTriangles += numTriangles;
+				if (!ranges.empty() && ranges.back().firstIndex + ranges.back().numIndices == range.firstIndex)
+					ranges.back().numIndices += range.numIndices;
+				else
+					ranges.push_back(range);
+			} };
+
+		uint32_t i{};
+#ifdef DAE_MESHLET_CULLING_SSE2
+		const __m128 cameraX{ _mm_set1_ps(cameraPosition.x) }, cameraY{ _mm_set1_ps(cameraPosition.y) }, cameraZ{ _mm_set1_ps(cameraPosition.z) };
+		for (; i < stats.numMeshlets; i += 4)
+		{
+			const __m128 centerX{ _mm_loadu_ps(&m_CenterX[i]) }, centerY{ _mm_loadu_ps(&m_CenterY[i]) }, centerZ{ _mm_loadu_ps(&m_CenterZ[i]) };
+			const __m128 negativeRadius{ _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&m_Radius[i])) };
+
+			__m128 inFrustum{ _mm_castsi128_ps(_mm_set1_epi32(-1)) };
+			for (const Vector4& plane : planes)
+			{
+				const __m128 distance{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.x)), _mm_mul_ps(centerY, _mm_set1_ps(plane.y))),
+					_mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w))) };
+				inFrustum = _mm_and_ps(inFrustum, _mm_cmpge_ps(distance, negativeRadius));
+			}
+
+			const __m128 toApexX{ _mm_sub_ps(_mm_loadu_ps(&m_ApexX[i]), cameraX) };
+			const __m128 toApexY{ _mm_sub_ps(_mm_loadu_ps(&m_ApexY[i]), cameraY) };
+			const __m128 toApexZ{ _mm_sub_ps(_mm_loadu_ps(&m_ApexZ[i]), cameraZ) };
+			const __m128 distance{ _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(toApexX, toApexX), _mm_mul_ps(toApexY, toApexY)), _mm_mul_ps(toApexZ, toApexZ))) };
+			const __m128 alongAxis{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(toApexX, _mm_loadu_ps(&m_AxisX[i])), _mm_mul_ps(toApexY, _mm_loadu_ps(&m_AxisY[i]))),
+				_mm_mul_ps(toApexZ, _mm_loadu_ps(&m_AxisZ[i]))) };
+			const __m128 backFacing{ _mm_cmpgt_ps(alongAxis, _mm_mul_ps(_mm_loadu_ps(&m_Cutoff[i]), distance)) };
+
+			const int inFrustumMask{ _mm_movemask_ps(inFrustum) };
+			const int backFacingMask{ cullBackFaces ? _mm_movemask_ps(backFacing) : 0 };
+			const uint32_t numLanes{ std::min(4u, stats.numMeshlets - i) };
+			for (uint32_t lane{}; lane < numLanes; ++lane)
+			{
+				accept(i + lane, (inFrustumMask >> lane) & 1, (backFacingMask >> lane) & 1);
+			}
+		}
+#else
+		for (; i < stats.numMeshlets; ++i)
+		{
+			bool isInFrustum{ true };
+			for (const Vector4& plane : planes)
+			{
+				isInFrustum &= m_CenterX[i] * plane.x + m_CenterY[i] * plane.y + m_CenterZ[i] * plane.z + plane.w >= -m_Radius[i];
+			}
+
+			const Vector3 toApex{ m_ApexX[i] - cameraPosition.x, m_ApexY[i] - cameraPosition.y, m_ApexZ[i] - cameraPosition.z };
+			const bool isBackFacing{ cullBackFaces && Vector3::Dot(toApex, { m_AxisX[i], m_AxisY[i], m_AxisZ[i] }) > m_Cutoff[i] * toApex.Magnitude() };
+			accept(i, isInFrustum, isBackFacing);
+		}
+#endif
+
+		stats.numDrawRanges = static_cast<uint32_t>(ranges.size());
+		return stats;
+	}
+
+	uint32_t MeshletCuller::GetNumMeshlets() const
+	{
+		return static_cast<uint32_t>(m_Ranges.size());
+	}
+}
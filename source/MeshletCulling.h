@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "MeshProcessing.h"
+
+namespace dae
+{
+	struct IndexRange
+	{
+		uint32_t firstIndex;
+		uint32_t numIndices;
+	};
+
+	struct MeshletCullStats
+	{
+		uint32_t numMeshlets{};
+		uint32_t numTriangles{};
+		uint32_t frustumCulledTriangles{};
+		uint32_t backfaceCulledTriangles{};
+		uint32_t visibleMeshlets{};
+		uint32_t visibleTriangles{};
+		uint32_t numDrawRanges{};
+
+		float GetRejectedPercentage() const
+		{
+			return numTriangles > 0 ? 100.f * (numTriangles - visibleTriangles) / numTriangles : 0.f;
+		}
+	};
+
+	// Rejects meshlets outside the frustum or facing away from the camera, four at a time with SSE2
+	class MeshletCuller final
+	{
+	public:
+		MeshletCuller(const MeshProcessing::Meshlet* pMeshlets, uint32_t numMeshlets);
+		MeshletCuller(const MeshletCuller& other) = delete;
+		MeshletCuller& operator=(const MeshletCuller& other) = delete;
+		MeshletCuller(MeshletCuller&& other) = delete;
+		MeshletCuller& operator=(MeshletCuller&& other) = delete;
+		~MeshletCuller() = default;
+
+		// Both in the object space of the meshlets, worldViewProjection without any dequantization
+		// Fills ranges with the index ranges to draw, neighbouring visible meshlets merged into one.
+		// Without cullBackFaces (double-sided materials) the cones are skipped and only the frustum rejects
+		MeshletCullStats Cull(const Matrix& worldViewProjection, const Vector3& cameraPosition, std::vector<IndexRange>& ranges, bool cullBackFaces = true) const;
+
+		uint32_t GetNumMeshlets() const;
+
+	private:
+		// Structure of arrays padded to a multiple of 4, padding is never visible
+		std::vector<float> m_CenterX, m_CenterY, m_CenterZ, m_Radius;
+		std::vector<float> m_ApexX, m_ApexY, m_ApexZ;
+		std::vector<float> m_AxisX, m_AxisY, m_AxisZ, m_Cutoff;
+		std::vector<IndexRange> m_Ranges;
+	};
+}
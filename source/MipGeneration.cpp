@@ -0,0 +1,455 @@
+#include "pch.h"
+#include "MipGeneration.h"
+#include "FastMath.h"
+#include "Utils.h"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace dae
+{
+	namespace MipGeneration
+	{
+		namespace
+		{
+			// Fewer source texels than this per thread and spawning it costs more than it saves
+			constexpr size_t minTexelsPerThread{ 128 * 1024 };
+			constexpr int numChannels{ 4 };
+
+			// One plane per channel, so neighbouring texels of a channel are next to each other for the SIMD loads
+			struct FloatLevel
+			{
+				uint32_t width{};
+				uint32_t height{};
+				std::vector<float> planes[numChannels];
+
+				void Resize(uint32_t newWidth, uint32_t newHeight)
+				{
+					width = newWidth;
+					height = newHeight;
+					for (std::vector<float>& plane : planes)
+						plane.resize(size_t{ width } * height);
+				}
+			};
+
+			// Source texels and weights of every destination texel along one axis, numTaps each, padded with zero weights
+			struct Taps
+			{
+				size_t numTaps{};
+				std::vector<uint32_t> indices;
+				std::vector<float> weights;
+				// Halving an even size, texel i reads 2 * i + firstOffset + k (before wrapping) with the same weights for every i
+				bool isHalving{};
+				int firstOffset{};
+			};
+
+			// Splits [0, count) into numThreads contiguous ranges
+			inline size_t GetRangeBegin(size_t count, size_t numThreads, size_t thread)
+			{
+				return count * thread / numThreads;
+			}
+
+			#pragma region Filters
+			float Sinc(float x)
+			{
+				if (std::abs(x) < 1e-6f)
+					return 1.f;
+				const float piX{ PI * x };
+				return std::sin(piX) / piX;
+			}
+
+			// Modified Bessel function of the first kind, order 0
+			float BesselI0(float x)
+			{
+				float sum{ 1.f };
+				float term{ 1.f };
+				for (int k{ 1 }; k < 32 && term > sum * 1e-8f; ++k)
+				{
+					const float factor{ x / (2.f * k) };
+					term *= factor * factor;
+					sum += term;
+				}
+				return sum;
+			}
+
+			// In destination texels
+			float GetRadius(Filter filter)
+			{
+				return filter == Filter::Box ? 0.5f : 3.f;
+			}
+
+			float EvaluateFilter(Filter filter, float t)
+			{
+				const float radius{ GetRadius(filter) };
+				const float absT{ std::abs(t) };
+				switch (filter)
+				{
+				case Filter::Box:
+					// A texel right on the edge is shared with the neighbour
+					return absT < radius ? 1.f : (absT == radius ? 0.5f : 0.f);
+				case Filter::Kaiser:
+				{
+					constexpr float alpha{ 4.f };
+					if (absT >= radius)
+						return 0.f;
+					const float ratio{ t / radius };
+					return Sinc(t) * BesselI0(alpha * std::sqrt(1.f - ratio * ratio)) / BesselI0(alpha);
+				}
+				case Filter::Lanczos:
+					return absT < radius ? Sinc(t) * Sinc(t / radius) : 0.f;
+				}
+				return 0.f;
+			}
+
+			Taps ComputeTaps(Filter filter, uint32_t sourceSize, uint32_t size)
+			{
+				// The filter stretched over the source texels, in source texels
+				const float scale{ static_cast<float>(sourceSize) / static_cast<float>(size) };
+				const float support{ GetRadius(filter) * scale };
+				const size_t maxTaps{ static_cast<size_t>(std::ceil(2.f * support)) + 1 };
+
+				std::vector<std::pair<uint32_t, float>> texelTaps(size * maxTaps);
+				std::vector<size_t> numTexelTaps(size);
+				int firstSource{};
+				for (uint32_t i{}; i < size; ++i)
+				{
+					const float center{ (static_cast<float>(i) + 0.5f) * scale };
+					const int first{ static_cast<int>(std::floor(center - support)) };
+					float sum{};
+					for (size_t k{}; k < maxTaps; ++k)
+					{
+						const int source{ first + static_cast<int>(k) };
+						const float weight{ EvaluateFilter(filter, (static_cast<float>(source) + 0.5f - center) / scale) };
+						if (weight == 0.f)
+							continue;
+						if (i == 0 && numTexelTaps[i] == 0)
+							firstSource = source;
+
+						// Wrapped like the samplers address the texture
+						const int wrapped{ (source % static_cast<int>(sourceSize) + static_cast<int>(sourceSize)) % static_cast<int>(sourceSize) };
+						texelTaps[i * maxTaps + numTexelTaps[i]++] = { static_cast<uint32_t>(wrapped), weight };
+						sum += weight;
+					}
+					for (size_t k{}; k < numTexelTaps[i]; ++k)
+						texelTaps[i * maxTaps + k].second /= sum;
+				}
+
+				// Zero weight taps skipped, the rest padded to the longest
+				Taps taps{};
+				taps.numTaps = *std::max_element(numTexelTaps.begin(), numTexelTaps.end());
+				taps.isHalving = sourceSize == 2 * size;
+				taps.firstOffset = firstSource;
+				taps.indices.resize(size * taps.numTaps);
+				taps.weights.resize(size * taps.numTaps);
+				for (uint32_t i{}; i < size; ++i)
+				{
+					for (size_t k{}; k < taps.numTaps; ++k)
+					{
+						const bool isPadding{ k >= numTexelTaps[i] };
+						taps.indices[i * taps.numTaps + k] = texelTaps[i * maxTaps + (isPadding ? 0 : k)].first;
+						taps.weights[i * taps.numTaps + k] = isPadding ? 0.f : texelTaps[i * maxTaps + k].second;
+					}
+				}
+				return taps;
+			}
+			#pragma endregion
+
+			#pragma region Texel Values
+			// Written once for float and SimdFloat, like the transforms in Transform.cpp
+			template<typename T>
+			T Splat(float value)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return value;
+				else
+					return T::Set(value);
+			}
+
+			template<typename T>
+			T Load(const float* pData)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return *pData;
+				else
+					return T::Load(pData);
+			}
+
+			template<typename T>
+			void Store(float* pData, T value)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					*pData = value;
+				else
+					value.Store(pData);
+			}
+
+			template<typename T>
+			T Saturate(T value)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return std::min(std::max(value, 0.f), 1.f);
+				else
+					return T::Min(T::Max(value, T::Set(0.f)), T::Set(1.f));
+			}
+
+			template<typename T>
+			T SelectLess(T a, T b, T ifLess, T otherwise)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					return a < b ? ifLess : otherwise;
+				else
+					return T::Select(T::Less(a, b), ifLess, otherwise);
+			}
+
+			// kernel(T{}, x) for every x in [0, count), SimdFloat::width at a time and the rest one by one
+			template<typename Kernel>
+			void ForEachTexel(size_t count, const Kernel& kernel)
+			{
+				size_t x{};
+#ifdef DAE_MATH_SIMD
+				for (; x + SimdFloat::width <= count; x += SimdFloat::width)
+					kernel(SimdFloat{}, x);
+#endif
+				for (; x < count; ++x)
+					kernel(0.f, x);
+			}
+
+			// Byte to float per channel
+			using DecodeTables = std::array<std::array<float, 256>, numChannels>;
+
+			DecodeTables CreateDecodeTables(Content content)
+			{
+				DecodeTables tables{};
+				for (int code{}; code < 256; ++code)
+				{
+					const float value{ static_cast<float>(code) / 255.f };
+					float decoded{ value };
+					if (content == Content::Color)
+						decoded = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+					else if (content == Content::NormalMap)
+						decoded = value * 2.f - 1.f;
+
+					for (int channel{}; channel < 3; ++channel)
+						tables[channel][code] = decoded;
+					tables[3][code] = value;
+				}
+				return tables;
+			}
+
+			// Scaled to [0, 255]
+			template<typename T>
+			T EncodeLinear(T value)
+			{
+				return Saturate(value) * Splat<T>(255.f);
+			}
+
+			template<typename T>
+			T EncodeSrgb(T linear)
+			{
+				linear = Saturate(linear);
+				const T curve{ Splat<T>(1.055f) * FastMath::Pow(linear, Splat<T>(1.f / 2.4f)) - Splat<T>(0.055f) };
+				return SelectLess(linear, Splat<T>(0.0031308f), linear * Splat<T>(12.92f), curve) * Splat<T>(255.f);
+			}
+
+			// Row y of level, scaled to [0, 255] in the four rows of encoded, then rounded to bytes in pDestination
+			void EncodeRow(const FloatLevel& level, size_t y, Content content, std::vector<float>(&encoded)[numChannels], uint8_t* pDestination)
+			{
+				const size_t rowOffset{ y * level.width };
+				const float* pRows[numChannels]{};
+				for (int channel{}; channel < numChannels; ++channel)
+					pRows[channel] = &level.planes[channel][rowOffset];
+
+				ForEachTexel(level.width, [&](auto tag, size_t x)
+					{
+						using T = decltype(tag);
+						T values[numChannels]{};
+						for (int channel{}; channel < numChannels; ++channel)
+							values[channel] = Load<T>(pRows[channel] + x);
+
+						switch (content)
+						{
+						case Content::Color:
+							for (int channel{}; channel < 3; ++channel)
+								values[channel] = EncodeSrgb(values[channel]);
+							break;
+						case Content::Linear:
+							for (int channel{}; channel < 3; ++channel)
+								values[channel] = EncodeLinear(values[channel]);
+							break;
+						case Content::NormalMap:
+						{
+							// Averages of unit vectors are shorter, zero where they cancel out: straight up then
+							const T sqrLength{ values[0] * values[0] + values[1] * values[1] + values[2] * values[2] };
+							const T minSqrLength{ Splat<T>(1e-12f) };
+							const T inverseLength{ FastMath::RSqrt(SelectLess(sqrLength, minSqrLength, Splat<T>(1.f), sqrLength)) };
+							const T half{ Splat<T>(0.5f) };
+							values[0] = SelectLess(sqrLength, minSqrLength, Splat<T>(0.f), values[0] * inverseLength);
+							values[1] = SelectLess(sqrLength, minSqrLength, Splat<T>(0.f), values[1] * inverseLength);
+							values[2] = SelectLess(sqrLength, minSqrLength, Splat<T>(1.f), values[2] * inverseLength);
+							for (int channel{}; channel < 3; ++channel)
+								values[channel] = EncodeLinear(values[channel] * half + half);
+							break;
+						}
+						}
+						values[3] = EncodeLinear(values[3]);
+
+						for (int channel{}; channel < numChannels; ++channel)
+							Store(&encoded[channel][x], values[channel]);
+					});
+
+				for (size_t x{}; x < level.width; ++x)
+				{
+					for (int channel{}; channel < numChannels; ++channel)
+						pDestination[x * numChannels + channel] = static_cast<uint8_t>(encoded[channel][x] + 0.5f);
+				}
+			}
+			#pragma endregion
+
+			// Rows [rowBegin, rowEnd) of destination from source, vertically into row, then horizontally
+			void FilterRows(const FloatLevel& source, const Taps& horizontalTaps, const Taps& verticalTaps, size_t rowBegin, size_t rowEnd,
+				std::vector<float>& row, FloatLevel& destination)
+			{
+				// Halving, the row is split in even and odd texels, so the taps of neighbouring destination texels are neighbours too.
+				// Both halves start padding texels early, wrapped around, and run as far past the end
+				const int padding{ static_cast<int>(horizontalTaps.numTaps) + std::max(-horizontalTaps.firstOffset, 0) };
+				const int sourceWidth{ static_cast<int>(source.width) };
+				std::vector<float> phases[2];
+				if (horizontalTaps.isHalving)
+				{
+					for (std::vector<float>& phase : phases)
+						phase.resize(destination.width + 2 * padding);
+				}
+
+				for (size_t y{ rowBegin }; y < rowEnd; ++y)
+				{
+					const uint32_t* pVerticalIndices{ &verticalTaps.indices[y * verticalTaps.numTaps] };
+					const float* pVerticalWeights{ &verticalTaps.weights[y * verticalTaps.numTaps] };
+					for (int channel{}; channel < numChannels; ++channel)
+					{
+						const float* pSource{ source.planes[channel].data() };
+						ForEachTexel(source.width, [&](auto tag, size_t x)
+							{
+								using T = decltype(tag);
+								T sum{ Splat<T>(0.f) };
+								for (size_t k{}; k < verticalTaps.numTaps; ++k)
+									sum = sum + Splat<T>(pVerticalWeights[k]) * Load<T>(pSource + size_t{ pVerticalIndices[k] } * source.width + x);
+								Store(&row[x], sum);
+							});
+
+						float* pDestination{ &destination.planes[channel][y * destination.width] };
+						if (horizontalTaps.isHalving)
+						{
+							const auto wrap{ [sourceWidth](int x) { return x >= 0 && x < sourceWidth ? x : (x % sourceWidth + sourceWidth) % sourceWidth; } };
+							for (int j{}; j < static_cast<int>(phases[0].size()); ++j)
+							{
+								const int even{ 2 * (j - padding) };
+								phases[0][j] = row[wrap(even)];
+								phases[1][j] = row[wrap(even + 1)];
+							}
+							ForEachTexel(destination.width, [&](auto tag, size_t x)
+								{
+									using T = decltype(tag);
+									T sum{ Splat<T>(0.f) };
+									for (size_t k{}; k < horizontalTaps.numTaps; ++k)
+									{
+										const int offset{ horizontalTaps.firstOffset + static_cast<int>(k) + 2 * padding };
+										sum = sum + Splat<T>(horizontalTaps.weights[k]) * Load<T>(&phases[offset & 1][x + offset / 2]);
+									}
+									Store(pDestination + x, sum);
+								});
+							continue;
+						}
+
+						for (size_t x{}; x < destination.width; ++x)
+						{
+							const uint32_t* pIndices{ &horizontalTaps.indices[x * horizontalTaps.numTaps] };
+							const float* pWeights{ &horizontalTaps.weights[x * horizontalTaps.numTaps] };
+							float sum{};
+							for (size_t k{}; k < horizontalTaps.numTaps; ++k)
+								sum += pWeights[k] * row[pIndices[k]];
+							pDestination[x] = sum;
+						}
+					}
+				}
+			}
+		}
+
+		MipStats GenerateMips(const uint8_t* pPixels, uint32_t width, uint32_t height, size_t pitch, const MipOptions& options, MipChain& chain)
+		{
+			assert(pPixels && width > 0 && height > 0 && pitch >= size_t{ width } * numChannels && "ERROR: no pixels to generate mips from!");
+			const auto startTime{ std::chrono::steady_clock::now() };
+
+			MipStats stats{};
+			stats.numLevels = GetNumLevels(width, height);
+			chain.levels.clear();
+			size_t numBytes{};
+			for (uint32_t level{}, levelWidth{ width }, levelHeight{ height }; level < stats.numLevels; ++level)
+			{
+				chain.levels.push_back({ levelWidth, levelHeight, numBytes });
+				numBytes += size_t{ levelWidth } * levelHeight * numChannels;
+				levelWidth = std::max(levelWidth / 2, 1u);
+				levelHeight = std::max(levelHeight / 2, 1u);
+			}
+			chain.pixels.resize(numBytes);
+
+			const size_t hardwareThreads{ options.numThreads != 0 ? options.numThreads : std::max(1u, std::thread::hardware_concurrency()) };
+			const auto getThreadCount{ [&](size_t numTexels) { return std::min(hardwareThreads, std::max(size_t{ 1 }, numTexels / minTexelsPerThread)); } };
+			stats.numThreads = static_cast<uint32_t>(getThreadCount(size_t{ width } * height));
+
+			// Level 0 copied as is, and decoded
+			FloatLevel source{};
+			source.Resize(width, height);
+			const DecodeTables decodeTables{ CreateDecodeTables(options.content) };
+			Utils::RunParallel(stats.numThreads, [&](size_t thread)
+				{
+					const size_t end{ GetRangeBegin(height, stats.numThreads, thread + 1) };
+					for (size_t y{ GetRangeBegin(height, stats.numThreads, thread) }; y < end; ++y)
+					{
+						const uint8_t* pRow{ pPixels + y * pitch };
+						std::memcpy(&chain.pixels[y * width * numChannels], pRow, size_t{ width } * numChannels);
+						float* pPlanes[numChannels]{};
+						for (int channel{}; channel < numChannels; ++channel)
+							pPlanes[channel] = &source.planes[channel][y * width];
+						for (size_t x{}; x < width; ++x)
+						{
+							for (int channel{}; channel < numChannels; ++channel)
+								pPlanes[channel][x] = decodeTables[channel][pRow[x * numChannels + channel]];
+						}
+					}
+				});
+
+			FloatLevel destination{};
+			for (size_t level{ 1 }; level < chain.levels.size(); ++level)
+			{
+				const MipLevel& mip{ chain.levels[level] };
+				destination.Resize(mip.width, mip.height);
+				const Taps horizontalTaps{ ComputeTaps(options.filter, source.width, mip.width) };
+				const Taps verticalTaps{ ComputeTaps(options.filter, source.height, mip.height) };
+
+				const size_t numThreads{ getThreadCount(size_t{ source.width } * source.height) };
+				Utils::RunParallel(numThreads, [&](size_t thread)
+					{
+						const size_t begin{ GetRangeBegin(mip.height, numThreads, thread) };
+						const size_t end{ GetRangeBegin(mip.height, numThreads, thread + 1) };
+						std::vector<float> row(source.width);
+						std::vector<float> encoded[numChannels];
+						for (std::vector<float>& encodedRow : encoded)
+							encodedRow.resize(mip.width);
+
+						FilterRows(source, horizontalTaps, verticalTaps, begin, end, row, destination);
+						for (size_t y{ begin }; y < end; ++y)
+							EncodeRow(destination, y, options.content, encoded, &chain.pixels[mip.offset + y * mip.width * numChannels]);
+					});
+
+				std::swap(source, destination);
+			}
+
+			stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			return stats;
+		}
+	}
+}
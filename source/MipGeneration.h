@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+namespace dae
+{
+	// Full mip chains for RGBA8 textures, built on the CPU at load time
+	namespace MipGeneration
+	{
+		enum class Filter
+		{
+			// Plain average of the texels under the smaller one, the fastest and the blurriest
+			Box,
+			// Kaiser windowed sinc, radius 3 and alpha 4, sharp with little ringing
+			Kaiser,
+			// Lanczos windowed sinc, radius 3, the sharpest and the most ringing
+			Lanczos
+		};
+
+		// What the texels hold decides how they are averaged
+		enum class Content
+		{
+			// sRGB encoded rgb averaged in linear light, alpha as stored
+			Color,
+			// Data like gloss or specular masks, every channel averaged as stored
+			Linear,
+			// Unit vectors in rgb mapped to [0, 1], averaged as vectors and written renormalized, alpha as stored
+			NormalMap
+		};
+
+		struct MipOptions
+		{
+			Content content{ Content::Color };
+			Filter filter{ Filter::Kaiser };
+			// 0 picks the hardware concurrency
+			uint32_t numThreads{};
+		};
+
+		struct MipLevel
+		{
+			uint32_t width;
+			uint32_t height;
+			// Into MipChain::pixels, rows are tightly packed
+			size_t offset;
+		};
+
+		// RGBA8, from the full size level down to 1x1
+		struct MipChain
+		{
+			std::vector<MipLevel> levels;
+			std::vector<uint8_t> pixels;
+		};
+
+		struct MipStats
+		{
+			uint32_t numLevels{};
+			uint32_t numThreads{};
+			float milliseconds{};
+		};
+
+		constexpr uint32_t GetNumLevels(uint32_t width, uint32_t height)
+		{
+			uint32_t numLevels{ 1 };
+			for (uint32_t size{ width > height ? width : height }; size > 1; size /= 2)
+				++numLevels;
+			return numLevels;
+		}
+
+		// pPixels is width x height RGBA8 with rows pitch bytes apart, copied to level 0 as is. Every smaller level is filtered from
+		// the one above it in float, separably, with edges wrapping around like the samplers do. Rows of a level are split over
+		// numThreads threads, the vertical pass runs SimdFloat::width texels at a time
+		MipStats GenerateMips(const uint8_t* pPixels, uint32_t width, uint32_t height, size_t pitch, const MipOptions& options, MipChain& chain);
+	}
+}
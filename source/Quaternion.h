@@ -0,0 +1,122 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+#include "FastMath.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace dae
+{
+	// Unit quaternions for rotations. Products compose in the same order as Matrix:
+	// a * b rotates by a first, then by b, so Matrix::CreateRotation(a * b) == Matrix::CreateRotation(a) * Matrix::CreateRotation(b)
+	struct Quaternion
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+
+		Quaternion() = default;
+		constexpr Quaternion(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+
+		// Angle in radians, counterclockwise looking down the axis
+		static Quaternion CreateFromAxisAngle(const Vector3& axis, float angle)
+		{
+			const Vector3 unitAxis{ axis.Normalized() };
+			float halfSin{}, halfCos{};
+			FastMath::SinCos(angle * 0.5f, halfSin, halfCos);
+			return { unitAxis.x * halfSin, unitAxis.y * halfSin, unitAxis.z * halfSin, halfCos };
+		}
+
+		// The same rotations as Matrix::CreateRotationX/Y/Z
+		static constexpr Quaternion CreateRotationX(float pitch)
+		{
+			float halfSin{}, halfCos{};
+			FastMath::SinCos(pitch * 0.5f, halfSin, halfCos);
+			return { -halfSin, 0.f, 0.f, halfCos };
+		}
+
+		static constexpr Quaternion CreateRotationY(float yaw)
+		{
+			float halfSin{}, halfCos{};
+			FastMath::SinCos(yaw * 0.5f, halfSin, halfCos);
+			return { 0.f, halfSin, 0.f, halfCos };
+		}
+
+		static constexpr Quaternion CreateRotationZ(float roll)
+		{
+			float halfSin{}, halfCos{};
+			FastMath::SinCos(roll * 0.5f, halfSin, halfCos);
+			return { 0.f, 0.f, halfSin, halfCos };
+		}
+
+		float Magnitude() const
+		{
+			return std::sqrt(x * x + y * y + z * z + w * w);
+		}
+
+		float Normalize()
+		{
+			const float m = Magnitude();
+			x /= m;
+			y /= m;
+			z /= m;
+			w /= m;
+
+			return m;
+		}
+
+		Quaternion Normalized() const
+		{
+			const float m = Magnitude();
+			return { x / m, y / m, z / m, w / m };
+		}
+
+		// Inverse of a unit quaternion
+		constexpr Quaternion Conjugate() const
+		{
+			return { -x, -y, -z, w };
+		}
+
+		constexpr Vector3 Rotate(const Vector3& v) const
+		{
+			// v + 2w(q x v) + 2q x (q x v), the axis being q.xyz
+			const Vector3 axis{ x, y, z };
+			const Vector3 t{ Vector3::Cross(axis, v) * 2.f };
+			return v + t * w + Vector3::Cross(axis, t);
+		}
+
+		static constexpr float Dot(const Quaternion& q1, const Quaternion& q2)
+		{
+			return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+		}
+
+		static const Quaternion Identity;
+
+		#pragma region Operator Overloads
+		// This rotation, then q
+		constexpr Quaternion operator*(const Quaternion& q) const
+		{
+			return {
+				q.w * x + w * q.x + q.y * z - q.z * y,
+				q.w * y + w * q.y + q.z * x - q.x * z,
+				q.w * z + w * q.z + q.x * y - q.y * x,
+				q.w * w - q.x * x - q.y * y - q.z * z
+			};
+		}
+
+		constexpr Quaternion& operator*=(const Quaternion& q)
+		{
+			*this = *this * q;
+			return *this;
+		}
+
+		constexpr bool operator==(const Quaternion& q) const
+		{
+			return x == q.x && y == q.y && z == q.z && w == q.w;
+		}
+		#pragma endregion
+	};
+
+	inline constexpr Quaternion Quaternion::Identity{ 0.f, 0.f, 0.f, 1.f };
+}
\ No newline at end of file
@@ -7,9 +7,31 @@
 
 #include "ShadedEffect.h"
 #include "Texture.h"
+#include "TaskGraph.h"
+#include "ResourceCache.h"
 
 namespace dae {
 
+	namespace
+	{
+		// Threads loading assets at startup, 0 picks the hardware concurrency. 1 is the serial path, every asset one after another
+		constexpr uint32_t numLoadingThreads{ 0 };
+		// Resources no mesh uses anymore are let go, least recently used first, once everything resident goes over this
+		constexpr size_t resourceBudgetBytes{ size_t{ 256 } * 1024 * 1024 };
+
+		struct TextureAsset
+		{
+			std::string path;
+			TextureCache::ImportOptions options;
+		};
+
+		void PrintResourceStats(const char* kind, const ResourceCacheStats& stats)
+		{
+			std::cout << "[RESOURCES] " << kind << ": " << stats.numResident << " resident, " << stats.residentBytes / 1024 << " KB, "
+				<< stats.pathHits << " path hits, " << stats.contentHits << " content hits, " << stats.misses << " misses, " << stats.evictions << " evictions\n";
+		}
+	}
+
 	Renderer::Renderer(SDL_Window* pWindow) :
 		m_pWindow(pWindow)
 	{
@@ -27,6 +49,7 @@ namespace dae {
 		{
 			std::cout << "DirectX initialization failed!\n";
 		}
+		m_pResourceCache = std::make_unique<ResourceCache>(m_pDevice, resourceBudgetBytes);
 
 		// Camera
 		m_Camera.Initialize(45.f,{0.f,0.f,-50.f},static_cast<float>(m_Width)/m_Height);
@@ -42,25 +65,95 @@ namespace dae {
 		
 		m_pMesh = new Mesh{ m_pDevice, vertices, indices };*/
 
-		auto pShadedEffect{ std::make_unique<ShadedEffect>(m_pDevice, L"Resources/PosCol3D.fx") };
+		// Every asset loads in two tasks: a worker reads, decodes or compiles it, then this thread adds it to the resource cache once
+		// the pool has joined. The meshes are placed last and find everything they use in the cache by path. The pool keeps every
+		// thread busy already, so the workers import on one thread each instead of starting pools of their own
+		TaskGraph loading{};
+		using Affinity = TaskGraph::Affinity;
 
-		Texture vehicleDiffuseTexture{ "Resources/vehicle_diffuse.png", m_pDevice };
-		Texture vehicleNormalTexture{ "Resources/vehicle_normal.png", m_pDevice };
-		Texture vehicleSpecularTexture{ "Resources/vehicle_specular.png", m_pDevice };
-		Texture vehicleGlossinessTexture{ "Resources/vehicle_gloss.png", m_pDevice };
-		pShadedEffect->SetDiffuseMap(&vehicleDiffuseTexture);
-		pShadedEffect->SetNormalMap(&vehicleNormalTexture);
-		pShadedEffect->SetSpecularMap(&vehicleSpecularTexture);
-		pShadedEffect->SetGlossinessMap(&vehicleGlossinessTexture);
+		const auto addTexture{ [&loading, this](const TextureAsset& texture)
+			{
+				const auto pData{ std::make_shared<TextureData>() };
+				TextureCache::ImportOptions importOptions{ texture.options };
+				importOptions.mips.numThreads = 1;
+				importOptions.compression.numThreads = 1;
+				const TaskGraph::TaskId load{ loading.Add(texture.path, [pData, texture, importOptions]() { *pData = Texture::Load(texture.path, importOptions); }) };
+				return loading.Add(texture.path + " (upload)", [pData, texture, this]() { m_pResourceCache->AddTexture(texture.path, texture.options, *pData); },
+					{ load }, Affinity::MainThread);
+			} };
+		const auto addEffect{ [&loading](const std::string& path, VertexFormat vertexFormat, std::function<void(const EffectData&)> create)
+			{
+				const auto pData{ std::make_shared<EffectData>() };
+				const TaskGraph::TaskId compile{ loading.Add(path,
+					[pData, path, vertexFormat]() { *pData = Effect::Compile(std::wstring(path.begin(), path.end()), vertexFormat); }) };
+				return loading.Add(path + " (create)", [pData, create]() { create(*pData); }, { compile }, Affinity::MainThread);
+			} };
+		const auto addMeshGeometry{ [&loading, this](const std::string& path, VertexFormat vertexFormat)
+			{
+				const auto pData{ std::make_shared<MeshData>() };
+				const TaskGraph::TaskId load{ loading.Add(path, [pData, path, vertexFormat]() { *pData = MeshGeometry::Load(path, vertexFormat, 1); }) };
+				return loading.Add(path + " (upload)", [pData, path, vertexFormat, this]() { m_pResourceCache->AddMeshGeometry(path, std::move(*pData), vertexFormat); },
+					{ load }, Affinity::MainThread);
+			} };
+		const auto getTexture{ [this](const TextureAsset& texture) { return m_pResourceCache->GetTexture(texture.path, texture.options); } };
+
+		// Vehicle, formats by what the maps hold: the specular map is coloured, the gloss map grey, the shader rebuilds the normal's z
+		const TextureAsset vehicleDiffuseMap{ "Resources/vehicle_diffuse.png", { { MipGeneration::Content::Color }, true, { BlockCompression::Format::BC7 } } };
+		const TextureAsset vehicleNormalMap{ "Resources/vehicle_normal.png", { { MipGeneration::Content::NormalMap }, true, { BlockCompression::Format::BC5 } } };
+		const TextureAsset vehicleSpecularMap{ "Resources/vehicle_specular.png", { { MipGeneration::Content::Linear }, true, { BlockCompression::Format::BC1 } } };
+		const TextureAsset vehicleGlossinessMap{ "Resources/vehicle_gloss.png", { { MipGeneration::Content::Linear }, true, { BlockCompression::Format::BC4 } } };
+		const std::string vehicleGeometry{ "Resources/vehicle.obj" };
+		const std::string shadedEffect{ "Resources/PosCol3D.fx" };
+
+		const TaskGraph::TaskId vehicleDependencies[]
+		{
+			addTexture(vehicleDiffuseMap),
+			addTexture(vehicleNormalMap),
+			addTexture(vehicleSpecularMap),
+			addTexture(vehicleGlossinessMap),
+			addEffect(shadedEffect, VertexFormat::Packed, [&](const EffectData& data) { m_pResourceCache->AddEffect<ShadedEffect>(shadedEffect, data); }),
+			addMeshGeometry(vehicleGeometry, VertexFormat::Packed)
+		};
+		loading.Add("Vehicle", [&]()
+			{
+				const Material material{ getTexture(vehicleDiffuseMap), getTexture(vehicleNormalMap), getTexture(vehicleSpecularMap), getTexture(vehicleGlossinessMap) };
+				m_pMeshes.push_back(new Mesh{ m_pDevice, m_pResourceCache->GetMeshGeometry(vehicleGeometry, VertexFormat::Packed),
+					m_pResourceCache->GetEffect<ShadedEffect>(shadedEffect, VertexFormat::Packed), material });
+			}, { std::begin(vehicleDependencies), std::end(vehicleDependencies) }, Affinity::MainThread);
 
-		m_pMeshes.push_back(new Mesh{ m_pDevice, "Resources/vehicle.obj", std::move(pShadedEffect) });
+		// Fire
+		const TextureAsset fireDiffuseMap{ "Resources/fireFX_diffuse.png", { { MipGeneration::Content::Color }, true, { BlockCompression::Format::BC7 } } };
+		const std::string fireGeometry{ "Resources/fireFX.obj" };
+		const std::string transparentEffect{ "Resources/Transparent3D.fx" };
 
-		auto pTransparentEffect{ std::make_unique<Effect>(m_pDevice, L"Resources/Transparent3D.fx") };
+		const TaskGraph::TaskId fireDependencies[]
+		{
+			addTexture(fireDiffuseMap),
+			addEffect(transparentEffect, VertexFormat::Packed, [&](const EffectData& data) { m_pResourceCache->AddEffect(transparentEffect, data); }),
+			addMeshGeometry(fireGeometry, VertexFormat::Packed)
+		};
+		loading.Add("Fire", [&]()
+			{
+				m_pMeshes.push_back(new Mesh{ m_pDevice, m_pResourceCache->GetMeshGeometry(fireGeometry, VertexFormat::Packed),
+					m_pResourceCache->GetEffect(transparentEffect, VertexFormat::Packed), { getTexture(fireDiffuseMap) } });
+			}, { std::begin(fireDependencies), std::end(fireDependencies) }, Affinity::MainThread);
+
+		const TaskGraphStats loadingStats{ loading.Run(numLoadingThreads) };
+		for (TaskGraph::TaskId i{}; i < loading.GetNumTasks(); ++i)
+		{
+			const TaskStats& taskStats{ loading.GetStats(i) };
+			std::cout << "[LOADING] " << loading.GetName(i) << ": " << taskStats.milliseconds << " ms on thread " << taskStats.thread
+				<< ", started at " << taskStats.startMilliseconds << " ms\n";
+		}
+		std::cout << "[LOADING] " << loadingStats.numTasks << " tasks in " << loadingStats.milliseconds << " ms on " << loadingStats.numThreads
+			<< " thread(s), " << loadingStats.taskMilliseconds << " ms one after another (" << loadingStats.taskMilliseconds / loadingStats.milliseconds << "x)\n";
 
-		Texture fireDiffuseTexture{ "Resources/fireFX_diffuse.png",m_pDevice };
-		pTransparentEffect->SetDiffuseMap(&fireDiffuseTexture);
+		PrintResourceStats("Textures", m_pResourceCache->GetTextureStats());
+		PrintResourceStats("Effects", m_pResourceCache->GetEffectStats());
+		PrintResourceStats("Mesh geometry", m_pResourceCache->GetMeshGeometryStats());
 
-		m_pMeshes.push_back(new Mesh{ m_pDevice,"Resources/fireFX.obj",std::move(pTransparentEffect) });
+		// Until the first Update culls
+		m_IsMeshVisible.assign(m_pMeshes.size(), 1);
 	}
 
 	Renderer::~Renderer()
@@ -74,6 +167,8 @@ namespace dae {
 			SAFE_DELETE(pMesh);
 		}
 		m_pMeshes.clear();
+		// Whatever the meshes shared goes with the cache, while the device is still there
+		m_pResourceCache.reset();
 
 		SAFE_RELEASE(m_pRenderTargetView);
 		SAFE_RELEASE(m_pRenderTargetBuffer);
@@ -104,15 +199,36 @@ namespace dae {
 		constexpr const float rotationSpeed{ 30.f };
 		if (m_EnableRotating)
 		{
+			// Twice the speed, in one rotation per mesh
+			const float angle{ 2.f * rotationSpeed * TO_RADIANS * pTimer->GetElapsed() };
 			for (const auto& pMesh : m_pMeshes)
 			{
-				pMesh->RotateY(rotationSpeed * TO_RADIANS * pTimer->GetElapsed());
-				pMesh->RotateY(rotationSpeed * TO_RADIANS * pTimer->GetElapsed());
+				pMesh->RotateY(angle);
 			}
 		}
+
+		// World matrices of whatever moved, all in one go
+		m_MeshTransforms.clear();
+		for (const auto& pMesh : m_pMeshes)
+		{
+			m_MeshTransforms.push_back(&pMesh->GetTransform());
+		}
+		Transform::UpdateWorldMatrices(m_MeshTransforms);
+
+		// Meshes outside the frustum skip their update here and their draw in Render
+		m_MeshBounds.clear();
 		for (const auto& pMesh : m_pMeshes)
 		{
-			pMesh->UpdateViewMatrices(m_Camera.GetWorldViewProjection(), m_Camera.GetInverseViewMatrix());
+			m_MeshBounds.push_back(pMesh->GetWorldBoundingVolume());
+		}
+		m_FrustumCullStats = CullBoundingVolumes(m_Camera.GetWorldViewProjection(), m_MeshBounds, m_IsMeshVisible);
+
+		for (size_t i{}; i < m_pMeshes.size(); ++i)
+		{
+			if (!m_IsMeshVisible[i])
+				continue;
+			m_pMeshes[i]->SelectLevelOfDetail(m_Camera.origin, m_Camera.fov, static_cast<float>(m_Height));
+			m_pMeshes[i]->UpdateViewMatrices(m_Camera.GetWorldViewProjection(), m_Camera.GetInverseViewMatrix());
 		}
 
 		const uint8_t* pKeyboardState = SDL_GetKeyboardState(nullptr);
@@ -143,6 +259,11 @@ namespace dae {
 	}
 
 
+	const FrustumCullStats& Renderer::GetFrustumCullStats() const
+	{
+		return m_FrustumCullStats;
+	}
+
 	void Renderer::Render() const
 	{
 		if (!m_IsInitialized)
@@ -154,9 +275,10 @@ namespace dae {
 		m_pDeviceContext->ClearDepthStencilView(m_pDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 
 		// 2. Set pipeline + Invoke drawcalls (= render)
-		for (const auto& pMesh : m_pMeshes)
+		for (size_t i{}; i < m_pMeshes.size(); ++i)
 		{
-			pMesh->Render(m_pDeviceContext);
+			if (m_IsMeshVisible[i])
+				m_pMeshes[i]->Render(m_pDeviceContext);
 		}
 
 		// 3. Present backbuffer (swap)
@@ -1,5 +1,8 @@
 #pragma once
+#include <memory>
 #include "Camera.h"
+#include "FrustumCulling.h"
+#include "Transform.h"
 
 struct SDL_Window;
 struct SDL_Surface;
@@ -7,6 +10,7 @@ struct SDL_Surface;
 namespace dae
 {
 	class Mesh;
+	class ResourceCache;
 
 	class Renderer final
 	{
@@ -22,6 +26,9 @@ namespace dae
 		void Update(const Timer* pTimer);
 		void Render() const;
 
+		// Meshes tested against the camera frustum by the last Update
+		const FrustumCullStats& GetFrustumCullStats() const;
+
 	private:
 		SDL_Window* m_pWindow{};
 
@@ -50,6 +57,13 @@ namespace dae
 		ID3D11Resource* m_pRenderTargetBuffer{};
 		ID3D11RenderTargetView* m_pRenderTargetView{};
 
+		// Textures, effects and mesh geometry, shared by the meshes
+		std::unique_ptr<ResourceCache> m_pResourceCache{};
 		std::vector<Mesh*> m_pMeshes;
+		// Per mesh, refilled every Update
+		std::vector<Transform*> m_MeshTransforms;
+		std::vector<BoundingVolume> m_MeshBounds;
+		std::vector<uint8_t> m_IsMeshVisible;
+		FrustumCullStats m_FrustumCullStats{};
 	};
 }
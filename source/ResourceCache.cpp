@@ -0,0 +1,223 @@
+#include "pch.h"
+#include "ResourceCache.h"
+#include "Utils.h"
+
+#include <cassert>
+
+namespace dae
+{
+	namespace
+	{
+		// variant is whatever else decides what gets created from the file: import options, vertex format, effect type
+		uint64_t GetPathKey(const std::string& path, uint64_t variant)
+		{
+			return Utils::HashBytes(path.data(), path.size(), variant);
+		}
+
+		uint64_t GetContentKey(uint64_t contentHash, uint64_t variant)
+		{
+			return Utils::HashBytes(&variant, sizeof(variant), contentHash);
+		}
+
+		uint64_t GetEffectVariant(VertexFormat vertexFormat, const std::type_info& type)
+		{
+			const uint64_t typeHash{ type.hash_code() };
+			return Utils::HashBytes(&vertexFormat, sizeof(vertexFormat), typeHash);
+		}
+
+		void AddStats(ResourceCacheStats& total, const ResourceCacheStats& stats)
+		{
+			total.pathHits += stats.pathHits;
+			total.contentHits += stats.contentHits;
+			total.misses += stats.misses;
+			total.evictions += stats.evictions;
+			total.numResident += stats.numResident;
+			total.residentBytes += stats.residentBytes;
+		}
+	}
+
+	template<typename Resource>
+	std::shared_ptr<Resource> ResourceCache::Find(Pool<Resource>& pool, uint64_t pathKey)
+	{
+		const auto path{ pool.paths.find(pathKey) };
+		if (path == pool.paths.end())
+			return nullptr;
+
+		const auto entry{ pool.entries.find(path->second) };
+		assert(entry != pool.entries.end() && "ERROR: evicting has to forget every path of an entry!");
+		entry->second.lastUse = ++m_NumRequests;
+		++pool.stats.pathHits;
+		return entry->second.pResource;
+	}
+
+	template<typename Resource>
+	std::shared_ptr<Resource> ResourceCache::Insert(Pool<Resource>& pool, uint64_t pathKey, uint64_t contentKey,
+		const std::function<std::shared_ptr<Resource>()>& create)
+	{
+		const auto entry{ pool.entries.find(contentKey) };
+		if (entry != pool.entries.end())
+		{
+			// Same content under another path, or the same path loaded twice
+			pool.paths[pathKey] = contentKey;
+			entry->second.lastUse = ++m_NumRequests;
+			++pool.stats.contentHits;
+			return entry->second.pResource;
+		}
+
+		std::shared_ptr<Resource> pResource{ create() };
+		const size_t sizeInBytes{ pResource->GetSizeInBytes() };
+		pool.entries.emplace(contentKey, typename Pool<Resource>::Entry{ pResource, sizeInBytes, ++m_NumRequests });
+		pool.paths[pathKey] = contentKey;
+		++pool.stats.misses;
+		++pool.stats.numResident;
+		pool.stats.residentBytes += sizeInBytes;
+
+		// pResource is held here, it can't be the one to go
+		Trim();
+		return pResource;
+	}
+
+	template<typename Resource>
+	typename std::unordered_map<uint64_t, typename ResourceCache::Pool<Resource>::Entry>::iterator ResourceCache::FindEvictable(Pool<Resource>& pool)
+	{
+		auto leastRecentlyUsed{ pool.entries.end() };
+		for (auto entry{ pool.entries.begin() }; entry != pool.entries.end(); ++entry)
+		{
+			if (entry->second.pResource.use_count() == 1
+				&& (leastRecentlyUsed == pool.entries.end() || entry->second.lastUse < leastRecentlyUsed->second.lastUse))
+				leastRecentlyUsed = entry;
+		}
+		return leastRecentlyUsed;
+	}
+
+	template<typename Resource>
+	void ResourceCache::Evict(Pool<Resource>& pool, typename std::unordered_map<uint64_t, typename Pool<Resource>::Entry>::iterator entry)
+	{
+		const uint64_t contentKey{ entry->first };
+		for (auto path{ pool.paths.begin() }; path != pool.paths.end();)
+		{
+			if (path->second == contentKey)
+				path = pool.paths.erase(path);
+			else
+				++path;
+		}
+
+		++pool.stats.evictions;
+		--pool.stats.numResident;
+		pool.stats.residentBytes -= entry->second.sizeInBytes;
+		pool.entries.erase(entry);
+	}
+
+	ResourceCache::ResourceCache(ID3D11Device* pDevice, size_t budgetBytes)
+		: m_pDevice{ pDevice }
+		, m_BudgetBytes{ budgetBytes }
+	{
+	}
+
+	std::shared_ptr<Texture> ResourceCache::GetTexture(const std::string& path, const TextureCache::ImportOptions& options)
+	{
+		if (std::shared_ptr<Texture> pTexture{ Find(m_Textures, GetPathKey(path, TextureCache::GetImportKey(options))) })
+			return pTexture;
+		return AddTexture(path, options, Texture::Load(path, options));
+	}
+
+	std::shared_ptr<Texture> ResourceCache::AddTexture(const std::string& path, const TextureCache::ImportOptions& options, const TextureData& data)
+	{
+		// The content hash covers the uploaded levels, the import key keeps the options apart as for the path
+		const uint32_t importKey{ TextureCache::GetImportKey(options) };
+		return Insert<Texture>(m_Textures, GetPathKey(path, importKey), GetContentKey(data.contentHash, importKey),
+			[this, &data]() { return std::make_shared<Texture>(data, m_pDevice); });
+	}
+
+	std::shared_ptr<Effect> ResourceCache::FindEffect(const std::string& path, VertexFormat vertexFormat, const std::type_info& type)
+	{
+		return Find(m_Effects, GetPathKey(path, GetEffectVariant(vertexFormat, type)));
+	}
+
+	std::shared_ptr<Effect> ResourceCache::AddEffect(const std::string& path, const EffectData& data, const std::type_info& type,
+		const std::function<std::shared_ptr<Effect>()>& create)
+	{
+		const uint64_t variant{ GetEffectVariant(data.vertexFormat, type) };
+		return Insert(m_Effects, GetPathKey(path, variant), GetContentKey(data.contentHash, variant), create);
+	}
+
+	std::shared_ptr<MeshGeometry> ResourceCache::GetMeshGeometry(const std::string& path, VertexFormat vertexFormat)
+	{
+		if (std::shared_ptr<MeshGeometry> pGeometry{ Find(m_MeshGeometries, GetPathKey(path, static_cast<uint64_t>(vertexFormat))) })
+			return pGeometry;
+		return AddMeshGeometry(path, MeshGeometry::Load(path, vertexFormat), vertexFormat);
+	}
+
+	std::shared_ptr<MeshGeometry> ResourceCache::AddMeshGeometry(const std::string& path, MeshData&& data, VertexFormat vertexFormat)
+	{
+		// The buffers are packed for the vertex format, equal files with different formats are different geometry
+		const uint64_t variant{ static_cast<uint64_t>(vertexFormat) };
+		return Insert<MeshGeometry>(m_MeshGeometries, GetPathKey(path, variant), GetContentKey(data.contentHash, variant),
+			[this, &data, vertexFormat]() { return std::make_shared<MeshGeometry>(m_pDevice, std::move(data), vertexFormat); });
+	}
+
+	void ResourceCache::SetBudget(size_t budgetBytes)
+	{
+		m_BudgetBytes = budgetBytes;
+		Trim();
+	}
+
+	size_t ResourceCache::GetBudget() const
+	{
+		return m_BudgetBytes;
+	}
+
+	void ResourceCache::Trim()
+	{
+		while (GetResidentBytes() > m_BudgetBytes)
+		{
+			// Least recently used over all three pools
+			const auto texture{ FindEvictable(m_Textures) };
+			const auto effect{ FindEvictable(m_Effects) };
+			const auto meshGeometry{ FindEvictable(m_MeshGeometries) };
+			const uint64_t textureUse{ texture != m_Textures.entries.end() ? texture->second.lastUse : UINT64_MAX };
+			const uint64_t effectUse{ effect != m_Effects.entries.end() ? effect->second.lastUse : UINT64_MAX };
+			const uint64_t meshGeometryUse{ meshGeometry != m_MeshGeometries.entries.end() ? meshGeometry->second.lastUse : UINT64_MAX };
+
+			// Everything left is in use
+			if (textureUse == UINT64_MAX && effectUse == UINT64_MAX && meshGeometryUse == UINT64_MAX)
+				return;
+
+			if (textureUse < effectUse && textureUse < meshGeometryUse)
+				Evict(m_Textures, texture);
+			else if (effectUse < meshGeometryUse)
+				Evict(m_Effects, effect);
+			else
+				Evict(m_MeshGeometries, meshGeometry);
+		}
+	}
+
+	const ResourceCacheStats& ResourceCache::GetTextureStats() const
+	{
+		return m_Textures.stats;
+	}
+
+	const ResourceCacheStats& ResourceCache::GetEffectStats() const
+	{
+		return m_Effects.stats;
+	}
+
+	const ResourceCacheStats& ResourceCache::GetMeshGeometryStats() const
+	{
+		return m_MeshGeometries.stats;
+	}
+
+	ResourceCacheStats ResourceCache::GetStats() const
+	{
+		ResourceCacheStats stats{};
+		AddStats(stats, m_Textures.stats);
+		AddStats(stats, m_Effects.stats);
+		AddStats(stats, m_MeshGeometries.stats);
+		return stats;
+	}
+
+	size_t ResourceCache::GetResidentBytes() const
+	{
+		return m_Textures.stats.residentBytes + m_Effects.stats.residentBytes + m_MeshGeometries.stats.residentBytes;
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include "Texture.h"
+#include "Effect.h"
+#include "MeshGeometry.h"
+
+namespace dae
+{
+	struct ResourceCacheStats
+	{
+		// Found by path, nothing was loaded
+		uint32_t pathHits{};
+		// Loaded under a new path but equal to a resident resource, which is shared instead of creating another
+		uint32_t contentHits{};
+		// Created
+		uint32_t misses{};
+		uint32_t evictions{};
+
+		uint32_t numResident{};
+		size_t residentBytes{};
+	};
+
+	// Hands out shared textures, effects and mesh geometry, so every Mesh using the same file uses the same device resources.
+	// Resources are found by path and, once loaded, by content: two paths to equal files end up as one resource.
+	// The cache keeps what it created alive for later requests, and only lets go of the least recently used resources nothing else
+	// holds on to once it is over budget. Main thread only, like the device calls it makes
+	class ResourceCache final
+	{
+	public:
+		explicit ResourceCache(ID3D11Device* pDevice, size_t budgetBytes = SIZE_MAX);
+		~ResourceCache() = default;
+
+		ResourceCache(const ResourceCache& other) = delete;
+		ResourceCache& operator=(const ResourceCache& other) = delete;
+		ResourceCache(ResourceCache&& other) = delete;
+		ResourceCache& operator=(ResourceCache&& other) = delete;
+
+		// The resident texture, otherwise Texture::Load then AddTexture
+		std::shared_ptr<Texture> GetTexture(const std::string& path, const TextureCache::ImportOptions& options = {});
+		// For data loaded elsewhere, on a worker thread say. Only creates the texture when no resident one has the same content
+		std::shared_ptr<Texture> AddTexture(const std::string& path, const TextureCache::ImportOptions& options, const TextureData& data);
+
+		// The resident effect, otherwise Effect::Compile then AddEffect. Effects of different types never share
+		template<typename EffectType = Effect>
+		std::shared_ptr<EffectType> GetEffect(const std::string& path, VertexFormat vertexFormat = VertexFormat::Full)
+		{
+			if (std::shared_ptr<Effect> pEffect{ FindEffect(path, vertexFormat, typeid(EffectType)) })
+				return std::static_pointer_cast<EffectType>(pEffect);
+			return AddEffect<EffectType>(path, Effect::Compile(std::wstring(path.begin(), path.end()), vertexFormat));
+		}
+		template<typename EffectType = Effect>
+		std::shared_ptr<EffectType> AddEffect(const std::string& path, const EffectData& data)
+		{
+			return std::static_pointer_cast<EffectType>(AddEffect(path, data, typeid(EffectType),
+				[this, &data]() -> std::shared_ptr<Effect> { return std::make_shared<EffectType>(m_pDevice, data); }));
+		}
+
+		// The resident geometry, otherwise MeshGeometry::Load then AddMeshGeometry
+		std::shared_ptr<MeshGeometry> GetMeshGeometry(const std::string& path, VertexFormat vertexFormat);
+		std::shared_ptr<MeshGeometry> AddMeshGeometry(const std::string& path, MeshData&& data, VertexFormat vertexFormat);
+
+		// Evicts right away when the resident resources no longer fit
+		void SetBudget(size_t budgetBytes);
+		size_t GetBudget() const;
+		// Evicts the least recently used resources only the cache holds until the rest fits the budget, or nothing is left to evict.
+		// Adding does this already
+		void Trim();
+
+		const ResourceCacheStats& GetTextureStats() const;
+		const ResourceCacheStats& GetEffectStats() const;
+		const ResourceCacheStats& GetMeshGeometryStats() const;
+		// All of the above summed
+		ResourceCacheStats GetStats() const;
+		size_t GetResidentBytes() const;
+
+	private:
+		template<typename Resource>
+		struct Pool
+		{
+			struct Entry
+			{
+				std::shared_ptr<Resource> pResource;
+				size_t sizeInBytes;
+				// m_NumRequests when it was last handed out
+				uint64_t lastUse;
+			};
+
+			// By content key
+			std::unordered_map<uint64_t, Entry> entries{};
+			// Path key => content key, an entry can be reached through several paths
+			std::unordered_map<uint64_t, uint64_t> paths{};
+			ResourceCacheStats stats{};
+		};
+
+		template<typename Resource>
+		std::shared_ptr<Resource> Find(Pool<Resource>& pool, uint64_t pathKey);
+		template<typename Resource>
+		std::shared_ptr<Resource> Insert(Pool<Resource>& pool, uint64_t pathKey, uint64_t contentKey, const std::function<std::shared_ptr<Resource>()>& create);
+		// The least recently used entry only the cache holds, entries.end() when every one is in use
+		template<typename Resource>
+		static typename std::unordered_map<uint64_t, typename Pool<Resource>::Entry>::iterator FindEvictable(Pool<Resource>& pool);
+		template<typename Resource>
+		static void Evict(Pool<Resource>& pool, typename std::unordered_map<uint64_t, typename Pool<Resource>::Entry>::iterator entry);
+
+		std::shared_ptr<Effect> FindEffect(const std::string& path, VertexFormat vertexFormat, const std::type_info& type);
+		std::shared_ptr<Effect> AddEffect(const std::string& path, const EffectData& data, const std::type_info& type,
+			const std::function<std::shared_ptr<Effect>()>& create);
+
+		ID3D11Device* m_pDevice;
+		size_t m_BudgetBytes;
+		uint64_t m_NumRequests{};
+
+		Pool<Texture> m_Textures{};
+		Pool<Effect> m_Effects{};
+		Pool<MeshGeometry> m_MeshGeometries{};
+	};
+}
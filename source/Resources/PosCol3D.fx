@@ -59,12 +59,23 @@ DepthStencilState gDepthStencilState
 // -----------------------------------------------------
 // Input/Output structs
 // -----------------------------------------------------
+// PACKED_VERTICES or FULL_VERTICES is defined by the Effect, matching the mesh vertex buffer
 struct VS_INPUT
 {
+#ifdef PACKED_VERTICES
+    // UNORM against the mesh bounds (gWorldViewProj dequantizes), w: tangent handedness 0/1
+    float4 Position : POSITION;
+    float2 UV : TEXCOORD;
+    // Octahedral
+    float2 Normal : NORMAL;
+    float2 Tangent : TANGENT;
+#else
     float3 Position : POSITION;
     float2 UV : TEXCOORD;
     float3 Normal : NORMAL;
-    float3 Tangent : TANGENT;
+    // w: bitangent sign
+    float4 Tangent : TANGENT;
+#endif
 };
 
 struct VS_OUTPUT
@@ -74,8 +85,17 @@ struct VS_OUTPUT
     float2 UV : TEXCOORD;
     float3 Normal : NORMAL;
     float3 Tangent : TANGENT;
+    float TangentSign : TANGENTSIGN;
 };
 
+float3 DecodeOctahedral(float2 encoded)
+{
+    float3 direction = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    const float fold = saturate(-direction.z);
+    direction.xy += direction.xy >= 0.0f ? -fold : fold;
+    return normalize(direction);
+}
+
 //------------------------------------------------
 // BRDF
 //------------------------------------------------
@@ -103,10 +123,17 @@ float CalculatePhong(float ks, float exp, float3 l, float3 v, float3 n)
 VS_OUTPUT VS(VS_INPUT input)
 {
     VS_OUTPUT output = (VS_OUTPUT)0;
-    output.Position = mul(float4(input.Position,1.f),gWorldViewProj);
+    output.Position = mul(float4(input.Position.xyz,1.f),gWorldViewProj);
     output.UV = input.UV;
-    output.Tangent = mul(normalize(input.Tangent), (float3x3)gWorldMatrix);
+#ifdef PACKED_VERTICES
+    output.Tangent = mul(DecodeOctahedral(input.Tangent), (float3x3)gWorldMatrix);
+	output.Normal = mul(DecodeOctahedral(input.Normal), (float3x3)gWorldMatrix);
+    output.TangentSign = input.Position.w * 2.0f - 1.0f;
+#else
+    output.Tangent = mul(normalize(input.Tangent.xyz), (float3x3)gWorldMatrix);
 	output.Normal = mul(normalize(input.Normal), (float3x3)gWorldMatrix);
+    output.TangentSign = input.Tangent.w;
+#endif
     return output;
 }
 
@@ -116,9 +143,11 @@ VS_OUTPUT VS(VS_INPUT input)
 
 float4 PS_Phong(VS_OUTPUT input, SamplerState state) : SV_TARGET
 {
-    const float3 binormal = cross(input.Normal, input.Tangent);
+    const float3 binormal = cross(input.Normal, input.Tangent) * input.TangentSign;
 	const float4x4 tangentSpaceAxis = float4x4(float4(input.Tangent, 0.0f), float4(binormal, 0.0f), float4(input.Normal, 0.0), float4(0.0f, 0.0f, 0.0f, 1.0f));
-	const float3 currentNormalMap = 2.0f * gNormalMap.Sample(state, input.UV).rgb - float3(1.0f, 1.0f, 1.0f);
+	// BC5 keeps x and y only, z is rebuilt from the unit length
+	const float2 normalMapXY = 2.0f * gNormalMap.Sample(state, input.UV).rg - float2(1.0f, 1.0f);
+	const float3 currentNormalMap = float3(normalMapXY, sqrt(saturate(1.0f - dot(normalMapXY, normalMapXY))));
 	const float3 normal = mul(float4(currentNormalMap, 0.0f), tangentSpaceAxis);
 
 	const float3 viewDirection = normalize(input.WorldPosition.xyz - gViewInverseMatrix[3].xyz);
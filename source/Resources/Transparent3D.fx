@@ -74,12 +74,23 @@ DepthStencilState gDepthStencilState
 // -----------------------------------------------------
 // Input/Output structs
 // -----------------------------------------------------
+// PACKED_VERTICES or FULL_VERTICES is defined by the Effect, matching the mesh vertex buffer
 struct VS_INPUT
 {
+#ifdef PACKED_VERTICES
+    // UNORM against the mesh bounds (gWorldViewProj dequantizes), w: tangent handedness 0/1
+    float4 Position : POSITION;
+    float2 UV : TEXCOORD;
+    // Octahedral
+    float2 Normal : NORMAL;
+    float2 Tangent : TANGENT;
+#else
     float3 Position : POSITION;
     float2 UV : TEXCOORD;
     float3 Normal : NORMAL;
-    float3 Tangent : TANGENT;
+    // w: bitangent sign
+    float4 Tangent : TANGENT;
+#endif
 };
 
 struct VS_OUTPUT
@@ -94,7 +105,7 @@ struct VS_OUTPUT
 VS_OUTPUT VS(VS_INPUT input)
 {
     VS_OUTPUT output = (VS_OUTPUT)0;
-    output.Position = mul(float4(input.Position,1.f),gWorldViewProj);
+    output.Position = mul(float4(input.Position.xyz,1.f),gWorldViewProj);
     output.UV = input.UV;
     return output;
 }
@@ -2,8 +2,13 @@
 #include "ShadedEffect.h"
 #include "Texture.h"
 
-dae::ShadedEffect::ShadedEffect(ID3D11Device* pDevice, const std::wstring& assetFile)
-	:Effect(pDevice,assetFile)
+dae::ShadedEffect::ShadedEffect(ID3D11Device* pDevice, const std::wstring& assetFile, VertexFormat vertexFormat)
+	:ShadedEffect(pDevice, Compile(assetFile, vertexFormat))
+{
+}
+
+dae::ShadedEffect::ShadedEffect(ID3D11Device* pDevice, const EffectData& data)
+	:Effect(pDevice,data)
 {
 	m_pNormalMapVariable = m_pEffect->GetVariableByName("gNormalMap")->AsShaderResource();
 	if (!m_pNormalMapVariable->IsValid())
@@ -64,6 +69,17 @@ void dae::ShadedEffect::SetGlossinessMap(Texture* pGlossinessTexture)
 	}
 }
 
+void dae::ShadedEffect::SetMaterial(const Material& material)
+{
+	Effect::SetMaterial(material);
+	if (material.pNormalMap)
+		SetNormalMap(material.pNormalMap.get());
+	if (material.pSpecularMap)
+		SetSpecularMap(material.pSpecularMap.get());
+	if (material.pGlossinessMap)
+		SetGlossinessMap(material.pGlossinessMap.get());
+}
+
 void dae::ShadedEffect::SetWorldMatrix(const Matrix& matrix)
 {
 	m_pWorldVariable->SetMatrix(reinterpret_cast<const float*>(&matrix));
@@ -71,5 +87,5 @@ void dae::ShadedEffect::SetWorldMatrix(const Matrix& matrix)
 
 void dae::ShadedEffect::SetInverseViewMatrix(const Matrix& matrix)
 {
-	m_pWorldVariable->SetMatrix(reinterpret_cast<const float*>(&matrix));
+	m_pViewInverseVariable->SetMatrix(reinterpret_cast<const float*>(&matrix));
 }
@@ -6,7 +6,8 @@ namespace dae
 	class ShadedEffect final : public Effect
 	{
 	public:
-		ShadedEffect(ID3D11Device* pDevice, const std::wstring& assetFile);
+		ShadedEffect(ID3D11Device* pDevice, const std::wstring& assetFile, VertexFormat vertexFormat = VertexFormat::Full);
+		ShadedEffect(ID3D11Device* pDevice, const EffectData& data);
 		virtual ~ShadedEffect();
 
 		ShadedEffect(const ShadedEffect& other) = delete;
@@ -17,6 +18,7 @@ namespace dae
 		void SetNormalMap(Texture* pNormalTexture);
 		void SetSpecularMap(Texture* pSpecularTexture);
 		void SetGlossinessMap(Texture* pGlossinessTexture);
+		virtual void SetMaterial(const Material& material) override;
 
 		virtual void SetWorldMatrix(const Matrix& matrix) override;
 		virtual void SetInverseViewMatrix(const Matrix& matrix) override;
@@ -0,0 +1,364 @@
+#include "pch.h"
+#include "TangentSpace.h"
+#include "Utils.h"
+
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "FastMath.h"
+
+// Follows the math backend, so DAE_MATH_SCALAR turns this off as well
+#if defined(DAE_MATH_SSE)
+#define DAE_TANGENT_SPACE_SSE2
+#endif
+
+namespace dae
+{
+	namespace
+	{
+		// Less work than this per thread and spawning it costs more than it saves
+		constexpr size_t minTrianglesPerThread{ 16 * 1024 };
+
+		// One entry per triangle
+		struct FaceFrames
+		{
+			// Unit dP/du, zero for degenerate faces
+			std::vector<float> tangentX, tangentY, tangentZ;
+			// Angle at each corner in the tangent plane of its vertex normal, the corner's weight, 0 for degenerate faces.
+			// Negative where dP/du x dP/dv points away from the vertex normal, the uv mapping is mirrored there
+			std::vector<float> angle[3];
+		};
+
+		// Abramowitz and Stegun 4.4.45, off by less than 7e-5 radians, plenty for a weight
+		inline float FastAcos(float x)
+		{
+			const float absX{ std::abs(x) };
+			const float result{ std::sqrt(std::max(1.f - absX, 0.f)) * (((-0.0187293f * absX + 0.0742610f) * absX - 0.2121144f) * absX + 1.5707288f) };
+			return x < 0.f ? PI - result : result;
+		}
+
+		// Zero for lengths outside the normal float range as well, where the squared length under- or overflows
+		inline Vector3 NormalizedOrZero(const Vector3& v)
+		{
+			const float sqrLength{ v.SqrMagnitude() };
+			return sqrLength >= FLT_MIN && sqrLength <= FLT_MAX ? v * FastMath::RSqrt(sqrLength) : Vector3::Zero;
+		}
+
+		// Removes the part of v along n, n doesn't have to be unit length
+		inline Vector3 RejectSafe(const Vector3& v, const Vector3& n)
+		{
+			const float sqrLength{ n.SqrMagnitude() };
+			return sqrLength > 0.f ? v - n * (Vector3::Dot(n, v) / sqrLength) : v;
+		}
+
+		// Returns true for a degenerate face
+		bool ComputeFaceFrame(const std::vector<Vertex>& vertices, const uint32_t* pIndices, size_t face, FaceFrames& frames)
+		{
+			const Vertex* pCorners[3]{ &vertices[pIndices[0]], &vertices[pIndices[1]], &vertices[pIndices[2]] };
+			const Vector3 edge1{ pCorners[1]->position - pCorners[0]->position };
+			const Vector3 edge2{ pCorners[2]->position - pCorners[0]->position };
+			const float du1{ pCorners[1]->uv.x - pCorners[0]->uv.x }, dv1{ pCorners[1]->uv.y - pCorners[0]->uv.y };
+			const float du2{ pCorners[2]->uv.x - pCorners[0]->uv.x }, dv2{ pCorners[2]->uv.y - pCorners[0]->uv.y };
+
+			// Zero uv area divides by zero, zero area has no tangent plane. Relative, so cancellation counts as zero too
+			const float uvArea{ du1 * dv2 - du2 * dv1 };
+			const float sqrArea{ Vector3::Cross(edge1, edge2).SqrMagnitude() };
+			const bool isDegenerate{ !(std::abs(uvArea) > FLT_EPSILON * (std::abs(du1 * dv2) + std::abs(du2 * dv1)))
+				|| !(sqrArea > FLT_EPSILON * FLT_EPSILON * edge1.SqrMagnitude() * edge2.SqrMagnitude()) };
+
+			// dP/du and dP/dv up to the 1 / uvArea scale, which only contributes its sign since the tangent gets normalized
+			const float orientation{ uvArea < 0.f ? -1.f : 1.f };
+			const Vector3 tangent{ (edge1 * dv2 - edge2 * dv1) * orientation };
+			const Vector3 bitangent{ (edge2 * du1 - edge1 * du2) * orientation };
+			const Vector3 uvNormal{ Vector3::Cross(tangent, bitangent) };
+			const Vector3 unitTangent{ isDegenerate ? Vector3::Zero : NormalizedOrZero(tangent) };
+			frames.tangentX[face] = unitTangent.x;
+			frames.tangentY[face] = unitTangent.y;
+			frames.tangentZ[face] = unitTangent.z;
+
+			for (int corner{}; corner < 3; ++corner)
+			{
+				const Vector3& position{ pCorners[corner]->position };
+				const Vector3& normal{ pCorners[corner]->normal };
+				const Vector3 toNext{ RejectSafe(pCorners[(corner + 1) % 3]->position - position, normal) };
+				const Vector3 toPrevious{ RejectSafe(pCorners[(corner + 2) % 3]->position - position, normal) };
+				const float lengths{ toNext.Magnitude() * toPrevious.Magnitude() };
+				const float cosAngle{ lengths > 0.f ? Vector3::Dot(toNext, toPrevious) / lengths : 1.f };
+				const float sign{ Vector3::Dot(normal, uvNormal) < 0.f ? -1.f : 1.f };
+				frames.angle[corner][face] = isDegenerate ? 0.f : sign * FastAcos(std::clamp(cosAngle, -1.f, 1.f));
+			}
+			return isDegenerate;
+		}
+
+#ifdef DAE_TANGENT_SPACE_SSE2
+		// Four 3D vectors, one per lane
+		struct Vector3x4
+		{
+			__m128 x, y, z;
+		};
+
+		inline Vector3x4 operator-(const Vector3x4& a, const Vector3x4& b)
+		{
+			return { _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) };
+		}
+
+		inline Vector3x4 operator*(const Vector3x4& v, __m128 scale)
+		{
+			return { _mm_mul_ps(v.x, scale), _mm_mul_ps(v.y, scale), _mm_mul_ps(v.z, scale) };
+		}
+
+		inline __m128 Dot(const Vector3x4& a, const Vector3x4& b)
+		{
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+		}
+
+		inline Vector3x4 Cross(const Vector3x4& a, const Vector3x4& b)
+		{
+			return { _mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)), _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+				_mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x)) };
+		}
+
+		inline __m128 Select(__m128 mask, __m128 ifTrue, __m128 ifFalse)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+		}
+
+		inline __m128 Abs(__m128 value)
+		{
+			return _mm_andnot_ps(_mm_set1_ps(-0.f), value);
+		}
+
+		// Same bounds as NormalizedOrZero
+		inline Vector3x4 NormalizedOrZero(const Vector3x4& v)
+		{
+			const __m128 sqrLength{ Dot(v, v) };
+			const __m128 isValid{ _mm_and_ps(_mm_cmpge_ps(sqrLength, _mm_set1_ps(FLT_MIN)), _mm_cmple_ps(sqrLength, _mm_set1_ps(FLT_MAX))) };
+			return v * _mm_and_ps(isValid, FastMath::RSqrt(sqrLength));
+		}
+
+		inline Vector3x4 RejectSafe(const Vector3x4& v, const Vector3x4& n)
+		{
+			const __m128 sqrLength{ Dot(n, n) };
+			const __m128 scale{ _mm_and_ps(_mm_cmpgt_ps(sqrLength, _mm_setzero_ps()), _mm_div_ps(Dot(n, v), sqrLength)) };
+			return v - n * scale;
+		}
+
+		inline __m128 FastAcos(__m128 x)
+		{
+			const __m128 absX{ Abs(x) };
+			__m128 polynomial{ _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.0187293f), absX), _mm_set1_ps(0.0742610f)) };
+			polynomial = _mm_sub_ps(_mm_mul_ps(polynomial, absX), _mm_set1_ps(0.2121144f));
+			polynomial = _mm_add_ps(_mm_mul_ps(polynomial, absX), _mm_set1_ps(1.5707288f));
+			const __m128 result{ _mm_mul_ps(_mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.f), absX), _mm_setzero_ps())), polynomial) };
+			return Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(PI), result), result);
+		}
+
+		// ComputeFaceFrame for faces [face, face + 4), returns how many were degenerate
+		int ComputeFaceFrames4(const std::vector<Vertex>& vertices, const uint32_t* pIndices, size_t face, FaceFrames& frames)
+		{
+			const Vertex* pCorners[3][4];
+			for (int lane{}; lane < 4; ++lane)
+			{
+				for (int corner{}; corner < 3; ++corner)
+				{
+					pCorners[corner][lane] = &vertices[pIndices[lane * 3 + corner]];
+				}
+			}
+
+			Vector3x4 positions[3], normals[3];
+			__m128 u[3], v[3];
+			for (int corner{}; corner < 3; ++corner)
+			{
+				const Vertex* const* p{ pCorners[corner] };
+				positions[corner] = { _mm_setr_ps(p[0]->position.x, p[1]->position.x, p[2]->position.x, p[3]->position.x),
+					_mm_setr_ps(p[0]->position.y, p[1]->position.y, p[2]->position.y, p[3]->position.y),
+					_mm_setr_ps(p[0]->position.z, p[1]->position.z, p[2]->position.z, p[3]->position.z) };
+				normals[corner] = { _mm_setr_ps(p[0]->normal.x, p[1]->normal.x, p[2]->normal.x, p[3]->normal.x),
+					_mm_setr_ps(p[0]->normal.y, p[1]->normal.y, p[2]->normal.y, p[3]->normal.y),
+					_mm_setr_ps(p[0]->normal.z, p[1]->normal.z, p[2]->normal.z, p[3]->normal.z) };
+				u[corner] = _mm_setr_ps(p[0]->uv.x, p[1]->uv.x, p[2]->uv.x, p[3]->uv.x);
+				v[corner] = _mm_setr_ps(p[0]->uv.y, p[1]->uv.y, p[2]->uv.y, p[3]->uv.y);
+			}
+
+			const Vector3x4 edge1{ positions[1] - positions[0] };
+			const Vector3x4 edge2{ positions[2] - positions[0] };
+			const __m128 du1{ _mm_sub_ps(u[1], u[0]) }, dv1{ _mm_sub_ps(v[1], v[0]) };
+			const __m128 du2{ _mm_sub_ps(u[2], u[0]) }, dv2{ _mm_sub_ps(v[2], v[0]) };
+
+			const __m128 epsilon{ _mm_set1_ps(FLT_EPSILON) };
+			const __m128 uvArea{ _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1)) };
+			const Vector3x4 cross{ Cross(edge1, edge2) };
+			const __m128 isValidUv{ _mm_cmpgt_ps(Abs(uvArea), _mm_mul_ps(epsilon, _mm_add_ps(Abs(_mm_mul_ps(du1, dv2)), Abs(_mm_mul_ps(du2, dv1))))) };
+			const __m128 isValidArea{ _mm_cmpgt_ps(Dot(cross, cross),
+				_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(epsilon, epsilon), Dot(edge1, edge1)), Dot(edge2, edge2))) };
+			const __m128 isValid{ _mm_and_ps(isValidUv, isValidArea) };
+
+			const __m128 orientation{ Select(_mm_cmplt_ps(uvArea, _mm_setzero_ps()), _mm_set1_ps(-1.f), _mm_set1_ps(1.f)) };
+			const Vector3x4 tangent{ (edge1 * dv2 - edge2 * dv1) * orientation };
+			const Vector3x4 bitangent{ (edge2 * du1 - edge1 * du2) * orientation };
+			const Vector3x4 uvNormal{ Cross(tangent, bitangent) };
+			const Vector3x4 unitTangent{ NormalizedOrZero(tangent) };
+			_mm_storeu_ps(&frames.tangentX[face], _mm_and_ps(isValid, unitTangent.x));
+			_mm_storeu_ps(&frames.tangentY[face], _mm_and_ps(isValid, unitTangent.y));
+			_mm_storeu_ps(&frames.tangentZ[face], _mm_and_ps(isValid, unitTangent.z));
+
+			for (int corner{}; corner < 3; ++corner)
+			{
+				const Vector3x4 toNext{ RejectSafe(positions[(corner + 1) % 3] - positions[corner], normals[corner]) };
+				const Vector3x4 toPrevious{ RejectSafe(positions[(corner + 2) % 3] - positions[corner], normals[corner]) };
+				const __m128 lengths{ _mm_mul_ps(_mm_sqrt_ps(Dot(toNext, toNext)), _mm_sqrt_ps(Dot(toPrevious, toPrevious))) };
+				const __m128 cosAngle{ Select(_mm_cmpgt_ps(lengths, _mm_setzero_ps()), _mm_div_ps(Dot(toNext, toPrevious), lengths), _mm_set1_ps(1.f)) };
+				const __m128 angle{ FastAcos(_mm_min_ps(_mm_max_ps(cosAngle, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f))) };
+				const __m128 isMirrored{ _mm_cmplt_ps(Dot(normals[corner], uvNormal), _mm_setzero_ps()) };
+				_mm_storeu_ps(&frames.angle[corner][face], _mm_and_ps(isValid, _mm_or_ps(angle, _mm_and_ps(isMirrored, _mm_set1_ps(-0.f)))));
+			}
+
+			return 4 - static_cast<int>(std::popcount(static_cast<unsigned>(_mm_movemask_ps(isValid))));
+		}
+#endif
+
+		// Splits [0, count) into numThreads contiguous ranges
+		inline size_t GetRangeBegin(size_t count, size_t numThreads, size_t thread)
+		{
+			return count * thread / numThreads;
+		}
+	}
+
+	namespace TangentSpace
+	{
+		TangentStats GenerateTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t numThreads)
+		{
+			const auto startTime{ std::chrono::steady_clock::now() };
+
+			TangentStats stats{};
+			stats.numTriangles = indices.size() / 3;
+			stats.numVertices = vertices.size();
+			const size_t numFaces{ stats.numTriangles };
+
+			const size_t maxThreads{ std::max(size_t{ 1 }, numFaces / minTrianglesPerThread) };
+			const size_t threadCount{ std::min(maxThreads, size_t{ numThreads != 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency()) }) };
+			stats.numThreads = static_cast<uint32_t>(threadCount);
+
+			// Face frames, every thread writes its own range of faces
+			FaceFrames frames{};
+			for (std::vector<float>* pArray : { &frames.tangentX, &frames.tangentY, &frames.tangentZ, &frames.angle[0], &frames.angle[1], &frames.angle[2] })
+			{
+				pArray->resize(numFaces);
+			}
+
+			std::vector<size_t> degenerateTriangles(threadCount);
+			Utils::RunParallel(threadCount, [&](size_t thread)
+				{
+					const size_t end{ GetRangeBegin(numFaces, threadCount, thread + 1) };
+					size_t face{ GetRangeBegin(numFaces, threadCount, thread) };
+					size_t numDegenerate{};
+#ifdef DAE_TANGENT_SPACE_SSE2
+					for (; face + 4 <= end; face += 4)
+					{
+						numDegenerate += ComputeFaceFrames4(vertices, &indices[face * 3], face, frames);
+					}
+#endif
+					for (; face < end; ++face)
+					{
+						numDegenerate += ComputeFaceFrame(vertices, &indices[face * 3], face, frames);
+					}
+					degenerateTriangles[thread] = numDegenerate;
+				});
+
+			// Vertex -> corners (CSR), a corner is an index into the index buffer
+			std::vector<uint32_t> cornerOffsets(vertices.size() + 1);
+			for (size_t i{}; i < numFaces * 3; ++i)
+			{
+				++cornerOffsets[indices[i] + 1];
+			}
+			for (size_t v{}; v < vertices.size(); ++v)
+			{
+				cornerOffsets[v + 1] += cornerOffsets[v];
+			}
+			std::vector<uint32_t> corners(numFaces * 3);
+			{
+				std::vector<uint32_t> fill{ cornerOffsets.begin(), cornerOffsets.end() - 1 };
+				for (size_t i{}; i < numFaces * 3; ++i)
+				{
+					corners[fill[indices[i]]++] = static_cast<uint32_t>(i);
+				}
+			}
+
+			// Every vertex gathers its own corners, so the threads never touch the same vertex
+			std::vector<size_t> mirroredVertices(threadCount), fallbackVertices(threadCount);
+			Utils::RunParallel(threadCount, [&](size_t thread)
+				{
+					const size_t end{ GetRangeBegin(vertices.size(), threadCount, thread + 1) };
+					size_t numMirrored{};
+					size_t numFallbacks{};
+					for (size_t v{ GetRangeBegin(vertices.size(), threadCount, thread) }; v < end; ++v)
+					{
+						Vertex& vertex{ vertices[v] };
+						const Vector3 normal{ NormalizedOrZero(vertex.normal) };
+
+						// Plain floats, this loop runs once per corner
+						float tangentSum[3]{};
+						float signedAngleSum{};
+						float angleSum{};
+						for (uint32_t i{ cornerOffsets[v] }; i < cornerOffsets[v + 1]; ++i)
+						{
+							const size_t face{ corners[i] / 3 };
+							const float signedAngle{ frames.angle[corners[i] % 3][face] };
+							if (signedAngle == 0.f)
+								continue;
+
+							// MikkTSpace projects every face tangent onto the vertex's tangent plane before weighting it
+							const float faceTangent[3]{ frames.tangentX[face], frames.tangentY[face], frames.tangentZ[face] };
+							const float alongNormal{ normal.x * faceTangent[0] + normal.y * faceTangent[1] + normal.z * faceTangent[2] };
+							const float projected[3]{ faceTangent[0] - normal.x * alongNormal, faceTangent[1] - normal.y * alongNormal, faceTangent[2] - normal.z * alongNormal };
+							const float sqrLength{ projected[0] * projected[0] + projected[1] * projected[1] + projected[2] * projected[2] };
+							const float angle{ std::abs(signedAngle) };
+							if (sqrLength > 0.f)
+							{
+								const float scale{ angle / std::sqrt(sqrLength) };
+								tangentSum[0] += projected[0] * scale;
+								tangentSum[1] += projected[1] * scale;
+								tangentSum[2] += projected[2] * scale;
+							}
+							signedAngleSum += signedAngle;
+							angleSum += angle;
+						}
+
+						Vector3 tangent{ Vector3{ tangentSum[0], tangentSum[1], tangentSum[2] } - normal * Vector3::Dot(normal, { tangentSum[0], tangentSum[1], tangentSum[2] }) };
+						// Corners that disagree (mirror seams) are not split off like MikkTSpace does, the larger angle wins
+						float sign{ signedAngleSum < 0.f ? -1.f : 1.f };
+						const float length{ tangent.Magnitude() };
+						if (length > FLT_EPSILON * angleSum && length < INFINITY)
+						{
+							tangent /= length;
+						}
+						else
+						{
+							// Only degenerate faces, no uvs, or tangents that cancel out
+							const Vector3 helper{ std::abs(normal.x) < 0.9f ? Vector3::UnitX : Vector3::UnitY };
+							tangent = NormalizedOrZero(helper - normal * Vector3::Dot(normal, helper));
+							sign = 1.f;
+							++numFallbacks;
+						}
+
+						vertex.tangent = { tangent, sign };
+						if (sign < 0.f)
+							++numMirrored;
+					}
+					mirroredVertices[thread] = numMirrored;
+					fallbackVertices[thread] = numFallbacks;
+				});
+
+			for (size_t thread{}; thread < threadCount; ++thread)
+			{
+				stats.degenerateTriangles += degenerateTriangles[thread];
+				stats.mirroredVertices += mirroredVertices[thread];
+				stats.fallbackVertices += fallbackVertices[thread];
+			}
+			stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			return stats;
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "DataTypes.h"
+
+namespace dae
+{
+	// Per-vertex tangent frames for normal mapping, following MikkTSpace
+	namespace TangentSpace
+	{
+		struct TangentStats
+		{
+			size_t numTriangles{};
+			// Zero area or zero uv area, they don't contribute
+			size_t degenerateTriangles{};
+			size_t numVertices{};
+			// Bitangent points against cross(normal, tangent), tangent.w == -1
+			size_t mirroredVertices{};
+			// Nothing usable to average, got an arbitrary tangent perpendicular to the normal
+			size_t fallbackVertices{};
+			uint32_t numThreads{};
+			float milliseconds{};
+		};
+
+		// Overwrites vertex.tangent: xyz the angle weighted average of the face tangents around the vertex, orthogonalized against
+		// the normal, w the bitangent sign (bitangent = cross(normal, tangent.xyz) * tangent.w). Corners are only averaged when they
+		// share a vertex, so weld the buffer first (ObjParseOptions::weldVertices) to get MikkTSpace's grouping.
+		// Faces are done four at a time with SSE2, on numThreads threads (0 picks the hardware concurrency), vertices gather
+		// their corners through a vertex -> corner table, so no two threads ever write the same memory
+		TangentStats GenerateTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t numThreads = 0);
+	}
+}
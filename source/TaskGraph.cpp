@@ -0,0 +1,144 @@
+#include "pch.h"
+#include "TaskGraph.h"
+#include "Utils.h"
+
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace dae
+{
+	TaskGraph::TaskId TaskGraph::Add(const std::string& name, std::function<void()> function, const std::vector<TaskId>& dependencies, Affinity affinity)
+	{
+		const TaskId id{ static_cast<TaskId>(m_Tasks.size()) };
+		for (const TaskId dependency : dependencies)
+		{
+			assert(dependency < id && "ERROR: dependencies have to be added first!");
+			assert((affinity == Affinity::MainThread || m_Tasks[dependency].affinity == Affinity::Worker)
+				&& "ERROR: worker tasks can't wait on main thread tasks!");
+			// Main thread tasks run in the order they were added, after every worker task, so they never have to wait
+			if (affinity == Affinity::Worker)
+				m_Tasks[dependency].dependents.push_back(id);
+		}
+
+		m_Tasks.push_back({ name, std::move(function), affinity, affinity == Affinity::Worker ? static_cast<uint32_t>(dependencies.size()) : 0u });
+		return id;
+	}
+
+	TaskGraphStats TaskGraph::Run(uint32_t numThreads)
+	{
+		const auto startTime{ std::chrono::steady_clock::now() };
+		const auto getMilliseconds{ [&startTime]() { return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count(); } };
+
+		TaskGraphStats stats{};
+		stats.numTasks = static_cast<uint32_t>(m_Tasks.size());
+
+		std::deque<TaskId> readyTasks{};
+		std::vector<uint32_t> numPendingDependencies(m_Tasks.size());
+		uint32_t numWorkerTasks{};
+		for (TaskId i{}; i < m_Tasks.size(); ++i)
+		{
+			if (m_Tasks[i].affinity != Affinity::Worker)
+				continue;
+			++numWorkerTasks;
+			numPendingDependencies[i] = m_Tasks[i].numDependencies;
+			if (numPendingDependencies[i] == 0)
+				readyTasks.push_back(i);
+		}
+
+		// No more threads than worker tasks
+		stats.numThreads = numThreads != 0 ? numThreads : std::max(std::thread::hardware_concurrency(), 1u);
+		stats.numThreads = std::min(stats.numThreads, std::max(numWorkerTasks, 1u));
+
+		const auto runTask{ [&](TaskId id, uint32_t thread)
+			{
+				Task& task{ m_Tasks[id] };
+				task.stats.thread = thread;
+				task.stats.startMilliseconds = getMilliseconds();
+				task.function();
+				task.stats.milliseconds = getMilliseconds() - task.stats.startMilliseconds;
+			} };
+
+		if (stats.numThreads == 1)
+		{
+			// Added order is a valid order
+			for (TaskId i{}; i < m_Tasks.size(); ++i)
+			{
+				if (m_Tasks[i].affinity == Affinity::Worker)
+					runTask(i, 0);
+			}
+		}
+		else
+		{
+			// Every thread takes the oldest ready task, finishing one can make its dependents ready
+			std::mutex mutex{};
+			std::condition_variable condition{};
+			uint32_t numRemainingTasks{ numWorkerTasks };
+			Utils::RunParallel(stats.numThreads, [&](size_t thread)
+				{
+					std::unique_lock<std::mutex> lock{ mutex };
+					while (true)
+					{
+						condition.wait(lock, [&]() { return !readyTasks.empty() || numRemainingTasks == 0; });
+						if (readyTasks.empty())
+							return;
+
+						const TaskId id{ readyTasks.front() };
+						readyTasks.pop_front();
+						lock.unlock();
+						runTask(id, static_cast<uint32_t>(thread));
+						lock.lock();
+
+						--numRemainingTasks;
+						for (const TaskId dependent : m_Tasks[id].dependents)
+						{
+							if (--numPendingDependencies[dependent] == 0)
+							{
+								readyTasks.push_back(dependent);
+								condition.notify_one();
+							}
+						}
+						if (numRemainingTasks == 0)
+							condition.notify_all();
+					}
+				});
+		}
+
+		// The pool has joined
+		for (TaskId i{}; i < m_Tasks.size(); ++i)
+		{
+			if (m_Tasks[i].affinity == Affinity::MainThread)
+				runTask(i, 0);
+		}
+
+		stats.milliseconds = getMilliseconds();
+		for (const Task& task : m_Tasks)
+		{
+			stats.taskMilliseconds += task.stats.milliseconds;
+		}
+		return stats;
+	}
+
+	uint32_t TaskGraph::GetNumTasks() const
+	{
+		return static_cast<uint32_t>(m_Tasks.size());
+	}
+
+	const std::string& TaskGraph::GetName(TaskId task) const
+	{
+		return m_Tasks[task].name;
+	}
+
+	TaskGraph::Affinity TaskGraph::GetAffinity(TaskId task) const
+	{
+		return m_Tasks[task].affinity;
+	}
+
+	const TaskStats& TaskGraph::GetStats(TaskId task) const
+	{
+		return m_Tasks[task].stats;
+	}
+}
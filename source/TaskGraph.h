@@ -0,0 +1,78 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace dae
+{
+	struct TaskStats
+	{
+		// From the start of TaskGraph::Run
+		float startMilliseconds{};
+		float milliseconds{};
+		// 0 is the thread that called Run
+		uint32_t thread{};
+	};
+
+	struct TaskGraphStats
+	{
+		uint32_t numTasks{};
+		uint32_t numThreads{};
+		// Wall clock, from the start of Run to the end of the last task
+		float milliseconds{};
+		// Every task one after another, what Run takes on one thread
+		float taskMilliseconds{};
+	};
+
+	// Runs a fixed set of tasks once, each after the tasks it depends on. Worker tasks are spread over a pool of threads, main
+	// thread tasks run on the thread calling Run after the pool has joined, for work that has to stay there like creating
+	// device resources
+	class TaskGraph final
+	{
+	public:
+		using TaskId = uint32_t;
+
+		enum class Affinity
+		{
+			Worker,
+			MainThread
+		};
+
+		TaskGraph() = default;
+		~TaskGraph() = default;
+
+		TaskGraph(const TaskGraph& other) = delete;
+		TaskGraph& operator=(const TaskGraph& other) = delete;
+		TaskGraph(TaskGraph&& other) = delete;
+		TaskGraph& operator=(TaskGraph&& other) = delete;
+
+		// Dependencies have to be added before the tasks that need them, which keeps the graph free of cycles.
+		// Worker tasks can only depend on worker tasks
+		TaskId Add(const std::string& name, std::function<void()> function, const std::vector<TaskId>& dependencies = {},
+			Affinity affinity = Affinity::Worker);
+
+		// 0 picks the hardware concurrency, 1 runs every task on the calling thread in the order they were added
+		TaskGraphStats Run(uint32_t numThreads = 0);
+
+		uint32_t GetNumTasks() const;
+		const std::string& GetName(TaskId task) const;
+		Affinity GetAffinity(TaskId task) const;
+		// Filled in by Run
+		const TaskStats& GetStats(TaskId task) const;
+
+	private:
+		struct Task
+		{
+			std::string name{};
+			std::function<void()> function{};
+			Affinity affinity{ Affinity::Worker };
+			uint32_t numDependencies{};
+			// Worker tasks waiting on this one
+			std::vector<TaskId> dependents{};
+			TaskStats stats{};
+		};
+
+		std::vector<Task> m_Tasks{};
+	};
+}
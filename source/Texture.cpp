@@ -3,20 +3,189 @@
 #include "Vector2.h"
 #include <SDL_image.h>
 #include "HelperFuncts.h"
+#include "Utils.h"
+#include "MappedFile.h"
+#include <cassert>
+#include <chrono>
 
 namespace dae
 {
-	Texture::Texture(const std::string& path, ID3D11Device* pDevice)
+	namespace
 	{
+		DXGI_FORMAT GetDxgiFormat(TextureCache::PixelFormat format)
+		{
+			switch (format)
+			{
+			case TextureCache::PixelFormat::BC1:
+				return DXGI_FORMAT_BC1_UNORM;
+			case TextureCache::PixelFormat::BC4:
+				return DXGI_FORMAT_BC4_UNORM;
+			case TextureCache::PixelFormat::BC5:
+				return DXGI_FORMAT_BC5_UNORM;
+			case TextureCache::PixelFormat::BC7:
+				return DXGI_FORMAT_BC7_UNORM;
+			default:
+				return DXGI_FORMAT_R8G8B8A8_UNORM;
+			}
+		}
+	}
+
+	Texture::Texture(const std::string& path, ID3D11Device* pDevice, const TextureCache::ImportOptions& options)
+		: Texture{ Load(path, options), pDevice }
+	{
+	}
+	Texture::Texture(const TextureData& data, ID3D11Device* pDevice)
+	{
+		if (const TextureCache::Header* pHeader{ data.pCacheHeader })
+		{
+			// InitData per mip level, pointing at the mapped pages, the driver copies them before the mapping goes away
+			std::vector<D3D11_SUBRESOURCE_DATA> initData(pHeader->numLevels);
+			for (uint32_t i{}; i < pHeader->numLevels; ++i)
+			{
+				initData[i].pSysMem = TextureCache::GetLevelData(*pHeader, i);
+				initData[i].SysMemPitch = pHeader->levels[i].rowPitch;
+				initData[i].SysMemSlicePitch = pHeader->levels[i].size;
+			}
+			CreateResource(pDevice, GetDxgiFormat(pHeader->format), pHeader->levels[0].width, pHeader->levels[0].height, initData);
+		}
+		else if (!data.compressedChain.levels.empty())
+		{
+			CreateResource(pDevice, data.compressedChain);
+		}
+		else if (!data.mipChain.levels.empty())
+		{
+			CreateResource(pDevice, data.mipChain);
+		}
+	}
+	Texture::Texture(const BlockCompression::CompressedChain& chain, ID3D11Device* pDevice)
+	{
+		CreateResource(pDevice, chain);
+	}
+	Texture::~Texture()
+	{
+		SAFE_RELEASE(m_pResource);
+		SAFE_RELEASE(m_pShaderResourceView);
+	}
+	TextureData Texture::Load(const std::string& path, const TextureCache::ImportOptions& options)
+	{
+		const auto startTime{ std::chrono::steady_clock::now() };
+		TextureData data{};
+
+		// The source is only hashed, never decoded, when the cache is current
+		uint64_t sourceHash{};
+		uint64_t sourceSize{};
+		{
+			const MappedFile sourceFile{ path };
+			if (!sourceFile.IsValid())
+			{
+				std::cout << "[TEXTURE] Could not load " << path << "\n";
+				return data;
+			}
+			sourceHash = Utils::HashBytes(sourceFile.GetData(), sourceFile.GetSize());
+			sourceSize = sourceFile.GetSize();
+		}
+
+		const uint32_t importKey{ TextureCache::GetImportKey(options) };
+		const std::string cachePath{ TextureCache::GetCachePath(path) };
+		data.pCacheFile = std::make_unique<MappedFile>(cachePath);
+		data.pCacheHeader = TextureCache::Validate(*data.pCacheFile, sourceHash, sourceSize, importKey);
+		if (data.pCacheHeader)
+		{
+			data.contentHash = data.pCacheHeader->contentHash;
+			std::cout << "[TEXTURE] " << cachePath << ": loaded in "
+				<< std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms\n";
+			return data;
+		}
+		data.pCacheFile.reset();
+
 		// Make SDL_Surface, release at the end
 		SDL_Surface* pSurface = IMG_Load(path.c_str());
+		if (!pSurface)
+		{
+			std::cout << "[TEXTURE] Could not load " << path << ": " << IMG_GetError() << "\n";
+			return data;
+		}
+
+		// Mip generation reads RGBA8 in memory order, whatever the file held
+		if (pSurface->format->format != SDL_PIXELFORMAT_RGBA32)
+		{
+			SDL_Surface* pConverted = SDL_ConvertSurfaceFormat(pSurface, SDL_PIXELFORMAT_RGBA32, 0);
+			SDL_FreeSurface(pSurface);
+			pSurface = pConverted;
+			if (!pSurface)
+			{
+				std::cout << "[TEXTURE] Could not convert " << path << " to RGBA8: " << SDL_GetError() << "\n";
+				return data;
+			}
+		}
+
+		const MipGeneration::MipStats mipStats{ MipGeneration::GenerateMips(static_cast<const uint8_t*>(pSurface->pixels),
+			static_cast<uint32_t>(pSurface->w), static_cast<uint32_t>(pSurface->h), static_cast<size_t>(pSurface->pitch), options.mips, data.mipChain) };
+		std::cout << "[TEXTURE] " << path << ": " << mipStats.numLevels << " mip levels in " << mipStats.milliseconds
+			<< " ms on " << mipStats.numThreads << " thread(s)\n";
 
+		// SDL_Surface no longer needed
+		SDL_FreeSurface(pSurface);
+
+		// Blocks need whole 4x4 tiles at the top level, anything else stays RGBA8
+		bool isWritten{};
+		if (options.compress && data.mipChain.levels[0].width % 4 == 0 && data.mipChain.levels[0].height % 4 == 0)
+		{
+			const BlockCompression::EncodeStats encodeStats{ BlockCompression::EncodeChain(data.mipChain, options.compression, data.compressedChain) };
+			std::cout << "[TEXTURE] " << path << ": " << encodeStats.numBlocks << " blocks in " << encodeStats.milliseconds << " ms ("
+				<< encodeStats.megabytesPerSecond << " MB/s) on " << encodeStats.numThreads << " thread(s), PSNR " << encodeStats.psnr << " dB\n";
+
+			isWritten = TextureCache::Write(cachePath, sourceHash, sourceSize, importKey, data.compressedChain, &data.contentHash);
+			// The uncompressed levels are not uploaded
+			data.mipChain = {};
+		}
+		else
+		{
+			isWritten = TextureCache::Write(cachePath, sourceHash, sourceSize, importKey, data.mipChain, &data.contentHash);
+		}
+		if (!isWritten)
+			std::cout << "[TEXTURE] Could not write " << cachePath << "\n";
+
+		std::cout << "[TEXTURE] " << path << ": imported in "
+			<< std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms\n";
+		return data;
+	}
+	void Texture::CreateResource(ID3D11Device* pDevice, const MipGeneration::MipChain& chain)
+	{
+		// InitData per mip level, rows are tightly packed in the chain
+		std::vector<D3D11_SUBRESOURCE_DATA> initData(chain.levels.size());
+		for (size_t i{}; i < chain.levels.size(); ++i)
+		{
+			const MipGeneration::MipLevel& level{ chain.levels[i] };
+			initData[i].pSysMem = chain.pixels.data() + level.offset;
+			initData[i].SysMemPitch = level.width * 4;
+			initData[i].SysMemSlicePitch = level.width * level.height * 4;
+		}
+		CreateResource(pDevice, DXGI_FORMAT_R8G8B8A8_UNORM, chain.levels[0].width, chain.levels[0].height, initData);
+	}
+	void Texture::CreateResource(ID3D11Device* pDevice, const BlockCompression::CompressedChain& chain)
+	{
+		assert(!chain.levels.empty() && chain.levels[0].width % 4 == 0 && chain.levels[0].height % 4 == 0
+			&& "ERROR: block compressed textures must be a multiple of 4 texels!");
+
+		// InitData per mip level, pitches in rows of blocks
+		std::vector<D3D11_SUBRESOURCE_DATA> initData(chain.levels.size());
+		for (size_t i{}; i < chain.levels.size(); ++i)
+		{
+			const MipGeneration::MipLevel& level{ chain.levels[i] };
+			initData[i].pSysMem = chain.blocks.data() + level.offset;
+			initData[i].SysMemPitch = static_cast<UINT>(BlockCompression::GetRowPitch(chain.format, level.width));
+			initData[i].SysMemSlicePitch = static_cast<UINT>(BlockCompression::GetLevelSize(chain.format, level.width, level.height));
+		}
+		CreateResource(pDevice, GetDxgiFormat(TextureCache::GetPixelFormat(chain.format)), chain.levels[0].width, chain.levels[0].height, initData);
+	}
+	void Texture::CreateResource(ID3D11Device* pDevice, DXGI_FORMAT format, uint32_t width, uint32_t height, const std::vector<D3D11_SUBRESOURCE_DATA>& initData)
+	{
 		// Texture description
-		const DXGI_FORMAT format{ DXGI_FORMAT_R8G8B8A8_UNORM };
 		D3D11_TEXTURE2D_DESC desc{};
-		desc.Width = pSurface->w;
-		desc.Height = pSurface->h;
-		desc.MipLevels = 1;
+		desc.Width = width;
+		desc.Height = height;
+		desc.MipLevels = static_cast<UINT>(initData.size());
 		desc.ArraySize = 1;
 		desc.Format = format;
 		desc.SampleDesc.Count = 1;
@@ -26,29 +195,20 @@ namespace dae
 		desc.CPUAccessFlags = 0;
 		desc.MiscFlags = 0;
 
-		// InitData SDL_Surface
-		D3D11_SUBRESOURCE_DATA initData{};
-		initData.pSysMem = pSurface->pixels;
-		initData.SysMemPitch = static_cast<UINT>(pSurface->pitch);
-		initData.SysMemSlicePitch = static_cast<UINT>(pSurface->h * pSurface->pitch);
-
-		HRESULT hr = pDevice->CreateTexture2D(&desc, &initData, &m_pResource);
+		HRESULT hr = pDevice->CreateTexture2D(&desc, initData.data(), &m_pResource);
 
 		// ShaderResourceView description
 		D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc{};
 		SRVDesc.Format = format;
 		SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		SRVDesc.Texture2D.MipLevels = 1;
+		SRVDesc.Texture2D.MipLevels = desc.MipLevels;
 
 		hr = pDevice->CreateShaderResourceView(m_pResource, &SRVDesc, &m_pShaderResourceView);
 
-		// SDL_Surface no longer needed
-		SDL_FreeSurface(pSurface);
-	}
-	Texture::~Texture()
-	{
-		SAFE_RELEASE(m_pResource);
-		SAFE_RELEASE(m_pShaderResourceView);
+		for (const D3D11_SUBRESOURCE_DATA& level : initData)
+		{
+			m_SizeInBytes += level.SysMemSlicePitch;
+		}
 	}
 	ID3D11Texture2D* Texture::GetResource() const
 	{
@@ -58,5 +218,9 @@ namespace dae
 	{
 		return m_pShaderResourceView;
 	}
+	size_t Texture::GetSizeInBytes() const
+	{
+		return m_SizeInBytes;
+	}
 }
 
@@ -1,24 +1,57 @@
 #pragma once
 #include <SDL_surface.h>
 #include <string>
+#include <memory>
 #include "ColorRGB.h"
+#include "MipGeneration.h"
+#include "BlockCompression.h"
+#include "TextureCache.h"
+#include "MappedFile.h"
 
 namespace dae
 {
 	struct Vector2;
 
+	// What Texture::Load leaves for the upload: the mapped .dtex, or the chain that was just imported
+	struct TextureData
+	{
+		// Keeps pCacheHeader and the levels behind it mapped
+		std::unique_ptr<MappedFile> pCacheFile;
+		const TextureCache::Header* pCacheHeader{};
+		// Imported, only one of them is filled
+		MipGeneration::MipChain mipChain;
+		BlockCompression::CompressedChain compressedChain;
+		// The .dtex contentHash of the level data, equal for textures that upload the same texels whatever source they came from
+		uint64_t contentHash{};
+	};
+
 	class Texture
 	{
 	public:
-		Texture(const std::string& path, ID3D11Device* pDevice);
+		// Load, then the upload
+		Texture(const std::string& path, ID3D11Device* pDevice, const TextureCache::ImportOptions& options = {});
+		// Uploads straight from the mapping when there is one, data that failed to load leaves the texture empty
+		Texture(const TextureData& data, ID3D11Device* pDevice);
+		// Blocks encoded at import time, uploaded as they are. The top level must be a multiple of 4 texels wide and high
+		Texture(const BlockCompression::CompressedChain& chain, ID3D11Device* pDevice);
 		~Texture();
+
+		// Maps the .dtex next to path when it is current. Otherwise the full mip chain is generated, filtered according to what the
+		// texture holds and block compressed if asked, then written to the .dtex for the next run. Touches no device, any thread can run it
+		static TextureData Load(const std::string& path, const TextureCache::ImportOptions& options = {});
 		
 		ID3D11Texture2D* GetResource() const;
 		ID3D11ShaderResourceView* GetShaderResourceView() const;
+		// Of every mip level as uploaded
+		size_t GetSizeInBytes() const;
 
 	private:
+		void CreateResource(ID3D11Device* pDevice, const MipGeneration::MipChain& chain);
+		void CreateResource(ID3D11Device* pDevice, const BlockCompression::CompressedChain& chain);
+		void CreateResource(ID3D11Device* pDevice, DXGI_FORMAT format, uint32_t width, uint32_t height, const std::vector<D3D11_SUBRESOURCE_DATA>& initData);
 
 		ID3D11Texture2D* m_pResource{};
 		ID3D11ShaderResourceView* m_pShaderResourceView{};
+		size_t m_SizeInBytes{};
 	};
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "pch.h"
+#include "TextureCache.h"
+#include "MappedFile.h"
+#include "Utils.h"
+
+#include <fstream>
+
+namespace dae
+{
+	namespace
+	{
+		inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		void WritePadding(std::ofstream& file, uint64_t alignment)
+		{
+			static constexpr char zeros[TextureCache::levelAlignment]{};
+			const uint64_t position{ static_cast<uint64_t>(file.tellp()) };
+			file.write(zeros, static_cast<std::streamsize>(AlignUp(position, alignment) - position));
+		}
+
+		uint64_t GetRowPitch(TextureCache::PixelFormat format, uint32_t width)
+		{
+			using TextureCache::PixelFormat;
+			switch (format)
+			{
+			case PixelFormat::RGBA8:
+				return uint64_t{ width } * 4;
+			case PixelFormat::BC1:
+				return BlockCompression::GetRowPitch(BlockCompression::Format::BC1, width);
+			case PixelFormat::BC4:
+				return BlockCompression::GetRowPitch(BlockCompression::Format::BC4, width);
+			case PixelFormat::BC5:
+				return BlockCompression::GetRowPitch(BlockCompression::Format::BC5, width);
+			default:
+				return BlockCompression::GetRowPitch(BlockCompression::Format::BC7, width);
+			}
+		}
+
+		// Rows of texels, or of blocks
+		uint64_t GetNumRows(TextureCache::PixelFormat format, uint32_t height)
+		{
+			return format == TextureCache::PixelFormat::RGBA8 ? height : (uint64_t{ height } + 3) / 4;
+		}
+
+		// Levels are tightly packed in pData at the offsets of levels, they start on levelAlignment in the file
+		bool WriteLevels(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t importKey,
+			TextureCache::PixelFormat format, const std::vector<MipGeneration::MipLevel>& levels, const uint8_t* pData, uint64_t* pContentHash)
+		{
+			using namespace TextureCache;
+			if (levels.empty() || levels.size() > maxLevels)
+				return false;
+
+			Header header{};
+			header.magic = magic;
+			header.version = version;
+			header.format = format;
+			header.importKey = importKey;
+			header.sourceHash = sourceHash;
+			header.sourceSize = sourceSize;
+			header.numLevels = static_cast<uint32_t>(levels.size());
+
+			// Hash chained level by level, seeded with the format and the top level size
+			const uint32_t description[]{ static_cast<uint32_t>(format), levels[0].width, levels[0].height, header.numLevels };
+			uint64_t contentHash{ Utils::HashBytes(description, sizeof(description)) };
+
+			uint64_t offset{ AlignUp(sizeof(Header), levelAlignment) };
+			for (size_t i{}; i < levels.size(); ++i)
+			{
+				Level& level{ header.levels[i] };
+				level.offset = offset;
+				level.width = levels[i].width;
+				level.height = levels[i].height;
+				level.rowPitch = static_cast<uint32_t>(GetRowPitch(format, level.width));
+				level.size = static_cast<uint32_t>(level.rowPitch * GetNumRows(format, level.height));
+				contentHash = Utils::HashBytes(pData + levels[i].offset, level.size, contentHash);
+				offset = AlignUp(offset + level.size, levelAlignment);
+			}
+			header.contentHash = contentHash;
+			if (pContentHash)
+				*pContentHash = contentHash;
+
+			std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+			if (!file)
+				return false;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			for (size_t i{}; i < levels.size(); ++i)
+			{
+				WritePadding(file, levelAlignment);
+				file.write(reinterpret_cast<const char*>(pData + levels[i].offset), static_cast<std::streamsize>(header.levels[i].size));
+			}
+			// The last level is padded too, so every level can be read in whole aligned blocks
+			WritePadding(file, levelAlignment);
+
+			return static_cast<bool>(file);
+		}
+	}
+
+	namespace TextureCache
+	{
+		std::string GetCachePath(const std::string& sourcePath)
+		{
+			const size_t extension{ sourcePath.find_last_of('.') };
+			const size_t directory{ sourcePath.find_last_of("/\\") };
+			if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+				return sourcePath + ".dtex";
+			return sourcePath.substr(0, extension) + ".dtex";
+		}
+
+		PixelFormat GetPixelFormat(BlockCompression::Format format)
+		{
+			switch (format)
+			{
+			case BlockCompression::Format::BC1:
+				return PixelFormat::BC1;
+			case BlockCompression::Format::BC4:
+				return PixelFormat::BC4;
+			case BlockCompression::Format::BC5:
+				return PixelFormat::BC5;
+			default:
+				return PixelFormat::BC7;
+			}
+		}
+
+		uint32_t GetImportKey(const ImportOptions& options)
+		{
+			uint32_t key{ static_cast<uint32_t>(options.mips.content) | static_cast<uint32_t>(options.mips.filter) << 2 };
+			if (options.compress)
+			{
+				key |= 1u << 4 | static_cast<uint32_t>(options.compression.format) << 5
+					| static_cast<uint32_t>(options.compression.quality) << 7;
+			}
+			return key;
+		}
+
+		bool Write(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t importKey, const MipGeneration::MipChain& chain,
+			uint64_t* pContentHash)
+		{
+			return WriteLevels(path, sourceHash, sourceSize, importKey, PixelFormat::RGBA8, chain.levels, chain.pixels.data(), pContentHash);
+		}
+
+		bool Write(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t importKey, const BlockCompression::CompressedChain& chain,
+			uint64_t* pContentHash)
+		{
+			return WriteLevels(path, sourceHash, sourceSize, importKey, GetPixelFormat(chain.format), chain.levels, chain.blocks.data(), pContentHash);
+		}
+
+		const Header* Validate(const MappedFile& file, uint64_t sourceHash, uint64_t sourceSize, uint32_t importKey)
+		{
+			if (!file.IsValid() || file.GetSize() < sizeof(Header))
+				return nullptr;
+
+			const Header* pHeader{ reinterpret_cast<const Header*>(file.GetData()) };
+			if (pHeader->magic != magic || pHeader->version != version || pHeader->format > PixelFormat::BC7)
+				return nullptr;
+
+			// Stale
+			if (pHeader->sourceHash != sourceHash || pHeader->sourceSize != sourceSize || pHeader->importKey != importKey)
+				return nullptr;
+
+			// Truncated or damaged: every level aligned, in order, inside the file, the size its dimensions call for and halving down
+			// the chain. The size is checked against what is left after the offset, so a huge offset can't wrap around
+			if (pHeader->numLevels == 0 || pHeader->numLevels > maxLevels)
+				return nullptr;
+			const uint64_t fileSize{ file.GetSize() };
+			uint64_t levelEnd{ sizeof(Header) };
+			for (uint32_t i{}; i < pHeader->numLevels; ++i)
+			{
+				const Level& level{ pHeader->levels[i] };
+				const uint32_t width{ i == 0 ? level.width : std::max(pHeader->levels[i - 1].width / 2, 1u) };
+				const uint32_t height{ i == 0 ? level.height : std::max(pHeader->levels[i - 1].height / 2, 1u) };
+				if (level.width == 0 || level.height == 0 || level.width != width || level.height != height
+					|| level.rowPitch != GetRowPitch(pHeader->format, level.width) || level.size != level.rowPitch * GetNumRows(pHeader->format, level.height)
+					|| level.offset % levelAlignment != 0 || level.offset < levelEnd || level.offset > fileSize || level.size > fileSize - level.offset)
+					return nullptr;
+				levelEnd = level.offset + level.size;
+			}
+
+			return pHeader;
+		}
+
+		const uint8_t* GetLevelData(const Header& header, uint32_t level)
+		{
+			return reinterpret_cast<const uint8_t*>(&header) + header.levels[level].offset;
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include "MipGeneration.h"
+#include "BlockCompression.h"
+
+namespace dae
+{
+	class MappedFile;
+
+	// .dtex: every mip level of an imported texture, RGBA8 or block compressed, laid out so the levels are uploaded straight from the mapping
+	namespace TextureCache
+	{
+		constexpr uint32_t magic{ 0x58455444 }; // "DTEX"
+		constexpr uint32_t version{ 1 };
+		// D3D12's placement alignment, so a level could also be copied into an upload heap as it is
+		constexpr uint32_t levelAlignment{ 512 };
+		// D3D11 textures go up to 16384 x 16384, 15 levels
+		constexpr uint32_t maxLevels{ 16 };
+
+		enum class PixelFormat : uint32_t
+		{
+			RGBA8,
+			BC1,
+			BC4,
+			BC5,
+			BC7
+		};
+
+		// How a source is imported, everything but the thread counts is part of what makes a cache current
+		struct ImportOptions
+		{
+			MipGeneration::MipOptions mips{};
+			// RGBA8 when false, and for sources that are not a multiple of 4 texels
+			bool compress{};
+			BlockCompression::EncodeOptions compression{};
+		};
+
+		struct Level
+		{
+			// From the start of the file, a multiple of levelAlignment
+			uint64_t offset;
+			uint32_t width;
+			uint32_t height;
+			// Between rows of texels, or of blocks
+			uint32_t rowPitch;
+			uint32_t size;
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			PixelFormat format;
+			uint32_t importKey;
+
+			uint64_t sourceHash;
+			uint64_t sourceSize;
+			// Of the format, size and level data, equal for equal textures whatever file they came from
+			uint64_t contentHash;
+
+			uint32_t numLevels;
+			uint32_t padding;
+			Level levels[maxLevels];
+		};
+
+		// Resources/vehicle_diffuse.png => Resources/vehicle_diffuse.dtex
+		std::string GetCachePath(const std::string& sourcePath);
+
+		PixelFormat GetPixelFormat(BlockCompression::Format format);
+		uint32_t GetImportKey(const ImportOptions& options);
+
+		// pContentHash gets the header's contentHash, also when the file could not be written
+		bool Write(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t importKey, const MipGeneration::MipChain& chain,
+			uint64_t* pContentHash = nullptr);
+		bool Write(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, uint32_t importKey, const BlockCompression::CompressedChain& chain,
+			uint64_t* pContentHash = nullptr);
+
+		// Returns the header at the start of the mapping if it is a complete, current cache of the source, nullptr otherwise.
+		// The level data is not hashed again, that would read every page the upload is about to read
+		const Header* Validate(const MappedFile& file, uint64_t sourceHash, uint64_t sourceSize, uint32_t importKey);
+
+		// Points into the mapping, only valid while the MappedFile is alive
+		const uint8_t* GetLevelData(const Header& header, uint32_t level);
+	}
+}
@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "Transform.h"
+
+namespace dae
+{
+	namespace
+	{
+		template<typename T>
+		T Splat(float value)
+		{
+			if constexpr (std::is_same_v<T, float>)
+				return value;
+			else
+				return T::Set(value);
+		}
+
+		// One transform per lane, written once for float and SimdFloat so both give the same bits.
+		// rotation is x, y, z, w; world gets the three axes, inverseTranspose its three rows with the translation in w
+		template<typename T>
+		void ComposeWorldMatrix(const T(&rotation)[4], const T(&position)[3], const T(&scale)[3], T(&world)[3][3], T(&inverseTranspose)[3][4])
+		{
+			const T one{ Splat<T>(1.f) };
+			const T two{ Splat<T>(2.f) };
+			const T zero{ Splat<T>(0.f) };
+
+			// Matrix::CreateRotation(const Quaternion&)
+			const T& x{ rotation[0] };
+			const T& y{ rotation[1] };
+			const T& z{ rotation[2] };
+			const T& w{ rotation[3] };
+			const T xx{ x * x }, yy{ y * y }, zz{ z * z };
+			const T xy{ x * y }, xz{ x * z }, yz{ y * z };
+			const T wx{ w * x }, wy{ w * y }, wz{ w * z };
+			const T axes[3][3]{
+				{ one - two * (yy + zz), two * (xy + wz), two * (xz - wy) },
+				{ two * (xy - wz), one - two * (xx + zz), two * (yz + wx) },
+				{ two * (xz + wy), two * (yz - wx), one - two * (xx + yy) }
+			};
+
+			// (S * R)^-T = S^-1 * R for an orthonormal R, and the translation row of the inverse becomes the w column
+			for (int i{}; i < 3; ++i)
+			{
+				const T inverseScale{ one / scale[i] };
+				for (int j{}; j < 3; ++j)
+				{
+					world[i][j] = axes[i][j] * scale[i];
+					inverseTranspose[i][j] = axes[i][j] * inverseScale;
+				}
+				const T projected{ position[0] * axes[i][0] + position[1] * axes[i][1] + position[2] * axes[i][2] };
+				inverseTranspose[i][3] = (zero - projected) * inverseScale;
+			}
+		}
+
+		void StoreWorldMatrix(const float(&world)[3][3], const Vector3& position, const float(&inverseTranspose)[3][4],
+			Matrix& worldMatrix, Matrix& inverseTransposeWorldMatrix)
+		{
+			for (int i{}; i < 3; ++i)
+			{
+				worldMatrix[i] = { world[i][0], world[i][1], world[i][2], 0.f };
+				inverseTransposeWorldMatrix[i] = { inverseTranspose[i][0], inverseTranspose[i][1], inverseTranspose[i][2], inverseTranspose[i][3] };
+			}
+			worldMatrix[3] = { position, 1.f };
+			inverseTransposeWorldMatrix[3] = { 0.f, 0.f, 0.f, 1.f };
+		}
+	}
+
+	void Transform::SetPosition(const Vector3& position)
+	{
+		m_Position = position;
+		m_IsDirty = true;
+	}
+
+	void Transform::Translate(const Vector3& offset)
+	{
+		m_Position += offset;
+		m_IsDirty = true;
+	}
+
+	void Transform::SetRotation(const Quaternion& rotation)
+	{
+		m_Rotation = rotation.Normalized();
+		m_IsDirty = true;
+	}
+
+	void Transform::Rotate(const Quaternion& rotation)
+	{
+		m_Rotation = (rotation * m_Rotation).Normalized();
+		m_IsDirty = true;
+	}
+
+	void Transform::SetScale(const Vector3& scale)
+	{
+		assert(scale.x != 0.f && scale.y != 0.f && scale.z != 0.f && "ERROR: zero scale has no inverse!");
+		m_Scale = scale;
+		m_IsDirty = true;
+	}
+
+	const Matrix& Transform::GetWorldMatrix() const
+	{
+		if (m_IsDirty)
+			UpdateWorldMatrix();
+		return m_WorldMatrix;
+	}
+
+	const Matrix& Transform::GetInverseTransposeWorldMatrix() const
+	{
+		if (m_IsDirty)
+			UpdateWorldMatrix();
+		return m_InverseTransposeWorldMatrix;
+	}
+
+	void Transform::UpdateWorldMatrix() const
+	{
+		const float rotation[4]{ m_Rotation.x, m_Rotation.y, m_Rotation.z, m_Rotation.w };
+		const float position[3]{ m_Position.x, m_Position.y, m_Position.z };
+		const float scale[3]{ m_Scale.x, m_Scale.y, m_Scale.z };
+		float world[3][3];
+		float inverseTranspose[3][4];
+		ComposeWorldMatrix(rotation, position, scale, world, inverseTranspose);
+		StoreWorldMatrix(world, m_Position, inverseTranspose, m_WorldMatrix, m_InverseTransposeWorldMatrix);
+		m_IsDirty = false;
+	}
+
+	void Transform::UpdateWorldMatrices(std::span<Transform* const> transforms)
+	{
+#ifdef DAE_MATH_SIMD
+		constexpr size_t width{ SimdFloat::width };
+		// Dirty ones packed into lanes, position and scale components next to the rotation
+		alignas(64) float input[10][width];
+		alignas(64) float world[3][3][width];
+		alignas(64) float inverseTranspose[3][4][width];
+		Transform* pBlock[width];
+		size_t numInBlock{};
+
+		const auto flushBlock{ [&]()
+			{
+				SimdFloat rotation[4], position[3], scale[3];
+				for (int c{}; c < 4; ++c)
+					rotation[c] = SimdFloat::Load(input[c]);
+				for (int c{}; c < 3; ++c)
+				{
+					position[c] = SimdFloat::Load(input[4 + c]);
+					scale[c] = SimdFloat::Load(input[7 + c]);
+				}
+				SimdFloat worldLanes[3][3], inverseTransposeLanes[3][4];
+				ComposeWorldMatrix(rotation, position, scale, worldLanes, inverseTransposeLanes);
+				for (int i{}; i < 3; ++i)
+				{
+					for (int j{}; j < 3; ++j)
+						worldLanes[i][j].Store(world[i][j]);
+					for (int j{}; j < 4; ++j)
+						inverseTransposeLanes[i][j].Store(inverseTranspose[i][j]);
+				}
+
+				for (size_t lane{}; lane < numInBlock; ++lane)
+				{
+					float laneWorld[3][3], laneInverseTranspose[3][4];
+					for (int i{}; i < 3; ++i)
+					{
+						for (int j{}; j < 3; ++j)
+							laneWorld[i][j] = world[i][j][lane];
+						for (int j{}; j < 4; ++j)
+							laneInverseTranspose[i][j] = inverseTranspose[i][j][lane];
+					}
+					Transform& transform{ *pBlock[lane] };
+					StoreWorldMatrix(laneWorld, transform.m_Position, laneInverseTranspose, transform.m_WorldMatrix, transform.m_InverseTransposeWorldMatrix);
+					transform.m_IsDirty = false;
+				}
+				numInBlock = 0;
+			} };
+
+		for (Transform* pTransform : transforms)
+		{
+			if (!pTransform->m_IsDirty)
+				continue;
+
+			const float values[10]{ pTransform->m_Rotation.x, pTransform->m_Rotation.y, pTransform->m_Rotation.z, pTransform->m_Rotation.w,
+				pTransform->m_Position.x, pTransform->m_Position.y, pTransform->m_Position.z,
+				pTransform->m_Scale.x, pTransform->m_Scale.y, pTransform->m_Scale.z };
+			for (int c{}; c < 10; ++c)
+				input[c][numInBlock] = values[c];
+			pBlock[numInBlock++] = pTransform;
+			if (numInBlock == width)
+				flushBlock();
+		}
+
+		// Fewer than width left over
+		for (size_t lane{}; lane < numInBlock; ++lane)
+			pBlock[lane]->UpdateWorldMatrix();
+#else
+		for (Transform* pTransform : transforms)
+		{
+			if (pTransform->m_IsDirty)
+				pTransform->UpdateWorldMatrix();
+		}
+#endif
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <span>
+#include "Math.h"
+
+namespace dae
+{
+	// Position, rotation and scale, with the world matrix built from them only after one of them changed
+	class Transform final
+	{
+	public:
+		Transform() = default;
+
+		const Vector3& GetPosition() const { return m_Position; }
+		void SetPosition(const Vector3& position);
+		void Translate(const Vector3& offset);
+
+		const Quaternion& GetRotation() const { return m_Rotation; }
+		void SetRotation(const Quaternion& rotation);
+		// Applied before the current rotation, like Matrix::CreateRotationY(angle) * rotationMatrix.
+		// Renormalized every time, so rotating each frame doesn't drift
+		void Rotate(const Quaternion& rotation);
+
+		const Vector3& GetScale() const { return m_Scale; }
+		void SetScale(const Vector3& scale);
+
+		bool IsDirty() const { return m_IsDirty; }
+
+		// Scale, then rotation, then translation
+		const Matrix& GetWorldMatrix() const;
+		// Takes normals to world space, also under non-uniform scale. Transposed it's the inverse world matrix
+		const Matrix& GetInverseTransposeWorldMatrix() const;
+
+		// Rebuilds the matrices of the dirty ones, SimdFloat::width at a time. The getters do the same on demand,
+		// this is for updating everything once a frame
+		static void UpdateWorldMatrices(std::span<Transform* const> transforms);
+
+	private:
+		void UpdateWorldMatrix() const;
+
+		Vector3 m_Position{ Vector3::Zero };
+		Quaternion m_Rotation{ Quaternion::Identity };
+		Vector3 m_Scale{ 1.f, 1.f, 1.f };
+
+		// Cache, kept identity while the transform is
+		mutable Matrix m_WorldMatrix{ Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, Vector3::Zero };
+		mutable Matrix m_InverseTransposeWorldMatrix{ Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, Vector3::Zero };
+		mutable bool m_IsDirty{};
+	};
+}
@@ -0,0 +1,895 @@
+#include "pch.h"
+#include "Utils.h"
+#include "MappedFile.h"
+
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace dae
+{
+	namespace
+	{
+		// ---- OBJ TOKENIZER ----
+		// Works directly on the mapped bytes, a token is never copied out of the file
+
+		inline bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		inline void SkipSpaces(const char*& pCurrent, const char* pEnd)
+		{
+			while (pCurrent < pEnd && IsSpace(*pCurrent)) ++pCurrent;
+		}
+
+		inline void SkipLine(const char*& pCurrent, const char* pEnd)
+		{
+			const void* pNewLine{ std::memchr(pCurrent, '\n', static_cast<size_t>(pEnd - pCurrent)) };
+			pCurrent = pNewLine ? static_cast<const char*>(pNewLine) + 1 : pEnd;
+		}
+
+		inline float ParseFloat(const char*& pCurrent, const char* pEnd)
+		{
+			SkipSpaces(pCurrent, pEnd);
+			// from_chars does not accept an explicit plus sign
+			if (pCurrent < pEnd && *pCurrent == '+') ++pCurrent;
+
+			float value{};
+			pCurrent = std::from_chars(pCurrent, pEnd, value).ptr;
+			return value;
+		}
+
+		inline uint32_t ParseIndex(const char*& pCurrent, const char* pEnd)
+		{
+			SkipSpaces(pCurrent, pEnd);
+
+			uint32_t value{};
+			pCurrent = std::from_chars(pCurrent, pEnd, value).ptr;
+			return value;
+		}
+
+		// ---- OBJ CHUNKS ----
+
+		// 1-based indices into the global attribute pools, 0 means the attribute is absent
+		struct ObjCorner
+		{
+			uint32_t position;
+			uint32_t uv;
+			uint32_t normal;
+		};
+
+		// Everything one worker found in its newline-aligned slice of the file
+		struct ObjChunk
+		{
+			const char* pBegin{};
+			const char* pEnd{};
+
+			std::vector<Vector3> positions{};
+			std::vector<Vector3> normals{};
+			std::vector<Vector2> UVs{};
+			// 3 per face, in file order
+			std::vector<ObjCorner> corners{};
+
+			// Prefix sums over the previous chunks
+			size_t positionOffset{};
+			size_t normalOffset{};
+			size_t uvOffset{};
+			size_t cornerOffset{};
+
+			bool isValid{ true };
+		};
+
+		// Don't bother spinning up a thread for less than this
+		constexpr size_t minBytesPerChunk{ 256 * 1024 };
+
+		// Calls handler.Position, handler.UV, handler.Normal and handler.Face for every record in [pBegin, pEnd), which holds whole lines
+		template<typename Handler>
+		void ParseLines(const char* pBegin, const char* pEnd, Handler& handler)
+		{
+			const char* pCurrent{ pBegin };
+			while (pCurrent < pEnd)
+			{
+				SkipSpaces(pCurrent, pEnd);
+
+				// Read the command, the first word of the line
+				const char* const pCommand{ pCurrent };
+				while (pCurrent < pEnd && !IsSpace(*pCurrent) && *pCurrent != '\n') ++pCurrent;
+				const size_t commandLength{ static_cast<size_t>(pCurrent - pCommand) };
+
+				if (commandLength == 1 && pCommand[0] == 'v')
+				{
+					//Vertex
+					const float x{ ParseFloat(pCurrent, pEnd) };
+					const float y{ ParseFloat(pCurrent, pEnd) };
+					const float z{ ParseFloat(pCurrent, pEnd) };
+
+					handler.Position({ x, y, z });
+				}
+				else if (commandLength == 2 && pCommand[0] == 'v' && pCommand[1] == 't')
+				{
+					// Vertex TexCoord
+					const float u{ ParseFloat(pCurrent, pEnd) };
+					const float v{ ParseFloat(pCurrent, pEnd) };
+					handler.UV({ u, 1 - v });
+				}
+				else if (commandLength == 2 && pCommand[0] == 'v' && pCommand[1] == 'n')
+				{
+					// Vertex Normal
+					const float x{ ParseFloat(pCurrent, pEnd) };
+					const float y{ ParseFloat(pCurrent, pEnd) };
+					const float z{ ParseFloat(pCurrent, pEnd) };
+
+					handler.Normal({ x, y, z });
+				}
+				else if (commandLength == 1 && pCommand[0] == 'f')
+				{
+					// Faces or triangles
+					// A corner without uv or normal keeps the one of the previous corner of the face
+					ObjCorner corners[3]{};
+					ObjCorner corner{};
+					for (size_t iFace = 0; iFace < 3; iFace++)
+					{
+						corner.position = ParseIndex(pCurrent, pEnd);
+
+						if (pCurrent < pEnd && '/' == *pCurrent)
+						{
+							++pCurrent;
+
+							// Optional texture coordinate
+							if (pCurrent < pEnd && '/' != *pCurrent)
+								corner.uv = ParseIndex(pCurrent, pEnd);
+
+							if (pCurrent < pEnd && '/' == *pCurrent)
+							{
+								++pCurrent;
+
+								// Optional vertex normal
+								corner.normal = ParseIndex(pCurrent, pEnd);
+							}
+						}
+
+						corners[iFace] = corner;
+					}
+					handler.Face(corners);
+				}
+				//read till end of line and ignore all remaining chars (also skips comments)
+				SkipLine(pCurrent, pEnd);
+			}
+		}
+
+		void ParseChunk(ObjChunk& chunk)
+		{
+			struct ChunkHandler
+			{
+				ObjChunk& chunk;
+				void Position(const Vector3& position) { chunk.positions.push_back(position); }
+				void UV(const Vector2& uv) { chunk.UVs.push_back(uv); }
+				void Normal(const Vector3& normal) { chunk.normals.push_back(normal); }
+				void Face(const ObjCorner (&corners)[3]) { chunk.corners.insert(chunk.corners.end(), corners, corners + 3); }
+			};
+
+			ChunkHandler handler{ chunk };
+			ParseLines(chunk.pBegin, chunk.pEnd, handler);
+		}
+
+		// The attribute pools of all chunks, concatenated in file order
+		struct ObjPools
+		{
+			std::vector<Vector3> positions{};
+			std::vector<Vector3> normals{};
+			std::vector<Vector2> UVs{};
+		};
+
+		void MergeChunkPools(ObjChunk& chunk, ObjPools& pools)
+		{
+			std::copy(chunk.positions.begin(), chunk.positions.end(), pools.positions.begin() + chunk.positionOffset);
+			std::copy(chunk.normals.begin(), chunk.normals.end(), pools.normals.begin() + chunk.normalOffset);
+			std::copy(chunk.UVs.begin(), chunk.UVs.end(), pools.UVs.begin() + chunk.uvOffset);
+		}
+
+		inline bool IsCornerValid(const ObjCorner& corner, const ObjPools& pools)
+		{
+			return corner.position != 0 && corner.position <= pools.positions.size() && corner.uv <= pools.UVs.size() && corner.normal <= pools.normals.size();
+		}
+
+		inline Vertex ResolveCorner(const ObjCorner& corner, const ObjPools& pools)
+		{
+			// OBJ format uses 1-based arrays
+			Vertex vertex{};
+			vertex.position = pools.positions[corner.position - 1];
+			if (corner.uv != 0)
+				vertex.uv = pools.UVs[corner.uv - 1];
+#ifdef ENABLE_NORMAL
+			if (corner.normal != 0)
+				vertex.normal = pools.normals[corner.normal - 1];
+#endif
+			return vertex;
+		}
+
+		inline void WriteFaceIndices(uint32_t* pIndex, uint32_t index0, uint32_t index1, uint32_t index2, bool flipAxisAndWinding)
+		{
+			pIndex[0] = index0;
+			pIndex[1] = flipAxisAndWinding ? index2 : index1;
+			pIndex[2] = flipAxisAndWinding ? index1 : index2;
+		}
+
+		// Resolves the corners of one chunk against the merged pools and writes them at the chunk's global offset
+		void BuildChunkVertices(ObjChunk& chunk, const ObjPools& pools,
+			std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+		{
+			for (size_t i{}; i < chunk.corners.size(); ++i)
+			{
+				if (!IsCornerValid(chunk.corners[i], pools))
+				{
+					chunk.isValid = false;
+					return;
+				}
+				vertices[chunk.cornerOffset + i] = ResolveCorner(chunk.corners[i], pools);
+			}
+
+			for (size_t i{}; i < chunk.corners.size(); i += 3)
+			{
+				const uint32_t index{ static_cast<uint32_t>(chunk.cornerOffset + i) };
+				WriteFaceIndices(&indices[chunk.cornerOffset + i], index, index + 1, index + 2, flipAxisAndWinding);
+			}
+		}
+
+		// ---- VERTEX WELDING ----
+
+		inline bool operator==(const ObjCorner& a, const ObjCorner& b)
+		{
+			return a.position == b.position && a.uv == b.uv && a.normal == b.normal;
+		}
+
+		inline uint32_t HashCorner(const ObjCorner& corner)
+		{
+			uint32_t hash{ corner.position * 0x9E3779B1u };
+			hash ^= corner.uv * 0x85EBCA77u + (hash << 6) + (hash >> 2);
+			hash ^= corner.normal * 0xC2B2AE3Du + (hash << 6) + (hash >> 2);
+			return hash ^ (hash >> 15);
+		}
+
+		// Open addressing (linear probing) from an index triple to the vertex it was welded into
+		class CornerWelder final
+		{
+		public:
+			explicit CornerWelder(size_t expectedCount)
+			{
+				size_t capacity{ 64 };
+				while (capacity < expectedCount * 2) capacity *= 2;
+				m_Slots.resize(capacity);
+				m_UniqueCorners.reserve(expectedCount);
+			}
+
+			// Returns the welded vertex index, isNew tells whether the triple was seen for the first time
+			uint32_t Insert(const ObjCorner& corner, bool& isNew)
+			{
+				const size_t mask{ m_Slots.size() - 1 };
+				size_t slot{ HashCorner(corner) & mask };
+				while (m_Slots[slot] != 0)
+				{
+					const uint32_t vertexIndex{ m_Slots[slot] - 1 };
+					if (m_UniqueCorners[vertexIndex] == corner)
+					{
+						isNew = false;
+						return vertexIndex;
+					}
+					slot = (slot + 1) & mask;
+				}
+
+				isNew = true;
+				m_UniqueCorners.push_back(corner);
+				m_Slots[slot] = static_cast<uint32_t>(m_UniqueCorners.size());
+
+				// Keep the load factor under one half
+				if (m_UniqueCorners.size() * 2 > m_Slots.size())
+					Grow();
+
+				return static_cast<uint32_t>(m_UniqueCorners.size()) - 1;
+			}
+
+		private:
+			// Slot holds vertex index + 1, 0 marks an empty slot
+			std::vector<uint32_t> m_Slots{};
+			std::vector<ObjCorner> m_UniqueCorners{};
+
+			void Grow()
+			{
+				m_Slots.assign(m_Slots.size() * 2, 0);
+				const size_t mask{ m_Slots.size() - 1 };
+				for (uint32_t i{}; i < m_UniqueCorners.size(); ++i)
+				{
+					size_t slot{ HashCorner(m_UniqueCorners[i]) & mask };
+					while (m_Slots[slot] != 0) slot = (slot + 1) & mask;
+					m_Slots[slot] = i + 1;
+				}
+			}
+		};
+
+		// Serial on purpose, first-seen order keeps the result independent of the thread count
+		bool WeldChunks(const std::vector<ObjChunk>& chunks, const ObjPools& pools,
+			std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+		{
+			const size_t numCorners{ chunks.back().cornerOffset + chunks.back().corners.size() };
+			// Typical meshes share every position 4 to 6 times
+			CornerWelder welder{ numCorners / 4 };
+			vertices.reserve(numCorners / 4);
+			indices.resize(numCorners);
+
+			for (const ObjChunk& chunk : chunks)
+			{
+				for (size_t i{}; i < chunk.corners.size(); i += 3)
+				{
+					uint32_t tempIndices[3];
+					for (size_t iFace{}; iFace < 3; ++iFace)
+					{
+						const ObjCorner& corner{ chunk.corners[i + iFace] };
+						if (!IsCornerValid(corner, pools))
+							return false;
+
+						bool isNew{};
+						tempIndices[iFace] = welder.Insert(corner, isNew);
+						if (isNew)
+							vertices.push_back(ResolveCorner(corner, pools));
+					}
+					WriteFaceIndices(&indices[chunk.cornerOffset + i], tempIndices[0], tempIndices[1], tempIndices[2], flipAxisAndWinding);
+				}
+			}
+			return true;
+		}
+
+		// ---- STREAMING ----
+
+		// Read size of StreamOBJ, a line longer than this grows the buffer
+		constexpr size_t streamBlockSize{ 4 * 1024 * 1024 };
+
+		// Hands out the file in blocks of whole lines through one buffer, so only a block of the file is ever resident
+		class ObjLineReader final
+		{
+		public:
+			explicit ObjLineReader(const std::string& path)
+				: m_File{ path, std::ios::binary }
+				, m_Buffer(streamBlockSize)
+			{
+			}
+
+			ObjLineReader(const ObjLineReader& other) = delete;
+			ObjLineReader& operator=(const ObjLineReader& other) = delete;
+			ObjLineReader(ObjLineReader&& other) = delete;
+			ObjLineReader& operator=(ObjLineReader&& other) = delete;
+
+			bool IsValid() const { return m_File.is_open(); }
+			uint64_t GetBytesRead() const { return m_BytesRead; }
+
+			// False once the file is exhausted, the block is valid until the next call
+			bool Next(const char*& pBegin, const char*& pEnd)
+			{
+				// The partial line after the previous block moves to the front
+				std::memmove(m_Buffer.data(), m_Buffer.data() + m_BlockSize, m_Size - m_BlockSize);
+				m_Size -= m_BlockSize;
+				m_BlockSize = 0;
+
+				while (m_BlockSize == 0)
+				{
+					if (m_Size == m_Buffer.size())
+						m_Buffer.resize(m_Buffer.size() * 2);
+
+					m_File.read(m_Buffer.data() + m_Size, static_cast<std::streamsize>(m_Buffer.size() - m_Size));
+					const size_t numRead{ static_cast<size_t>(m_File.gcount()) };
+					m_Size += numRead;
+					m_BytesRead += numRead;
+
+					if (!m_File || numRead == 0)
+					{
+						// The last line doesn't need a newline
+						m_BlockSize = m_Size;
+						break;
+					}
+					for (size_t i{ m_Size }; i-- > 0;)
+					{
+						if (m_Buffer[i] == '\n')
+						{
+							m_BlockSize = i + 1;
+							break;
+						}
+					}
+				}
+
+				pBegin = m_Buffer.data();
+				pEnd = m_Buffer.data() + m_BlockSize;
+				return m_BlockSize > 0;
+			}
+
+		private:
+			std::ifstream m_File;
+			std::vector<char> m_Buffer;
+			// Bytes in the buffer, the block handed out last is the first m_BlockSize of them
+			size_t m_Size{};
+			size_t m_BlockSize{};
+			uint64_t m_BytesRead{};
+		};
+
+		// Which records of one attribute pool the faces use, and where each of them lands in the compacted pool
+		// A bit per record plus a running count per 64 of them
+		class ReferencedRecords final
+		{
+		public:
+			// 1-based like the face records
+			void Mark(uint32_t record)
+			{
+				const size_t bit{ record - size_t{ 1 } };
+				if (bit / 64 >= m_Words.size())
+					m_Words.resize(bit / 64 + 1);
+				m_Words[bit / 64] |= uint64_t{ 1 } << (bit % 64);
+			}
+
+			// Call once every record is marked
+			void Finalize()
+			{
+				m_Ranks.resize(m_Words.size());
+				uint32_t rank{};
+				for (size_t i{}; i < m_Words.size(); ++i)
+				{
+					m_Ranks[i] = rank;
+					rank += static_cast<uint32_t>(std::popcount(m_Words[i]));
+				}
+				m_NumReferenced = rank;
+			}
+
+			bool IsReferenced(uint32_t record) const
+			{
+				const size_t bit{ record - size_t{ 1 } };
+				return bit / 64 < m_Words.size() && (m_Words[bit / 64] >> (bit % 64) & 1) != 0;
+			}
+
+			// Only meaningful for referenced records
+			uint32_t GetCompactIndex(uint32_t record) const
+			{
+				const size_t bit{ record - size_t{ 1 } };
+				const uint64_t lowerBits{ m_Words[bit / 64] & ((uint64_t{ 1 } << (bit % 64)) - 1) };
+				return m_Ranks[bit / 64] + static_cast<uint32_t>(std::popcount(lowerBits));
+			}
+
+			uint32_t GetNumReferenced() const { return m_NumReferenced; }
+
+		private:
+			std::vector<uint64_t> m_Words{};
+			std::vector<uint32_t> m_Ranks{};
+			uint32_t m_NumReferenced{};
+		};
+
+		// First pass, only counts and marks
+		struct ObjScan
+		{
+			uint32_t numPositions{};
+			uint32_t numUVs{};
+			uint32_t numNormals{};
+			size_t numTriangles{};
+			ObjCorner maxRecords{};
+
+			ReferencedRecords positions{};
+			ReferencedRecords UVs{};
+			ReferencedRecords normals{};
+			bool hasForwardReferences{};
+			bool hasCornerWithoutPosition{};
+
+			void Position(const Vector3&) { ++numPositions; }
+			void UV(const Vector2&) { ++numUVs; }
+			void Normal(const Vector3&) { ++numNormals; }
+			void Face(const ObjCorner (&corners)[3])
+			{
+				for (const ObjCorner& corner : corners)
+				{
+					hasCornerWithoutPosition |= corner.position == 0;
+					if (corner.position != 0) positions.Mark(corner.position);
+					if (corner.uv != 0) UVs.Mark(corner.uv);
+					if (corner.normal != 0) normals.Mark(corner.normal);
+					maxRecords = { std::max(maxRecords.position, corner.position), std::max(maxRecords.uv, corner.uv), std::max(maxRecords.normal, corner.normal) };
+					hasForwardReferences |= corner.position > numPositions || corner.uv > numUVs || corner.normal > numNormals;
+				}
+				++numTriangles;
+			}
+
+			// A face without a position already spoils the file
+			bool IsReading() const { return !hasCornerWithoutPosition; }
+
+			// Same rule as IsCornerValid, checked once for the whole file
+			bool IsValid() const
+			{
+				return !hasCornerWithoutPosition && maxRecords.position <= numPositions && maxRecords.uv <= numUVs && maxRecords.normal <= numNormals;
+			}
+		};
+
+		// Second (and third) pass: loads the referenced records into compacted pools and turns the faces into batches
+		class ObjBatchBuilder final
+		{
+		public:
+			ObjBatchBuilder(const ObjScan& scan, const Utils::ObjStreamOptions& options, const Utils::ObjBatchCallback& onBatch)
+				: m_Scan{ scan }
+				, m_Options{ options }
+				, m_OnBatch{ onBatch }
+				, m_Welder{ options.weldVertices ? GetExpectedBatchVertices() : 0 }
+			{
+				m_Pools.positions.reserve(scan.positions.GetNumReferenced());
+				m_Pools.UVs.reserve(scan.UVs.GetNumReferenced());
+				m_Pools.normals.reserve(scan.normals.GetNumReferenced());
+			}
+
+			ObjBatchBuilder(const ObjBatchBuilder& other) = delete;
+			ObjBatchBuilder& operator=(const ObjBatchBuilder& other) = delete;
+			ObjBatchBuilder(ObjBatchBuilder&& other) = delete;
+			ObjBatchBuilder& operator=(ObjBatchBuilder&& other) = delete;
+
+			// Every pass reads the whole file, the records are counted again each time
+			void StartPass(bool loadRecords, bool buildFaces)
+			{
+				m_LoadRecords = loadRecords;
+				m_BuildFaces = buildFaces;
+				m_NumPositions = m_NumUVs = m_NumNormals = 0;
+			}
+
+			void Position(const Vector3& position)
+			{
+				if (m_LoadRecords && m_Scan.positions.IsReferenced(++m_NumPositions))
+					m_Pools.positions.push_back(position);
+			}
+			void UV(const Vector2& uv)
+			{
+				if (m_LoadRecords && m_Scan.UVs.IsReferenced(++m_NumUVs))
+					m_Pools.UVs.push_back(uv);
+			}
+			void Normal(const Vector3& normal)
+			{
+				if (m_LoadRecords && m_Scan.normals.IsReferenced(++m_NumNormals))
+					m_Pools.normals.push_back(normal);
+			}
+
+			void Face(const ObjCorner (&corners)[3])
+			{
+				if (!m_BuildFaces || !m_IsValid)
+					return;
+
+				uint32_t faceIndices[3];
+				for (size_t iFace{}; iFace < 3; ++iFace)
+				{
+					const ObjCorner& corner{ corners[iFace] };
+					bool isNew{ true };
+					faceIndices[iFace] = m_Options.weldVertices ? m_Welder.Insert(corner, isNew) : static_cast<uint32_t>(m_Vertices.size());
+					if (!isNew)
+						continue;
+
+					// Same corner, pointing into the compacted pools
+					const ObjCorner compactCorner{ m_Scan.positions.GetCompactIndex(corner.position) + 1,
+						corner.uv != 0 ? m_Scan.UVs.GetCompactIndex(corner.uv) + 1 : 0, corner.normal != 0 ? m_Scan.normals.GetCompactIndex(corner.normal) + 1 : 0 };
+					m_Vertices.push_back(ResolveCorner(compactCorner, m_Pools));
+				}
+
+				m_Indices.resize(m_Indices.size() + 3);
+				WriteFaceIndices(&m_Indices[m_Indices.size() - 3], faceIndices[0], faceIndices[1], faceIndices[2], m_Options.flipAxisAndWinding);
+				if (m_Indices.size() >= m_Options.batchTriangles * 3)
+					Flush();
+			}
+
+			// Finishes the batch so far and hands it out
+			void Flush()
+			{
+				if (m_Indices.empty() || !m_IsValid)
+					return;
+
+#ifdef ENABLE_TANGENT
+				TangentSpace::GenerateTangents(m_Vertices, m_Indices, m_Options.numThreads);
+#endif
+				if (m_Options.flipAxisAndWinding)
+				{
+					for (Vertex& v : m_Vertices)
+					{
+						v.position.z *= -1.f;
+#ifdef ENABLE_NORMAL
+						v.normal.z *= -1.f;
+#endif
+#ifdef ENABLE_TANGENT
+						v.tangent.z *= -1.f;
+#endif
+					}
+				}
+
+				// 32-bit indices
+				if (m_FirstVertex + m_Vertices.size() > UINT32_MAX)
+				{
+					m_IsValid = false;
+					return;
+				}
+				for (uint32_t& index : m_Indices)
+				{
+					index += static_cast<uint32_t>(m_FirstVertex);
+				}
+
+				m_IsValid = m_OnBatch(m_Vertices, m_Indices);
+				m_FirstVertex += m_Vertices.size();
+				++m_NumBatches;
+
+				m_Vertices.clear();
+				m_Indices.clear();
+				if (m_Options.weldVertices)
+					m_Welder = CornerWelder{ GetExpectedBatchVertices() };
+			}
+
+			bool IsReading() const { return m_IsValid; }
+			bool IsValid() const { return m_IsValid; }
+			size_t GetNumBatches() const { return m_NumBatches; }
+			size_t GetNumVertices() const { return m_FirstVertex; }
+			size_t GetPoolBytes() const
+			{
+				return m_Pools.positions.size() * sizeof(Vector3) + m_Pools.UVs.size() * sizeof(Vector2) + m_Pools.normals.size() * sizeof(Vector3);
+			}
+
+		private:
+			// Same guess as WeldChunks, a batch never has more triangles than the file
+			size_t GetExpectedBatchVertices() const
+			{
+				return std::min(m_Options.batchTriangles, m_Scan.numTriangles) * 3 / 4;
+			}
+
+			const ObjScan& m_Scan;
+			const Utils::ObjStreamOptions& m_Options;
+			const Utils::ObjBatchCallback& m_OnBatch;
+
+			ObjPools m_Pools{};
+			bool m_LoadRecords{};
+			bool m_BuildFaces{};
+			uint32_t m_NumPositions{};
+			uint32_t m_NumUVs{};
+			uint32_t m_NumNormals{};
+
+			// The batch being built, indices are local to it until Flush
+			std::vector<Vertex> m_Vertices{};
+			std::vector<uint32_t> m_Indices{};
+			CornerWelder m_Welder;
+			size_t m_FirstVertex{};
+			size_t m_NumBatches{};
+			bool m_IsValid{ true };
+		};
+	}
+
+	namespace Utils
+	{
+		bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding, ObjParseStats* pStats)
+		{
+			ObjParseOptions options{};
+			options.flipAxisAndWinding = flipAxisAndWinding;
+			return ParseOBJ(filename, vertices, indices, options, pStats);
+		}
+
+		bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const ObjParseOptions& options, ObjParseStats* pStats)
+		{
+			const auto startTime{ std::chrono::steady_clock::now() };
+
+			vertices.clear();
+			indices.clear();
+
+			const MappedFile file{ filename };
+			if (!file.IsValid())
+				return false;
+
+			// Split the file into newline-aligned chunks, one per worker
+			size_t numThreads{ options.numThreads != 0 ? options.numThreads : std::max(1u, std::thread::hardware_concurrency()) };
+			numThreads = std::clamp(file.GetSize() / minBytesPerChunk, size_t{ 1 }, numThreads);
+
+			std::vector<ObjChunk> chunks(numThreads);
+			const char* pChunkBegin{ file.GetData() };
+			for (size_t i{}; i < numThreads; ++i)
+			{
+				const char* pChunkEnd{ file.GetData() + file.GetSize() * (i + 1) / numThreads };
+				if (pChunkEnd < pChunkBegin) pChunkEnd = pChunkBegin;
+				if (i + 1 < numThreads)
+					SkipLine(pChunkEnd, file.GetEnd());
+				else
+					pChunkEnd = file.GetEnd();
+
+				chunks[i].pBegin = pChunkBegin;
+				chunks[i].pEnd = pChunkEnd;
+				pChunkBegin = pChunkEnd;
+			}
+
+			RunParallel(numThreads, [&chunks](size_t i) { ParseChunk(chunks[i]); });
+
+			// Prefix sums so every chunk knows where its records land globally
+			for (size_t i{ 1 }; i < numThreads; ++i)
+			{
+				const ObjChunk& previous{ chunks[i - 1] };
+				chunks[i].positionOffset = previous.positionOffset + previous.positions.size();
+				chunks[i].normalOffset = previous.normalOffset + previous.normals.size();
+				chunks[i].uvOffset = previous.uvOffset + previous.UVs.size();
+				chunks[i].cornerOffset = previous.cornerOffset + previous.corners.size();
+			}
+
+			const ObjChunk& lastChunk{ chunks.back() };
+			ObjPools pools{};
+			if (numThreads == 1)
+			{
+				pools.positions = std::move(chunks[0].positions);
+				pools.normals = std::move(chunks[0].normals);
+				pools.UVs = std::move(chunks[0].UVs);
+			}
+			else
+			{
+				pools.positions.resize(lastChunk.positionOffset + lastChunk.positions.size());
+				pools.normals.resize(lastChunk.normalOffset + lastChunk.normals.size());
+				pools.UVs.resize(lastChunk.uvOffset + lastChunk.UVs.size());
+				RunParallel(numThreads, [&](size_t i) { MergeChunkPools(chunks[i], pools); });
+			}
+
+			const size_t numCorners{ lastChunk.cornerOffset + lastChunk.corners.size() };
+			float weldMilliseconds{};
+			if (options.weldVertices)
+			{
+				const auto weldStartTime{ std::chrono::steady_clock::now() };
+				const bool isValid{ WeldChunks(chunks, pools, vertices, indices, options.flipAxisAndWinding) };
+				weldMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - weldStartTime).count();
+				if (!isValid)
+				{
+					vertices.clear();
+					indices.clear();
+					return false;
+				}
+			}
+			else
+			{
+				vertices.resize(numCorners);
+				indices.resize(numCorners);
+
+				RunParallel(numThreads, [&](size_t i) { BuildChunkVertices(chunks[i], pools, vertices, indices, options.flipAxisAndWinding); });
+
+				for (const ObjChunk& chunk : chunks)
+				{
+					if (!chunk.isValid)
+					{
+						vertices.clear();
+						indices.clear();
+						return false;
+					}
+				}
+			}
+
+#ifdef ENABLE_TANGENT
+			// In the file's own space, so the bitangent signs are the ones the texture was authored against
+			const TangentSpace::TangentStats tangentStats{ TangentSpace::GenerateTangents(vertices, indices, options.numThreads) };
+#endif
+
+			if (options.flipAxisAndWinding)
+			{
+				for (auto& v : vertices)
+				{
+					v.position.z *= -1.f;
+#ifdef ENABLE_NORMAL
+					v.normal.z *= -1.f;
+#endif
+#ifdef ENABLE_TANGENT
+					v.tangent.z *= -1.f;
+#endif
+				}
+			}
+
+			if (pStats)
+			{
+				pStats->fileSize = file.GetSize();
+				pStats->numThreads = static_cast<uint32_t>(numThreads);
+				pStats->numCorners = numCorners;
+				pStats->numVertices = vertices.size();
+				pStats->weldMilliseconds = weldMilliseconds;
+#ifdef ENABLE_TANGENT
+				pStats->tangents = tangentStats;
+#endif
+				pStats->parseMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			}
+
+			return true;
+		}
+
+		bool StreamOBJ(const std::string& filename, const ObjStreamOptions& options, const ObjBatchCallback& onBatch, ObjStreamStats* pStats)
+		{
+			const auto startTime{ std::chrono::steady_clock::now() };
+			if (options.batchTriangles == 0)
+				return false;
+
+			const auto readFile{ [&filename](auto& handler)
+				{
+					ObjLineReader reader{ filename };
+					const char* pBegin{};
+					const char* pEnd{};
+					while (handler.IsReading() && reader.Next(pBegin, pEnd))
+					{
+						ParseLines(pBegin, pEnd, handler);
+					}
+					return reader.GetBytesRead();
+				} };
+
+			if (!ObjLineReader{ filename }.IsValid())
+				return false;
+
+			// Pass 1: which records the faces reference
+			ObjScan scan{};
+			const uint64_t fileSize{ readFile(scan) };
+			if (!scan.IsValid())
+				return false;
+			scan.positions.Finalize();
+			scan.UVs.Finalize();
+			scan.normals.Finalize();
+
+			// Pass 2: the referenced records, and the faces right away unless one of them refers forward
+			ObjBatchBuilder builder{ scan, options, onBatch };
+			uint32_t numPasses{ 2 };
+			if (scan.hasForwardReferences)
+			{
+				builder.StartPass(true, false);
+				readFile(builder);
+				builder.StartPass(false, true);
+				++numPasses;
+			}
+			else
+			{
+				builder.StartPass(true, true);
+			}
+			readFile(builder);
+			builder.Flush();
+
+			if (pStats)
+			{
+				pStats->fileSize = fileSize;
+				pStats->numPasses = numPasses;
+				pStats->numBatches = builder.GetNumBatches();
+				pStats->numTriangles = scan.numTriangles;
+				pStats->numVertices = builder.GetNumVertices();
+				pStats->poolBytes = builder.GetPoolBytes();
+				pStats->milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			}
+
+			return builder.IsValid();
+		}
+
+		size_t GetPeakMemoryUsage()
+		{
+#ifdef _WIN32
+			PROCESS_MEMORY_COUNTERS counters{};
+			return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+			rusage usage{};
+			// Kilobytes on Linux
+			return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<size_t>(usage.ru_maxrss) * 1024 : 0;
+#endif
+		}
+
+		uint64_t HashBytes(const void* pData, size_t size, uint64_t seed)
+		{
+			constexpr uint64_t multiplier{ 0x9E3779B97F4A7C15ull };
+			const unsigned char* pBytes{ static_cast<const unsigned char*>(pData) };
+
+			uint64_t hash{ seed ^ (size * multiplier) };
+			// Eight bytes per step, memcpy keeps unaligned reads legal
+			for (; size >= 8; size -= 8, pBytes += 8)
+			{
+				uint64_t word;
+				std::memcpy(&word, pBytes, 8);
+				hash = (hash ^ word) * multiplier;
+				hash ^= hash >> 29;
+			}
+			for (; size > 0; --size, ++pBytes)
+			{
+				hash = (hash ^ *pBytes) * multiplier;
+			}
+			hash ^= hash >> 32;
+			return hash;
+		}
+	}
+}
@@ -1,8 +1,11 @@
 #pragma once
-#include <fstream>
+#include <string>
+#include <functional>
 #include <vector>
+#include <thread>
 #include "Math.h"
 #include "DataTypes.h"
+#include "TangentSpace.h"
 
 #define ENABLE_TANGENT
 #define ENABLE_NORMAL
@@ -11,177 +14,104 @@ namespace dae
 {
 	namespace Utils
 	{
-		//Just parses vertices and indices
-#pragma warning(push)
-#pragma warning(disable : 4505) //Warning unreferenced local function
-		static bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true)
+		struct ObjParseOptions
 		{
-#ifdef DISABLE_OBJ
-
-			//TODO: Enable the code below after uncommenting all the vertex attributes of DataTypes::Vertex
-			// >> Comment/Remove '#define DISABLE_OBJ'
-			assert(false && "OBJ PARSER not enabled! Check the comments in Utils::ParseOBJ");
-
-#else
-
-			std::ifstream file(filename);
-			if (!file)
-				return false;
-
-			std::vector<Vector3> positions{};
-			std::vector<Vector3> normals{};
-			std::vector<Vector2> UVs{};
-
-			vertices.clear();
-			indices.clear();
-
-			std::string sCommand;
-			// start a while iteration ending when the end of file is reached (ios::eof)
-			while (!file.eof())
+			bool flipAxisAndWinding{ true };
+			// Workers that each parse a newline-aligned chunk of the file, 0 picks the hardware concurrency
+			uint32_t numThreads{ 1 };
+			// Face corners with the same position/uv/normal triple share one vertex instead of getting their own
+			bool weldVertices{ false };
+		};
+
+		struct ObjParseStats
+		{
+			size_t fileSize{};
+			uint32_t numThreads{};
+			size_t numCorners{};
+			size_t numVertices{};
+			float parseMilliseconds{};
+			// Part of parseMilliseconds spent hashing corners, 0 without welding
+			float weldMilliseconds{};
+			// Part of parseMilliseconds spent on tangent frames
+			TangentSpace::TangentStats tangents{};
+
+			float GetMegabytesPerSecond() const
 			{
-				//read the first word of the string, use the >> operator (istream::operator>>) 
-				file >> sCommand;
-				//use conditional statements to process the different commands	
-				if (sCommand == "#")
-				{
-					// Ignore Comment
-				}
-				else if (sCommand == "v")
-				{
-					//Vertex
-					float x, y, z;
-					file >> x >> y >> z;
-
-					positions.emplace_back(x, y, z);
-				}
-				else if (sCommand == "vt")
-				{
-					// Vertex TexCoord
-					float u, v;
-					file >> u >> v;
-					UVs.emplace_back(u, 1 - v);
-				}
-				else if (sCommand == "vn")
-				{
-					// Vertex Normal
-					float x, y, z;
-					file >> x >> y >> z;
-
-					normals.emplace_back(x, y, z);
-				}
-				else if (sCommand == "f")
-				{
-					//if a face is read:
-					//construct the 3 vertices, add them to the vertex array
-					//add three indices to the index array
-					//add the material index as attibute to the attribute array
-					//
-					// Faces or triangles
-					Vertex vertex{};
-					size_t iPosition, iTexCoord, iNormal;
-
-					uint32_t tempIndices[3];
-					for (size_t iFace = 0; iFace < 3; iFace++)
-					{
-						// OBJ format uses 1-based arrays
-						file >> iPosition;
-						vertex.position = positions[iPosition - 1];
-
-						if ('/' == file.peek())//is next in buffer ==  '/' ?
-						{
-							file.ignore();//read and ignore one element ('/')
-
-							if ('/' != file.peek())
-							{
-								// Optional texture coordinate
-								file >> iTexCoord;
-								vertex.uv = UVs[iTexCoord - 1];
-							}
-
-							if ('/' == file.peek())
-							{
-								file.ignore();
-
-								// Optional vertex normal
-								file >> iNormal;
-#ifdef ENABLE_NORMAL
-								vertex.normal = normals[iNormal - 1];
-#endif
-							}
-							}
-
-						vertices.push_back(vertex);
-						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
-						//indices.push_back(uint32_t(vertices.size()) - 1);
-						}
-
-					indices.push_back(tempIndices[0]);
-					if (flipAxisAndWinding)
-					{
-						indices.push_back(tempIndices[2]);
-						indices.push_back(tempIndices[1]);
-					}
-					else
-					{
-						indices.push_back(tempIndices[1]);
-						indices.push_back(tempIndices[2]);
-					}
-					}
-				//read till end of line and ignore all remaining chars
-				file.ignore(1000, '\n');
-				}
+				return parseMilliseconds > 0.f ? (fileSize / (1024.f * 1024.f)) / (parseMilliseconds / 1000.f) : 0.f;
+			}
 
-#ifdef ENABLE_TANGENT
-			//Cheap Tangent Calculations
-			for (uint32_t i = 0; i < indices.size(); i += 3)
+			// Face corners per output vertex, 1 without welding
+			float GetWeldRatio() const
 			{
-				uint32_t index0 = indices[i];
-				uint32_t index1 = indices[size_t(i) + 1];
-				uint32_t index2 = indices[size_t(i) + 2];
-
-				const Vector3& p0 = vertices[index0].position;
-				const Vector3& p1 = vertices[index1].position;
-				const Vector3& p2 = vertices[index2].position;
-				const Vector2& uv0 = vertices[index0].uv;
-				const Vector2& uv1 = vertices[index1].uv;
-				const Vector2& uv2 = vertices[index2].uv;
+				return numVertices > 0 ? static_cast<float>(numCorners) / numVertices : 0.f;
+			}
+		};
 
-				const Vector3 edge0 = p1 - p0;
-				const Vector3 edge1 = p2 - p0;
-				const Vector2 diffX = Vector2(uv1.x - uv0.x, uv2.x - uv0.x);
-				const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
-				float r = 1.f / Vector2::Cross(diffX, diffY);
+		struct ObjStreamOptions
+		{
+			bool flipAxisAndWinding{ true };
+			// Only corners within the same batch are welded
+			bool weldVertices{ false };
+			// Triangles per batch, the output side of the memory bound
+			size_t batchTriangles{ 256 * 1024 };
+			// Threads for the tangent frames of a batch, 0 picks the hardware concurrency
+			uint32_t numThreads{ 0 };
+		};
+
+		struct ObjStreamStats
+		{
+			size_t fileSize{};
+			// 2, or 3 when a face refers to a record declared after it
+			uint32_t numPasses{};
+			size_t numBatches{};
+			size_t numTriangles{};
+			size_t numVertices{};
+			// The attribute records the faces reference, the part of the memory that still grows with the file
+			size_t poolBytes{};
+			float milliseconds{};
+
+			float GetMegabytesPerSecond() const
+			{
+				return milliseconds > 0.f ? (numPasses * fileSize / (1024.f * 1024.f)) / (milliseconds / 1000.f) : 0.f;
+			}
+		};
 
+		// Receives one finished batch, indices refer to the vertices of every batch so far. Returning false stops the import
+		using ObjBatchCallback = std::function<bool(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)>;
 
-				Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
-				vertices[index0].tangent += tangent;
-				vertices[index1].tangent += tangent;
-				vertices[index2].tangent += tangent;
+		//Just parses vertices and indices
+		//The file is memory-mapped and tokenized in place, no stream extraction and no per-token allocations
+		bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true, ObjParseStats* pStats = nullptr);
+		//Output is identical to the serial parse for any thread count
+		bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const ObjParseOptions& options, ObjParseStats* pStats = nullptr);
+
+		//Calls function(i) for i in [0, count), one thread each, 0 runs on the calling thread
+		template<typename Function>
+		void RunParallel(size_t count, const Function& function)
+		{
+			std::vector<std::thread> workers{};
+			workers.reserve(count > 0 ? count - 1 : 0);
+			for (size_t i{ 1 }; i < count; ++i)
+			{
+				workers.emplace_back([&function, i]() { function(i); });
 			}
-#endif
-
-			//Fix the tangents per vertex now because we accumulated
-			for (auto& v : vertices)
+			if (count > 0) function(0);
+			for (auto& worker : workers)
 			{
-#ifdef ENABLE_TANGENT
-				v.tangent = Vector3::Reject(v.tangent, v.normal).Normalized();
-#endif
-				if (flipAxisAndWinding)
-				{
-					v.position.z *= -1.f;
-#ifdef ENABLE_NORMAL
-					v.normal.z *= -1.f;
-#endif
-#ifdef ENABLE_TANGENT
-					v.tangent.z *= -1.f;
-#endif
-				}
-
+				worker.join();
 			}
-
-			return true;
-#endif
 		}
-#pragma warning(pop)
+
+		//Hands the mesh to onBatch in batches of finished vertices and indices, only ever holding one read buffer, the attribute
+		//records the faces reference and one batch. Matches ParseOBJ, except that welding and tangent frames stop at batch boundaries.
+		//The file is read front to back twice: to find the referenced records, then to load them and emit the faces
+		//(a third time, splitting the second, when a face refers to a record declared after it)
+		bool StreamOBJ(const std::string& filename, const ObjStreamOptions& options, const ObjBatchCallback& onBatch, ObjStreamStats* pStats = nullptr);
+
+		//Peak working set (resident set size) of the process so far, in bytes, 0 where it can't be queried
+		size_t GetPeakMemoryUsage();
+
+		//64-bit content hash used to detect stale caches, not cryptographic
+		uint64_t HashBytes(const void* pData, size_t size, uint64_t seed = 0);
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,537 @@
+#include "pch.h"
+#include "VertexFormat.h"
+
+#include <bit>
+#include <cstddef>
+
+#include "MathBackend.h"
+
+// Follows the math backend, so DAE_MATH_SCALAR turns this off as well
+#if defined(DAE_MATH_SSE)
+#define DAE_VERTEX_PACKING_SSE2
+#endif
+
+namespace dae
+{
+	namespace
+	{
+		constexpr float unorm16Max{ 65535.f };
+		constexpr float snorm16Max{ 32767.f };
+
+		// Bitangent sign of the tangent frame
+		inline float GetHandedness(const Vertex& vertex)
+		{
+			return vertex.tangent.w < 0.f ? -1.f : 1.f;
+		}
+
+		inline float SignNotZero(float value)
+		{
+			return std::copysign(1.f, value);
+		}
+
+		inline int16_t QuantizeSnorm16(float value)
+		{
+			return static_cast<int16_t>(std::nearbyint(std::clamp(value, -1.f, 1.f) * snorm16Max));
+		}
+
+		inline float DequantizeSnorm16(int16_t value)
+		{
+			return std::max(value / snorm16Max, -1.f);
+		}
+
+		// Project onto the octahedron, fold the lower half over the diagonals
+		// Zero and non-finite directions (degenerate uv tangents) encode as +Z
+		inline void EncodeOctahedral(const Vector3& direction, int16_t* pEncoded)
+		{
+			const float length{ std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z) };
+			if (!(length < INFINITY))
+			{
+				pEncoded[0] = 0;
+				pEncoded[1] = 0;
+				return;
+			}
+
+			const float invLength{ 1.f / std::max(length, FLT_MIN) };
+			float x{ direction.x * invLength };
+			float y{ direction.y * invLength };
+			if (direction.z < 0.f)
+			{
+				const float foldedX{ (1.f - std::abs(y)) * SignNotZero(x) };
+				const float foldedY{ (1.f - std::abs(x)) * SignNotZero(y) };
+				x = foldedX;
+				y = foldedY;
+			}
+			pEncoded[0] = QuantizeSnorm16(x);
+			pEncoded[1] = QuantizeSnorm16(y);
+		}
+
+		inline Vector3 DecodeOctahedral(const int16_t* pEncoded)
+		{
+			Vector3 direction{ DequantizeSnorm16(pEncoded[0]), DequantizeSnorm16(pEncoded[1]), 0.f };
+			direction.z = 1.f - std::abs(direction.x) - std::abs(direction.y);
+			const float fold{ std::max(-direction.z, 0.f) };
+			direction.x += direction.x >= 0.f ? -fold : fold;
+			direction.y += direction.y >= 0.f ? -fold : fold;
+			return direction.Normalized();
+		}
+
+		inline uint16_t QuantizeUnorm16(float value, float min, float scale)
+		{
+			return static_cast<uint16_t>(std::nearbyint(std::clamp((value - min) * scale, 0.f, unorm16Max)));
+		}
+
+		inline void PackVertex(const Vertex& vertex, const VertexPacking::QuantizationBounds& bounds, const Vector3& scale, PackedVertex& packed)
+		{
+			packed.position[0] = QuantizeUnorm16(vertex.position.x, bounds.min.x, scale.x);
+			packed.position[1] = QuantizeUnorm16(vertex.position.y, bounds.min.y, scale.y);
+			packed.position[2] = QuantizeUnorm16(vertex.position.z, bounds.min.z, scale.z);
+			packed.position[3] = GetHandedness(vertex) < 0.f ? 0 : 65535;
+			packed.uv[0] = VertexPacking::FloatToHalf(vertex.uv.x);
+			packed.uv[1] = VertexPacking::FloatToHalf(vertex.uv.y);
+			EncodeOctahedral(vertex.normal, packed.normal);
+			EncodeOctahedral(vertex.tangent.GetXYZ(), packed.tangent);
+		}
+
+		inline void UnpackVertex(const PackedVertex& packed, const VertexPacking::QuantizationBounds& bounds, const Vector3& step, Vertex& vertex)
+		{
+			vertex.position = { bounds.min.x + packed.position[0] * step.x, bounds.min.y + packed.position[1] * step.y, bounds.min.z + packed.position[2] * step.z };
+			vertex.uv = { VertexPacking::HalfToFloat(packed.uv[0]), VertexPacking::HalfToFloat(packed.uv[1]) };
+			vertex.normal = DecodeOctahedral(packed.normal);
+			vertex.tangent = { DecodeOctahedral(packed.tangent), packed.position[3] == 0 ? -1.f : 1.f };
+		}
+
+		// Quantization scale per axis, 0 for a flat axis
+		inline Vector3 GetQuantizationScale(const VertexPacking::QuantizationBounds& bounds)
+		{
+			return { bounds.extent.x > 0.f ? unorm16Max / bounds.extent.x : 0.f,
+				bounds.extent.y > 0.f ? unorm16Max / bounds.extent.y : 0.f,
+				bounds.extent.z > 0.f ? unorm16Max / bounds.extent.z : 0.f };
+		}
+
+		inline Vector3 GetQuantizationStep(const VertexPacking::QuantizationBounds& bounds)
+		{
+			return bounds.extent / unorm16Max;
+		}
+
+		inline float GetAngle(const Vector3& a, const Vector3& b)
+		{
+			return std::atan2(Vector3::Cross(a, b).Magnitude(), Vector3::Dot(a, b));
+		}
+
+#ifdef DAE_VERTEX_PACKING_SSE2
+		// Round to nearest even, same results as FloatToHalf (after Fabian Giesen's float_to_half_fast3_rtne)
+		inline __m128i FloatToHalf4(__m128 value)
+		{
+			const __m128i maxHalf{ _mm_set1_epi32((127 + 16) << 23) };
+			const __m128i minNormalHalf{ _mm_set1_epi32((127 - 14) << 23) };
+			const __m128i subnormalMagic{ _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23) };
+			const __m128i normalBias{ _mm_set1_epi32(0xfff - ((127 - 15) << 23)) };
+
+			const __m128 sign{ _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)))) };
+			const __m128 absolute{ _mm_xor_ps(value, sign) };
+			const __m128i absoluteBits{ _mm_castps_si128(absolute) };
+
+			const __m128i isNan{ _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute)) };
+			const __m128i isRegular{ _mm_cmpgt_epi32(maxHalf, absoluteBits) };
+			const __m128i infOrNan{ _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00)) };
+			const __m128i isSubnormal{ _mm_cmpgt_epi32(minNormalHalf, absoluteBits) };
+
+			const __m128i subnormal{ _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(subnormalMagic))), subnormalMagic) };
+
+			const __m128i mantissaOdd{ _mm_srai_epi32(_mm_slli_epi32(absoluteBits, 31 - 13), 31) };
+			const __m128i normal{ _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absoluteBits, normalBias), mantissaOdd), 13) };
+
+			const __m128i finite{ _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal)) };
+			const __m128i result{ _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infOrNan)) };
+			return _mm_or_si128(result, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+		}
+
+		inline __m128 HalfToFloat4(__m128i value)
+		{
+			const __m128i shiftedExponent{ _mm_set1_epi32(0x7c00 << 13) };
+			const __m128 magic{ _mm_castsi128_ps(_mm_set1_epi32(113 << 23)) };
+
+			__m128i bits{ _mm_slli_epi32(_mm_and_si128(value, _mm_set1_epi32(0x7fff)), 13) };
+			const __m128i exponent{ _mm_and_si128(bits, shiftedExponent) };
+			bits = _mm_add_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+
+			// Inf/NaN get the rest of the float exponent, subnormals are renormalized through the magic subtraction
+			const __m128i isInfOrNan{ _mm_cmpeq_epi32(exponent, shiftedExponent) };
+			bits = _mm_add_epi32(bits, _mm_and_si128(isInfOrNan, _mm_set1_epi32((128 - 16) << 23)));
+			const __m128i isSubnormal{ _mm_cmpeq_epi32(exponent, _mm_setzero_si128()) };
+			const __m128 renormalized{ _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))), magic) };
+			const __m128 result{ _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(isSubnormal), renormalized), _mm_andnot_ps(_mm_castsi128_ps(isSubnormal), _mm_castsi128_ps(bits))) };
+
+			return _mm_or_ps(result, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(value, _mm_set1_epi32(0x8000)), 16)));
+		}
+
+		inline __m128 Abs4(__m128 value)
+		{
+			return _mm_andnot_ps(_mm_set1_ps(-0.f), value);
+		}
+
+		inline __m128 SignNotZero4(__m128 value)
+		{
+			return _mm_or_ps(_mm_and_ps(value, _mm_set1_ps(-0.f)), _mm_set1_ps(1.f));
+		}
+
+		inline __m128 Select4(__m128 mask, __m128 a, __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		// Rounds to nearest even like nearbyint under the default MXCSR
+		inline __m128i QuantizeSnorm16x4(__m128 value)
+		{
+			const __m128 clamped{ _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f)) };
+			return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(snorm16Max)));
+		}
+
+		inline void EncodeOctahedral4(__m128 x, __m128 y, __m128 z, __m128i& encodedX, __m128i& encodedY)
+		{
+			const __m128 length{ _mm_add_ps(_mm_add_ps(Abs4(x), Abs4(y)), Abs4(z)) };
+			const __m128 isFinite{ _mm_cmplt_ps(length, _mm_set1_ps(INFINITY)) };
+			x = _mm_and_ps(x, isFinite);
+			y = _mm_and_ps(y, isFinite);
+			z = _mm_and_ps(z, isFinite);
+
+			const __m128 invLength{ _mm_div_ps(_mm_set1_ps(1.f), _mm_max_ps(_mm_and_ps(length, isFinite), _mm_set1_ps(FLT_MIN))) };
+			x = _mm_mul_ps(x, invLength);
+			y = _mm_mul_ps(y, invLength);
+
+			const __m128 isLowerHalf{ _mm_cmplt_ps(z, _mm_setzero_ps()) };
+			const __m128 foldedX{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), Abs4(y)), SignNotZero4(x)) };
+			const __m128 foldedY{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), Abs4(x)), SignNotZero4(y)) };
+
+			encodedX = QuantizeSnorm16x4(Select4(isLowerHalf, foldedX, x));
+			encodedY = QuantizeSnorm16x4(Select4(isLowerHalf, foldedY, y));
+		}
+
+		inline void DecodeOctahedral4(__m128i encodedX, __m128i encodedY, __m128& x, __m128& y, __m128& z)
+		{
+			const __m128 invMax{ _mm_set1_ps(1.f / snorm16Max) };
+			x = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(encodedX), invMax), _mm_set1_ps(-1.f));
+			y = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(encodedY), invMax), _mm_set1_ps(-1.f));
+			z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.f), Abs4(x)), Abs4(y));
+
+			// x += x >= 0 ? -fold : fold
+			const __m128 fold{ _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps()) };
+			const __m128 negativeFold{ _mm_sub_ps(_mm_setzero_ps(), fold) };
+			x = _mm_add_ps(x, Select4(_mm_cmpge_ps(x, _mm_setzero_ps()), negativeFold, fold));
+			y = _mm_add_ps(y, Select4(_mm_cmpge_ps(y, _mm_setzero_ps()), negativeFold, fold));
+
+			const __m128 invLength{ _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)))) };
+			x = _mm_mul_ps(x, invLength);
+			y = _mm_mul_ps(y, invLength);
+			z = _mm_mul_ps(z, invLength);
+		}
+#endif
+	}
+
+	namespace VertexPacking
+	{
+		QuantizationBounds ComputeBounds(const Vertex* pVertices, size_t numVertices)
+		{
+			if (numVertices == 0)
+				return {};
+
+			Vector3 boundsMin{ pVertices[0].position };
+			Vector3 boundsMax{ pVertices[0].position };
+			for (size_t i{ 1 }; i < numVertices; ++i)
+			{
+				const Vector3& position{ pVertices[i].position };
+				boundsMin = { std::min(boundsMin.x, position.x), std::min(boundsMin.y, position.y), std::min(boundsMin.z, position.z) };
+				boundsMax = { std::max(boundsMax.x, position.x), std::max(boundsMax.y, position.y), std::max(boundsMax.z, position.z) };
+			}
+			return ComputeBounds(boundsMin, boundsMax);
+		}
+
+		QuantizationBounds ComputeBounds(const Vector3& boundsMin, const Vector3& boundsMax)
+		{
+			return { boundsMin, boundsMax - boundsMin };
+		}
+
+		Matrix GetDequantizationMatrix(const QuantizationBounds& bounds)
+		{
+			return Matrix::CreateScale(bounds.extent) * Matrix::CreateTranslation(bounds.min);
+		}
+
+		void Pack(const Vertex* pVertices, size_t numVertices, const QuantizationBounds& bounds, PackedVertex* pPacked)
+		{
+			const Vector3 scale{ GetQuantizationScale(bounds) };
+			size_t i{};
+
+#ifdef DAE_VERTEX_PACKING_SSE2
+			const __m128 minX{ _mm_set1_ps(bounds.min.x) }, minY{ _mm_set1_ps(bounds.min.y) }, minZ{ _mm_set1_ps(bounds.min.z) };
+			const __m128 scaleX{ _mm_set1_ps(scale.x) }, scaleY{ _mm_set1_ps(scale.y) }, scaleZ{ _mm_set1_ps(scale.z) };
+			const __m128 zero{ _mm_setzero_ps() };
+			const __m128 maxUnorm{ _mm_set1_ps(unorm16Max) };
+
+			alignas(16) int32_t lanes[9][4];
+			for (; i + 4 <= numVertices; i += 4)
+			{
+				const Vertex& v0{ pVertices[i] };
+				const Vertex& v1{ pVertices[i + 1] };
+				const Vertex& v2{ pVertices[i + 2] };
+				const Vertex& v3{ pVertices[i + 3] };
+
+				const auto quantize{ [&](__m128 value, __m128 min, __m128 scale)
+					{
+						return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(value, min), scale), zero), maxUnorm));
+					} };
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[0]), quantize(_mm_setr_ps(v0.position.x, v1.position.x, v2.position.x, v3.position.x), minX, scaleX));
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[1]), quantize(_mm_setr_ps(v0.position.y, v1.position.y, v2.position.y, v3.position.y), minY, scaleY));
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[2]), quantize(_mm_setr_ps(v0.position.z, v1.position.z, v2.position.z, v3.position.z), minZ, scaleZ));
+
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[3]), FloatToHalf4(_mm_setr_ps(v0.uv.x, v1.uv.x, v2.uv.x, v3.uv.x)));
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[4]), FloatToHalf4(_mm_setr_ps(v0.uv.y, v1.uv.y, v2.uv.y, v3.uv.y)));
+
+				__m128i encodedX, encodedY;
+				EncodeOctahedral4(_mm_setr_ps(v0.normal.x, v1.normal.x, v2.normal.x, v3.normal.x),
+					_mm_setr_ps(v0.normal.y, v1.normal.y, v2.normal.y, v3.normal.y),
+					_mm_setr_ps(v0.normal.z, v1.normal.z, v2.normal.z, v3.normal.z), encodedX, encodedY);
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[5]), encodedX);
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[6]), encodedY);
+
+				EncodeOctahedral4(_mm_setr_ps(v0.tangent.x, v1.tangent.x, v2.tangent.x, v3.tangent.x),
+					_mm_setr_ps(v0.tangent.y, v1.tangent.y, v2.tangent.y, v3.tangent.y),
+					_mm_setr_ps(v0.tangent.z, v1.tangent.z, v2.tangent.z, v3.tangent.z), encodedX, encodedY);
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[7]), encodedX);
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[8]), encodedY);
+
+				for (int lane{}; lane < 4; ++lane)
+				{
+					PackedVertex& packed{ pPacked[i + lane] };
+					packed.position[0] = static_cast<uint16_t>(lanes[0][lane]);
+					packed.position[1] = static_cast<uint16_t>(lanes[1][lane]);
+					packed.position[2] = static_cast<uint16_t>(lanes[2][lane]);
+					packed.position[3] = GetHandedness(pVertices[i + lane]) < 0.f ? 0 : 65535;
+					packed.uv[0] = static_cast<uint16_t>(lanes[3][lane]);
+					packed.uv[1] = static_cast<uint16_t>(lanes[4][lane]);
+					packed.normal[0] = static_cast<int16_t>(lanes[5][lane]);
+					packed.normal[1] = static_cast<int16_t>(lanes[6][lane]);
+					packed.tangent[0] = static_cast<int16_t>(lanes[7][lane]);
+					packed.tangent[1] = static_cast<int16_t>(lanes[8][lane]);
+				}
+			}
+#endif
+
+			for (; i < numVertices; ++i)
+			{
+				PackVertex(pVertices[i], bounds, scale, pPacked[i]);
+			}
+		}
+
+		void Unpack(const PackedVertex* pPacked, size_t numVertices, const QuantizationBounds& bounds, Vertex* pVertices)
+		{
+			const Vector3 step{ GetQuantizationStep(bounds) };
+			size_t i{};
+
+#ifdef DAE_VERTEX_PACKING_SSE2
+			const __m128 minX{ _mm_set1_ps(bounds.min.x) }, minY{ _mm_set1_ps(bounds.min.y) }, minZ{ _mm_set1_ps(bounds.min.z) };
+			const __m128 stepX{ _mm_set1_ps(step.x) }, stepY{ _mm_set1_ps(step.y) }, stepZ{ _mm_set1_ps(step.z) };
+
+			alignas(16) float lanes[11][4];
+			for (; i + 4 <= numVertices; i += 4)
+			{
+				const PackedVertex& p0{ pPacked[i] };
+				const PackedVertex& p1{ pPacked[i + 1] };
+				const PackedVertex& p2{ pPacked[i + 2] };
+				const PackedVertex& p3{ pPacked[i + 3] };
+
+				const auto gather{ [&](auto member, int component)
+					{
+						return _mm_setr_epi32((p0.*member)[component], (p1.*member)[component], (p2.*member)[component], (p3.*member)[component]);
+					} };
+				const auto dequantize{ [](__m128i value, __m128 min, __m128 step)
+					{
+						return _mm_add_ps(min, _mm_mul_ps(_mm_cvtepi32_ps(value), step));
+					} };
+
+				_mm_store_ps(lanes[0], dequantize(gather(&PackedVertex::position, 0), minX, stepX));
+				_mm_store_ps(lanes[1], dequantize(gather(&PackedVertex::position, 1), minY, stepY));
+				_mm_store_ps(lanes[2], dequantize(gather(&PackedVertex::position, 2), minZ, stepZ));
+				_mm_store_ps(lanes[3], HalfToFloat4(gather(&PackedVertex::uv, 0)));
+				_mm_store_ps(lanes[4], HalfToFloat4(gather(&PackedVertex::uv, 1)));
+
+				__m128 x, y, z;
+				DecodeOctahedral4(gather(&PackedVertex::normal, 0), gather(&PackedVertex::normal, 1), x, y, z);
+				_mm_store_ps(lanes[5], x);
+				_mm_store_ps(lanes[6], y);
+				_mm_store_ps(lanes[7], z);
+				DecodeOctahedral4(gather(&PackedVertex::tangent, 0), gather(&PackedVertex::tangent, 1), x, y, z);
+				_mm_store_ps(lanes[8], x);
+				_mm_store_ps(lanes[9], y);
+				_mm_store_ps(lanes[10], z);
+
+				for (int lane{}; lane < 4; ++lane)
+				{
+					Vertex& vertex{ pVertices[i + lane] };
+					vertex.position = { lanes[0][lane], lanes[1][lane], lanes[2][lane] };
+					vertex.uv = { lanes[3][lane], lanes[4][lane] };
+					vertex.normal = { lanes[5][lane], lanes[6][lane], lanes[7][lane] };
+					vertex.tangent = { lanes[8][lane], lanes[9][lane], lanes[10][lane], pPacked[i + lane].position[3] == 0 ? -1.f : 1.f };
+				}
+			}
+#endif
+
+			for (; i < numVertices; ++i)
+			{
+				UnpackVertex(pPacked[i], bounds, step, pVertices[i]);
+			}
+		}
+
+		PackingError MeasureError(const Vertex* pVertices, const PackedVertex* pPacked, size_t numVertices, const QuantizationBounds& bounds)
+		{
+			const Vector3 step{ GetQuantizationStep(bounds) };
+			PackingError error{};
+			for (size_t i{}; i < numVertices; ++i)
+			{
+				const Vertex& original{ pVertices[i] };
+				Vertex decoded{};
+				UnpackVertex(pPacked[i], bounds, step, decoded);
+
+				error.position = std::max({ error.position, std::abs(decoded.position.x - original.position.x),
+					std::abs(decoded.position.y - original.position.y), std::abs(decoded.position.z - original.position.z) });
+				error.uv = std::max({ error.uv, std::abs(decoded.uv.x - original.uv.x), std::abs(decoded.uv.y - original.uv.y) });
+				// Directions without a meaningful encoding are skipped
+				if (original.normal.SqrMagnitude() > 0.f && original.normal.SqrMagnitude() < INFINITY)
+					error.normal = std::max(error.normal, GetAngle(decoded.normal, original.normal.Normalized()));
+				const Vector3 originalTangent{ original.tangent.GetXYZ() };
+				if (originalTangent.SqrMagnitude() > 0.f && originalTangent.SqrMagnitude() < INFINITY)
+					error.tangent = std::max(error.tangent, GetAngle(decoded.tangent.GetXYZ(), originalTangent.Normalized()));
+				if ((pPacked[i].position[3] != 0) != (GetHandedness(original) >= 0.f))
+					++error.handednessMismatches;
+			}
+			return error;
+		}
+
+		PackingError GetErrorBounds(const Vertex* pVertices, size_t numVertices, const QuantizationBounds& bounds)
+		{
+			float maxUv{};
+			for (size_t i{}; i < numVertices; ++i)
+			{
+				maxUv = std::max({ maxUv, std::abs(pVertices[i].uv.x), std::abs(pVertices[i].uv.y) });
+			}
+
+			const float maxExtent{ std::max({ bounds.extent.x, bounds.extent.y, bounds.extent.z }) };
+			const float maxMagnitude{ std::max({ std::abs(bounds.min.x), std::abs(bounds.min.y), std::abs(bounds.min.z) }) + maxExtent };
+
+			PackingError errorBounds{};
+			// Half a step, plus the float rounding of min + q * step
+			errorBounds.position = 0.5f * maxExtent / unorm16Max + 4.f * FLT_EPSILON * maxMagnitude;
+			// Half an ulp at the largest exponent, subnormal halfs are spaced 2^-24 apart
+			errorBounds.uv = maxUv > 65504.f ? INFINITY : std::max(std::ldexp(1.f, std::ilogb(std::max(maxUv, FLT_MIN)) - 11), std::ldexp(1.f, -25));
+			// Rounding both octahedral coordinates moves the point by at most sqrt(2) / 2 steps, lifting it onto the
+			// octahedron and projecting that onto the sphere stretches it by at most sqrt(3) * sqrt(3)
+			errorBounds.normal = 3.f * std::sqrt(0.5f) / snorm16Max + 1e-6f;
+			errorBounds.tangent = errorBounds.normal;
+			return errorBounds;
+		}
+
+		bool IsWithinBounds(const PackingError& error, const PackingError& bounds)
+		{
+			return error.position <= bounds.position && error.uv <= bounds.uv && error.normal <= bounds.normal
+				&& error.tangent <= bounds.tangent && error.handednessMismatches <= bounds.handednessMismatches;
+		}
+
+		uint16_t FloatToHalf(float value)
+		{
+			constexpr uint32_t infinity{ 255u << 23 };
+			constexpr uint32_t maxHalf{ (127u + 16u) << 23 };
+			constexpr uint32_t subnormalMagic{ ((127u - 15u) + (23u - 10u) + 1u) << 23 };
+
+			uint32_t bits{ std::bit_cast<uint32_t>(value) };
+			const uint32_t sign{ bits & 0x80000000u };
+			bits ^= sign;
+
+			uint32_t half{};
+			if (bits >= maxHalf)
+			{
+				// Inf stays Inf, NaN becomes a quiet NaN
+				half = bits > infinity ? 0x7e00 : 0x7c00;
+			}
+			else if (bits < (113u << 23))
+			{
+				// Subnormal or zero, the float addition does the rounding
+				half = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) + std::bit_cast<float>(subnormalMagic)) - subnormalMagic;
+			}
+			else
+			{
+				const uint32_t mantissaOdd{ (bits >> 13) & 1 };
+				bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff + mantissaOdd;
+				half = bits >> 13;
+			}
+			return static_cast<uint16_t>(half | (sign >> 16));
+		}
+
+		float HalfToFloat(uint16_t value)
+		{
+			constexpr uint32_t shiftedExponent{ 0x7c00u << 13 };
+			constexpr float magic{ std::bit_cast<float>(113u << 23) };
+
+			uint32_t bits{ (value & 0x7fffu) << 13 };
+			const uint32_t exponent{ bits & shiftedExponent };
+			bits += (127u - 15u) << 23;
+
+			float result{};
+			if (exponent == shiftedExponent)
+			{
+				result = std::bit_cast<float>(bits + ((128u - 16u) << 23));
+			}
+			else if (exponent == 0)
+			{
+				result = std::bit_cast<float>(bits + (1u << 23)) - magic;
+			}
+			else
+			{
+				result = std::bit_cast<float>(bits);
+			}
+			return std::bit_cast<float>(std::bit_cast<uint32_t>(result) | ((value & 0x8000u) << 16));
+		}
+	}
+
+	uint32_t GetVertexStride(VertexFormat format)
+	{
+		return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+	}
+
+#ifndef DAE_HEADLESS
+	std::vector<D3D11_INPUT_ELEMENT_DESC> GetInputElements(VertexFormat format)
+	{
+		const auto element{ [](const char* semanticName, DXGI_FORMAT elementFormat, size_t offset)
+			{
+				D3D11_INPUT_ELEMENT_DESC desc{};
+				desc.SemanticName = semanticName;
+				desc.Format = elementFormat;
+				desc.AlignedByteOffset = static_cast<UINT>(offset);
+				desc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+				return desc;
+			} };
+
+		if (format == VertexFormat::Packed)
+		{
+			return
+			{
+				element("POSITION", DXGI_FORMAT_R16G16B16A16_UNORM, offsetof(PackedVertex, position)),
+				element("TEXCOORD", DXGI_FORMAT_R16G16_FLOAT, offsetof(PackedVertex, uv)),
+				element("NORMAL", DXGI_FORMAT_R16G16_SNORM, offsetof(PackedVertex, normal)),
+				element("TANGENT", DXGI_FORMAT_R16G16_SNORM, offsetof(PackedVertex, tangent))
+			};
+		}
+
+		return
+		{
+			element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT, offsetof(Vertex, position)),
+			element("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, offsetof(Vertex, uv)),
+			element("NORMAL", DXGI_FORMAT_R32G32B32_FLOAT, offsetof(Vertex, normal)),
+			element("TANGENT", DXGI_FORMAT_R32G32B32A32_FLOAT, offsetof(Vertex, tangent))
+		};
+	}
+#endif
+
+	const char* GetShaderDefine(VertexFormat format)
+	{
+		return format == VertexFormat::Packed ? "PACKED_VERTICES" : "FULL_VERTICES";
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "DataTypes.h"
+
+namespace dae
+{
+	// Layout of the GPU vertex buffer, CPU side processing always works on Vertex
+	enum class VertexFormat
+	{
+		// Vertex as is, 48 bytes
+		Full,
+		// PackedVertex, 20 bytes, 42% of Full
+		Packed
+	};
+	static_assert(sizeof(Vertex) == 48);
+
+	struct PackedVertex final
+	{
+		// UNORM16 against the mesh bounds, w holds the tangent handedness (0 => -1, 65535 => +1)
+		uint16_t position[4];
+		// Half floats
+		uint16_t uv[2];
+		// Octahedral SNORM16
+		int16_t normal[2];
+		int16_t tangent[2];
+	};
+	static_assert(sizeof(PackedVertex) == 20);
+
+	namespace VertexPacking
+	{
+		// Maps [min, max] onto [0, 65535], a flat axis quantizes to 0
+		struct QuantizationBounds
+		{
+			Vector3 min;
+			Vector3 extent;
+		};
+
+		// Largest round trip error over a set of vertices
+		struct PackingError
+		{
+			// Per axis, in object space units
+			float position{};
+			float uv{};
+			// Radians
+			float normal{};
+			float tangent{};
+			uint32_t handednessMismatches{};
+		};
+
+		QuantizationBounds ComputeBounds(const Vertex* pVertices, size_t numVertices);
+		QuantizationBounds ComputeBounds(const Vector3& boundsMin, const Vector3& boundsMax);
+
+		// Brings a position decoded by the GPU ([0, 1] per axis) back to object space, prepend it to the world matrix
+		Matrix GetDequantizationMatrix(const QuantizationBounds& bounds);
+
+		// SSE2 four vertices at a time, scalar for the tail and on other targets
+		void Pack(const Vertex* pVertices, size_t numVertices, const QuantizationBounds& bounds, PackedVertex* pPacked);
+		void Unpack(const PackedVertex* pPacked, size_t numVertices, const QuantizationBounds& bounds, Vertex* pVertices);
+
+		PackingError MeasureError(const Vertex* pVertices, const PackedVertex* pPacked, size_t numVertices, const QuantizationBounds& bounds);
+		// Worst case the format allows for these bounds and uv range: half a quantization step for positions,
+		// half an ulp for uvs and the octahedral grid spacing for directions
+		PackingError GetErrorBounds(const Vertex* pVertices, size_t numVertices, const QuantizationBounds& bounds);
+		bool IsWithinBounds(const PackingError& error, const PackingError& bounds);
+
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t value);
+	}
+
+	uint32_t GetVertexStride(VertexFormat format);
+#ifndef DAE_HEADLESS
+	// Input layout matching the vertex buffer of the format, offsets come straight from the structs
+	std::vector<D3D11_INPUT_ELEMENT_DESC> GetInputElements(VertexFormat format);
+#endif
+	// Effect files compile their vertex shader input for the format from this define
+	const char* GetShaderDefine(VertexFormat format);
+}
@@ -76,6 +76,9 @@ int main(int argc, char* args[])
 		{
 			printTimer = 0.f;
 			std::cout << "dFPS: " << pTimer->GetdFPS() << std::endl;
+			const FrustumCullStats& cullStats{ pRenderer->GetFrustumCullStats() };
+			std::cout << "[CULL] " << cullStats.visibleVolumes << "/" << cullStats.numVolumes << " meshes visible, "
+				<< cullStats.sphereCulledVolumes << " culled by sphere, " << cullStats.boxCulledVolumes << " by box" << std::endl;
 		}
 	}
 	pTimer->Stop();
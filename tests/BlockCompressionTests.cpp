@@ -0,0 +1,255 @@
+#include "Tests.h"
+#include "BlockCompression.h"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	using BlockCompression::Format;
+	using Texels = std::array<std::array<uint8_t, 4>, 16>;
+
+	// Decoders written from the format descriptions, independent of the encoder's own decoding for the PSNR
+	uint64_t ReadBits(const uint8_t* pBlock, uint32_t first, uint32_t count)
+	{
+		uint64_t bits{};
+		for (uint32_t i{}; i < count; ++i)
+			bits |= uint64_t{ (pBlock[(first + i) / 8] >> ((first + i) % 8)) & 1u } << i;
+		return bits;
+	}
+
+	void DecodeBc1(const uint8_t* pBlock, Texels& texels)
+	{
+		const uint32_t colors[2]{ static_cast<uint32_t>(ReadBits(pBlock, 0, 16)), static_cast<uint32_t>(ReadBits(pBlock, 16, 16)) };
+		std::array<std::array<int, 3>, 4> palette{};
+		for (int i{}; i < 2; ++i)
+		{
+			const uint32_t r{ colors[i] >> 11 }, g{ (colors[i] >> 5) & 63 }, b{ colors[i] & 31 };
+			palette[i] = { static_cast<int>((r << 3) | (r >> 2)), static_cast<int>((g << 2) | (g >> 4)), static_cast<int>((b << 3) | (b >> 2)) };
+		}
+		for (int c{}; c < 3; ++c)
+		{
+			if (colors[0] > colors[1])
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		for (uint32_t i{}; i < 16; ++i)
+		{
+			const std::array<int, 3>& color{ palette[ReadBits(pBlock, 32 + 2 * i, 2)] };
+			texels[i] = { static_cast<uint8_t>(color[0]), static_cast<uint8_t>(color[1]), static_cast<uint8_t>(color[2]), 255 };
+		}
+	}
+
+	void DecodeBc4(const uint8_t* pBlock, Texels& texels, int channel)
+	{
+		const int endpoints[2]{ pBlock[0], pBlock[1] };
+		int palette[8]{ endpoints[0], endpoints[1] };
+		if (endpoints[0] > endpoints[1])
+		{
+			for (int i{ 1 }; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * endpoints[0] + i * endpoints[1] + 3) / 7;
+		}
+		else
+		{
+			for (int i{ 1 }; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * endpoints[0] + i * endpoints[1] + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		for (uint32_t i{}; i < 16; ++i)
+			texels[i][channel] = static_cast<uint8_t>(palette[ReadBits(pBlock, 16 + 3 * i, 3)]);
+	}
+
+	// Mode 6 only: 7 bit rgba endpoints with a p-bit each, 4 bit indices. Returns false for any other mode
+	bool DecodeBc7Mode6(const uint8_t* pBlock, Texels& texels)
+	{
+		if (ReadBits(pBlock, 0, 7) != 0x40)
+			return false;
+		constexpr int weights[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		int endpoints[2][4]{};
+		for (int c{}; c < 4; ++c)
+		{
+			for (int e{}; e < 2; ++e)
+				endpoints[e][c] = static_cast<int>(ReadBits(pBlock, 7 + (2 * c + e) * 7, 7)) << 1;
+		}
+		for (int e{}; e < 2; ++e)
+		{
+			const int pBit{ static_cast<int>(ReadBits(pBlock, 63 + e, 1)) };
+			for (int c{}; c < 4; ++c)
+				endpoints[e][c] |= pBit;
+		}
+		// The first index has its top bit implied zero
+		uint32_t bit{ 65 };
+		for (uint32_t i{}; i < 16; ++i)
+		{
+			const uint32_t numBits{ i == 0 ? 3u : 4u };
+			const int weight{ weights[ReadBits(pBlock, bit, numBits)] };
+			bit += numBits;
+			for (int c{}; c < 4; ++c)
+				texels[i][c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+		return true;
+	}
+
+	BlockCompression::EncodeStats EncodeBlock(const Texels& texels, Format format, BlockCompression::Quality quality, std::array<uint8_t, 16>& block)
+	{
+		BlockCompression::EncodeOptions options{};
+		options.format = format;
+		options.quality = quality;
+		options.numThreads = 1;
+		block.fill(0);
+		return BlockCompression::Encode(texels[0].data(), 4, 4, 4 * 4, options, block.data());
+	}
+
+	// Every channel the format stores within maxError of the source, after decoding
+	void CheckBlock(const Texels& texels, Format format, BlockCompression::Quality quality, int maxError, const char* name)
+	{
+		std::array<uint8_t, 16> block{};
+		const BlockCompression::EncodeStats stats{ EncodeBlock(texels, format, quality, block) };
+		CHECK(stats.numBlocks == 1);
+
+		Texels decoded{};
+		int numChannels{ 4 };
+		switch (format)
+		{
+		case Format::BC1:
+			DecodeBc1(block.data(), decoded);
+			numChannels = 3;
+			break;
+		case Format::BC4:
+			DecodeBc4(block.data(), decoded, 0);
+			numChannels = 1;
+			break;
+		case Format::BC5:
+			DecodeBc4(block.data(), decoded, 0);
+			DecodeBc4(block.data() + 8, decoded, 1);
+			numChannels = 2;
+			break;
+		case Format::BC7:
+			CHECK_MESSAGE(DecodeBc7Mode6(block.data(), decoded), name << ": not a mode 6 block");
+			break;
+		}
+
+		int worstError{};
+		for (size_t i{}; i < texels.size(); ++i)
+		{
+			for (int c{}; c < numChannels; ++c)
+				worstError = std::max(worstError, std::abs(static_cast<int>(decoded[i][c]) - static_cast<int>(texels[i][c])));
+		}
+		CHECK_MESSAGE(worstError <= maxError, name << ": off by " << worstError << ", at most " << maxError);
+	}
+
+	Texels CreateSolidBlock()
+	{
+		Texels texels{};
+		texels.fill({ 200, 100, 50, 255 });
+		return texels;
+	}
+
+	// Every channel ramps over the block in a different direction, alpha included
+	Texels CreateGradientBlock()
+	{
+		Texels texels{};
+		for (uint32_t i{}; i < 16; ++i)
+		{
+			const uint32_t x{ i % 4 }, y{ i / 4 };
+			texels[i] = { static_cast<uint8_t>(i * 17), static_cast<uint8_t>(255 - i * 17), static_cast<uint8_t>((x + y) * 30),
+				static_cast<uint8_t>(255 - i * 8) };
+		}
+		return texels;
+	}
+
+	// A single line through all the channels, fits any format as well as its levels allow
+	Texels CreateLineBlock()
+	{
+		Texels texels{};
+		for (uint32_t i{}; i < 16; ++i)
+		{
+			const uint8_t value{ static_cast<uint8_t>(i * 17) };
+			texels[i] = { value, value, value, value };
+		}
+		return texels;
+	}
+}
+
+DAE_TEST(BlockCompressionSolidAndGradientBlocks)
+{
+	using BlockCompression::Quality;
+	const Texels solid{ CreateSolidBlock() };
+	const Texels gradient{ CreateGradientBlock() };
+	const Texels line{ CreateLineBlock() };
+
+	// Solid: only the endpoint precision is lost, 565 for BC1, nothing for BC4/BC5, the p-bit shared by rgba for BC7
+	for (const Quality quality : { Quality::Fast, Quality::Normal, Quality::High })
+	{
+		CheckBlock(solid, Format::BC1, quality, 4, "BC1 solid");
+		CheckBlock(solid, Format::BC4, quality, 0, "BC4 solid");
+		CheckBlock(solid, Format::BC5, quality, 0, "BC5 solid");
+	}
+	CheckBlock(solid, Format::BC7, Quality::Fast, 1, "BC7 solid");
+
+	// Along one line the error is at most half the step between palette entries: 255 / 3, 255 / 7 and 255 / 15, plus rounding
+	CheckBlock(line, Format::BC1, Quality::Normal, 255 / 6 + 4, "BC1 line");
+	CheckBlock(line, Format::BC4, Quality::Normal, 255 / 14 + 1, "BC4 line");
+	CheckBlock(line, Format::BC5, Quality::Normal, 255 / 14 + 1, "BC5 line");
+	CheckBlock(line, Format::BC7, Quality::Fast, 255 / 30 + 2, "BC7 line");
+
+	// Channels ramping in different directions: BC4/BC5 still fit each channel on its own, BC1 and BC7 have to share one line
+	CheckBlock(gradient, Format::BC4, Quality::Normal, 255 / 14 + 1, "BC4 gradient");
+	CheckBlock(gradient, Format::BC5, Quality::Normal, 255 / 14 + 1, "BC5 gradient");
+	CheckBlock(gradient, Format::BC7, Quality::Fast, 40, "BC7 gradient");
+}
+
+DAE_TEST(BlockCompressionThreadsAndPartialBlocks)
+{
+	// Pseudo random texels, 2 blocks more than a whole number of rows so the threads get uneven ranges, and partial blocks at the edges
+	constexpr uint32_t width{ 37 };
+	constexpr uint32_t height{ 30 };
+	std::vector<uint8_t> pixels(size_t{ width } * height * 4);
+	uint32_t state{ 11 };
+	for (uint8_t& value : pixels)
+	{
+		state = state * 1664525u + 1013904223u;
+		value = static_cast<uint8_t>(state >> 24);
+	}
+
+	for (const Format format : { Format::BC1, Format::BC4, Format::BC5, Format::BC7 })
+	{
+		const size_t levelSize{ BlockCompression::GetLevelSize(format, width, height) };
+		CHECK(levelSize == size_t{ 10 } * 8 * BlockCompression::GetBlockSize(format));
+
+		BlockCompression::EncodeOptions options{};
+		options.format = format;
+		options.numThreads = 1;
+		std::vector<uint8_t> serial(levelSize);
+		const BlockCompression::EncodeStats stats{ BlockCompression::Encode(pixels.data(), width, height, width * 4, options, serial.data()) };
+		CHECK(stats.numBlocks == 80);
+
+		options.numThreads = 4;
+		std::vector<uint8_t> parallel(levelSize);
+		BlockCompression::Encode(pixels.data(), width, height, width * 4, options, parallel.data());
+		CHECK_MESSAGE(serial == parallel, "format " << static_cast<int>(format) << " differs on 4 threads");
+	}
+
+	// A 1x1 image fills its block with copies of the texel, so it decodes to the texel everywhere
+	const uint8_t texel[4]{ 10, 20, 30, 255 };
+	std::array<uint8_t, 16> block{};
+	BlockCompression::EncodeOptions options{};
+	options.format = Format::BC4;
+	BlockCompression::Encode(texel, 1, 1, 4, options, block.data());
+	Texels decoded{};
+	DecodeBc4(block.data(), decoded, 0);
+	for (const std::array<uint8_t, 4>& decodedTexel : decoded)
+		CHECK(decodedTexel[0] == 10);
+}
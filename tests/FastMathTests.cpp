@@ -0,0 +1,233 @@
+#include "Tests.h"
+#include "FastMath.h"
+
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	// Every stride-th float in [first, last] for 0 <= first <= last, and last itself. Steps through the bit patterns, so every
+	// binade gets the same share
+	std::vector<float> GetFloats(float first, float last, uint32_t stride)
+	{
+		std::vector<float> floats{};
+		const uint32_t lastBits{ std::bit_cast<uint32_t>(last) };
+		for (uint32_t bits{ std::bit_cast<uint32_t>(first) }; bits < lastBits; bits += stride)
+			floats.push_back(std::bit_cast<float>(bits));
+		floats.push_back(last);
+		return floats;
+	}
+
+	// [-limit, limit]
+	std::vector<float> GetSymmetricFloats(float limit, uint32_t stride)
+	{
+		std::vector<float> floats{ GetFloats(0.f, limit, stride) };
+		const size_t numPositive{ floats.size() };
+		for (size_t i{}; i < numPositive; ++i)
+			floats.push_back(-floats[i]);
+		return floats;
+	}
+
+	// The bound is what FastMath.h documents for the error against the double result
+	template<typename Reference, typename Bound>
+	void CheckWithinBound(const char* name, const std::vector<float>& inputs, const std::vector<float>& results, Reference reference, Bound bound)
+	{
+		uint32_t numFailures{};
+		for (size_t i{}; i < inputs.size(); ++i)
+		{
+			const double expected{ reference(inputs[i]) };
+			const double error{ std::abs(results[i] - expected) };
+			if (!(error <= bound(expected)) && numFailures++ == 0)
+				CHECK_MESSAGE(false, name << "(" << inputs[i] << ") = " << results[i] << " instead of " << expected << ", off by " << error);
+		}
+		CHECK_MESSAGE(numFailures == 0, name << ": " << numFailures << " of " << inputs.size() << " inputs");
+	}
+
+	template<typename Function>
+	std::vector<float> Evaluate(const std::vector<float>& inputs, Function function)
+	{
+		std::vector<float> results(inputs.size());
+		for (size_t i{}; i < inputs.size(); ++i)
+			results[i] = function(inputs[i]);
+		return results;
+	}
+
+#ifdef DAE_MATH_SIMD
+	// The SimdFloat form over the same inputs, the last lanes padded with the last input
+	template<typename Function>
+	std::vector<float> EvaluateSimd(const std::vector<float>& inputs, Function function)
+	{
+		constexpr size_t width{ SimdFloat::width };
+		std::vector<float> padded{ inputs };
+		padded.resize((inputs.size() + width - 1) / width * width, inputs.back());
+		std::vector<float> results(padded.size());
+		for (size_t i{}; i < padded.size(); i += width)
+			function(SimdFloat::Load(&padded[i])).Store(&results[i]);
+		results.resize(inputs.size());
+		return results;
+	}
+#endif
+
+	// Relative to the expected value, or absolute on top of rounding the result to float
+	auto RelativeBound(double bound) { return [bound](double expected) { return bound * std::abs(expected); }; }
+	auto AbsoluteBound(double bound) { return [bound](double expected) { return bound + std::ldexp(std::abs(expected), -24); }; }
+}
+
+DAE_TEST(FastMathRSqrtWithinBound)
+{
+	// Every mantissa in two binades, where the estimate repeats, then the whole normal range
+	std::vector<float> inputs{ GetFloats(1.f, 4.f, 1) };
+	const std::vector<float> wide{ GetFloats(FLT_MIN, FLT_MAX, 4099) };
+	inputs.insert(inputs.end(), wide.begin(), wide.end());
+
+	const auto reference{ [](float x) { return 1.0 / std::sqrt(static_cast<double>(x)); } };
+	CheckWithinBound("RSqrt", inputs, Evaluate(inputs, [](float x) { return FastMath::RSqrt(x); }), reference, RelativeBound(2.8e-7));
+#ifdef DAE_MATH_SIMD
+	CheckWithinBound("RSqrt(SimdFloat)", inputs, EvaluateSimd(inputs, [](SimdFloat x) { return FastMath::RSqrt(x); }), reference, RelativeBound(2.8e-7));
+#endif
+}
+
+DAE_TEST(FastMathNormalizedWithinBound)
+{
+	// Directions on a sphere at lengths from tiny to huge
+	std::vector<Vector3> vectors{};
+	for (int i{}; i < 4096; ++i)
+	{
+		float sin{}, cos{};
+		FastMath::SinCos(static_cast<float>(i) * 0.731f, sin, cos);
+		const float z{ static_cast<float>(i) / 2048.f - 1.f };
+		const float ring{ std::sqrt(1.f - z * z) };
+		const float length{ std::ldexp(1.f + static_cast<float>(i % 7) / 7.f, i % 120 - 60) };
+		vectors.push_back(Vector3{ ring * cos, ring * sin, z } * length);
+	}
+
+	const auto getLength{ [](float x, float y, float z)
+		{
+			return std::sqrt(static_cast<double>(x) * x + static_cast<double>(y) * y + static_cast<double>(z) * z);
+		} };
+	// The documented length error, plus rounding the three products
+	constexpr double bound{ 2.8e-7 + 1.5 / 16777216.0 };
+
+	uint32_t numFailures{};
+	for (const Vector3& vector : vectors)
+	{
+		const Vector3 normalized{ FastMath::Normalized(vector) };
+		if (!(std::abs(getLength(normalized.x, normalized.y, normalized.z) - 1.0) <= bound) && numFailures++ == 0)
+			CHECK_MESSAGE(false, "(" << vector.x << ", " << vector.y << ", " << vector.z << ") has length " << getLength(normalized.x, normalized.y, normalized.z));
+	}
+	CHECK_MESSAGE(numFailures == 0, "Normalized: " << numFailures << " of " << vectors.size() << " vectors");
+
+#ifdef DAE_MATH_SIMD
+	constexpr size_t width{ SimdFloat::width };
+	numFailures = 0;
+	for (size_t i{}; i + width <= vectors.size(); i += width)
+	{
+		float x[width], y[width], z[width];
+		for (size_t lane{}; lane < width; ++lane)
+		{
+			x[lane] = vectors[i + lane].x;
+			y[lane] = vectors[i + lane].y;
+			z[lane] = vectors[i + lane].z;
+		}
+		SimdFloat lanesX{ SimdFloat::Load(x) }, lanesY{ SimdFloat::Load(y) }, lanesZ{ SimdFloat::Load(z) };
+		FastMath::Normalize(lanesX, lanesY, lanesZ);
+		lanesX.Store(x);
+		lanesY.Store(y);
+		lanesZ.Store(z);
+		for (size_t lane{}; lane < width; ++lane)
+		{
+			if (!(std::abs(getLength(x[lane], y[lane], z[lane]) - 1.0) <= bound))
+				++numFailures;
+		}
+	}
+	CHECK_MESSAGE(numFailures == 0, "Normalize(SimdFloat): " << numFailures << " of " << vectors.size() << " vectors");
+#endif
+}
+
+DAE_TEST(FastMathSinCosWithinBound)
+{
+	struct Range
+	{
+		float limit;
+		double bound;
+	};
+	const Range ranges[]{ { 8192.f, 9.3e-8 }, { 65536.f, 9.6e-7 } };
+	for (const Range& range : ranges)
+	{
+		const std::vector<float> inputs{ GetSymmetricFloats(range.limit, 1021) };
+		const auto sinReference{ [](float x) { return std::sin(static_cast<double>(x)); } };
+		const auto cosReference{ [](float x) { return std::cos(static_cast<double>(x)); } };
+
+		std::vector<float> sines(inputs.size()), cosines(inputs.size());
+		for (size_t i{}; i < inputs.size(); ++i)
+			FastMath::SinCos(inputs[i], sines[i], cosines[i]);
+		CheckWithinBound("SinCos sine", inputs, sines, sinReference, AbsoluteBound(range.bound));
+		CheckWithinBound("SinCos cosine", inputs, cosines, cosReference, AbsoluteBound(range.bound));
+
+#ifdef DAE_MATH_SIMD
+		const std::vector<float> simdSines{ EvaluateSimd(inputs, [](SimdFloat x) { SimdFloat sin, cos; FastMath::SinCos(x, sin, cos); return sin; }) };
+		const std::vector<float> simdCosines{ EvaluateSimd(inputs, [](SimdFloat x) { SimdFloat sin, cos; FastMath::SinCos(x, sin, cos); return cos; }) };
+		CheckWithinBound("SinCos(SimdFloat) sine", inputs, simdSines, sinReference, AbsoluteBound(range.bound));
+		CheckWithinBound("SinCos(SimdFloat) cosine", inputs, simdCosines, cosReference, AbsoluteBound(range.bound));
+#endif
+	}
+}
+
+DAE_TEST(FastMathExp2WithinBound)
+{
+	std::vector<float> inputs{ GetFloats(0.f, 127.f, 1021) };
+	const std::vector<float> negative{ GetFloats(0.f, 126.f, 1021) };
+	for (const float x : negative)
+		inputs.push_back(-x);
+
+	const auto reference{ [](float x) { return std::exp2(static_cast<double>(x)); } };
+	CheckWithinBound("Exp2", inputs, Evaluate(inputs, [](float x) { return FastMath::Exp2(x); }), reference, RelativeBound(1.1e-7));
+#ifdef DAE_MATH_SIMD
+	CheckWithinBound("Exp2(SimdFloat)", inputs, EvaluateSimd(inputs, [](SimdFloat x) { return FastMath::Exp2(x); }), reference, RelativeBound(1.1e-7));
+#endif
+
+	// Clamped past the ends
+	CHECK(FastMath::Exp2(200.f) == FastMath::Exp2(127.f));
+	CHECK(FastMath::Exp2(-200.f) == FastMath::Exp2(-126.f));
+}
+
+DAE_TEST(FastMathLog2WithinBound)
+{
+	// Every mantissa around 1, where the result is smallest, then the whole normal range
+	std::vector<float> inputs{ GetFloats(0.5f, 2.f, 1) };
+	const std::vector<float> wide{ GetFloats(FLT_MIN, FLT_MAX, 4099) };
+	inputs.insert(inputs.end(), wide.begin(), wide.end());
+
+	const auto reference{ [](float x) { return std::log2(static_cast<double>(x)); } };
+	CheckWithinBound("Log2", inputs, Evaluate(inputs, [](float x) { return FastMath::Log2(x); }), reference, AbsoluteBound(1.3e-7));
+#ifdef DAE_MATH_SIMD
+	CheckWithinBound("Log2(SimdFloat)", inputs, EvaluateSimd(inputs, [](SimdFloat x) { return FastMath::Log2(x); }), reference, AbsoluteBound(1.3e-7));
+#endif
+}
+
+DAE_TEST(FastMathPowWithinBound)
+{
+	// Exponents like the sRGB curve and specular powers use, x wherever the result stays a normal float
+	const float exponents[]{ -8.f, -2.4f, -1.f, -0.5f, 1.f / 2.4f, 0.5f, 1.f, 2.f, 2.2f, 8.f, 32.f, 256.f };
+	for (const float y : exponents)
+	{
+		const float limit{ std::min(120.f / std::abs(y), 125.f) };
+		const std::vector<float> inputs{ GetFloats(std::exp2(-limit), std::exp2(limit), 4099) };
+
+		const auto reference{ [y](float x) { return std::pow(static_cast<double>(x), static_cast<double>(y)); } };
+		// The documented error grows with y * log2(x), the exponent of the result
+		const auto bound{ [](double expected) { return (1.5e-7 + 2.4e-7 * std::abs(std::log2(expected))) * expected; } };
+		CheckWithinBound("Pow", inputs, Evaluate(inputs, [y](float x) { return FastMath::Pow(x, y); }), reference, bound);
+#ifdef DAE_MATH_SIMD
+		CheckWithinBound("Pow(SimdFloat)", inputs, EvaluateSimd(inputs, [y](SimdFloat x) { return FastMath::Pow(x, SimdFloat::Set(y)); }), reference, bound);
+#endif
+	}
+
+	CHECK(FastMath::Pow(0.f, 2.4f) == 0.f);
+	CHECK(FastMath::Pow(0.f, -1.f) == 0.f);
+}
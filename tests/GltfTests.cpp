@@ -0,0 +1,163 @@
+#include "Tests.h"
+#include "Gltf.h"
+
+#include <cstring>
+#include <string>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	constexpr uint32_t glbMagic{ 0x46546C67 };
+	constexpr uint32_t jsonChunkType{ 0x4E4F534A };
+	constexpr uint32_t binChunkType{ 0x004E4942 };
+
+	// One triangle: three float positions and three 16-bit indices in the BIN chunk
+	const std::string triangleJson{ R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":42}],)"
+		R"("bufferViews":[{"buffer":0,"byteLength":36},{"buffer":0,"byteOffset":36,"byteLength":6}],)"
+		R"("accessors":[{"bufferView":0,"componentType":5126,"count":3,"type":"VEC3"},{"bufferView":1,"componentType":5123,"count":3,"type":"SCALAR"}],)"
+		R"("meshes":[{"primitives":[{"attributes":{"POSITION":0},"indices":1}]}]})" };
+
+	void AppendUint32(std::string& bytes, uint32_t value)
+	{
+		bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	void PatchUint32(std::string& bytes, size_t offset, uint32_t value)
+	{
+		std::memcpy(bytes.data() + offset, &value, sizeof(value));
+	}
+
+	// Header, JSON chunk padded with spaces and BIN chunk padded with zeros, as the spec lays them out
+	std::string CreateGlb(std::string json, std::string bin)
+	{
+		json.resize((json.size() + 3) & ~size_t{ 3 }, ' ');
+		bin.resize((bin.size() + 3) & ~size_t{ 3 }, '\0');
+
+		std::string glb{};
+		AppendUint32(glb, glbMagic);
+		AppendUint32(glb, 2);
+		AppendUint32(glb, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+		AppendUint32(glb, static_cast<uint32_t>(json.size()));
+		AppendUint32(glb, jsonChunkType);
+		glb += json;
+		AppendUint32(glb, static_cast<uint32_t>(bin.size()));
+		AppendUint32(glb, binChunkType);
+		glb += bin;
+		return glb;
+	}
+
+	std::string CreateTriangleGlb(const std::string& json = triangleJson)
+	{
+		std::string bin{};
+		const float positions[]{ 0.f, 0.f, 1.f, 1.f, 0.f, 2.f, 0.f, 1.f, 3.f };
+		const uint16_t indices[]{ 0, 1, 2 };
+		bin.append(reinterpret_cast<const char*>(positions), sizeof(positions));
+		bin.append(reinterpret_cast<const char*>(indices), sizeof(indices));
+		return CreateGlb(json, bin);
+	}
+
+	// triangleJson with the first occurrence of from replaced
+	std::string ReplaceInTriangleJson(const std::string& from, const std::string& to)
+	{
+		std::string json{ triangleJson };
+		const size_t position{ json.find(from) };
+		CHECK_MESSAGE(position != std::string::npos, from);
+		if (position != std::string::npos)
+			json.replace(position, from.size(), to);
+		return json;
+	}
+
+	bool LoadGlb(const std::string& bytes)
+	{
+		const TemporaryFile file{ "dae_tests.glb", bytes };
+		std::vector<Vertex> vertices{};
+		std::vector<uint32_t> indices{};
+		return Gltf::LoadGLB(file.GetPath(), vertices, indices, true, nullptr, 1);
+	}
+}
+
+DAE_TEST(LoadGlbTriangle)
+{
+	const TemporaryFile file{ "dae_tests.glb", CreateTriangleGlb() };
+	std::vector<Vertex> vertices{};
+	std::vector<uint32_t> indices{};
+	Gltf::GlbLoadStats stats{};
+	CHECK(Gltf::LoadGLB(file.GetPath(), vertices, indices, true, &stats, 1));
+	CHECK(stats.numPrimitives == 1 && stats.generatedTangentPrimitives == 1);
+
+	// Flipped like ParseOBJ flips: z negated, winding reversed
+	CHECK(vertices.size() == 3);
+	CHECK(indices == std::vector<uint32_t>({ 0, 2, 1 }));
+	if (vertices.size() == 3)
+		CHECK(vertices[1].position.x == 1.f && vertices[1].position.z == -2.f);
+}
+
+DAE_TEST(LoadGlbRejectsTruncatedAndBrokenHeaders)
+{
+	const std::string glb{ CreateTriangleGlb() };
+	CHECK(LoadGlb(glb));
+
+	// Cut anywhere, from the GLB header to the last index
+	for (size_t size{}; size < glb.size(); ++size)
+		CHECK_MESSAGE(!LoadGlb(glb.substr(0, size)), "cut to " << size << " of " << glb.size() << " bytes");
+
+	// A header length too small for the headers themselves, with a JSON chunk of nothing but whitespace whose
+	// length runs far past the end of the file. Accepting it would have the JSON parser scan out of the mapping
+	std::string smallLength{ glb.substr(0, 20) };
+	smallLength.resize(4096, ' ');
+	PatchUint32(smallLength, 12, 0x10000000);
+	for (const uint32_t length : { 0u, 12u, 19u, 20u })
+	{
+		PatchUint32(smallLength, 8, length);
+		CHECK_MESSAGE(!LoadGlb(smallLength), "header length " << length);
+	}
+
+	// Chunk lengths past the header length
+	std::string jsonPastEnd{ glb };
+	PatchUint32(jsonPastEnd, 12, static_cast<uint32_t>(glb.size()));
+	CHECK(!LoadGlb(jsonPastEnd));
+	std::string binPastEnd{ glb };
+	PatchUint32(binPastEnd, 20 + ((triangleJson.size() + 3) & ~size_t{ 3 }), 0xFFFFFFF0);
+	CHECK(!LoadGlb(binPastEnd));
+
+	// Wrong magic, version or first chunk type
+	for (const size_t offset : { size_t{ 0 }, size_t{ 4 }, size_t{ 16 } })
+	{
+		std::string broken{ glb };
+		PatchUint32(broken, offset, 1);
+		CHECK_MESSAGE(!LoadGlb(broken), "field at " << offset);
+	}
+}
+
+DAE_TEST(LoadGlbRejectsBadStridesAndAccessorIndices)
+{
+	// A stride given explicitly, in range, loads like the tightly packed one
+	CHECK(LoadGlb(CreateTriangleGlb(ReplaceInTriangleJson(R"("byteLength":36})", R"("byteLength":36,"byteStride":12})"))));
+
+	// Outside 4..252 or not a multiple of 4
+	for (const char* byteStride : { "0", "2", "14", "256", "-12", "12.5" })
+	{
+		const std::string json{ ReplaceInTriangleJson(R"("byteLength":36})", std::string{ R"("byteLength":36,"byteStride":)" } + byteStride + "}") };
+		CHECK_MESSAGE(!LoadGlb(CreateTriangleGlb(json)), "byteStride " << byteStride);
+	}
+
+	// A stride of 2^53 over 2049 elements: stride * (count - 1) is 2^64, which wrapped the bounds check around to 0
+	const std::string hugeStrideJson{ R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":4096}],)"
+		R"("bufferViews":[{"buffer":0,"byteLength":4096,"byteStride":9007199254740992}],)"
+		R"("accessors":[{"bufferView":0,"componentType":5126,"count":2049,"type":"VEC3"}],)"
+		R"("meshes":[{"primitives":[{"attributes":{"POSITION":0}}]}]})" };
+	CHECK(!LoadGlb(CreateGlb(hugeStrideJson, std::string(4096, '\0'))));
+
+	// Counts one past the end of the view, and far past it
+	CHECK(!LoadGlb(CreateTriangleGlb(ReplaceInTriangleJson(R"("count":3,"type":"VEC3")", R"("count":4,"type":"VEC3")"))));
+	CHECK(!LoadGlb(CreateTriangleGlb(ReplaceInTriangleJson(R"("count":3,"type":"VEC3")", R"("count":9007199254740992,"type":"VEC3")"))));
+
+	// Accessor indices that would narrow onto accessor 0 or 1 as an int, and ones that aren't indices at all
+	for (const char* index : { "4294967296", "4294967297", "2147483647", "-1", "0.5" })
+	{
+		CHECK_MESSAGE(!LoadGlb(CreateTriangleGlb(ReplaceInTriangleJson(R"("POSITION":0)", std::string{ R"("POSITION":)" } + index))), "POSITION " << index);
+		CHECK_MESSAGE(!LoadGlb(CreateTriangleGlb(ReplaceInTriangleJson(R"("indices":1)", std::string{ R"("indices":)" } + index))), "indices " << index);
+	}
+}
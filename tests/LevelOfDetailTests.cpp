@@ -0,0 +1,135 @@
+#include "Tests.h"
+#include "TestMeshes.h"
+#include "MeshProcessing.h"
+#include "VertexFormat.h"
+
+#include <algorithm>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	// What MeshGeometry imports with
+	const std::vector<float> ratios{ 0.5f, 0.25f, 0.1f };
+	constexpr float maxErrorShare{ 0.01f };
+
+	float GetMaxError(const TestMesh& mesh)
+	{
+		return maxErrorShare * VertexPacking::ComputeBounds(mesh.vertices.data(), mesh.vertices.size()).extent.Magnitude();
+	}
+
+	// Level 0 is the input, the others are appended back to back, index valid vertices, stay under their target unless the chain
+	// ended on them, and only get coarser
+	void CheckLevelsOfDetail(const TestMesh& mesh, const std::vector<uint32_t>& indices, const std::vector<MeshProcessing::LevelOfDetail>& levels, float maxError)
+	{
+		CHECK(!levels.empty() && levels.size() <= ratios.size() + 1);
+		if (levels.empty())
+			return;
+		CHECK(levels[0].firstIndex == 0 && levels[0].numIndices == mesh.indices.size() && levels[0].error == 0.f);
+		CHECK(std::equal(mesh.indices.begin(), mesh.indices.end(), indices.begin()));
+
+		const bool isChainCut{ levels.size() < ratios.size() + 1 };
+		uint32_t nextIndex{ levels[0].numIndices };
+		for (size_t i{ 1 }; i < levels.size(); ++i)
+		{
+			const MeshProcessing::LevelOfDetail& level{ levels[i] };
+			CHECK(level.firstIndex == nextIndex);
+			CHECK(level.numIndices > 0 && level.numIndices % 3 == 0);
+			nextIndex = level.firstIndex + level.numIndices;
+
+			const uint32_t targetIndexCount{ static_cast<uint32_t>(mesh.indices.size() * ratios[i - 1]) / 3 * 3 };
+			const bool isLast{ i + 1 == levels.size() };
+			CHECK_MESSAGE(level.numIndices <= targetIndexCount || (isLast && isChainCut),
+				"LOD " << i << ": " << level.numIndices << " indices for a target of " << targetIndexCount);
+			CHECK_MESSAGE(level.numIndices < levels[i - 1].numIndices, "LOD " << i << ": " << level.numIndices << " indices");
+			CHECK_MESSAGE(level.error >= levels[i - 1].error && level.error <= maxError, "LOD " << i << ": error " << level.error << ", max " << maxError);
+		}
+		CHECK(nextIndex == indices.size());
+		CHECK(std::all_of(indices.begin(), indices.end(), [&mesh](uint32_t index) { return index < mesh.vertices.size(); }));
+	}
+}
+
+DAE_TEST(SimplifyReachesTargetWithinError)
+{
+	// Flat, so it collapses to the target without any error
+	const TestMesh grid{ CreateGrid(32, 32) };
+	std::vector<uint32_t> indices{ grid.indices };
+	const size_t targetIndexCount{ grid.indices.size() / 4 / 3 * 3 };
+	const float error{ MeshProcessing::Simplify(grid.vertices, indices, targetIndexCount) };
+	CHECK_MESSAGE(indices.size() <= targetIndexCount && !indices.empty(), indices.size() << " indices for a target of " << targetIndexCount);
+	CHECK_MESSAGE(error < 1e-3f, "error " << error);
+
+	// The error limit stops it short, and a tighter one keeps more
+	const TestMesh& vehicle{ GetVehicle() };
+	const float maxError{ GetMaxError(vehicle) };
+	std::vector<uint32_t> limited{ vehicle.indices };
+	const float limitedError{ MeshProcessing::Simplify(vehicle.vertices, limited, 0, maxError) };
+	std::vector<uint32_t> tighter{ vehicle.indices };
+	const float tighterError{ MeshProcessing::Simplify(vehicle.vertices, tighter, 0, maxError * 0.1f) };
+	CHECK_MESSAGE(limitedError <= maxError && tighterError <= maxError * 0.1f, limitedError << " and " << tighterError);
+	CHECK_MESSAGE(!limited.empty() && limited.size() < vehicle.indices.size() && tighter.size() >= limited.size(),
+		vehicle.indices.size() << " -> " << limited.size() << " and " << tighter.size() << " indices");
+
+	// Nothing to collapse in a single triangle or an empty buffer
+	std::vector<uint32_t> triangle{ 0, 1, 2 };
+	MeshProcessing::Simplify(grid.vertices, triangle, 0);
+	CHECK(triangle.empty() || triangle == std::vector<uint32_t>({ 0, 1, 2 }));
+	std::vector<uint32_t> empty{};
+	CHECK(MeshProcessing::Simplify(grid.vertices, empty, 0) == 0.f && empty.empty());
+}
+
+DAE_TEST(BuildLevelsOfDetailChain)
+{
+	const TestMesh grid{ CreateGrid(32, 32) };
+	const TestMesh* const meshes[]{ &GetVehicle(), &grid };
+	for (const TestMesh* pMesh : meshes)
+	{
+		const float maxError{ GetMaxError(*pMesh) };
+		std::vector<uint32_t> indices{ pMesh->indices };
+		const std::vector<MeshProcessing::LevelOfDetail> levels{ MeshProcessing::BuildLevelsOfDetail(pMesh->vertices, indices, ratios, maxError) };
+		CHECK_MESSAGE(levels.size() > 1, levels.size() << " level(s)");
+		CheckLevelsOfDetail(*pMesh, indices, levels, maxError);
+	}
+
+	// No error allowed on a curved mesh cuts the chain short, but what is there still holds up
+	const TestMesh& vehicle{ GetVehicle() };
+	std::vector<uint32_t> indices{ vehicle.indices };
+	const std::vector<MeshProcessing::LevelOfDetail> levels{ MeshProcessing::BuildLevelsOfDetail(vehicle.vertices, indices, ratios, 0.f) };
+	CheckLevelsOfDetail(vehicle, indices, levels, 0.f);
+}
+
+DAE_TEST(SelectLevelOfDetailByDistance)
+{
+	const TestMesh& vehicle{ GetVehicle() };
+	std::vector<uint32_t> indices{ vehicle.indices };
+	const std::vector<MeshProcessing::LevelOfDetail> levels{ MeshProcessing::BuildLevelsOfDetail(vehicle.vertices, indices, ratios, GetMaxError(vehicle)) };
+	CHECK(levels.size() > 1);
+
+	// 45 degree field of view on a 1080 pixel viewport
+	const float fov{ std::tan(22.5f * TO_RADIANS) };
+	constexpr float viewportHeight{ 1080.f };
+
+	// Inside or on the bounding sphere
+	CHECK(MeshProcessing::SelectLevelOfDetail(levels, -1.f, 1.f, fov, viewportHeight) == 0);
+	CHECK(MeshProcessing::SelectLevelOfDetail(levels, 0.f, 1.f, fov, viewportHeight) == 0);
+
+	// Never finer further away, the coarsest level in the end
+	uint32_t previous{};
+	for (float distance{ 0.01f }; distance < 1e6f; distance *= 1.5f)
+	{
+		const uint32_t level{ MeshProcessing::SelectLevelOfDetail(levels, distance, 1.f, fov, viewportHeight) };
+		CHECK_MESSAGE(level >= previous, "LOD " << level << " at " << distance << " after LOD " << previous);
+		previous = level;
+	}
+	CHECK(previous == levels.size() - 1);
+	CHECK(MeshProcessing::SelectLevelOfDetail(levels, 0.01f, 1.f, fov, viewportHeight) == 0);
+
+	// A bigger mesh stays finer, a bigger error budget goes coarse sooner
+	const float distance{ 100.f };
+	CHECK(MeshProcessing::SelectLevelOfDetail(levels, distance, 10.f, fov, viewportHeight) <= MeshProcessing::SelectLevelOfDetail(levels, distance, 1.f, fov, viewportHeight));
+	CHECK(MeshProcessing::SelectLevelOfDetail(levels, distance, 1.f, fov, viewportHeight, 10.f) >= MeshProcessing::SelectLevelOfDetail(levels, distance, 1.f, fov, viewportHeight));
+
+	// Only level 0
+	CHECK(MeshProcessing::SelectLevelOfDetail({ levels[0] }, 1e6f, 1.f, fov, viewportHeight) == 0);
+}
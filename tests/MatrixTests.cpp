@@ -0,0 +1,175 @@
+#include "Tests.h"
+#include "Matrix.h"
+
+#include <array>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	constexpr size_t numMatrices{ 32 };
+	using Matrices = std::array<Matrix, numMatrices>;
+
+	// Same sequence at compile time and at run time, in [-1, 1)
+	struct Random
+	{
+		uint32_t state{};
+
+		constexpr float Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return static_cast<float>(state >> 8) / 8388608.f - 1.f;
+		}
+	};
+
+	// Diagonal pushed out of [-1, 1) so every matrix is well away from singular
+	constexpr Matrices CreateRandomMatrices(uint32_t seed)
+	{
+		Random random{ seed };
+		Matrices matrices{};
+		for (Matrix& matrix : matrices)
+		{
+			for (int r{}; r < 4; ++r)
+			{
+				matrix[r] = { random.Next(), random.Next(), random.Next(), random.Next() };
+				matrix[r][r] += matrix[r][r] < 0.f ? -2.f : 2.f;
+			}
+		}
+		return matrices;
+	}
+
+	struct Results
+	{
+		Matrices products{};
+		Matrices transposes{};
+		Matrices inverses{};
+		std::array<Vector4, numMatrices> points{};
+	};
+
+	// The scalar code when the compiler evaluates it, the SIMD code at run time in a SIMD build
+	constexpr Results Compute(const Matrices& a, const Matrices& b)
+	{
+		Results results{};
+		for (size_t i{}; i < numMatrices; ++i)
+		{
+			results.products[i] = a[i] * b[i];
+			results.transposes[i] = Matrix::Transpose(a[i]);
+			results.inverses[i] = Matrix::Inverse(a[i]);
+			const Vector4 point{ b[i][3] };
+			results.points[i] = a[i].TransformPoint(point.x, point.y, point.z, 1.f);
+		}
+		return results;
+	}
+
+	constexpr Matrices matricesA{ CreateRandomMatrices(1) };
+	constexpr Matrices matricesB{ CreateRandomMatrices(2) };
+	constexpr Results scalarResults{ Compute(matricesA, matricesB) };
+
+	bool AreIdentical(const Vector4& a, const Vector4& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+	}
+
+	bool AreIdentical(const Matrix& a, const Matrix& b)
+	{
+		return AreIdentical(a[0], b[0]) && AreIdentical(a[1], b[1]) && AreIdentical(a[2], b[2]) && AreIdentical(a[3], b[3]);
+	}
+
+	void CheckIdentical(const Matrices& results, const Matrices& expected, const char* name)
+	{
+		uint32_t numMismatches{};
+		for (size_t i{}; i < numMatrices; ++i)
+		{
+			if (!AreIdentical(results[i], expected[i]) && numMismatches++ == 0)
+				CHECK_MESSAGE(false, name << " of matrix " << i << " differs from the scalar code in the " << mathBackendName << " build");
+		}
+		CHECK_MESSAGE(numMismatches == 0, name << ": " << numMismatches << " of " << numMatrices << " matrices");
+	}
+
+	// The fast inverses take a different route to the same result, so they only agree up to float rounding: relative to the
+	// entry, or absolute below 1. With the scale within [0.5, 2] and the translation within 100 they differ by up to 4e-6
+	constexpr float inverseTolerance{ 1e-5f };
+
+	void CheckNear(const Matrix& result, const Matrix& expected, const char* name, size_t index)
+	{
+		for (int r{}; r < 4; ++r)
+		{
+			for (int c{}; c < 4; ++c)
+			{
+				const float tolerance{ inverseTolerance * std::max(1.f, std::abs(expected[r][c])) };
+				CHECK_MESSAGE(AreEqual(result[r][c], expected[r][c], tolerance),
+					name << " of matrix " << index << ": " << result[r][c] << " instead of " << expected[r][c] << " at " << r << ", " << c);
+			}
+		}
+	}
+
+	Vector3 NextVector(Random& random, float scale)
+	{
+		return Vector3{ random.Next(), random.Next(), random.Next() } * scale;
+	}
+
+	Matrix NextRotation(Random& random)
+	{
+		return Matrix::CreateRotation(NextVector(random, PI));
+	}
+}
+
+DAE_TEST(MatrixSimdMatchesScalar)
+{
+	// The SIMD paths do the same operations in the same order as the scalar code, so nothing is allowed to differ. In a scalar
+	// build both sides run the same code
+	Results results{ Compute(matricesA, matricesB) };
+	CheckIdentical(results.products, scalarResults.products, "operator*");
+	CheckIdentical(results.transposes, scalarResults.transposes, "Transpose");
+	CheckIdentical(results.inverses, scalarResults.inverses, "Inverse");
+
+	uint32_t numMismatches{};
+	for (size_t i{}; i < numMatrices; ++i)
+	{
+		if (!AreIdentical(results.points[i], scalarResults.points[i]))
+			++numMismatches;
+	}
+	CHECK_MESSAGE(numMismatches == 0, "TransformPoint: " << numMismatches << " of " << numMatrices << " points");
+
+	// And the inverses are inverses
+	for (size_t i{}; i < numMatrices; ++i)
+	{
+		const Matrix identity{ results.inverses[i] * matricesA[i] };
+		for (int r{}; r < 4; ++r)
+		{
+			for (int c{}; c < 4; ++c)
+				CHECK_MESSAGE(AreEqual(identity[r][c], r == c ? 1.f : 0.f, 1e-5f), "matrix " << i << ": " << identity[r][c] << " at " << r << ", " << c);
+		}
+	}
+}
+
+DAE_TEST(InverseAffineAndRigidMatchInverse)
+{
+	Random random{ 3 };
+	for (size_t i{}; i < 256; ++i)
+	{
+		// Scale, rotation and translation, mirrored on any axis that comes out negative
+		Vector3 scale{ NextVector(random, 1.f) };
+		for (int axis{}; axis < 3; ++axis)
+			scale[axis] = (scale[axis] < 0.f ? -0.5f : 0.5f) + scale[axis] * 1.5f;
+		const Matrix affine{ Matrix::CreateScale(scale) * NextRotation(random) * Matrix::CreateTranslation(NextVector(random, 100.f)) };
+		CHECK(affine.IsAffine());
+		CheckNear(Matrix::InverseAffine(affine), Matrix::Inverse(affine), "InverseAffine", i);
+
+		// Rotation and translation, also mirrored
+		const Matrix mirror{ Matrix::CreateScale(i % 2 == 0 ? 1.f : -1.f, 1.f, 1.f) };
+		const Matrix rigid{ mirror * NextRotation(random) * Matrix::CreateTranslation(NextVector(random, 100.f)) };
+		CHECK(rigid.IsRigid());
+		const Matrix inverse{ Matrix::Inverse(rigid) };
+		CheckNear(Matrix::InverseRigid(rigid), inverse, "InverseRigid", i);
+		CheckNear(Matrix::InverseAffine(rigid), inverse, "InverseAffine", i);
+	}
+
+	// Exact for the axes, whichever way they are inverted
+	const Matrix translation{ Matrix::CreateTranslation(1.f, -2.f, 4.f) };
+	const Matrix expected{ Matrix::CreateTranslation(-1.f, 2.f, -4.f) };
+	CHECK(AreIdentical(Matrix::Inverse(translation), expected));
+	CHECK(AreIdentical(Matrix::InverseAffine(translation), expected));
+	CHECK(AreIdentical(Matrix::InverseRigid(translation), expected));
+}
@@ -0,0 +1,101 @@
+#include "Tests.h"
+#include "TestMeshes.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+
+#include <cstddef>
+#include <cstring>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	constexpr uint64_t sourceHash{ 0x0123456789ABCDEF };
+	constexpr uint64_t sourceSize{ 4096 };
+	constexpr uint32_t flags{ MeshCache::BuildMeshlets | MeshCache::BuildLevelsOfDetail };
+
+	template<typename T>
+	void Patch(std::string& bytes, size_t offset, T value)
+	{
+		std::memcpy(bytes.data() + offset, &value, sizeof(value));
+	}
+
+	bool IsValid(const std::string& bytes)
+	{
+		const TemporaryFile file{ "dae_tests_patched.dmesh", bytes };
+		const MappedFile mapping{ file.GetPath() };
+		return MeshCache::Validate(mapping, sourceHash, sourceSize, flags) != nullptr;
+	}
+}
+
+DAE_TEST(MeshCacheRoundTripAndRejectsDamage)
+{
+	TestMesh grid{ CreateGrid(16, 16) };
+	const std::vector<MeshProcessing::Meshlet> meshlets{ MeshProcessing::BuildMeshlets(grid.vertices, grid.indices, 64, 32) };
+	const std::vector<MeshProcessing::LevelOfDetail> levelsOfDetail{ { 0, static_cast<uint32_t>(grid.indices.size()), 0.f } };
+	CHECK(meshlets.size() > 1);
+
+	const TemporaryFile file{ "dae_tests.dmesh" };
+	CHECK(MeshCache::Write(file.GetPath(), sourceHash, sourceSize, flags, grid.vertices, grid.indices, meshlets, levelsOfDetail));
+	{
+		const MappedFile mapping{ file.GetPath() };
+		const MeshCache::Header* pHeader{ MeshCache::Validate(mapping, sourceHash, sourceSize, flags) };
+		CHECK(pHeader);
+		CHECK(!MeshCache::Validate(mapping, sourceHash + 1, sourceSize, flags));
+		if (pHeader)
+		{
+			CHECK(pHeader->numVertices == grid.vertices.size() && pHeader->numIndices == grid.indices.size());
+			CHECK(pHeader->numMeshlets == meshlets.size() && pHeader->numLevelsOfDetail == 1);
+			CHECK(std::memcmp(MeshCache::GetVertexData(*pHeader), grid.vertices.data(), grid.vertices.size() * sizeof(Vertex)) == 0);
+			CHECK(std::memcmp(MeshCache::GetIndices(*pHeader), grid.indices.data(), grid.indices.size() * sizeof(uint32_t)) == 0);
+		}
+	}
+
+	const std::string bytes{ file.Read() };
+	MeshCache::Header header{};
+	std::memcpy(&header, bytes.data(), sizeof(header));
+
+	// Truncated anywhere in the last section
+	CHECK(!IsValid(bytes.substr(0, bytes.size() - 1)));
+	CHECK(!IsValid(bytes.substr(0, sizeof(MeshCache::Header))));
+
+	// Section offsets so large that offset + size wraps around to less than 64, still aligned
+	const struct
+	{
+		size_t field;
+		uint64_t size;
+	} sections[]{
+		{ offsetof(MeshCache::Header, vertexOffset), uint64_t{ header.vertexStride } * header.numVertices },
+		{ offsetof(MeshCache::Header, indexOffset), uint64_t{ sizeof(uint32_t) } * header.numIndices },
+		{ offsetof(MeshCache::Header, meshletOffset), uint64_t{ sizeof(MeshProcessing::Meshlet) } * header.numMeshlets }
+	};
+	for (const auto& section : sections)
+	{
+		std::string damaged{ bytes };
+		Patch(damaged, section.field, uint64_t{} - (section.size & ~uint64_t{ MeshCache::sectionAlignment - 1 }));
+		CHECK_MESSAGE(!IsValid(damaged), "offset at " << section.field);
+	}
+
+	// An index past the vertex buffer
+	std::string badIndex{ bytes };
+	Patch(badIndex, static_cast<size_t>(header.indexOffset), header.numVertices);
+	CHECK(!IsValid(badIndex));
+
+	// Meshlets running past the index buffer, with more vertices than corners and with a partial triangle
+	const size_t lastMeshlet{ static_cast<size_t>(header.meshletOffset) + (meshlets.size() - 1) * sizeof(MeshProcessing::Meshlet) };
+	std::string meshletPastEnd{ bytes };
+	Patch(meshletPastEnd, lastMeshlet + offsetof(MeshProcessing::Meshlet, numIndices), meshlets.back().numIndices + 3);
+	CHECK(!IsValid(meshletPastEnd));
+	std::string meshletVertices{ bytes };
+	Patch(meshletVertices, lastMeshlet + offsetof(MeshProcessing::Meshlet, numVertices), meshlets.back().numIndices + 1);
+	CHECK(!IsValid(meshletVertices));
+	std::string meshletPartial{ bytes };
+	Patch(meshletPartial, lastMeshlet + offsetof(MeshProcessing::Meshlet, numIndices), meshlets.back().numIndices - 1);
+	CHECK(!IsValid(meshletPartial));
+
+	// A level of detail past the index buffer
+	std::string levelPastEnd{ bytes };
+	Patch(levelPastEnd, static_cast<size_t>(header.levelOfDetailOffset) + offsetof(MeshProcessing::LevelOfDetail, firstIndex), 3u);
+	CHECK(!IsValid(levelPastEnd));
+}
@@ -0,0 +1,141 @@
+#include "Tests.h"
+#include "TestMeshes.h"
+#include "MeshProcessing.h"
+
+#include <unordered_set>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	constexpr uint32_t cacheSize{ 32 };
+
+	// Small meshes the passes have to leave alone or get through without tripping over
+	std::vector<TestMesh> GetEdgeCases()
+	{
+		const TestMesh grid{ CreateGrid(1, 1) };
+		const std::vector<Vertex>& vertices{ grid.vertices };
+
+		std::vector<TestMesh> meshes{};
+		// Empty
+		meshes.push_back({ vertices, {} });
+		// Single triangle
+		meshes.push_back({ vertices, { 0, 1, 2 } });
+		// Degenerate: repeated corners, a zero area triangle and the same triangle twice
+		meshes.push_back({ vertices, { 0, 0, 1, 1, 1, 1, 0, 1, 2, 0, 1, 2, 3, 2, 1 } });
+		return meshes;
+	}
+
+	// Every meshlet within the limits, the meshlets in order covering the whole index buffer
+	void CheckMeshlets(const std::vector<MeshProcessing::Meshlet>& meshlets, const std::vector<uint32_t>& indices, uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		uint32_t nextIndex{};
+		for (const MeshProcessing::Meshlet& meshlet : meshlets)
+		{
+			CHECK(meshlet.firstIndex == nextIndex);
+			CHECK(meshlet.numIndices > 0 && meshlet.numIndices % 3 == 0);
+			CHECK_MESSAGE(meshlet.numIndices / 3 <= maxTriangles, meshlet.numIndices / 3 << " triangles");
+			CHECK_MESSAGE(meshlet.numVertices <= maxVertices, meshlet.numVertices << " vertices");
+
+			const std::unordered_set<uint32_t> uniqueVertices{ indices.begin() + meshlet.firstIndex, indices.begin() + meshlet.firstIndex + meshlet.numIndices };
+			CHECK(meshlet.numVertices == uniqueVertices.size());
+			nextIndex = meshlet.firstIndex + meshlet.numIndices;
+		}
+		CHECK(nextIndex == indices.size());
+	}
+}
+
+DAE_TEST(OptimizeVertexCacheKeepsTrianglesAndImprovesReuse)
+{
+	TestMesh shuffledGrid{ CreateGrid(64, 64) };
+	ShuffleTriangles(shuffledGrid.indices);
+
+	const TestMesh* const meshes[]{ &GetVehicle(), &shuffledGrid };
+	for (const TestMesh* pMesh : meshes)
+	{
+		std::vector<uint32_t> indices{ pMesh->indices };
+		const MeshProcessing::VertexCacheStats before{ MeshProcessing::AnalyzeVertexCache(indices, pMesh->vertices.size(), cacheSize) };
+		MeshProcessing::OptimizeVertexCache(indices, pMesh->vertices.size(), cacheSize);
+		const MeshProcessing::VertexCacheStats after{ MeshProcessing::AnalyzeVertexCache(indices, pMesh->vertices.size(), cacheSize) };
+
+		CHECK(MeshProcessing::HaveSameTriangles(pMesh->indices, indices));
+		CHECK_MESSAGE(after.acmr < before.acmr, "ACMR " << before.acmr << " -> " << after.acmr);
+		CHECK_MESSAGE(after.atvr < before.atvr, "ATVR " << before.atvr << " -> " << after.atvr);
+	}
+}
+
+DAE_TEST(OptimizeVertexCacheEdgeCases)
+{
+	for (const TestMesh& mesh : GetEdgeCases())
+	{
+		std::vector<uint32_t> indices{ mesh.indices };
+		MeshProcessing::OptimizeVertexCache(indices, mesh.vertices.size(), cacheSize);
+		CHECK(MeshProcessing::HaveSameTriangles(mesh.indices, indices));
+	}
+}
+
+DAE_TEST(OptimizeOverdrawKeepsTrianglesAndVertexReuse)
+{
+	constexpr float threshold{ 1.05f };
+	const TestMesh& vehicle{ GetVehicle() };
+
+	std::vector<uint32_t> indices{ vehicle.indices };
+	const float acmrParsed{ MeshProcessing::AnalyzeVertexCache(indices, vehicle.vertices.size(), cacheSize).acmr };
+	MeshProcessing::OptimizeVertexCache(indices, vehicle.vertices.size(), cacheSize);
+	const std::vector<uint32_t> cacheOptimized{ indices };
+	const float acmrBefore{ MeshProcessing::AnalyzeVertexCache(indices, vehicle.vertices.size(), cacheSize).acmr };
+	const float overdrawBefore{ MeshProcessing::AnalyzeOverdraw(vehicle.vertices, indices).overdraw };
+
+	MeshProcessing::OptimizeOverdraw(vehicle.vertices, indices, cacheSize, threshold);
+	const float acmrAfter{ MeshProcessing::AnalyzeVertexCache(indices, vehicle.vertices.size(), cacheSize).acmr };
+	const float overdrawAfter{ MeshProcessing::AnalyzeOverdraw(vehicle.vertices, indices).overdraw };
+
+	CHECK(MeshProcessing::HaveSameTriangles(cacheOptimized, indices));
+	// Less overdraw for some vertex reuse: the clusters start with a cold cache, but the order has to stay better than the parsed one
+	CHECK_MESSAGE(overdrawAfter < overdrawBefore, "overdraw " << overdrawBefore << " -> " << overdrawAfter);
+	CHECK_MESSAGE(acmrAfter < acmrParsed, "ACMR " << acmrParsed << " parsed, " << acmrBefore << " -> " << acmrAfter);
+
+	for (const TestMesh& mesh : GetEdgeCases())
+	{
+		std::vector<uint32_t> edgeIndices{ mesh.indices };
+		MeshProcessing::OptimizeOverdraw(mesh.vertices, edgeIndices, cacheSize, threshold);
+		CHECK(MeshProcessing::HaveSameTriangles(mesh.indices, edgeIndices));
+	}
+}
+
+DAE_TEST(BuildMeshletsKeepsTrianglesWithinLimits)
+{
+	TestMesh shuffledGrid{ CreateGrid(32, 32) };
+	ShuffleTriangles(shuffledGrid.indices);
+
+	const TestMesh* const meshes[]{ &GetVehicle(), &shuffledGrid };
+	for (const TestMesh* pMesh : meshes)
+	{
+		std::vector<uint32_t> indices{ pMesh->indices };
+		MeshProcessing::OptimizeVertexCache(indices, pMesh->vertices.size(), cacheSize);
+		const std::vector<uint32_t> cacheOptimized{ indices };
+
+		const std::vector<MeshProcessing::Meshlet> meshlets{ MeshProcessing::BuildMeshlets(pMesh->vertices, indices) };
+		CHECK(MeshProcessing::HaveSameTriangles(cacheOptimized, indices));
+		CheckMeshlets(meshlets, indices, 64, 124);
+	}
+
+	// Tighter limits than the defaults
+	std::vector<uint32_t> indices{ GetVehicle().indices };
+	const std::vector<MeshProcessing::Meshlet> meshlets{ MeshProcessing::BuildMeshlets(GetVehicle().vertices, indices, 16, 8) };
+	CHECK(MeshProcessing::HaveSameTriangles(GetVehicle().indices, indices));
+	CheckMeshlets(meshlets, indices, 16, 8);
+}
+
+DAE_TEST(BuildMeshletsEdgeCases)
+{
+	for (const TestMesh& mesh : GetEdgeCases())
+	{
+		std::vector<uint32_t> indices{ mesh.indices };
+		const std::vector<MeshProcessing::Meshlet> meshlets{ MeshProcessing::BuildMeshlets(mesh.vertices, indices) };
+		CHECK(MeshProcessing::HaveSameTriangles(mesh.indices, indices));
+		CHECK(meshlets.size() == (mesh.indices.empty() ? 0u : 1u));
+		CheckMeshlets(meshlets, indices, 64, 124);
+	}
+}
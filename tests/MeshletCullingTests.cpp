@@ -0,0 +1,57 @@
+#include "Tests.h"
+#include "TestMeshes.h"
+#include "MeshletCulling.h"
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	// Camera looking at target, view * projection with a 45 degree field of view
+	Matrix CreateViewProjection(const Vector3& eye, const Vector3& target)
+	{
+		const Vector3 forward{ (target - eye).Normalized() };
+		const Vector3 helper{ std::abs(forward.y) > 0.9f ? Vector3::UnitX : Vector3::UnitY };
+		const Vector3 right{ Vector3::Cross(helper, forward).Normalized() };
+		const Vector3 up{ Vector3::Cross(forward, right) };
+		const Matrix view{ Matrix::InverseRigid({ right, up, forward, eye }) };
+		return view * Matrix::CreatePerspectiveFovLH(tanf(22.5f * TO_RADIANS), 1.f, 0.1f, 1000.f);
+	}
+}
+
+DAE_TEST(CullSkipsConesForDoubleSidedMaterials)
+{
+	// Flat, so from one side every cone rejects its meshlet
+	TestMesh grid{ CreateGrid(16, 16) };
+	const std::vector<MeshProcessing::Meshlet> meshlets{ MeshProcessing::BuildMeshlets(grid.vertices, grid.indices, 16, 8) };
+	const MeshletCuller culler{ meshlets.data(), static_cast<uint32_t>(meshlets.size()) };
+	const uint32_t numTriangles{ static_cast<uint32_t>(grid.indices.size() / 3) };
+	CHECK(culler.GetNumMeshlets() > 1);
+
+	const Vector3 center{ 8.f, 8.f, 0.f };
+	const Vector3 eyes[]{ center + Vector3::UnitZ * 40.f, center - Vector3::UnitZ * 40.f };
+	std::vector<IndexRange> ranges{};
+	uint32_t minBackfaceCulled{ UINT32_MAX };
+	uint32_t maxBackfaceCulled{};
+	for (const Vector3& eye : eyes)
+	{
+		const Matrix viewProjection{ CreateViewProjection(eye, center) };
+
+		const MeshletCullStats singleSided{ culler.Cull(viewProjection, eye, ranges) };
+		CHECK(singleSided.frustumCulledTriangles == 0);
+		minBackfaceCulled = std::min(minBackfaceCulled, singleSided.backfaceCulledTriangles);
+		maxBackfaceCulled = std::max(maxBackfaceCulled, singleSided.backfaceCulledTriangles);
+
+		// Both sides are drawn, whatever the cones say
+		const MeshletCullStats doubleSided{ culler.Cull(viewProjection, eye, ranges, false) };
+		CHECK(doubleSided.backfaceCulledTriangles == 0);
+		CHECK_MESSAGE(doubleSided.visibleTriangles == numTriangles, doubleSided.visibleTriangles << " of " << numTriangles);
+		CHECK(ranges.size() == 1 && ranges[0].firstIndex == 0 && ranges[0].numIndices == grid.indices.size());
+	}
+	CHECK_MESSAGE(minBackfaceCulled == 0 && maxBackfaceCulled == numTriangles, minBackfaceCulled << "/" << maxBackfaceCulled << " of " << numTriangles);
+
+	// The frustum still rejects for double-sided materials
+	const MeshletCullStats lookingAway{ culler.Cull(CreateViewProjection(eyes[0], eyes[0] * 2.f - center), eyes[0], ranges, false) };
+	CHECK(lookingAway.frustumCulledTriangles == numTriangles);
+	CHECK(lookingAway.visibleTriangles == 0 && ranges.empty());
+}
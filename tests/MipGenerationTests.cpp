@@ -0,0 +1,223 @@
+#include "Tests.h"
+#include "MipGeneration.h"
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	using MipGeneration::Content;
+
+	constexpr uint32_t size{ 4 };
+	constexpr int numChannels{ 4 };
+	// FastMath::Pow and RSqrt in the encoders, a code either way of the exact result
+	constexpr int tolerance{ 1 };
+
+	using Texel = std::array<double, numChannels>;
+
+	double DecodeSrgb(double value)
+	{
+		return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+	}
+
+	double EncodeSrgb(double linear)
+	{
+		return linear < 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+	}
+
+	Texel Decode(const uint8_t* pTexel, Content content)
+	{
+		Texel texel{};
+		for (int channel{}; channel < numChannels; ++channel)
+		{
+			const double value{ pTexel[channel] / 255.0 };
+			if (channel == 3 || content == Content::Linear)
+				texel[channel] = value;
+			else
+				texel[channel] = content == Content::Color ? DecodeSrgb(value) : value * 2.0 - 1.0;
+		}
+		return texel;
+	}
+
+	std::array<double, numChannels> Encode(Texel texel, Content content)
+	{
+		if (content == Content::NormalMap)
+		{
+			const double length{ std::sqrt(texel[0] * texel[0] + texel[1] * texel[1] + texel[2] * texel[2]) };
+			for (int channel{}; channel < 3; ++channel)
+				texel[channel] = texel[channel] / length * 0.5 + 0.5;
+		}
+		else if (content == Content::Color)
+		{
+			for (int channel{}; channel < 3; ++channel)
+				texel[channel] = EncodeSrgb(texel[channel]);
+		}
+		for (double& value : texel)
+			value *= 255.0;
+		return texel;
+	}
+
+	// Each level the average of 2x2 texels of the unencoded level above, like the box filter halving with wrapping edges
+	std::vector<Texel> Halve(const std::vector<Texel>& level, uint32_t levelSize)
+	{
+		const uint32_t halfSize{ levelSize / 2 };
+		std::vector<Texel> result(size_t{ halfSize } * halfSize);
+		for (uint32_t y{}; y < halfSize; ++y)
+		{
+			for (uint32_t x{}; x < halfSize; ++x)
+			{
+				for (int channel{}; channel < numChannels; ++channel)
+				{
+					double sum{};
+					for (uint32_t k{}; k < 4; ++k)
+						sum += level[(2 * y + k / 2) * levelSize + 2 * x + k % 2][channel];
+					result[y * halfSize + x][channel] = sum / 4.0;
+				}
+			}
+		}
+		return result;
+	}
+
+	// Box filtered chain against the double precision reference, and against expected codes of the top left texel of level 1
+	void CheckChain(const std::vector<uint8_t>& pixels, Content content, const std::array<int, numChannels>& expectedTopLeft, const char* name)
+	{
+		MipGeneration::MipOptions options{};
+		options.content = content;
+		options.filter = MipGeneration::Filter::Box;
+		options.numThreads = 1;
+		MipGeneration::MipChain chain{};
+		const MipGeneration::MipStats stats{ MipGeneration::GenerateMips(pixels.data(), size, size, size * numChannels, options, chain) };
+		CHECK(stats.numLevels == 3 && chain.levels.size() == 3);
+		if (chain.levels.size() != 3)
+			return;
+		CHECK(chain.levels[1].width == 2 && chain.levels[1].height == 2 && chain.levels[2].width == 1 && chain.levels[2].height == 1);
+		CHECK(std::equal(pixels.begin(), pixels.end(), chain.pixels.begin()));
+
+		std::vector<Texel> reference(size_t{ size } * size);
+		for (size_t i{}; i < reference.size(); ++i)
+			reference[i] = Decode(&pixels[i * numChannels], content);
+
+		uint32_t levelSize{ size };
+		for (size_t level{ 1 }; level < 3; ++level)
+		{
+			reference = Halve(reference, levelSize);
+			levelSize /= 2;
+			for (size_t i{}; i < reference.size(); ++i)
+			{
+				const std::array<double, numChannels> expected{ Encode(reference[i], content) };
+				for (int channel{}; channel < numChannels; ++channel)
+				{
+					const int code{ chain.pixels[chain.levels[level].offset + i * numChannels + channel] };
+					CHECK_MESSAGE(std::abs(code - expected[channel]) <= tolerance + 0.5,
+						name << " level " << level << " texel " << i << " channel " << channel << ": " << code << " instead of " << expected[channel]);
+				}
+			}
+		}
+
+		for (int channel{}; channel < numChannels; ++channel)
+		{
+			const int code{ chain.pixels[chain.levels[1].offset + channel] };
+			CHECK_MESSAGE(std::abs(code - expectedTopLeft[channel]) <= tolerance,
+				name << " top left channel " << channel << ": " << code << " instead of " << expectedTopLeft[channel]);
+		}
+	}
+
+	void SetTexel(std::vector<uint8_t>& pixels, uint32_t x, uint32_t y, std::array<uint8_t, numChannels> texel)
+	{
+		std::copy(texel.begin(), texel.end(), pixels.begin() + (size_t{ y } * size + x) * numChannels);
+	}
+
+	// A checker of black and white texels in the top left 2x2 block, alpha 0 and 255 the same way, the rest pseudo random
+	std::vector<uint8_t> CreateCheckerPixels()
+	{
+		std::vector<uint8_t> pixels(size_t{ size } * size * numChannels);
+		uint32_t state{ 7 };
+		for (uint8_t& value : pixels)
+		{
+			state = state * 1664525u + 1013904223u;
+			value = static_cast<uint8_t>(state >> 24);
+		}
+		SetTexel(pixels, 0, 0, { 0, 0, 0, 0 });
+		SetTexel(pixels, 1, 0, { 255, 255, 255, 255 });
+		SetTexel(pixels, 0, 1, { 255, 255, 255, 255 });
+		SetTexel(pixels, 1, 1, { 0, 0, 0, 0 });
+		return pixels;
+	}
+
+	// Unit normals, the top left 2x2 block +x and +y twice each
+	std::vector<uint8_t> CreateNormalPixels()
+	{
+		std::vector<uint8_t> pixels(size_t{ size } * size * numChannels);
+		for (uint32_t y{}; y < size; ++y)
+		{
+			for (uint32_t x{}; x < size; ++x)
+			{
+				const double angle{ 0.4 * (y * size + x) };
+				const double tilt{ 0.1 * x };
+				const double normal[3]{ std::sin(tilt) * std::cos(angle), std::sin(tilt) * std::sin(angle), std::cos(tilt) };
+				std::array<uint8_t, numChannels> texel{ 0, 0, 0, 255 };
+				for (int channel{}; channel < 3; ++channel)
+					texel[channel] = static_cast<uint8_t>(std::lround((normal[channel] * 0.5 + 0.5) * 255.0));
+				SetTexel(pixels, x, y, texel);
+			}
+		}
+		SetTexel(pixels, 0, 0, { 255, 128, 128, 255 });
+		SetTexel(pixels, 1, 0, { 128, 255, 128, 255 });
+		SetTexel(pixels, 0, 1, { 128, 255, 128, 255 });
+		SetTexel(pixels, 1, 1, { 255, 128, 128, 255 });
+		return pixels;
+	}
+}
+
+DAE_TEST(BoxFilteredMipChain)
+{
+	const std::vector<uint8_t> checker{ CreateCheckerPixels() };
+
+	// Half the light of white is 188 in sRGB, not the 128 averaging the codes would give. Alpha is averaged as stored
+	CheckChain(checker, Content::Color, { 188, 188, 188, 128 }, "Color");
+	CheckChain(checker, Content::Linear, { 128, 128, 128, 128 }, "Linear");
+
+	// +x and +y average to (0.5, 0.5, 0), renormalized to (0.707, 0.707, 0) instead of left at length 0.707
+	CheckChain(CreateNormalPixels(), Content::NormalMap, { 218, 218, 128, 255 }, "NormalMap");
+}
+
+DAE_TEST(MipChainLevelsAndPitch)
+{
+	CHECK(MipGeneration::GetNumLevels(1, 1) == 1);
+	CHECK(MipGeneration::GetNumLevels(4, 4) == 3);
+	CHECK(MipGeneration::GetNumLevels(256, 16) == 9);
+	CHECK(MipGeneration::GetNumLevels(5, 3) == 3);
+
+	// Rows further apart than the texels, level 0 comes out tightly packed
+	constexpr uint32_t width{ 8 };
+	constexpr uint32_t height{ 2 };
+	constexpr size_t pitch{ width * numChannels + 12 };
+	std::vector<uint8_t> pixels(pitch * height, 0xCD);
+	for (uint32_t y{}; y < height; ++y)
+	{
+		for (size_t i{}; i < width * numChannels; ++i)
+			pixels[y * pitch + i] = static_cast<uint8_t>(y * 64 + i);
+	}
+
+	MipGeneration::MipOptions options{};
+	options.content = Content::Linear;
+	options.filter = MipGeneration::Filter::Box;
+	MipGeneration::MipChain chain{};
+	MipGeneration::GenerateMips(pixels.data(), width, height, pitch, options, chain);
+	CHECK(chain.levels.size() == 4);
+	if (chain.levels.size() != 4)
+		return;
+	CHECK(chain.levels[3].width == 1 && chain.levels[3].height == 1);
+	for (uint32_t y{}; y < height; ++y)
+		CHECK(std::equal(&pixels[y * pitch], &pixels[y * pitch] + width * numChannels, &chain.pixels[y * width * numChannels]));
+	for (size_t level{ 1 }; level < chain.levels.size(); ++level)
+	{
+		const MipGeneration::MipLevel& previous{ chain.levels[level - 1] };
+		CHECK(chain.levels[level].offset == previous.offset + size_t{ previous.width } * previous.height * numChannels);
+	}
+	CHECK(chain.pixels.size() == chain.levels.back().offset + numChannels);
+}
@@ -0,0 +1,56 @@
+#include "Tests.h"
+#include "Utils.h"
+
+#include <cstring>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	struct ParsedMesh
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	ParsedMesh Parse(const std::string& fileName, uint32_t numThreads, bool weldVertices)
+	{
+		Utils::ObjParseOptions options{};
+		options.numThreads = numThreads;
+		options.weldVertices = weldVertices;
+
+		ParsedMesh mesh{};
+		CHECK_MESSAGE(Utils::ParseOBJ(GetResourcePath(fileName), mesh.vertices, mesh.indices, options),
+			"could not parse " << fileName << " on " << numThreads << " threads");
+		return mesh;
+	}
+
+	// Bit for bit, a -0 or a NaN payload counts as well
+	bool AreIdentical(const std::vector<Vertex>& a, const std::vector<Vertex>& b)
+	{
+		return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(Vertex)) == 0);
+	}
+}
+
+DAE_TEST(ParseObjInParallelMatchesSerial)
+{
+	// More threads than the files have chunks worth splitting as well, so some chunks come out empty
+	constexpr uint32_t threadCounts[]{ 2, 3, 4, 8, 32 };
+	for (const char* fileName : { "vehicle.obj", "fireFX.obj" })
+	{
+		for (const bool weldVertices : { false, true })
+		{
+			const ParsedMesh serial{ Parse(fileName, 1, weldVertices) };
+			CHECK(!serial.indices.empty());
+			for (const uint32_t numThreads : threadCounts)
+			{
+				const ParsedMesh parallel{ Parse(fileName, numThreads, weldVertices) };
+				CHECK_MESSAGE(AreIdentical(parallel.vertices, serial.vertices),
+					fileName << (weldVertices ? " welded" : "") << " on " << numThreads << " threads: vertices differ");
+				CHECK_MESSAGE(parallel.indices == serial.indices,
+					fileName << (weldVertices ? " welded" : "") << " on " << numThreads << " threads: indices differ");
+			}
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#include "TestMeshes.h"
+#include "Tests.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <random>
+
+namespace dae::Tests
+{
+	const TestMesh& GetVehicle()
+	{
+		static const TestMesh vehicle{ []()
+			{
+				Utils::ObjParseOptions options{};
+				options.weldVertices = true;
+
+				TestMesh mesh{};
+				CHECK_MESSAGE(Utils::ParseOBJ(GetResourcePath("vehicle.obj"), mesh.vertices, mesh.indices, options), "could not parse vehicle.obj");
+				return mesh;
+			}() };
+		return vehicle;
+	}
+
+	TestMesh CreateGrid(uint32_t width, uint32_t height)
+	{
+		TestMesh mesh{};
+		for (uint32_t y{}; y <= height; ++y)
+		{
+			for (uint32_t x{}; x <= width; ++x)
+			{
+				const Vector3 position{ static_cast<float>(x), static_cast<float>(y), 0.f };
+				const Vector2 uv{ static_cast<float>(x) / width, static_cast<float>(y) / height };
+				mesh.vertices.push_back({ position, uv, Vector3::UnitZ, { Vector3::UnitX, 1.f } });
+			}
+		}
+
+		const uint32_t rowSize{ width + 1 };
+		for (uint32_t y{}; y < height; ++y)
+		{
+			for (uint32_t x{}; x < width; ++x)
+			{
+				const uint32_t corner{ y * rowSize + x };
+				mesh.indices.insert(mesh.indices.end(), { corner, corner + 1, corner + rowSize });
+				mesh.indices.insert(mesh.indices.end(), { corner + 1, corner + rowSize + 1, corner + rowSize });
+			}
+		}
+		return mesh;
+	}
+
+	void ShuffleTriangles(std::vector<uint32_t>& indices, uint32_t seed)
+	{
+		std::vector<uint32_t> order(indices.size() / 3);
+		for (uint32_t t{}; t < order.size(); ++t)
+		{
+			order[t] = t;
+		}
+		std::shuffle(order.begin(), order.end(), std::mt19937{ seed });
+
+		std::vector<uint32_t> shuffled{};
+		shuffled.reserve(indices.size());
+		for (const uint32_t t : order)
+		{
+			shuffled.insert(shuffled.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+		}
+		indices = std::move(shuffled);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "DataTypes.h"
+
+// Meshes the tests share: the vehicle of source/Resources and small synthetic ones
+namespace dae::Tests
+{
+	struct TestMesh
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	// Parsed and welded like MeshGeometry::Load does, once per run. Fails the calling test when the file is missing
+	const TestMesh& GetVehicle();
+
+	// Flat grid of width x height quads in the xy plane, facing +z, triangles in row order
+	TestMesh CreateGrid(uint32_t width, uint32_t height);
+
+	// Triangle order shuffled with a fixed seed, the vertices of each triangle stay in order
+	void ShuffleTriangles(std::vector<uint32_t>& indices, uint32_t seed = 1234);
+}
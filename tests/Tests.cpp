@@ -0,0 +1,137 @@
+// Tests for the CPU side of the renderer: OBJ parsing, the .dmesh cache, mesh processing, glTF loading, vertex packing, levels of detail, mip generation, block compression, the .dtex cache, the math types and Transform.
+// Builds without SDL and DirectX (DAE_HEADLESS), run it from the repository root so it finds source/Resources:
+//
+//   g++ -std=c++20 -O2 -DDAE_HEADLESS -Isource tests/*.cpp source/BlockCompression.cpp source/FrustumCulling.cpp
+//       source/Gltf.cpp source/MappedFile.cpp source/MeshCache.cpp source/MeshletCulling.cpp source/MeshProcessing.cpp source/MipGeneration.cpp
+//       source/TangentSpace.cpp source/TextureCache.cpp source/Transform.cpp source/Utils.cpp source/VertexFormat.cpp -pthread -o Tests
+//   cl /std:c++20 /O2 /EHsc /DDAE_HEADLESS /Isource tests\*.cpp source\BlockCompression.cpp source\FrustumCulling.cpp
+//       source\Gltf.cpp source\MappedFile.cpp source\MeshCache.cpp source\MeshletCulling.cpp source\MeshProcessing.cpp source\MipGeneration.cpp
+//       source\TangentSpace.cpp source\TextureCache.cpp source\Transform.cpp source\Utils.cpp source\VertexFormat.cpp /FeTests.exe
+//
+// Add -DDAE_MATH_SCALAR for the portable math code, the SIMD and scalar builds have to pass the same tests. With FMA enabled
+// (-mfma, -mavx512f, -march=native) also add -ffp-contract=off: GCC and Clang fuse the scalar a * b + c but not the intrinsics,
+// so the SIMD paths wouldn't match the scalar code bit for bit any more. MSVC doesn't fuse unless told to with /fp:contract. Usage:
+//
+//   Tests [--filter <text>] [--resources <directory>]
+//
+// Exits with 1 when a check failed, 2 on bad arguments
+#include "Tests.h"
+#include "MathBackend.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace dae::Tests
+{
+	namespace
+	{
+		struct Test
+		{
+			const char* name;
+			TestFunction function;
+		};
+
+		// Function local, registration runs during static initialization of the other files
+		std::vector<Test>& GetTests()
+		{
+			static std::vector<Test> tests{};
+			return tests;
+		}
+
+		std::string g_ResourceDirectory{ "source/Resources" };
+		uint32_t g_NumFailedChecks{};
+	}
+
+	bool Register(const char* name, TestFunction function)
+	{
+		GetTests().push_back({ name, function });
+		return true;
+	}
+
+	void Fail(const char* file, int line, const std::string& message)
+	{
+		++g_NumFailedChecks;
+		std::cout << "[TEST]   " << file << "(" << line << "): " << message << "\n";
+	}
+
+	std::string GetResourcePath(const std::string& fileName)
+	{
+		return g_ResourceDirectory + "/" + fileName;
+	}
+
+	TemporaryFile::TemporaryFile(const std::string& name)
+		: m_Path{ (std::filesystem::temp_directory_path() / name).string() }
+	{
+	}
+
+	TemporaryFile::TemporaryFile(const std::string& name, const std::string& bytes)
+		: TemporaryFile{ name }
+	{
+		Write(bytes);
+	}
+
+	TemporaryFile::~TemporaryFile()
+	{
+		std::error_code error{};
+		std::filesystem::remove(m_Path, error);
+	}
+
+	std::string TemporaryFile::Read() const
+	{
+		std::ifstream file{ m_Path, std::ios::binary };
+		return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+	}
+
+	void TemporaryFile::Write(const std::string& bytes) const
+	{
+		std::ofstream file{ m_Path, std::ios::binary | std::ios::trunc };
+		file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using namespace dae::Tests;
+
+	std::string filter{};
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if (std::strcmp(argv[i], "--resources") == 0 && i + 1 < argc)
+			g_ResourceDirectory = argv[++i];
+		else
+		{
+			std::cout << "Usage: Tests [--filter <text>] [--resources <directory>]\n";
+			return 2;
+		}
+	}
+
+	std::cout << "[TEST] Math backend: " << dae::mathBackendName << "\n";
+	uint32_t numTests{};
+	uint32_t numFailedTests{};
+	for (const Test& test : GetTests())
+	{
+		if (!filter.empty() && std::strstr(test.name, filter.c_str()) == nullptr)
+			continue;
+
+		const uint32_t numFailedChecks{ g_NumFailedChecks };
+		const auto startTime{ std::chrono::steady_clock::now() };
+		test.function();
+		const float milliseconds{ std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() };
+
+		++numTests;
+		const bool isPassed{ g_NumFailedChecks == numFailedChecks };
+		if (!isPassed)
+			++numFailedTests;
+		std::cout << "[TEST] " << test.name << ": " << (isPassed ? "passed" : "FAILED") << " in " << milliseconds << " ms\n";
+	}
+
+	std::cout << "[TEST] " << numTests - numFailedTests << "/" << numTests << " tests passed\n";
+	return numFailedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <sstream>
+#include <string>
+
+// Checks for the standalone test executable, see Tests.cpp for building and running it.
+// A failed CHECK reports itself and the test goes on, so one run shows every failure
+namespace dae::Tests
+{
+	using TestFunction = void(*)();
+
+	bool Register(const char* name, TestFunction function);
+	void Fail(const char* file, int line, const std::string& message);
+
+	// fileName in source/Resources, or in the directory given with --resources
+	std::string GetResourcePath(const std::string& fileName);
+
+	// name in the temp directory, removed again when it goes out of scope. For the loaders that map a file
+	class TemporaryFile final
+	{
+	public:
+		explicit TemporaryFile(const std::string& name);
+		TemporaryFile(const std::string& name, const std::string& bytes);
+		~TemporaryFile();
+
+		TemporaryFile(const TemporaryFile& other) = delete;
+		TemporaryFile& operator=(const TemporaryFile& other) = delete;
+		TemporaryFile(TemporaryFile&& other) = delete;
+		TemporaryFile& operator=(TemporaryFile&& other) = delete;
+
+		const std::string& GetPath() const { return m_Path; }
+		std::string Read() const;
+		void Write(const std::string& bytes) const;
+
+	private:
+		std::string m_Path;
+	};
+}
+
+#define DAE_TEST(name) \
+	static void name(); \
+	static const bool name##IsRegistered{ dae::Tests::Register(#name, name) }; \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) dae::Tests::Fail(__FILE__, __LINE__, #condition); } while (false)
+
+// message is streamed, e.g. CHECK_MESSAGE(error <= bound, "error " << error << " > " << bound)
+#define CHECK_MESSAGE(condition, message) \
+	do { if (!(condition)) { std::ostringstream stream{}; stream << #condition << ": " << message; dae::Tests::Fail(__FILE__, __LINE__, stream.str()); } } while (false)
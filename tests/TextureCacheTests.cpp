@@ -0,0 +1,150 @@
+#include "Tests.h"
+#include "MappedFile.h"
+#include "TextureCache.h"
+
+#include <cstddef>
+#include <cstring>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	constexpr uint64_t sourceHash{ 0xFEDCBA9876543210 };
+	constexpr uint64_t sourceSize{ 2048 };
+	constexpr uint32_t importKey{ 5 };
+	constexpr uint32_t size{ 16 };
+
+	template<typename T>
+	void Patch(std::string& bytes, size_t offset, T value)
+	{
+		std::memcpy(bytes.data() + offset, &value, sizeof(value));
+	}
+
+	size_t GetLevelFieldOffset(uint32_t level, size_t field)
+	{
+		return offsetof(TextureCache::Header, levels) + level * sizeof(TextureCache::Level) + field;
+	}
+
+	bool IsValid(const std::string& bytes)
+	{
+		const TemporaryFile file{ "dae_tests_patched.dtex", bytes };
+		const MappedFile mapping{ file.GetPath() };
+		return TextureCache::Validate(mapping, sourceHash, sourceSize, importKey) != nullptr;
+	}
+
+	MipGeneration::MipChain CreateChain()
+	{
+		std::vector<uint8_t> pixels(size_t{ size } * size * 4);
+		for (size_t i{}; i < pixels.size(); ++i)
+			pixels[i] = static_cast<uint8_t>(i * 7 + i / 64);
+
+		MipGeneration::MipOptions options{};
+		options.numThreads = 1;
+		MipGeneration::MipChain chain{};
+		MipGeneration::GenerateMips(pixels.data(), size, size, size * 4, options, chain);
+		return chain;
+	}
+
+	// Every level where the header says, holding what was written
+	void CheckRoundTrip(const std::string& path, const std::vector<MipGeneration::MipLevel>& levels, const std::vector<uint8_t>& data,
+		TextureCache::PixelFormat format, uint64_t contentHash)
+	{
+		const MappedFile mapping{ path };
+		const TextureCache::Header* pHeader{ TextureCache::Validate(mapping, sourceHash, sourceSize, importKey) };
+		CHECK(pHeader);
+		CHECK(!TextureCache::Validate(mapping, sourceHash, sourceSize + 1, importKey));
+		CHECK(!TextureCache::Validate(mapping, sourceHash, sourceSize, importKey + 1));
+		if (!pHeader)
+			return;
+
+		CHECK(pHeader->format == format && pHeader->contentHash == contentHash && pHeader->numLevels == levels.size());
+		for (uint32_t i{}; i < pHeader->numLevels && i < levels.size(); ++i)
+		{
+			const TextureCache::Level& level{ pHeader->levels[i] };
+			CHECK(level.offset % TextureCache::levelAlignment == 0);
+			CHECK(level.width == levels[i].width && level.height == levels[i].height);
+			CHECK_MESSAGE(std::memcmp(TextureCache::GetLevelData(*pHeader, i), data.data() + levels[i].offset, level.size) == 0, "level " << i);
+		}
+	}
+}
+
+DAE_TEST(TextureCacheRoundTrip)
+{
+	const MipGeneration::MipChain chain{ CreateChain() };
+	const TemporaryFile file{ "dae_tests.dtex" };
+	uint64_t contentHash{};
+	CHECK(TextureCache::Write(file.GetPath(), sourceHash, sourceSize, importKey, chain, &contentHash));
+	CheckRoundTrip(file.GetPath(), chain.levels, chain.pixels, TextureCache::PixelFormat::RGBA8, contentHash);
+
+	// The same texels from another source hash the same, so the resource cache shares them
+	const TemporaryFile other{ "dae_tests_other.dtex" };
+	uint64_t otherContentHash{};
+	CHECK(TextureCache::Write(other.GetPath(), sourceHash + 1, sourceSize, importKey, chain, &otherContentHash));
+	CHECK(otherContentHash == contentHash);
+
+	BlockCompression::EncodeOptions options{};
+	options.format = BlockCompression::Format::BC1;
+	options.numThreads = 1;
+	BlockCompression::CompressedChain compressed{};
+	BlockCompression::EncodeChain(chain, options, compressed);
+	const TemporaryFile compressedFile{ "dae_tests_bc1.dtex" };
+	uint64_t compressedContentHash{};
+	CHECK(TextureCache::Write(compressedFile.GetPath(), sourceHash, sourceSize, importKey, compressed, &compressedContentHash));
+	CHECK(compressedContentHash != contentHash);
+	CheckRoundTrip(compressedFile.GetPath(), compressed.levels, compressed.blocks, TextureCache::PixelFormat::BC1, compressedContentHash);
+}
+
+DAE_TEST(TextureCacheRejectsTruncatedAndDamaged)
+{
+	const MipGeneration::MipChain chain{ CreateChain() };
+	const TemporaryFile file{ "dae_tests.dtex" };
+	CHECK(TextureCache::Write(file.GetPath(), sourceHash, sourceSize, importKey, chain));
+	const std::string bytes{ file.Read() };
+	CHECK(IsValid(bytes));
+
+	TextureCache::Header header{};
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	const TextureCache::Level& lastLevel{ header.levels[header.numLevels - 1] };
+
+	// Cut in the header and in the last level
+	CHECK(!IsValid(bytes.substr(0, sizeof(TextureCache::Header) - 1)));
+	CHECK(!IsValid(bytes.substr(0, static_cast<size_t>(lastLevel.offset + lastLevel.size - 1))));
+
+	// Header fields
+	const struct
+	{
+		size_t offset;
+		uint32_t value;
+		const char* name;
+	} fields[]{
+		{ offsetof(TextureCache::Header, magic), 0, "magic" },
+		{ offsetof(TextureCache::Header, version), TextureCache::version + 1, "version" },
+		{ offsetof(TextureCache::Header, format), static_cast<uint32_t>(TextureCache::PixelFormat::BC7) + 1, "format" },
+		{ offsetof(TextureCache::Header, numLevels), 0, "no levels" },
+		{ offsetof(TextureCache::Header, numLevels), TextureCache::maxLevels + 1, "too many levels" },
+		{ GetLevelFieldOffset(1, offsetof(TextureCache::Level, width)), size, "level 1 not halved" },
+		{ GetLevelFieldOffset(0, offsetof(TextureCache::Level, rowPitch)), size * 4 + 4, "row pitch" },
+		{ GetLevelFieldOffset(0, offsetof(TextureCache::Level, size)), size * size * 4 - 4, "level size" }
+	};
+	for (const auto& field : fields)
+	{
+		std::string damaged{ bytes };
+		Patch(damaged, field.offset, field.value);
+		CHECK_MESSAGE(!IsValid(damaged), field.name);
+	}
+
+	// Level offsets misaligned, overlapping the level before and past the end of the file
+	const size_t level1Offset{ GetLevelFieldOffset(1, offsetof(TextureCache::Level, offset)) };
+	for (const uint64_t offset : { header.levels[1].offset + 4, header.levels[0].offset, uint64_t{ bytes.size() } })
+	{
+		std::string damaged{ bytes };
+		Patch(damaged, level1Offset, offset);
+		CHECK_MESSAGE(!IsValid(damaged), "level 1 at " << offset);
+	}
+
+	// Level 0 holds 1024 bytes. At 2^64 - 512 its end wraps around to 512, before level 1 and inside the file
+	std::string wrapped{ bytes };
+	Patch(wrapped, GetLevelFieldOffset(0, offsetof(TextureCache::Level, offset)), uint64_t{} - TextureCache::levelAlignment);
+	CHECK(!IsValid(wrapped));
+}
@@ -0,0 +1,168 @@
+#include "Tests.h"
+#include "Transform.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+#ifdef DAE_MATH_SIMD
+	constexpr size_t simdWidth{ SimdFloat::width };
+#else
+	constexpr size_t simdWidth{ 1 };
+#endif
+
+	// In [-1, 1)
+	struct Random
+	{
+		uint32_t state{};
+
+		float Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return static_cast<float>(state >> 8) / 8388608.f - 1.f;
+		}
+
+		Vector3 NextVector(float scale)
+		{
+			return Vector3{ Next(), Next(), Next() } * scale;
+		}
+
+		// Within [0.5, 2] on every axis, mirrored where it comes out negative
+		Vector3 NextScale()
+		{
+			Vector3 scale{ NextVector(1.f) };
+			for (int axis{}; axis < 3; ++axis)
+				scale[axis] = (scale[axis] < 0.f ? -0.5f : 0.5f) + scale[axis] * 1.5f;
+			return scale;
+		}
+
+		Quaternion NextRotation()
+		{
+			return Quaternion::CreateFromAxisAngle(NextVector(1.f) + Vector3{ 0.f, 0.f, 1.5f }, Next() * PI);
+		}
+	};
+
+	void SetRandomTransform(Random& random, Transform& transform)
+	{
+		transform.SetScale(random.NextScale());
+		transform.SetRotation(random.NextRotation());
+		transform.SetPosition(random.NextVector(100.f));
+	}
+
+	bool AreIdentical(const Matrix& a, const Matrix& b)
+	{
+		for (int r{}; r < 4; ++r)
+		{
+			for (int c{}; c < 4; ++c)
+			{
+				if (a[r][c] != b[r][c])
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// Relative to the entry, or absolute below 1. The last column can be a difference of terms up to translationScale,
+	// it's relative to that instead when it's larger
+	void CheckNear(const Matrix& result, const Matrix& expected, float tolerance, const char* name, size_t index, float translationScale = 0.f)
+	{
+		for (int r{}; r < 4; ++r)
+		{
+			for (int c{}; c < 4; ++c)
+			{
+				const float scale{ std::max({ 1.f, std::abs(expected[r][c]), c == 3 ? translationScale : 0.f }) };
+				CHECK_MESSAGE(AreEqual(result[r][c], expected[r][c], tolerance * scale),
+					name << " of transform " << index << ": " << result[r][c] << " instead of " << expected[r][c] << " at " << r << ", " << c);
+			}
+		}
+	}
+}
+
+DAE_TEST(TransformWorldMatrixIsScaleRotationTranslation)
+{
+	const Transform identity{};
+	CHECK(!identity.IsDirty());
+	CHECK(AreIdentical(identity.GetWorldMatrix(), Matrix{ Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, Vector3::Zero }));
+
+	Random random{ 1 };
+	for (size_t i{}; i < 256; ++i)
+	{
+		Transform transform{};
+		SetRandomTransform(random, transform);
+		CHECK(transform.IsDirty());
+
+		const Matrix expected{ Matrix::CreateScale(transform.GetScale()) * Matrix::CreateRotation(transform.GetRotation())
+			* Matrix::CreateTranslation(transform.GetPosition()) };
+		const Matrix& world{ transform.GetWorldMatrix() };
+		CHECK(!transform.IsDirty());
+		CheckNear(world, expected, 1e-6f, "GetWorldMatrix", i);
+
+		// The rotation's transpose instead of a general inverse, so they agree up to float rounding. The w column is the
+		// translation projected on the axes and divided by the scale, up to 100 / 0.5
+		const Vector3& scale{ transform.GetScale() };
+		const float minScale{ std::min({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) }) };
+		CheckNear(transform.GetInverseTransposeWorldMatrix(), Matrix::Transpose(Matrix::InverseAffine(world)), 1e-5f,
+			"GetInverseTransposeWorldMatrix", i, transform.GetPosition().Magnitude() / minScale);
+	}
+}
+
+DAE_TEST(TransformUpdateWorldMatricesMatchesOneAtATime)
+{
+	// Three full blocks and a partial one, with clean transforms in between that have to be left as they are
+	const size_t numDirty{ 3 * simdWidth + simdWidth / 2 + 1 };
+	std::vector<std::unique_ptr<Transform>> batched{};
+	std::vector<std::unique_ptr<Transform>> expected{};
+	std::vector<Transform*> pBatched{};
+	Random random{ 2 };
+	for (size_t i{}; i < numDirty; ++i)
+	{
+		Transform& transform{ *batched.emplace_back(std::make_unique<Transform>()) };
+		SetRandomTransform(random, transform);
+		expected.emplace_back(std::make_unique<Transform>(transform));
+		pBatched.push_back(&transform);
+
+		if (i % 3 == 0)
+		{
+			Transform& clean{ *batched.emplace_back(std::make_unique<Transform>()) };
+			clean.SetPosition(random.NextVector(100.f));
+			clean.GetWorldMatrix();
+			expected.emplace_back(std::make_unique<Transform>(clean));
+			pBatched.push_back(&clean);
+		}
+	}
+
+	Transform::UpdateWorldMatrices(pBatched);
+
+	// The SIMD lanes do the same operations in the same order as the scalar code, so nothing is allowed to differ
+	uint32_t numMismatches{};
+	for (size_t i{}; i < batched.size(); ++i)
+	{
+		CHECK_MESSAGE(!batched[i]->IsDirty(), "transform " << i << " is still dirty");
+		if (!AreIdentical(batched[i]->GetWorldMatrix(), expected[i]->GetWorldMatrix())
+			|| !AreIdentical(batched[i]->GetInverseTransposeWorldMatrix(), expected[i]->GetInverseTransposeWorldMatrix()))
+		{
+			if (numMismatches++ == 0)
+				CHECK_MESSAGE(false, "transform " << i << " differs from the one-at-a-time rebuild in the " << mathBackendName << " build");
+		}
+	}
+	CHECK_MESSAGE(numMismatches == 0, numMismatches << " of " << batched.size() << " transforms");
+}
+
+DAE_TEST(QuaternionRotationsMatchMatrixRotations)
+{
+	// Half angle against full angle through FastMath::SinCos, so they agree up to its error
+	constexpr float tolerance{ 1e-4f };
+	Random random{ 3 };
+	for (size_t i{}; i < 256; ++i)
+	{
+		const float angle{ random.Next() * 2.f * PI };
+		CheckNear(Matrix::CreateRotation(Quaternion::CreateRotationX(angle)), Matrix::CreateRotationX(angle), tolerance, "CreateRotationX", i);
+		CheckNear(Matrix::CreateRotation(Quaternion::CreateRotationY(angle)), Matrix::CreateRotationY(angle), tolerance, "CreateRotationY", i);
+		CheckNear(Matrix::CreateRotation(Quaternion::CreateRotationZ(angle)), Matrix::CreateRotationZ(angle), tolerance, "CreateRotationZ", i);
+	}
+}
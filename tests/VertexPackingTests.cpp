@@ -0,0 +1,189 @@
+#include "Tests.h"
+#include "TestMeshes.h"
+#include "VertexFormat.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace dae;
+using namespace dae::Tests;
+
+namespace
+{
+	// Batched and one at a time Unpack only differ in how the float math is ordered
+	constexpr float unpackTolerance{ 1e-6f };
+
+	// Axis-aligned directions, signed zeros and the seams of the octahedral fold, each as normal and tangent.
+	// An odd count, so Pack ends on the scalar tail
+	std::vector<Vertex> CreateEdgeVertices()
+	{
+		const float zero{ 0.f };
+		const float negativeZero{ -0.f };
+		const float belowEquator{ -1e-7f };
+		std::vector<Vector3> directions
+		{
+			Vector3::UnitX, -Vector3::UnitX, Vector3::UnitY, -Vector3::UnitY, Vector3::UnitZ, -Vector3::UnitZ,
+			{ negativeZero, zero, 1.f }, { zero, negativeZero, 1.f }, { negativeZero, negativeZero, -1.f }, { zero, negativeZero, -1.f },
+			{ 1.f, negativeZero, zero }, { negativeZero, 1.f, negativeZero }, { -1.f, zero, negativeZero }, { negativeZero, -1.f, negativeZero },
+			// Corners of the folded lower half
+			{ 1.f, 1.f, -1.f }, { -1.f, 1.f, -1.f }, { 1.f, -1.f, -1.f }, { -1.f, -1.f, -1.f },
+			{ 1.f, 0.f, -1.f }, { 0.f, 1.f, -1.f }, { -1.f, 0.f, -1.f }, { 0.f, -1.f, -1.f }
+		};
+		// Around the equator, on it and just below it where the fold starts
+		for (int i{}; i < 16; ++i)
+		{
+			const float angle{ i * 2.f * PI / 16.f };
+			directions.push_back({ std::cos(angle), std::sin(angle), 0.f });
+			directions.push_back({ std::cos(angle), std::sin(angle), belowEquator });
+		}
+		directions.push_back({ 0.3f, -0.2f, 0.5f });
+
+		const float uvs[]{ 0.f, -0.f, 1.f, 0.5f, 0.999f, -3.75f, 1e-6f, 1e-8f };
+		std::vector<Vertex> vertices{};
+		for (size_t i{}; i < directions.size(); ++i)
+		{
+			const float offset{ static_cast<float>(i) };
+			const Vector3& tangent{ directions[(i + 1) % directions.size()] };
+			vertices.push_back({ { offset, -2.f * offset, 0.25f * offset }, { uvs[i % std::size(uvs)], uvs[(i + 3) % std::size(uvs)] }, directions[i],
+				{ tangent, i % 2 == 0 ? 1.f : -1.f } });
+		}
+		return vertices;
+	}
+
+	// Pack must not care which path a vertex takes
+	void CheckBatchedMatchesScalar(const std::vector<Vertex>& vertices, const VertexPacking::QuantizationBounds& bounds)
+	{
+		std::vector<PackedVertex> batched(vertices.size());
+		VertexPacking::Pack(vertices.data(), vertices.size(), bounds, batched.data());
+
+		uint32_t numMismatches{};
+		for (size_t i{}; i < vertices.size(); ++i)
+		{
+			PackedVertex scalar{};
+			VertexPacking::Pack(&vertices[i], 1, bounds, &scalar);
+			if (std::memcmp(&scalar, &batched[i], sizeof(PackedVertex)) != 0 && numMismatches++ == 0)
+				CHECK_MESSAGE(false, "vertex " << i << " packs differently in a batch of four");
+		}
+		CHECK_MESSAGE(numMismatches == 0, numMismatches << " of " << vertices.size() << " vertices");
+	}
+
+	bool IsNear(float a, float b)
+	{
+		return std::abs(a - b) <= unpackTolerance * std::max(1.f, std::abs(b));
+	}
+
+	void CheckBatchedUnpackMatchesScalar(const std::vector<PackedVertex>& packed, const VertexPacking::QuantizationBounds& bounds)
+	{
+		std::vector<Vertex> batched(packed.size());
+		VertexPacking::Unpack(packed.data(), packed.size(), bounds, batched.data());
+
+		uint32_t numMismatches{};
+		for (size_t i{}; i < packed.size(); ++i)
+		{
+			Vertex scalar{};
+			VertexPacking::Unpack(&packed[i], 1, bounds, &scalar);
+			const Vertex& vertex{ batched[i] };
+			const bool isNear{ IsNear(vertex.position.x, scalar.position.x) && IsNear(vertex.position.y, scalar.position.y) && IsNear(vertex.position.z, scalar.position.z)
+				&& IsNear(vertex.uv.x, scalar.uv.x) && IsNear(vertex.uv.y, scalar.uv.y)
+				&& IsNear(vertex.normal.x, scalar.normal.x) && IsNear(vertex.normal.y, scalar.normal.y) && IsNear(vertex.normal.z, scalar.normal.z)
+				&& IsNear(vertex.tangent.x, scalar.tangent.x) && IsNear(vertex.tangent.y, scalar.tangent.y) && IsNear(vertex.tangent.z, scalar.tangent.z)
+				&& vertex.tangent.w == scalar.tangent.w };
+			if (!isNear && numMismatches++ == 0)
+				CHECK_MESSAGE(false, "vertex " << i << " unpacks differently in a batch of four");
+		}
+		CHECK_MESSAGE(numMismatches == 0, numMismatches << " of " << packed.size() << " vertices");
+	}
+
+	void CheckWithinErrorBounds(const std::vector<Vertex>& vertices)
+	{
+		const VertexPacking::QuantizationBounds bounds{ VertexPacking::ComputeBounds(vertices.data(), vertices.size()) };
+		std::vector<PackedVertex> packed(vertices.size());
+		VertexPacking::Pack(vertices.data(), vertices.size(), bounds, packed.data());
+
+		const VertexPacking::PackingError error{ VertexPacking::MeasureError(vertices.data(), packed.data(), vertices.size(), bounds) };
+		const VertexPacking::PackingError errorBounds{ VertexPacking::GetErrorBounds(vertices.data(), vertices.size(), bounds) };
+		CHECK_MESSAGE(error.position <= errorBounds.position, error.position << " > " << errorBounds.position);
+		CHECK_MESSAGE(error.uv <= errorBounds.uv, error.uv << " > " << errorBounds.uv);
+		CHECK_MESSAGE(error.normal <= errorBounds.normal, error.normal << " > " << errorBounds.normal << " radians");
+		CHECK_MESSAGE(error.tangent <= errorBounds.tangent, error.tangent << " > " << errorBounds.tangent << " radians");
+		CHECK(error.handednessMismatches == 0);
+		CHECK(VertexPacking::IsWithinBounds(error, errorBounds));
+
+		CheckBatchedUnpackMatchesScalar(packed, bounds);
+	}
+}
+
+DAE_TEST(PackVehicleWithinErrorBounds)
+{
+	CheckWithinErrorBounds(GetVehicle().vertices);
+}
+
+DAE_TEST(PackEdgeDirectionsWithinErrorBounds)
+{
+	const std::vector<Vertex> vertices{ CreateEdgeVertices() };
+	CheckWithinErrorBounds(vertices);
+
+	// The axes and their signed zeros come back exactly
+	const VertexPacking::QuantizationBounds bounds{ VertexPacking::ComputeBounds(vertices.data(), vertices.size()) };
+	std::vector<PackedVertex> packed(vertices.size());
+	std::vector<Vertex> unpacked(vertices.size());
+	VertexPacking::Pack(vertices.data(), vertices.size(), bounds, packed.data());
+	VertexPacking::Unpack(packed.data(), packed.size(), bounds, unpacked.data());
+	for (size_t i{}; i < 14; ++i)
+	{
+		const Vector3 expected{ vertices[i].normal.Normalized() };
+		const Vector3& normal{ unpacked[i].normal };
+		CHECK_MESSAGE(std::abs(normal.x) == std::abs(expected.x) && std::abs(normal.y) == std::abs(expected.y) && normal.z == expected.z,
+			"vertex " << i << ": (" << normal.x << ", " << normal.y << ", " << normal.z << ")");
+	}
+}
+
+DAE_TEST(PackBatchedMatchesScalar)
+{
+	const std::vector<Vertex>& vehicle{ GetVehicle().vertices };
+	CheckBatchedMatchesScalar(vehicle, VertexPacking::ComputeBounds(vehicle.data(), vehicle.size()));
+
+	const std::vector<Vertex> edgeVertices{ CreateEdgeVertices() };
+	CheckBatchedMatchesScalar(edgeVertices, VertexPacking::ComputeBounds(edgeVertices.data(), edgeVertices.size()));
+
+	// Directions without an encoding, positions outside the bounds and every half value, with the ties between them as uvs
+	constexpr float infinity{ std::numeric_limits<float>::infinity() };
+	constexpr float nan{ std::numeric_limits<float>::quiet_NaN() };
+	std::vector<Vertex> vertices{};
+	const Vector3 directions[]{ Vector3::Zero, { infinity, 0.f, 0.f }, { nan, 1.f, 0.f }, { 0.f, -infinity, -1.f }, { 0.2f, -0.7f, -0.1f } };
+	for (uint32_t half{}; half <= 0xffff; ++half)
+	{
+		const float value{ VertexPacking::HalfToFloat(static_cast<uint16_t>(half)) };
+		const float nextValue{ VertexPacking::HalfToFloat(static_cast<uint16_t>(half + 1)) };
+		const float tie{ 0.5f * value + 0.5f * nextValue };
+		const float position{ static_cast<float>(half % 7) - 3.f };
+		vertices.push_back({ { position, -position, 2.f * position }, { value, tie }, directions[half % std::size(directions)],
+			{ directions[(half + 2) % std::size(directions)], half % 3 == 0 ? -0.f : -1.f } });
+	}
+	vertices.resize(vertices.size() - 1);
+	CheckBatchedMatchesScalar(vertices, VertexPacking::ComputeBounds({ -2.f, -2.f, -2.f }, { 2.f, 2.f, 2.f }));
+}
+
+DAE_TEST(HalfRoundTrip)
+{
+	uint32_t numMismatches{};
+	for (uint32_t half{}; half <= 0xffff; ++half)
+	{
+		const float value{ VertexPacking::HalfToFloat(static_cast<uint16_t>(half)) };
+		if (std::isnan(value))
+			continue;
+		const uint16_t roundTrip{ VertexPacking::FloatToHalf(value) };
+		if (roundTrip != half && numMismatches++ == 0)
+			CHECK_MESSAGE(false, std::hex << half << " -> " << value << " -> " << roundTrip);
+	}
+	CHECK(numMismatches == 0);
+
+	// Past the largest half, and ties rounding to even
+	CHECK(VertexPacking::FloatToHalf(65520.f) == 0x7c00);
+	CHECK(VertexPacking::FloatToHalf(-65520.f) == 0xfc00);
+	CHECK(VertexPacking::FloatToHalf(65519.f) == 0x7bff);
+	CHECK(VertexPacking::FloatToHalf(1.f + std::ldexp(1.f, -11)) == 0x3c00);
+	CHECK(VertexPacking::FloatToHalf(1.f + 3.f * std::ldexp(1.f, -11)) == 0x3c02);
+	CHECK(std::isnan(VertexPacking::HalfToFloat(VertexPacking::FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+}